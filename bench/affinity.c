@@ -0,0 +1,334 @@
+/*
+ * affinity.c
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains a benchmark of resuming a suspended process on the CPU
+ * that it last ran on. A child process repeatedly touches a working set of
+ * memory, and is time-sliced by stopping and continuing it, as the host
+ * dispatcher would. Before each slice the child is either restricted to the CPU
+ * that it last ran on (as restart_PCB() does while its cache is warm), or moved
+ * to a different CPU (as may happen when resuming on a cold CPU). For each, the
+ * rate at which the child touches memory is reported, along with its
+ * instructions per cycle if the hardware performance counters are available.
+ *
+ * Usage: affinity_bench [-m kilobytes] [-s slice] [-r rounds]
+ */
+#define _GNU_SOURCE // for MAP_ANONYMOUS, syscall() and the CPU_* macros
+
+#include "../inc/affinity.h"
+#include "../inc/output.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <signal.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#define BENCH_KILOBYTES     1024    // default size of the working set of the child (in kilobytes)
+#define BENCH_SLICE_MS      20      // default length of each slice (in milliseconds)
+#define BENCH_ROUNDS        50      // default number of slices for each placement
+#define BENCH_LINE          64      // stride with which the working set is touched (a cache line, in bytes)
+
+// An enumerator to identify where the child is resumed
+typedef enum {
+    Last_CPU_Placement, // the CPU that the child last ran on
+    Other_CPU_Placement // a different CPU from the one that the child last ran on
+} Placement;
+
+// The results of time-slicing the child with a placement
+typedef struct Result {
+    double touched_mb; // memory touched by the child (in megabytes)
+    double seconds; // time for which the child was running
+    unsigned long long instructions; // instructions retired by the child (0 if not counted)
+    unsigned long long cycles; // cycles used by the child (0 if not counted)
+    unsigned int migrations; // number of slices that started on a different CPU from the previous slice
+} Result;
+
+static void run(Placement placement, unsigned int kilobytes, unsigned int slice_ms, unsigned int rounds, Result * result);
+static void touch(unsigned int kilobytes, volatile uint64_t * passes);
+static int open_counter(pid_t pid, uint64_t config);
+static unsigned long long read_counter(int fd);
+static int other_cpu(int cpu);
+static double elapsed_s(struct timespec * start, struct timespec * stop);
+
+/*
+ * The main function for the CPU affinity benchmark.
+ *
+ * PARAMETERS
+ *     argc: The number of arguments.
+ *     argv: The arguments.
+ *
+ * RETURN VALUE
+ * An integer representing the exit status of the program. (0 = success)
+ */
+int main(int argc, char * argv[]) {
+    unsigned int kilobytes = BENCH_KILOBYTES; // size of the working set of the child (in kilobytes)
+    unsigned int slice_ms = BENCH_SLICE_MS; // length of each slice (in milliseconds)
+    unsigned int rounds = BENCH_ROUNDS; // number of slices for each placement
+    const char * names[] = { "last", "other" }; // the names of the placements
+    double base = 0.0; // rate at which memory was touched when resumed on the last CPU (in megabytes per second)
+    cpu_set_t allowed; // the CPUs that the benchmark may run on
+    int option; // command line option
+
+    while ((option = getopt(argc, argv, "m:s:r:")) != -1) {
+        switch (option) {
+            case 'm':
+                kilobytes = (unsigned int) strtoul(optarg, NULL, 10);
+                break;
+            case 's':
+                slice_ms = (unsigned int) strtoul(optarg, NULL, 10);
+                break;
+            case 'r':
+                rounds = (unsigned int) strtoul(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(__ERROR_OUTPUT, "Usage: %s [-m kilobytes] [-s slice] [-r rounds]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if ((kilobytes == 0) || (slice_ms == 0) || (rounds == 0)) {
+        fprintf(__ERROR_OUTPUT, "The working set, slice length and number of rounds must be positive.\n");
+        return 1;
+    }
+    if ((sched_getaffinity(0, sizeof(allowed), &allowed) != 0) || (CPU_COUNT(&allowed) < 2)) {
+        fprintf(__ERROR_OUTPUT, "Only one CPU is available, so the child cannot be moved to a different CPU.\n");
+    }
+
+    fprintf(__STANDARD_OUTPUT, "resume_on\tworking_kb\tslices\tmigrations\tmb_per_s\tipc\tspeedup\n");
+    for (Placement placement = Last_CPU_Placement; placement <= Other_CPU_Placement; placement++) {
+        Result result; // the results of the placement
+        double rate; // rate at which memory was touched (in megabytes per second)
+
+        run(placement, kilobytes, slice_ms, rounds, &result);
+        rate = (result.seconds > 0.0) ? result.touched_mb / result.seconds : 0.0;
+        if (placement == Last_CPU_Placement) {
+            base = rate;
+        }
+
+        fprintf(__STANDARD_OUTPUT, "%s\t%d\t%d\t%d\t%.0f\t", names[placement], kilobytes, rounds, result.migrations, rate);
+        if (result.cycles > 0) {
+            fprintf(__STANDARD_OUTPUT, "%.3f\t", (double) result.instructions / result.cycles);
+        } else {
+            fprintf(__STANDARD_OUTPUT, "-\t");
+        }
+        fprintf(__STANDARD_OUTPUT, "%.2f\n", (rate > 0.0) ? base / rate : 0.0);
+        fflush(__STANDARD_OUTPUT);
+    }
+
+    return 0;
+}
+
+/*
+ * Time-slices a child that touches a working set of memory, resuming it with a
+ * placement before each slice.
+ *
+ * PARAMETERS
+ *     placement: Where the child is resumed.
+ *     kilobytes: The size of the working set of the child (in kilobytes).
+ *     slice_ms: The length of each slice (in milliseconds).
+ *     rounds: The number of slices.
+ *     result: Set to the results.
+ */
+static void run(Placement placement, unsigned int kilobytes, unsigned int slice_ms, unsigned int rounds, Result * result) {
+    volatile uint64_t * passes; // number of passes over the working set made by the child (shared with the child)
+    struct timespec slice = { slice_ms / 1000, (long) (slice_ms % 1000) * 1000000 }; // length of each slice
+    struct timespec started, stopped; // start and end of a slice
+    int instructions, cycles; // the performance counters of the child (-1 if unavailable)
+    int previous = AFFINITY_NO_CPU; // the CPU that the previous slice ran on
+    uint64_t before; // passes made before the slice
+    pid_t pid; // the system process ID of the child
+    int status;
+
+    memset(result, 0, sizeof(Result));
+    passes = (volatile uint64_t *) mmap(NULL, sizeof(uint64_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (passes == MAP_FAILED) {
+        fprintf(__ERROR_OUTPUT, "Unable to allocate memory for the benchmark.\n");
+        exit(1);
+    }
+    *passes = 0;
+
+    switch (pid = fork()) {
+        case -1:
+            fprintf(__ERROR_OUTPUT, "Unable to fork the child.\n");
+            exit(1);
+        case 0:
+            touch(kilobytes, passes);
+            _exit(0);
+        default:
+            break;
+    }
+
+    // Wait for the child to make its first pass (faulting its working set in), and then stop it
+    while (__atomic_load_n(passes, __ATOMIC_RELAXED) == 0) {
+        sched_yield();
+    }
+    kill(pid, SIGSTOP);
+    waitpid(pid, &status, WUNTRACED);
+    instructions = open_counter(pid, PERF_COUNT_HW_INSTRUCTIONS);
+    cycles = open_counter(pid, PERF_COUNT_HW_CPU_CYCLES);
+
+    for (unsigned int i = 0; i < rounds; i++) {
+        int cpu; // the CPU that the child last ran on
+
+        if (affinity_last_cpu(pid, &cpu)) {
+            if (placement == Other_CPU_Placement) {
+                int other = other_cpu(cpu); // a different CPU
+
+                affinity_pin_cpu(pid, (other != AFFINITY_NO_CPU) ? other : cpu);
+            } else {
+                affinity_pin_cpu(pid, cpu);
+            }
+        }
+
+        before = __atomic_load_n(passes, __ATOMIC_RELAXED);
+        clock_gettime(CLOCK_MONOTONIC, &started);
+        kill(pid, SIGCONT);
+        nanosleep(&slice, NULL);
+        kill(pid, SIGSTOP);
+        waitpid(pid, &status, WUNTRACED);
+        clock_gettime(CLOCK_MONOTONIC, &stopped);
+
+        result->seconds += elapsed_s(&started, &stopped);
+        result->touched_mb += (double) (__atomic_load_n(passes, __ATOMIC_RELAXED) - before) * kilobytes / 1024.0;
+        if (affinity_last_cpu(pid, &cpu)) {
+            if ((previous != AFFINITY_NO_CPU) && (cpu != previous)) {
+                result->migrations++;
+            }
+            previous = cpu;
+        }
+
+        // Leave the CPU idle for a slice, as if another process were running
+        nanosleep(&slice, NULL);
+    }
+
+    if ((instructions >= 0) && (cycles >= 0)) {
+        result->instructions = read_counter(instructions);
+        result->cycles = read_counter(cycles);
+    }
+    if (instructions >= 0) {
+        close(instructions);
+    }
+    if (cycles >= 0) {
+        close(cycles);
+    }
+
+    kill(pid, SIGKILL);
+    waitpid(pid, &status, 0);
+    munmap((void *) passes, sizeof(uint64_t));
+}
+
+/*
+ * Repeatedly touches every cache line of a working set of memory. This function
+ * does not return.
+ *
+ * PARAMETERS
+ *     kilobytes: The size of the working set (in kilobytes).
+ *     passes: Incremented after each pass over the working set.
+ */
+static void touch(unsigned int kilobytes, volatile uint64_t * passes) {
+    size_t size = (size_t) kilobytes * 1024; // size of the working set (in bytes)
+    volatile unsigned char * memory = (volatile unsigned char *) malloc(size); // the working set
+
+    if (memory == NULL) {
+        _exit(1);
+    }
+
+    for (;;) {
+        for (size_t i = 0; i < size; i += BENCH_LINE) {
+            memory[i]++;
+        }
+        __atomic_add_fetch(passes, 1, __ATOMIC_RELAXED);
+    }
+}
+
+/*
+ * Opens a hardware performance counter of the user-space execution of a
+ * process.
+ *
+ * PARAMETERS
+ *     pid: The system process ID of the process.
+ *     config: The hardware event to count.
+ *
+ * RETURN VALUE
+ * The file descriptor of the counter, or -1 if it is unavailable.
+ */
+static int open_counter(pid_t pid, uint64_t config) {
+    struct perf_event_attr attr; // the counter
+
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    return (int) syscall(SYS_perf_event_open, &attr, pid, -1, -1, 0);
+}
+
+/*
+ * Reads a hardware performance counter.
+ *
+ * PARAMETERS
+ *     fd: The file descriptor of the counter.
+ *
+ * RETURN VALUE
+ * The value of the counter (0 if it could not be read).
+ */
+static unsigned long long read_counter(int fd) {
+    uint64_t value = 0; // the value of the counter
+
+    if (read(fd, &value, sizeof(value)) != (ssize_t) sizeof(value)) {
+        return 0;
+    }
+    return (unsigned long long) value;
+}
+
+/*
+ * Finds a CPU that the benchmark may run on, other than a given CPU - the next
+ * such CPU after it, wrapping around.
+ *
+ * PARAMETERS
+ *     cpu: The CPU.
+ *
+ * RETURN VALUE
+ * The other CPU, or AFFINITY_NO_CPU if there is none.
+ */
+static int other_cpu(int cpu) {
+    cpu_set_t allowed; // the CPUs that the benchmark may run on
+
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return AFFINITY_NO_CPU;
+    }
+    for (int i = 1; i < CPU_SETSIZE; i++) {
+        int other = (cpu + i) % CPU_SETSIZE; // the next CPU
+
+        if (CPU_ISSET(other, &allowed)) {
+            return other;
+        }
+    }
+
+    return AFFINITY_NO_CPU;
+}
+
+/*
+ * Calculates the time elapsed between two times.
+ *
+ * PARAMETERS
+ *     start: The earlier time.
+ *     stop: The later time.
+ *
+ * RETURN VALUE
+ * The time elapsed (in seconds).
+ */
+static double elapsed_s(struct timespec * start, struct timespec * stop) {
+    return (double) (stop->tv_sec - start->tv_sec) + (double) (stop->tv_nsec - start->tv_nsec) / 1e9;
+}
@@ -0,0 +1,206 @@
+/*
+ * banker.c
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains a benchmark of the banker's algorithm. A number of
+ * processes are admitted with random maximum claims, and then randomly acquire
+ * and release resources within their claims. Each request is checked both with
+ * the full O(n^2 m) safety check, and with banker_request() (which keeps a safe
+ * sequence and only falls back to the full check when the sequence cannot
+ * absorb the request). The time per request of each is reported as the number
+ * of processes and the number of resources of each type grow, along with how
+ * often banker_request() needed the full check and whether the two ever
+ * disagreed.
+ *
+ * Usage: banker_bench [-r requests] [-s seed]
+ */
+#define _POSIX_C_SOURCE 200809L // for clock_gettime() and getopt()
+
+#include "../inc/banker.h"
+#include "../inc/PCB.h"
+#include "../inc/RAS.h"
+#include "../inc/output.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_REQUESTS      20000   // default number of requests for each configuration
+#define BENCH_SEED          1       // default seed of the random number generator
+#define BENCH_MAX_CLAIM     8       // largest maximum claim of a process for each type of resource
+
+// The results of a configuration
+typedef struct Result {
+    double full_ns; // total time of the full safety checks (in nanoseconds)
+    double incremental_ns; // total time of banker_request() (in nanoseconds)
+    unsigned int checked; // number of requests checked by both (there were enough free resources)
+    unsigned int granted; // number of requests granted
+    unsigned int full_checks; // number of requests for which banker_request() needed the full check
+    unsigned int mismatches; // number of requests for which banker_request() and the full check disagreed
+} Result;
+
+static void run(unsigned int processes, unsigned int devices, unsigned int requests, Result * result);
+static double elapsed_ns(struct timespec * start, struct timespec * stop);
+
+/*
+ * The main function for the banker's algorithm benchmark.
+ *
+ * PARAMETERS
+ *     argc: The number of arguments.
+ *     argv: The arguments.
+ *
+ * RETURN VALUE
+ * An integer representing the exit status of the program. (0 = success)
+ */
+int main(int argc, char * argv[]) {
+    const unsigned int processes[] = { 16, 64, 256, 1024, 4096 }; // the numbers of processes
+    const unsigned int devices[] = { 16, 256, 4096 }; // the numbers of resources of each type
+    unsigned int requests = BENCH_REQUESTS; // number of requests for each configuration
+    unsigned int seed = BENCH_SEED; // seed of the random number generator
+    int option; // command line option
+
+    while ((option = getopt(argc, argv, "r:s:")) != -1) {
+        switch (option) {
+            case 'r':
+                requests = (unsigned int) strtoul(optarg, NULL, 10);
+                break;
+            case 's':
+                seed = (unsigned int) strtoul(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(__ERROR_OUTPUT, "Usage: %s [-r requests] [-s seed]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if (requests == 0) {
+        fprintf(__ERROR_OUTPUT, "The number of requests must be positive.\n");
+        return 1;
+    }
+
+    fprintf(__STANDARD_OUTPUT, "processes\tdevices\tchecked\tgranted\tfull_ns\tincremental_ns\tfallbacks\tmismatches\tspeedup\n");
+    for (unsigned int d = 0; d < sizeof(devices) / sizeof(devices[0]); d++) {
+        for (unsigned int p = 0; p < sizeof(processes) / sizeof(processes[0]); p++) {
+            Result result; // the results of the configuration
+            double full, incremental; // time per request (in nanoseconds)
+
+            srand(seed);
+            run(processes[p], devices[d], requests, &result);
+            full = (result.checked > 0) ? result.full_ns / result.checked : 0.0;
+            incremental = (result.checked > 0) ? result.incremental_ns / result.checked : 0.0;
+
+            fprintf(__STANDARD_OUTPUT, "%d\t%d\t%d\t%d\t%.0f\t%.0f\t%d\t%d\t%.1f\n", processes[p], devices[d], result.checked, result.granted, full, incremental, result.full_checks, result.mismatches, (incremental > 0.0) ? full / incremental : 0.0);
+            fflush(__STANDARD_OUTPUT);
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Admits processes with random maximum claims, and makes random requests and
+ * releases on their behalf.
+ *
+ * PARAMETERS
+ *     processes: The number of processes.
+ *     devices: The number of resources of each type.
+ *     requests: The number of requests and releases.
+ *     result: Set to the results.
+ */
+static void run(unsigned int processes, unsigned int devices, unsigned int requests, Result * result) {
+    PCB * pcbs = (PCB *) calloc(processes, sizeof(PCB)); // the processes (only the fields used by the banker are set)
+    ResourcePool pool; // the resources
+    Banker banker; // the state of the banker's algorithm
+    struct timespec start, stop; // start and end of a timed call
+
+    memset(result, 0, sizeof(Result));
+    if (pcbs == NULL) {
+        fprintf(__ERROR_OUTPUT, "Unable to allocate %d processes.\n", processes);
+        return;
+    }
+
+    create_resources(&pool, devices, devices, devices, devices);
+    banker_init(&banker);
+
+    // Each process claims up to BENCH_MAX_CLAIM of each type of resource (and no more than half of them)
+    for (unsigned int i = 0; i < processes; i++) {
+        unsigned int limit = (devices / 2 < BENCH_MAX_CLAIM) ? devices / 2 : BENCH_MAX_CLAIM; // largest claim of each type
+
+        pcbs[i].id = i + 1;
+        pcbs[i].banker_position = BANKER_NOT_ADMITTED;
+        pcbs[i].num_printers = 1 + (unsigned int) rand() % limit;
+        pcbs[i].num_scanners = 1 + (unsigned int) rand() % limit;
+        pcbs[i].num_modems = 1 + (unsigned int) rand() % limit;
+        pcbs[i].num_cds = 1 + (unsigned int) rand() % limit;
+        banker_admit(&banker, &pool, &pcbs[i]);
+    }
+
+    for (unsigned int n = 0; n < requests; n++) {
+        PCB * pcb = &pcbs[(unsigned int) rand() % processes]; // the process making the request
+        ResourceType type = (ResourceType) (Printer_Resource + (unsigned int) rand() % (NUM_RESOURCE_TYPES - Printer_Resource)); // the type of resource
+        BankerEntry * entry = &banker.entries[pcb->banker_position]; // the entry of the process
+        unsigned int request[NUM_RESOURCE_TYPES]; // the request
+        boolean safe; // whether the full check found the request safe
+        BankerResult outcome; // the outcome of banker_request()
+
+        memset(request, 0, sizeof(request));
+
+        // Release everything of the type half of the time (or if nothing more can be claimed)
+        if ((entry->held[type] > 0) && ((rand() % 2 == 0) || (entry->held[type] == entry->claim[type]))) {
+            request[type] = entry->held[type];
+            banker_release(&banker, pcb, request);
+            resource_release(&pool, type, pcb, request[type]);
+            continue;
+        }
+        if (entry->held[type] == entry->claim[type]) {
+            continue;
+        }
+        request[type] = 1 + (unsigned int) rand() % (entry->claim[type] - entry->held[type]);
+        if (request[type] > resource_available(&pool, type)) {
+            continue;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        safe = banker_is_safe(&banker, &pool, pcb, request, NULL);
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+        result->full_ns += elapsed_ns(&start, &stop);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        outcome = banker_request(&banker, &pool, pcb, request);
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+        result->incremental_ns += elapsed_ns(&start, &stop);
+
+        result->checked++;
+        if (safe != (outcome == Banker_Granted)) {
+            result->mismatches++;
+        }
+        if (outcome == Banker_Granted) {
+            for (unsigned int i = 0; i < request[type]; i++) {
+                resource_alloc(&pool, type, pcb);
+            }
+            result->granted++;
+        }
+    }
+    result->full_checks = banker.full_checks;
+
+    banker_destroy(&banker);
+    resource_destroy(&pool);
+    free(pcbs);
+}
+
+/*
+ * Calculates the time between two instants.
+ *
+ * PARAMETERS
+ *     start: The first instant.
+ *     stop: The second instant.
+ *
+ * RETURN VALUE
+ * The time between the instants (in nanoseconds).
+ */
+static double elapsed_ns(struct timespec * start, struct timespec * stop) {
+    return (double) (stop->tv_sec - start->tv_sec) * 1e9 + (double) (stop->tv_nsec - start->tv_nsec);
+}
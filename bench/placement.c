@@ -0,0 +1,382 @@
+/*
+ * placement.c
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains a benchmark of the memory placement policies. Synthetic
+ * traces of processes are replayed against the MAB allocator with each
+ * placement policy, and the external fragmentation, admission delay and
+ * allocator cost are reported for each combination.
+ *
+ * Usage: placement_bench [-n processes] [-s seed]
+ */
+#define _POSIX_C_SOURCE 200809L // for clock_gettime() and getopt()
+
+#include "../inc/MAB.h"
+#include "../inc/output.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_MEMORY            1024    // total memory (in megabytes)
+#define BENCH_RESERVED_MEMORY   64      // memory reserved for real time processes (in megabytes)
+#define BENCH_PROCESSES         20000   // default number of processes per trace
+#define BENCH_SEED              1       // default random seed
+#define BENCH_REPLAYS           20      // number of times the allocator operations are replayed for timing
+#define BENCH_MAX_DURATION      20      // maximum duration of a process (in ticks)
+
+// An enumerator to identify the synthetic trace
+typedef enum {
+    Mixed_Trace, // 64 MB real time processes mixed with many small user processes
+    Small_Trace, // only small user processes
+    Bimodal_Trace, // small user processes mixed with occasional large user processes
+    NUM_TRACES
+} Trace;
+
+// A process in a synthetic trace
+typedef struct Process {
+    unsigned int arrival_time; // time at which the process arrives
+    unsigned int duration; // time for which the process holds its memory
+    unsigned int mbytes; // memory required by the process
+    boolean real_time; // whether the process is a real time process (which may use the reserved memory)
+    unsigned int start_time; // time at which the process was allocated memory
+    MAB * memory; // the MAB allocated to the process
+} Process;
+
+// An allocator operation, recorded so that it can be replayed for timing
+typedef struct Operation {
+    unsigned int process; // the process performing the operation
+    boolean alloc; // whether the operation is an allocation (otherwise it is a free)
+} Operation;
+
+// The results of replaying a trace with a placement policy
+typedef struct Result {
+    double mean_fragmentation; // mean external fragmentation of free memory
+    double max_fragmentation; // maximum external fragmentation of free memory
+    double mean_delay; // mean admission delay
+    unsigned int p95_delay; // 95th percentile admission delay
+    unsigned int max_delay; // maximum admission delay
+    double ns_per_op; // mean cost of an allocator operation
+} Result;
+
+static MemoryPool _memory; // the memory that processes are allocated from
+static PlacementPolicy _policy; // the placement policy of the memory
+
+static unsigned long _random_state; // state of the random number generator
+
+static void generate_trace(Trace trace, Process * processes, unsigned int n);
+static unsigned int simulate(Process * processes, unsigned int n, Operation * operations, Result * result);
+static double replay(Process * processes, Operation * operations, unsigned int num_operations);
+static boolean try_alloc(Process * process);
+static unsigned int random_uniform(unsigned int lo, unsigned int hi);
+static int compare_unsigned(const void * a, const void * b);
+static const char * trace_name(Trace trace);
+
+/*
+ * The main function for the placement policy benchmark.
+ *
+ * PARAMETERS
+ *     argc: The number of arguments.
+ *     argv: The arguments.
+ *
+ * RETURN VALUE
+ * An integer representing the exit status of the program. (0 = success)
+ */
+int main(int argc, char * argv[]) {
+    unsigned int n = BENCH_PROCESSES; // number of processes per trace
+    unsigned long seed = BENCH_SEED; // random seed
+    int option; // command line option
+
+    while ((option = getopt(argc, argv, "n:s:")) != -1) {
+        switch (option) {
+            case 'n':
+                n = (unsigned int) strtoul(optarg, NULL, 10);
+                break;
+            case 's':
+                seed = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(__ERROR_OUTPUT, "Usage: %s [-n processes] [-s seed]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    Process * processes = (Process *) malloc(n * sizeof(Process)); // the processes in the trace
+    Operation * operations = (Operation *) malloc(2 * n * sizeof(Operation)); // the allocator operations
+    if ((n == 0) || (processes == NULL) || (operations == NULL)) {
+        fprintf(__ERROR_OUTPUT, "Unable to allocate a trace of %u processes.\n", n);
+        return 1;
+    }
+
+    fprintf(__STANDARD_OUTPUT, "trace\tpolicy\tprocesses\tmean_frag\tmax_frag\tmean_delay\tp95_delay\tmax_delay\tns_per_op\n");
+
+    for (Trace trace = Mixed_Trace; trace < NUM_TRACES; trace++) {
+        for (PlacementPolicy policy = First_Fit; policy <= Worst_Fit; policy++) {
+            Result result; // the results for this trace and policy
+            unsigned int num_operations; // number of recorded allocator operations
+
+            // Every policy replays the same trace
+            _random_state = seed + trace;
+            generate_trace(trace, processes, n);
+
+            _policy = policy;
+            num_operations = simulate(processes, n, operations, &result);
+            result.ns_per_op = replay(processes, operations, num_operations);
+
+            fprintf(__STANDARD_OUTPUT, "%s\t%s\t%u\t%.4f\t%.4f\t%.2f\t%u\t%u\t%.1f\n", trace_name(trace), mem_policy_name(policy), n, result.mean_fragmentation, result.max_fragmentation, result.mean_delay, result.p95_delay, result.max_delay, result.ns_per_op);
+        }
+    }
+
+    free(processes);
+    free(operations);
+    return 0;
+}
+
+/*
+ * Generates a synthetic trace. Processes arrive at a rate of roughly two per
+ * tick.
+ *
+ * PARAMETERS
+ *     trace: The type of trace to generate.
+ *     processes: Array in which to store the processes.
+ *     n: The number of processes to generate.
+ */
+static void generate_trace(Trace trace, Process * processes, unsigned int n) {
+    unsigned int time = 0; // arrival time of the next process
+
+    for (unsigned int i = 0; i < n; i++) {
+        Process * p = &processes[i];
+
+        time += random_uniform(0, 1);
+        p->arrival_time = time;
+        p->duration = random_uniform(1, BENCH_MAX_DURATION);
+        p->real_time = false;
+        p->start_time = 0;
+        p->memory = NULL;
+
+        switch (trace) {
+            case Mixed_Trace:
+                if (random_uniform(0, 99) < 15) {
+                    p->real_time = true;
+                    p->mbytes = 64;
+                    p->duration = random_uniform(1, 3);
+                } else {
+                    p->mbytes = random_uniform(1, 96);
+                }
+                break;
+
+            case Small_Trace:
+                p->mbytes = random_uniform(1, 32);
+                break;
+
+            default:
+                p->mbytes = (random_uniform(0, 99) < 10) ? random_uniform(200, 400) : random_uniform(1, 48);
+                break;
+        }
+    }
+}
+
+/*
+ * Simulates a trace, admitting processes first come, first served (with any
+ * process that fits admitted ahead of blocked processes) and releasing their
+ * memory when their duration expires.
+ *
+ * PARAMETERS
+ *     processes: The processes in the trace.
+ *     n: The number of processes.
+ *     operations: Array in which to record the allocator operations.
+ *     result: Set to the fragmentation and delay results.
+ *
+ * RETURN VALUE
+ * The number of recorded allocator operations.
+ */
+static unsigned int simulate(Process * processes, unsigned int n, Operation * operations, Result * result) {
+    unsigned int * delays = (unsigned int *) malloc(n * sizeof(unsigned int)); // admission delay of each process
+    unsigned int * pending = (unsigned int *) malloc(n * sizeof(unsigned int)); // processes waiting for memory, in arrival order
+    unsigned int * resident = (unsigned int *) malloc(n * sizeof(unsigned int)); // processes holding memory
+    unsigned int num_pending = 0, num_resident = 0, num_operations = 0, admitted = 0, next = 0, samples = 0;
+    double total_fragmentation = 0.0, total_delay = 0.0;
+
+    result->max_fragmentation = 0.0;
+    mem_init(&_memory, BENCH_MEMORY);
+    mem_set_policy(&_memory, _policy);
+
+    for (unsigned int time = 0; admitted < n; time++) {
+        // Release the memory of processes that have completed
+        for (unsigned int i = 0; i < num_resident;) {
+            Process * p = &processes[resident[i]];
+            if (p->start_time + p->duration <= time) {
+                operations[num_operations].process = resident[i];
+                operations[num_operations++].alloc = false;
+                p->memory = mem_free(&_memory, p->memory);
+                resident[i] = resident[--num_resident];
+            } else {
+                i++;
+            }
+        }
+
+        // Add arriving processes to the pending list
+        while ((next < n) && (processes[next].arrival_time <= time)) {
+            pending[num_pending++] = next++;
+        }
+
+        // Admit any pending process that fits
+        for (unsigned int i = 0; i < num_pending;) {
+            Process * p = &processes[pending[i]];
+            if (try_alloc(p)) {
+                operations[num_operations].process = pending[i];
+                operations[num_operations++].alloc = true;
+                p->start_time = time;
+                delays[admitted++] = time - p->arrival_time;
+                total_delay += time - p->arrival_time;
+                resident[num_resident++] = pending[i];
+
+                // Keep the pending list in arrival order
+                for (unsigned int j = i + 1; j < num_pending; j++) {
+                    pending[j - 1] = pending[j];
+                }
+                num_pending--;
+            } else {
+                i++;
+            }
+        }
+
+        // Sample the fragmentation
+        if (mem_total_free(&_memory) > 0) {
+            double fragmentation = mem_fragmentation(&_memory);
+            total_fragmentation += fragmentation;
+            samples++;
+            if (fragmentation > result->max_fragmentation) {
+                result->max_fragmentation = fragmentation;
+            }
+        }
+    }
+
+    // Release the memory of the remaining processes
+    for (unsigned int i = 0; i < num_resident; i++) {
+        operations[num_operations].process = resident[i];
+        operations[num_operations++].alloc = false;
+        processes[resident[i]].memory = mem_free(&_memory, processes[resident[i]].memory);
+    }
+    mem_destroy(&_memory);
+
+    qsort(delays, n, sizeof(unsigned int), compare_unsigned);
+    result->mean_fragmentation = (samples > 0) ? (total_fragmentation / samples) : 0.0;
+    result->mean_delay = total_delay / n;
+    result->p95_delay = delays[(n * 95) / 100];
+    result->max_delay = delays[n - 1];
+
+    free(delays);
+    free(pending);
+    free(resident);
+    return num_operations;
+}
+
+/*
+ * Replays the recorded allocator operations, and measures their cost.
+ *
+ * PARAMETERS
+ *     processes: The processes in the trace.
+ *     operations: The recorded allocator operations.
+ *     num_operations: The number of recorded allocator operations.
+ *
+ * RETURN VALUE
+ * The mean cost of an allocator operation (in nanoseconds).
+ */
+static double replay(Process * processes, Operation * operations, unsigned int num_operations) {
+    struct timespec start, stop; // time at which the replay started and stopped
+    double elapsed = 0.0; // total time spent replaying (in nanoseconds)
+
+    for (unsigned int r = 0; r < BENCH_REPLAYS; r++) {
+        mem_init(&_memory, BENCH_MEMORY);
+        mem_set_policy(&_memory, _policy);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (unsigned int i = 0; i < num_operations; i++) {
+            Process * p = &processes[operations[i].process];
+            if (operations[i].alloc) {
+                try_alloc(p);
+            } else {
+                p->memory = mem_free(&_memory, p->memory);
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+
+        elapsed += (stop.tv_sec - start.tv_sec) * 1e9 + (stop.tv_nsec - start.tv_nsec);
+        mem_destroy(&_memory);
+    }
+
+    return (num_operations > 0) ? (elapsed / ((double) num_operations * BENCH_REPLAYS)) : 0.0;
+}
+
+/*
+ * Attempts to allocate memory for a process. User processes must leave enough
+ * memory for a real time process.
+ *
+ * PARAMETERS
+ *     process: The process.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the memory was allocated.
+ */
+static boolean try_alloc(Process * process) {
+    MAB * m = mem_reserve(&_memory, process->mbytes, process->real_time ? 0 : BENCH_RESERVED_MEMORY); // the reserved MAB
+
+    return ((m != NULL) && ((process->memory = mem_commit(&_memory, m, process->mbytes)) != NULL));
+}
+
+/*
+ * Generates a pseudo-random integer in a range, using a linear congruential
+ * generator so that traces are reproducible across platforms.
+ *
+ * PARAMETERS
+ *     lo: The lower bound (inclusive).
+ *     hi: The upper bound (inclusive).
+ *
+ * RETURN VALUE
+ * The random integer.
+ */
+static unsigned int random_uniform(unsigned int lo, unsigned int hi) {
+    _random_state = (_random_state * 6364136223846793005UL + 1442695040888963407UL) & 0xFFFFFFFFFFFFFFFFUL;
+    return lo + (unsigned int) ((_random_state >> 33) % (hi - lo + 1));
+}
+
+/*
+ * Compares two unsigned integers, for use with qsort().
+ *
+ * PARAMETERS
+ *     a: The first integer.
+ *     b: The second integer.
+ *
+ * RETURN VALUE
+ * A negative, zero or positive value if a is less than, equal to or greater
+ * than b.
+ */
+static int compare_unsigned(const void * a, const void * b) {
+    unsigned int x = *((const unsigned int *) a);
+    unsigned int y = *((const unsigned int *) b);
+
+    return (x > y) - (x < y);
+}
+
+/*
+ * Gets the name of a synthetic trace.
+ *
+ * PARAMETERS
+ *     trace: The trace.
+ *
+ * RETURN VALUE
+ * The name of the trace.
+ */
+static const char * trace_name(Trace trace) {
+    switch (trace) {
+        case Mixed_Trace:
+            return "mixed";
+        case Small_Trace:
+            return "small";
+        default:
+            return "bimodal";
+    }
+}
@@ -0,0 +1,427 @@
+/*
+ * ring.c
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains a benchmark of process submission through the submission
+ * ring of the host dispatcher. The benchmark starts a host dispatcher with a
+ * control socket and a submission ring, and then measures:
+ *     - The end-to-end latency of single submissions: the time until the host
+ *       dispatcher drains the record from the ring, and the time until the
+ *       process prints its START line. The process is a real time process, so
+ *       it is started at the next tick.
+ *     - The sustained enqueue rate of a number of producer processes, which
+ *       each attach to the ring and submit processes that arrive far in the
+ *       future (so that they remain on the input queue and are never started).
+ *       The rate includes the time for the host dispatcher to drain every
+ *       record.
+ *
+ * Usage: ring_bench [-x hostd] [-c socket] [-r slots] [-p producers]
+ *                   [-n processes] [-l samples]
+ */
+#define _POSIX_C_SOURCE 200809L // for clock_gettime(), getopt() and kill()
+
+#include "../inc/ring.h"
+#include "../inc/output.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#define BENCH_HOSTD         "./hostd"   // default path of the host dispatcher
+#define BENCH_SOCKET        "hostd.sock" // default path of the control socket
+#define BENCH_SLOTS         "16384"     // default number of slots in the submission ring
+#define BENCH_PRODUCERS     4           // default number of producer processes
+#define BENCH_PROCESSES     100000      // default number of processes submitted by each producer
+#define BENCH_SAMPLES       5           // default number of submissions for which latency is measured
+#define BENCH_ARRIVAL       1000000     // arrival time of the processes submitted by the producers
+#define BENCH_CONNECT_TRIES 100         // number of attempts to connect to the control socket (every 50 ms)
+#define BENCH_START_TIMEOUT 5000        // maximum time to wait for a process to start (in milliseconds)
+#define BENCH_LINE          4096        // maximum length of a line of output of the host dispatcher that is checked
+
+static pid_t start_hostd(const char * hostd, const char * socket_path, const char * slots, int * output);
+static boolean wait_for_socket(const char * path);
+static boolean shutdown_hostd(const char * path);
+static unsigned int read_output(int fd, int timeout);
+static void producer(const char * path, unsigned int n, unsigned int id);
+static double elapsed_s(struct timespec * start, struct timespec * stop);
+
+/*
+ * The main function for the submission ring benchmark.
+ *
+ * PARAMETERS
+ *     argc: The number of arguments.
+ *     argv: The arguments.
+ *
+ * RETURN VALUE
+ * An integer representing the exit status of the program. (0 = success)
+ */
+int main(int argc, char * argv[]) {
+    const char * hostd = BENCH_HOSTD; // path of the host dispatcher
+    const char * path = BENCH_SOCKET; // path of the control socket
+    const char * slots = BENCH_SLOTS; // number of slots in the submission ring
+    unsigned int producers = BENCH_PRODUCERS; // number of producer processes
+    unsigned int n = BENCH_PROCESSES; // number of processes submitted by each producer
+    unsigned int samples = BENCH_SAMPLES; // number of submissions for which latency is measured
+    int option; // command line option
+
+    while ((option = getopt(argc, argv, "c:l:n:p:r:x:")) != -1) {
+        switch (option) {
+            case 'c':
+                path = optarg;
+                break;
+            case 'l':
+                samples = (unsigned int) strtoul(optarg, NULL, 10);
+                break;
+            case 'n':
+                n = (unsigned int) strtoul(optarg, NULL, 10);
+                break;
+            case 'p':
+                producers = (unsigned int) strtoul(optarg, NULL, 10);
+                break;
+            case 'r':
+                slots = optarg;
+                break;
+            case 'x':
+                hostd = optarg;
+                break;
+            default:
+                fprintf(__ERROR_OUTPUT, "Usage: %s [-x hostd] [-c socket] [-r slots] [-p producers] [-n processes] [-l samples]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if ((producers == 0) || (n == 0)) {
+        fprintf(__ERROR_OUTPUT, "Usage: %s [-x hostd] [-c socket] [-r slots] [-p producers] [-n processes] [-l samples]\n", argv[0]);
+        return 1;
+    }
+
+    // Start the host dispatcher and attach to its submission ring
+    int output; // the standard output of the host dispatcher
+    pid_t pid = start_hostd(hostd, path, slots, &output); // the host dispatcher
+    Ring * ring; // the submission ring
+
+    if (pid < 0) {
+        return 1;
+    }
+    if (!wait_for_socket(path) || ((ring = ring_connect(path)) == NULL)) {
+        kill(pid, SIGKILL);
+        waitpid(pid, NULL, 0);
+        return 1;
+    }
+
+    // Measure the latency of single submissions
+    double accept_total_us = 0, start_total_ms = 0, start_max_ms = 0; // latency totals (and maximum)
+    unsigned int started = 0; // number of latency samples for which the process started
+
+    for (unsigned int i = 0; i < samples; i++) {
+        ProcessRecord record = { 0, 0, 1, 16, 0, 0, 0, 0, 0, { 0 }, 0, 1, 1 }; // a real time process that runs for one tick
+        struct timespec submitted, accepted, now; // time of submission, of the record being drained and of the process starting
+        uint64_t position; // position of the record in the ring
+        unsigned int lines = 0; // number of START lines read
+
+        // Discard any output of the previous sample
+        read_output(output, 0);
+
+        clock_gettime(CLOCK_MONOTONIC, &submitted);
+        ring_submit(ring, &record, true, &position);
+        while (!ring_drained(ring, position)) {
+            // Spin until the host dispatcher drains the record
+        }
+        clock_gettime(CLOCK_MONOTONIC, &accepted);
+
+        do {
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            lines = read_output(output, 10);
+        } while ((lines == 0) && (elapsed_s(&submitted, &now) * 1000 < BENCH_START_TIMEOUT));
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        accept_total_us += elapsed_s(&submitted, &accepted) * 1e6;
+        if (lines > 0) {
+            double start_ms = elapsed_s(&submitted, &now) * 1000; // the start latency of this sample
+            start_total_ms += start_ms;
+            if (start_ms > start_max_ms) {
+                start_max_ms = start_ms;
+            }
+            started++;
+        }
+
+        // Wait for the process to complete before the next sample
+        read_output(output, 1100);
+    }
+
+    // Measure the sustained enqueue rate of the producers
+    struct timespec start, stop; // time at which the producers started and all records were drained
+    uint64_t last; // position of the last record submitted by the producers
+    unsigned int remaining = producers; // number of producers still running
+    unsigned int failed = 0; // number of producers that failed
+
+    last = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) + (uint64_t) producers * n - 1;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (unsigned int i = 0; i < producers; i++) {
+        pid_t child = fork(); // the producer
+
+        if (child == 0) {
+            close(output);
+            producer(path, n, i);
+        } else if (child < 0) {
+            fprintf(__ERROR_OUTPUT, "Unable to fork producer %u.\n", i);
+            failed++;
+            remaining--;
+        }
+    }
+
+    // Keep reading the output of the host dispatcher, so that it is never blocked writing whilst the producers are waiting for it
+    while (remaining > 0) {
+        int status; // the exit status of a producer
+        pid_t child; // a producer that has exited
+
+        while ((child = waitpid(-1, &status, WNOHANG)) > 0) {
+            if (child == pid) {
+                fprintf(__ERROR_OUTPUT, "The host dispatcher exited during the benchmark.\n");
+                return 1;
+            }
+            if (!WIFEXITED(status) || (WEXITSTATUS(status) != 0)) {
+                failed++;
+            }
+            remaining--;
+        }
+        read_output(output, 1);
+    }
+    if (failed == 0) {
+        while (!ring_drained(ring, last)) {
+            read_output(output, 0);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+
+    // Shut down the host dispatcher, discarding the remaining output until it exits
+    char buffer[BENCH_LINE]; // the output discarded
+
+    ring_destroy(ring);
+    shutdown_hostd(path);
+    while (read(output, buffer, sizeof(buffer)) > 0);
+    close(output);
+    waitpid(pid, NULL, 0);
+
+    if (failed > 0) {
+        fprintf(__ERROR_OUTPUT, "%u of %u producers failed.\n", failed, producers);
+        return 1;
+    }
+
+    unsigned long total = (unsigned long) producers * n; // number of processes submitted by the producers
+
+    fprintf(__STANDARD_OUTPUT, "producers\tprocesses\tslots\tseconds\tprocesses_per_s\tsamples\taccept_us\tstart_ms\tstart_max_ms\n");
+    fprintf(__STANDARD_OUTPUT, "%u\t%lu\t%s\t%.3f\t%.0f\t%u\t%.1f\t%.1f\t%.1f\n", producers, total, slots, elapsed_s(&start, &stop), total / elapsed_s(&start, &stop), started, (samples > 0) ? accept_total_us / samples : 0, (started > 0) ? start_total_ms / started : 0, start_max_ms);
+
+    return (started < samples) ? 1 : 0;
+}
+
+/*
+ * Starts a host dispatcher with a control socket and a submission ring.
+ *
+ * PARAMETERS
+ *     hostd: The path of the host dispatcher.
+ *     socket_path: The path of the control socket.
+ *     slots: The number of slots in the submission ring.
+ *     output: Set to a pipe from the standard output of the host dispatcher.
+ *
+ * RETURN VALUE
+ * The PID of the host dispatcher, or -1 if it could not be started.
+ */
+static pid_t start_hostd(const char * hostd, const char * socket_path, const char * slots, int * output) {
+    int fds[2]; // the pipe from the standard output of the host dispatcher
+    pid_t pid; // the host dispatcher
+
+    if (pipe(fds) != 0) {
+        fprintf(__ERROR_OUTPUT, "Unable to create a pipe.\n");
+        return -1;
+    }
+
+    if ((pid = fork()) == 0) {
+        int null = open("/dev/null", O_WRONLY); // standard error is discarded
+
+        dup2(fds[1], STDOUT_FILENO);
+        dup2(null, STDERR_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        close(null);
+        execl(hostd, hostd, "-c", socket_path, "-r", slots, (char *) NULL);
+        _exit(127);
+    } else if (pid < 0) {
+        fprintf(__ERROR_OUTPUT, "Unable to fork the host dispatcher.\n");
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+
+    close(fds[1]);
+    *output = fds[0];
+    return pid;
+}
+
+/*
+ * Waits for the control socket of the host dispatcher to accept connections.
+ *
+ * PARAMETERS
+ *     path: The path of the control socket.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the control socket accepted a connection.
+ */
+static boolean wait_for_socket(const char * path) {
+    struct sockaddr_un address; // the address of the control socket
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+
+    for (unsigned int i = 0; i < BENCH_CONNECT_TRIES; i++) {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0); // the socket connected to the host dispatcher
+
+        if ((fd >= 0) && (connect(fd, (struct sockaddr *) &address, sizeof(address)) == 0)) {
+            close(fd);
+            return true;
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+        nanosleep(&(struct timespec) { 0, 50000000L }, NULL);
+    }
+
+    fprintf(__ERROR_OUTPUT, "Unable to connect to control socket '%s'.\n", path);
+    return false;
+}
+
+/*
+ * Shuts down the host dispatcher at the end of its current tick.
+ *
+ * PARAMETERS
+ *     path: The path of the control socket.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the request was sent.
+ */
+static boolean shutdown_hostd(const char * path) {
+    struct sockaddr_un address; // the address of the control socket
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0); // the socket connected to the host dispatcher
+    boolean sent; // whether the request was sent
+    char response; // the first byte of the response
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+
+    sent = (fd >= 0) && (connect(fd, (struct sockaddr *) &address, sizeof(address)) == 0) && (send(fd, "SHUTDOWN NOW\n", 13, MSG_NOSIGNAL) == 13) && (recv(fd, &response, 1, 0) == 1);
+    if (fd >= 0) {
+        close(fd);
+    }
+
+    return sent;
+}
+
+/*
+ * Reads the output of the host dispatcher, counting the START lines printed by
+ * processes.
+ *
+ * PARAMETERS
+ *     fd: The pipe from the standard output of the host dispatcher.
+ *     timeout: The time to wait for output (in milliseconds). The output that
+ *         is available is read, and then the function waits for more output
+ *         until the timeout expires or a START line is read.
+ *
+ * RETURN VALUE
+ * The number of START lines read.
+ */
+static unsigned int read_output(int fd, int timeout) {
+    static char line[BENCH_LINE]; // the current line (truncated to BENCH_LINE - 1 characters)
+    static size_t length = 0; // length of the current line
+    char buffer[BENCH_LINE]; // the output read
+    unsigned int lines = 0; // number of START lines read
+    struct timespec start, now; // time at which the function was called, and the current time
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (;;) {
+        struct pollfd events = { fd, POLLIN, 0 }; // the events to wait for
+        int wait; // the remaining time to wait
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        wait = timeout - (int) (elapsed_s(&start, &now) * 1000);
+        if (poll(&events, 1, ((wait > 0) && (lines == 0)) ? wait : 0) <= 0) {
+            if ((errno == EINTR) && (wait > 0)) {
+                continue;
+            }
+            break;
+        }
+
+        ssize_t n = read(fd, buffer, sizeof(buffer)); // number of bytes read
+        if (n <= 0) {
+            break;
+        }
+
+        for (ssize_t i = 0; i < n; i++) {
+            if (buffer[i] == '\n') {
+                line[length] = '\0';
+                if (strstr(line, "START") != NULL) {
+                    lines++;
+                }
+                length = 0;
+            } else if (length < sizeof(line) - 1) {
+                line[length++] = buffer[i];
+            }
+        }
+    }
+
+    return lines;
+}
+
+/*
+ * Submits processes to the submission ring, from a producer process. The
+ * producer exits once all of its processes have been submitted.
+ *
+ * PARAMETERS
+ *     path: The path of the control socket.
+ *     n: The number of processes to submit.
+ *     id: The index of the producer.
+ */
+static void producer(const char * path, unsigned int n, unsigned int id) {
+    Ring * ring = ring_connect(path); // the submission ring
+
+    if (ring == NULL) {
+        exit(1);
+    }
+
+    for (unsigned int i = 0; i < n; i++) {
+        ProcessRecord record = { BENCH_ARRIVAL, ((id + i) % 3) + 1, 1, 16, 0, 0, 0, 0, 0, { 0 }, 0, 1, 1 }; // a user job that is never started
+
+        ring_submit(ring, &record, true, NULL);
+    }
+
+    ring_destroy(ring);
+    exit(0);
+}
+
+/*
+ * Calculates the time elapsed between two times.
+ *
+ * PARAMETERS
+ *     start: The earlier time.
+ *     stop: The later time.
+ *
+ * RETURN VALUE
+ * The time elapsed (in seconds).
+ */
+static double elapsed_s(struct timespec * start, struct timespec * stop) {
+    return (stop->tv_sec - start->tv_sec) + (stop->tv_nsec - start->tv_nsec) / 1e9;
+}
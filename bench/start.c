@@ -0,0 +1,249 @@
+/*
+ * start.c
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains a benchmark of the process start latency. Processes are
+ * started with start_PCB() by forking and executing the program, and then on
+ * pre-spawned workers from the worker pool. For each method, the time taken by
+ * start_PCB() (for which the dispatcher is blocked) and the time until the
+ * program reports that it has started are reported.
+ *
+ * Usage: start_bench [-n processes]
+ */
+#define _POSIX_C_SOURCE 200809L // for clock_gettime() and getopt()
+
+#include "../inc/dispatcher.h"
+#include "../inc/PCB.h"
+#include "../inc/pool.h"
+#include "../inc/input.h"
+#include "../inc/output.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define BENCH_PROCESSES     200 // default number of processes started with each method
+#define BENCH_WORKERS       4   // number of idle workers kept in the worker pool
+#define BENCH_SETTLE_NS     5000000 // time allowed for replacement workers to park before each start (in nanoseconds)
+
+static FILE * _results; // where the results are written (standard output is connected to the processes)
+static int _output; // the read end of the pipe connected to the standard output of the processes
+
+static void run(Dispatcher * dispatcher, const char * method, unsigned int n);
+static boolean wait_for_start(void);
+static void report(const char * method, const char * measure, double * latency, unsigned int n);
+static double elapsed_us(struct timespec * start, struct timespec * stop);
+static int compare_double(const void * a, const void * b);
+
+/*
+ * The main function for the start latency benchmark.
+ *
+ * PARAMETERS
+ *     argc: The number of arguments.
+ *     argv: The arguments.
+ *
+ * RETURN VALUE
+ * An integer representing the exit status of the program. (0 = success)
+ */
+int main(int argc, char * argv[]) {
+    unsigned int n = BENCH_PROCESSES; // number of processes started with each method
+    int option; // command line option
+    DispatcherConfig config; // how the processes are executed
+    Dispatcher * dispatcher; // the host dispatcher that the processes belong to
+
+    while ((option = getopt(argc, argv, "n:")) != -1) {
+        switch (option) {
+            case 'n':
+                n = (unsigned int) strtoul(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(__ERROR_OUTPUT, "Usage: %s [-n processes]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if (n == 0) {
+        fprintf(__ERROR_OUTPUT, "The number of processes must be positive.\n");
+        return 1;
+    }
+
+    // Connect the standard output of the processes to a pipe, so that the benchmark can see when they start
+    int output[2]; // the pipe
+    if ((pipe(output) != 0) || ((_results = fdopen(dup(STDOUT_FILENO), "w")) == NULL) || (dup2(output[1], STDOUT_FILENO) < 0)) {
+        fprintf(__ERROR_OUTPUT, "Unable to redirect standard output.\n");
+        return 1;
+    }
+    close(output[1]);
+    _output = output[0];
+
+    default_config(&config);
+    if ((dispatcher = dispatcher_create(&config)) == NULL) {
+        return 1;
+    }
+
+    fprintf(_results, "method\tmeasure\tprocesses\tmean_us\tp50_us\tp99_us\tmax_us\n");
+
+    run(dispatcher, "fork", n);
+
+    pool_init(PROCESS, BENCH_WORKERS);
+    run(dispatcher, "pool", n);
+    pool_destroy();
+
+    dispatcher_free(dispatcher);
+    return 0;
+}
+
+/*
+ * Starts processes one at a time, timing each call to start_PCB() and the time
+ * until each program reports that it has started, and prints the results. Each
+ * process is killed before the next is started, and the worker pool (if
+ * enabled) is refilled outside of the timed region.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher that the processes belong to.
+ *     method: The name of the start method being measured.
+ *     n: The number of processes to start.
+ */
+static void run(Dispatcher * dispatcher, const char * method, unsigned int n) {
+    double * dispatch = (double *) malloc(n * sizeof(double)); // time taken by start_PCB() for each process (in microseconds)
+    double * ready = (double *) malloc(n * sizeof(double)); // time until each program started (in microseconds)
+    unsigned int started = 0; // number of processes started
+    struct timespec settle = { 0, BENCH_SETTLE_NS }; // time allowed for replacement workers to park
+
+    if ((dispatch == NULL) || (ready == NULL)) {
+        fprintf(__ERROR_OUTPUT, "Unable to allocate %u latencies.\n", n);
+        free(dispatch);
+        free(ready);
+        return;
+    }
+
+    for (unsigned int i = 0; i < n; i++) {
+        struct timespec start, stop, running; // time at which start_PCB() was called and returned, and at which the program started
+        PCB * pcb = create_null_PCB(dispatcher, 1);
+        int status;
+
+        pcb->args[0] = (char *) malloc(strlen(PROCESS) + 1);
+        strcpy(pcb->args[0], PROCESS);
+        pcb->args[1] = (char *) malloc(2);
+        strcpy(pcb->args[1], "1");
+        pcb->args[2] = NULL;
+
+        // Replace the worker used by the previous process, and let it park (as it would during a tick of the dispatcher)
+        pool_refill();
+        nanosleep(&settle, NULL);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        PCB * p = start_PCB(dispatcher, &pcb);
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+
+        if ((p != NULL) && wait_for_start()) {
+            clock_gettime(CLOCK_MONOTONIC, &running);
+            dispatch[started] = elapsed_us(&start, &stop);
+            ready[started++] = elapsed_us(&start, &running);
+        }
+
+        if (p != NULL) {
+            kill(pcb->pid, SIGKILL);
+            waitpid(pcb->pid, &status, 0);
+        }
+
+        free_PCB(dispatcher, &pcb);
+    }
+
+    report(method, "dispatch", dispatch, started);
+    report(method, "ready", ready, started);
+
+    free(dispatch);
+    free(ready);
+}
+
+/*
+ * Waits for a process to report that it has started, by reading its standard
+ * output until the end of a line containing "START".
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the process started.
+ */
+static boolean wait_for_start(void) {
+    char line[256]; // the current line of output
+    size_t length = 0; // length of the current line
+
+    while (length < sizeof(line) - 1) {
+        if (read(_output, &line[length], 1) != 1) {
+            return false;
+        }
+
+        if (line[length] == '\n') {
+            line[length] = '\0';
+            if (strstr(line, "START") != NULL) {
+                return true;
+            }
+            length = 0;
+        } else {
+            length++;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Prints the distribution of a set of latencies.
+ *
+ * PARAMETERS
+ *     method: The name of the start method.
+ *     measure: The name of the latency measured.
+ *     latency: The latencies (in microseconds). This array is sorted.
+ *     n: The number of latencies.
+ */
+static void report(const char * method, const char * measure, double * latency, unsigned int n) {
+    double total = 0.0; // total latency (in microseconds)
+
+    if (n == 0) {
+        return;
+    }
+
+    for (unsigned int i = 0; i < n; i++) {
+        total += latency[i];
+    }
+
+    qsort(latency, n, sizeof(double), compare_double);
+    fprintf(_results, "%s\t%s\t%u\t%.1f\t%.1f\t%.1f\t%.1f\n", method, measure, n, total / n, latency[n / 2], latency[(n * 99) / 100], latency[n - 1]);
+}
+
+/*
+ * Calculates the time elapsed between two times.
+ *
+ * PARAMETERS
+ *     start: The earlier time.
+ *     stop: The later time.
+ *
+ * RETURN VALUE
+ * The time elapsed (in microseconds).
+ */
+static double elapsed_us(struct timespec * start, struct timespec * stop) {
+    return (stop->tv_sec - start->tv_sec) * 1e6 + (stop->tv_nsec - start->tv_nsec) / 1e3;
+}
+
+/*
+ * Compares two doubles, for use with qsort().
+ *
+ * PARAMETERS
+ *     a: The first double.
+ *     b: The second double.
+ *
+ * RETURN VALUE
+ * A negative, zero or positive value if a is less than, equal to or greater
+ * than b.
+ */
+static int compare_double(const void * a, const void * b) {
+    double x = *((const double *) a);
+    double y = *((const double *) b);
+
+    return (x > y) - (x < y);
+}
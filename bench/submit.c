@@ -0,0 +1,249 @@
+/*
+ * submit.c
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains a benchmark of the throughput of process submission over
+ * the control socket of the host dispatcher. Processes are submitted in
+ * batches of SUBMIT requests, which are pipelined - the responses are read
+ * whilst further batches are sent. The processes arrive far in the future, so
+ * that they remain on the input queue and are never started.
+ *
+ * The number of ticks of the host dispatcher during the benchmark is also
+ * reported, to show whether submission delays the ticks.
+ *
+ * Usage: submit_bench -c socket [-n processes] [-b batch] [-s]
+ */
+#define _POSIX_C_SOURCE 200809L // for clock_gettime() and getopt()
+
+#include "../inc/boolean.h"
+#include "../inc/output.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define BENCH_PROCESSES     100000  // default number of processes submitted
+#define BENCH_BATCH         256     // default number of SUBMIT requests sent with each write
+#define BENCH_ARRIVAL       1000000 // arrival time of the submitted processes
+#define BENCH_RECORD        64      // maximum length of a SUBMIT request
+#define BENCH_BUFFER        65536   // size of the buffer for reading responses
+
+static boolean request(int fd, const char * line, char * response, size_t size);
+static unsigned int status_clock(int fd);
+static double elapsed_s(struct timespec * start, struct timespec * stop);
+
+/*
+ * The main function for the submission throughput benchmark.
+ *
+ * PARAMETERS
+ *     argc: The number of arguments.
+ *     argv: The arguments.
+ *
+ * RETURN VALUE
+ * An integer representing the exit status of the program. (0 = success)
+ */
+int main(int argc, char * argv[]) {
+    char * path = NULL; // path of the control socket
+    unsigned int n = BENCH_PROCESSES; // number of processes to submit
+    unsigned int batch = BENCH_BATCH; // number of SUBMIT requests sent with each write
+    boolean shutdown_after = false; // whether to shut down the host dispatcher afterwards
+    int option; // command line option
+
+    while ((option = getopt(argc, argv, "b:c:n:s")) != -1) {
+        switch (option) {
+            case 'b':
+                batch = (unsigned int) strtoul(optarg, NULL, 10);
+                break;
+            case 'c':
+                path = optarg;
+                break;
+            case 'n':
+                n = (unsigned int) strtoul(optarg, NULL, 10);
+                break;
+            case 's':
+                shutdown_after = true;
+                break;
+            default:
+                fprintf(__ERROR_OUTPUT, "Usage: %s -c socket [-n processes] [-b batch] [-s]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if ((path == NULL) || (n == 0) || (batch == 0)) {
+        fprintf(__ERROR_OUTPUT, "Usage: %s -c socket [-n processes] [-b batch] [-s]\n", argv[0]);
+        return 1;
+    }
+
+    // Connect to the control socket
+    struct sockaddr_un address; // the address of the control socket
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0); // the socket connected to the host dispatcher
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+    if ((fd < 0) || (connect(fd, (struct sockaddr *) &address, sizeof(address)) != 0)) {
+        fprintf(__ERROR_OUTPUT, "Unable to connect to control socket '%s'.\n", path);
+        return 1;
+    }
+
+    char * requests = (char *) malloc(batch * BENCH_RECORD); // the current batch of requests
+    char * responses = (char *) malloc(BENCH_BUFFER); // buffer for reading responses
+    size_t length = 0; // length of the current batch
+    size_t written = 0; // number of bytes of the current batch that have been sent
+    unsigned int sent = 0; // number of requests sent
+    unsigned int received = 0; // number of responses received
+    unsigned int errors = 0; // number of error responses
+    boolean line_start = true; // whether the next byte received starts a response
+    struct timespec start, stop; // time at which the first request was sent and the last response was received
+
+    if ((requests == NULL) || (responses == NULL)) {
+        fprintf(__ERROR_OUTPUT, "Unable to allocate buffers.\n");
+        return 1;
+    }
+
+    unsigned int first_tick = status_clock(fd); // the clock of the host dispatcher before submission
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    while (received < n) {
+        struct pollfd events = { fd, POLLIN, 0 }; // the events to wait for
+
+        // Build the next batch once the previous batch has been sent
+        if ((written == length) && (sent < n)) {
+            length = 0;
+            written = 0;
+            for (unsigned int i = 0; (i < batch) && (sent < n); i++, sent++) {
+                length += sprintf(requests + length, "SUBMIT %d, %d, 1, 16, 0, 0, 0, 0\n", BENCH_ARRIVAL, (sent % 3) + 1);
+            }
+        }
+        if (written < length) {
+            events.events |= POLLOUT;
+        }
+
+        if (poll(&events, 1, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        if (events.revents & POLLOUT) {
+            ssize_t n_written = send(fd, requests + written, length - written, MSG_DONTWAIT | MSG_NOSIGNAL);
+            if (n_written > 0) {
+                written += n_written;
+            } else if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+                break;
+            }
+        }
+
+        if (events.revents & (POLLIN | POLLHUP | POLLERR)) {
+            ssize_t n_read = recv(fd, responses, BENCH_BUFFER, MSG_DONTWAIT);
+            if (n_read == 0) {
+                break;
+            }
+            for (ssize_t i = 0; i < n_read; i++) {
+                if (line_start && (responses[i] == 'E')) {
+                    errors++;
+                }
+                line_start = (responses[i] == '\n');
+                if (line_start) {
+                    received++;
+                }
+            }
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    unsigned int last_tick = status_clock(fd); // the clock of the host dispatcher after submission
+
+    if (received < n) {
+        fprintf(__ERROR_OUTPUT, "The host dispatcher disconnected after %u of %u responses.\n", received, n);
+        return 1;
+    }
+
+    fprintf(__STANDARD_OUTPUT, "processes\tbatch\tseconds\tprocesses_per_s\terrors\tticks\n");
+    fprintf(__STANDARD_OUTPUT, "%u\t%u\t%.3f\t%.0f\t%u\t%u\n", n, batch, elapsed_s(&start, &stop), n / elapsed_s(&start, &stop), errors, last_tick - first_tick);
+
+    if (shutdown_after) {
+        char response[BENCH_RECORD]; // the response to the shutdown request
+        request(fd, "SHUTDOWN NOW\n", response, sizeof(response));
+    }
+
+    free(requests);
+    free(responses);
+    close(fd);
+    return 0;
+}
+
+/*
+ * Sends a request and waits for its response.
+ *
+ * PARAMETERS
+ *     fd: The socket connected to the host dispatcher.
+ *     line: The request (including the line terminator).
+ *     response: Set to the response (without the line terminator).
+ *     size: The size of the response buffer.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether a response was received.
+ */
+static boolean request(int fd, const char * line, char * response, size_t size) {
+    size_t length = 0; // length of the response
+
+    if (send(fd, line, strlen(line), MSG_NOSIGNAL) != (ssize_t) strlen(line)) {
+        return false;
+    }
+
+    while (length < size - 1) {
+        if (recv(fd, &response[length], 1, 0) != 1) {
+            return false;
+        }
+        if (response[length] == '\n') {
+            break;
+        }
+        length++;
+    }
+    response[length] = '\0';
+
+    return true;
+}
+
+/*
+ * Gets the clock of the host dispatcher.
+ *
+ * PARAMETERS
+ *     fd: The socket connected to the host dispatcher.
+ *
+ * RETURN VALUE
+ * The clock of the host dispatcher, or 0 if it could not be read.
+ */
+static unsigned int status_clock(int fd) {
+    char response[BENCH_BUFFER]; // the response to the status request
+    unsigned int ticks = 0; // the clock of the host dispatcher
+
+    if (request(fd, "STATUS\n", response, sizeof(response))) {
+        sscanf(response, "OK clock=%u", &ticks);
+    }
+
+    return ticks;
+}
+
+/*
+ * Calculates the time elapsed between two times.
+ *
+ * PARAMETERS
+ *     start: The earlier time.
+ *     stop: The later time.
+ *
+ * RETURN VALUE
+ * The time elapsed (in seconds).
+ */
+static double elapsed_s(struct timespec * start, struct timespec * stop) {
+    return (stop->tv_sec - start->tv_sec) + (stop->tv_nsec - start->tv_nsec) / 1e9;
+}
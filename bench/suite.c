@@ -0,0 +1,278 @@
+/*
+ * suite.c
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains the benchmark suite of the host dispatcher. A synthetic
+ * dispatch list is generated (with tracegen) for each combination of arrival
+ * process and offered load, and the host dispatcher is run on it in fast mode,
+ * in which the clock advances without waiting for real time to pass. For each
+ * run, the suite records:
+ *     - The throughput (processes completed per second of real time).
+ *     - The real time spent dispatching per tick, which excludes the waits for
+ *       the next tick (but includes starting, suspending and terminating the
+ *       processes).
+ *     - The peak resident set size of the host dispatcher.
+ *     - The mean and percentiles of the turnaround times (in ticks).
+ *     - The real time deadlines met and missed.
+ *
+ * The results are written to a CSV file with one row per run, so that the
+ * results of two versions of the host dispatcher can be compared. The
+ * dispatch lists are generated with a fixed seed, so every run of the suite
+ * replays the same dispatch lists.
+ *
+ * Usage: suite_bench [-x hostd] [-g tracegen] [-n processes] [-s seed]
+ *                    [-t trace] [-o results]
+ */
+#define _DEFAULT_SOURCE // for wait4()
+
+#include "../inc/output.h"
+#include "../inc/boolean.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#define BENCH_HOSTD         "./hostd"               // default path of the host dispatcher
+#define BENCH_TRACEGEN      "./tracegen"            // default path of the dispatch list generator
+#define BENCH_TRACE         "bench_trace.csv"       // default path of the generated dispatch list
+#define BENCH_RESULTS       "bench_results.csv"     // default path of the results file
+#define BENCH_PROCESSES     "1000"                  // default number of processes in each dispatch list
+#define BENCH_SEED          "1"                     // default random seed
+#define BENCH_CPU_TIME      4.0                     // mean CPU time of a process (in ticks)
+#define BENCH_INTERVAL      "1000000000"            // status interval of the host dispatcher (so that the status is only printed at the start)
+#define BENCH_LINE          4096                    // maximum length of a line of output of the host dispatcher that is parsed
+
+// The results of a run of the host dispatcher
+typedef struct Result {
+    unsigned int ticks; // total elapsed time (in ticks)
+    unsigned int completed; // number of processes completed
+    unsigned int deadlines_met; // number of real time deadlines met
+    unsigned int deadlines_missed; // number of real time deadlines missed
+    double turnaround_mean; // mean turnaround time
+    unsigned int turnaround_p50; // 50th percentile turnaround time
+    unsigned int turnaround_p90; // 90th percentile turnaround time
+    unsigned int turnaround_p99; // 99th percentile turnaround time
+    unsigned int turnaround_max; // maximum turnaround time
+    double dispatch_ms; // real time spent dispatching
+    double seconds; // real time taken by the run
+    long max_rss_kb; // peak resident set size of the host dispatcher
+} Result;
+
+static const char * _arrivals[] = { "poisson", "bursty", "diurnal" }; // the arrival processes
+static const double _loads[] = { 0.5, 0.9, 1.2 }; // the offered loads (the fraction of the CPU time demanded)
+
+static boolean generate(const char * tracegen, const char * trace, const char * arrivals, double load, const char * n, const char * seed);
+static boolean run(const char * hostd, const char * trace, Result * result);
+static double elapsed_s(struct timespec * start, struct timespec * stop);
+
+/*
+ * The main function for the benchmark suite.
+ *
+ * PARAMETERS
+ *     argc: The number of arguments.
+ *     argv: The arguments.
+ *
+ * RETURN VALUE
+ * An integer representing the exit status of the program. (0 = success)
+ */
+int main(int argc, char * argv[]) {
+    const char * hostd = BENCH_HOSTD; // path of the host dispatcher
+    const char * tracegen = BENCH_TRACEGEN; // path of the dispatch list generator
+    const char * trace = BENCH_TRACE; // path of the generated dispatch list
+    const char * results = BENCH_RESULTS; // path of the results file
+    const char * n = BENCH_PROCESSES; // number of processes in each dispatch list
+    const char * seed = BENCH_SEED; // random seed
+    FILE * file; // the results file
+    unsigned int failed = 0; // number of runs that failed
+    int option; // command line option
+
+    while ((option = getopt(argc, argv, "g:n:o:s:t:x:")) != -1) {
+        switch (option) {
+            case 'g':
+                tracegen = optarg;
+                break;
+            case 'n':
+                n = optarg;
+                break;
+            case 'o':
+                results = optarg;
+                break;
+            case 's':
+                seed = optarg;
+                break;
+            case 't':
+                trace = optarg;
+                break;
+            case 'x':
+                hostd = optarg;
+                break;
+            default:
+                fprintf(__ERROR_OUTPUT, "Usage: %s [-x hostd] [-g tracegen] [-n processes] [-s seed] [-t trace] [-o results]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if ((file = fopen(results, "w")) == NULL) {
+        fprintf(__ERROR_OUTPUT, "Unable to open the results file '%s'.\n", results);
+        return 1;
+    }
+    fprintf(file, "arrivals,load,processes,seed,ticks,completed,seconds,processes_per_s,dispatch_us_per_tick,max_rss_kb,turnaround_mean,turnaround_p50,turnaround_p90,turnaround_p99,turnaround_max,deadlines_met,deadlines_missed\n");
+
+    fprintf(__STANDARD_OUTPUT, "%-8s  %5s  %8s  %8s  %12s  %12s  %10s  %22s\n", "arrivals", "load", "ticks", "seconds", "processes/s", "us per tick", "max RSS kB", "turnaround p50/p90/p99");
+    for (size_t i = 0; i < sizeof(_arrivals) / sizeof(_arrivals[0]); i++) {
+        for (size_t j = 0; j < sizeof(_loads) / sizeof(_loads[0]); j++) {
+            Result result; // the results of the run
+
+            if (!generate(tracegen, trace, _arrivals[i], _loads[j], n, seed) || !run(hostd, trace, &result)) {
+                fprintf(__ERROR_OUTPUT, "The run with %s arrivals at load %.1f failed.\n", _arrivals[i], _loads[j]);
+                failed++;
+                continue;
+            }
+
+            double per_second = (result.seconds > 0) ? (result.completed / result.seconds) : 0; // throughput
+            double per_tick = (result.ticks > 0) ? (result.dispatch_ms * 1000 / result.ticks) : 0; // dispatch time per tick
+
+            fprintf(file, "%s,%.2f,%s,%s,%u,%u,%.3f,%.1f,%.2f,%ld,%.2f,%u,%u,%u,%u,%u,%u\n", _arrivals[i], _loads[j], n, seed, result.ticks, result.completed, result.seconds, per_second, per_tick, result.max_rss_kb,
+                result.turnaround_mean, result.turnaround_p50, result.turnaround_p90, result.turnaround_p99, result.turnaround_max, result.deadlines_met, result.deadlines_missed);
+            fprintf(__STANDARD_OUTPUT, "%-8s  %5.2f  %8u  %8.3f  %12.1f  %12.2f  %10ld  %10u/%5u/%5u\n", _arrivals[i], _loads[j], result.ticks, result.seconds, per_second, per_tick, result.max_rss_kb, result.turnaround_p50, result.turnaround_p90, result.turnaround_p99);
+        }
+    }
+
+    fclose(file);
+    remove(trace);
+    fprintf(__STANDARD_OUTPUT, "\nResults written to %s.\n", results);
+
+    return (failed > 0) ? 1 : 0;
+}
+
+/*
+ * Generates a dispatch list with tracegen.
+ *
+ * PARAMETERS
+ *     tracegen: The path of the dispatch list generator.
+ *     trace: The path of the dispatch list to generate.
+ *     arrivals: The arrival process.
+ *     load: The offered load (the mean arrival rate multiplied by the mean CPU
+ *         time).
+ *     n: The number of processes.
+ *     seed: The random seed.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the dispatch list was generated.
+ */
+static boolean generate(const char * tracegen, const char * trace, const char * arrivals, double load, const char * n, const char * seed) {
+    char rate[32]; // the mean arrival rate
+    char cpu[32]; // the mean CPU time
+    int status; // the exit status of tracegen
+    pid_t pid; // tracegen
+
+    snprintf(rate, sizeof(rate), "%f", load / BENCH_CPU_TIME);
+    snprintf(cpu, sizeof(cpu), "%f", BENCH_CPU_TIME);
+
+    if ((pid = fork()) == 0) {
+        int fd = open(trace, O_WRONLY | O_CREAT | O_TRUNC, 0644); // the dispatch list
+
+        if (fd < 0) {
+            _exit(127);
+        }
+        dup2(fd, STDOUT_FILENO);
+        close(fd);
+        execl(tracegen, tracegen, "-a", arrivals, "-r", rate, "-c", cpu, "-n", n, "-s", seed, (char *) NULL);
+        _exit(127);
+    } else if (pid < 0) {
+        fprintf(__ERROR_OUTPUT, "Unable to fork the dispatch list generator.\n");
+        return false;
+    }
+
+    return (waitpid(pid, &status, 0) == pid) && WIFEXITED(status) && (WEXITSTATUS(status) == 0);
+}
+
+/*
+ * Runs the host dispatcher in fast mode on a dispatch list, and parses the
+ * statistics that it prints when it has finished.
+ *
+ * PARAMETERS
+ *     hostd: The path of the host dispatcher.
+ *     trace: The path of the dispatch list.
+ *     result: Set to the results of the run.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the host dispatcher finished processing
+ * the dispatch list.
+ */
+static boolean run(const char * hostd, const char * trace, Result * result) {
+    int fds[2]; // the pipe from the standard output of the host dispatcher
+    FILE * output; // the standard output of the host dispatcher
+    char line[BENCH_LINE]; // a line of output
+    struct timespec start, stop; // time at which the host dispatcher was started and exited
+    struct rusage usage; // resource usage of the host dispatcher
+    boolean finished = false; // whether the host dispatcher finished processing
+    int status; // the exit status of the host dispatcher
+    pid_t pid; // the host dispatcher
+
+    memset(result, 0, sizeof(Result));
+    if (pipe(fds) != 0) {
+        fprintf(__ERROR_OUTPUT, "Unable to create a pipe.\n");
+        return false;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if ((pid = fork()) == 0) {
+        int null = open("/dev/null", O_WRONLY); // standard error is discarded
+
+        dup2(fds[1], STDOUT_FILENO);
+        dup2(null, STDERR_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        close(null);
+        execl(hostd, hostd, "-f", "-i", BENCH_INTERVAL, trace, (char *) NULL);
+        _exit(127);
+    } else if (pid < 0) {
+        fprintf(__ERROR_OUTPUT, "Unable to fork the host dispatcher.\n");
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    close(fds[1]);
+
+    // The output of the processes is interleaved with the output of the host dispatcher, and is ignored
+    output = fdopen(fds[0], "r");
+    while (fgets(line, sizeof(line), output) != NULL) {
+        if (sscanf(line, "Finished processing. Total elapsed time is %u.", &result->ticks) == 1) {
+            finished = true;
+        }
+        sscanf(line, "Real time deadlines met: %u. Missed: %u.", &result->deadlines_met, &result->deadlines_missed);
+        sscanf(line, "Processes completed: %u. Turnaround time: mean %lf, 50th percentile %u, 90th percentile %u, 99th percentile %u, maximum %u.", &result->completed, &result->turnaround_mean, &result->turnaround_p50, &result->turnaround_p90, &result->turnaround_p99, &result->turnaround_max);
+        sscanf(line, "Dispatch time: %lf ms", &result->dispatch_ms);
+    }
+    fclose(output);
+
+    if (wait4(pid, &status, 0, &usage) != pid) {
+        return false;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    result->seconds = elapsed_s(&start, &stop);
+    result->max_rss_kb = usage.ru_maxrss;
+
+    return finished && WIFEXITED(status) && (WEXITSTATUS(status) == 0);
+}
+
+/*
+ * Gets the time elapsed between two times.
+ *
+ * PARAMETERS
+ *     start: The start time.
+ *     stop: The stop time.
+ *
+ * RETURN VALUE
+ * The elapsed time (in seconds).
+ */
+static double elapsed_s(struct timespec * start, struct timespec * stop) {
+    return (stop->tv_sec - start->tv_sec) + (stop->tv_nsec - start->tv_nsec) / 1e9;
+}
@@ -0,0 +1,250 @@
+/*
+ * threads.c
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains a stress benchmark of concurrent process submission to a
+ * host dispatcher. A number of producer threads each submit processes with
+ * dispatcher_submit(), whilst the main thread owns the host dispatcher and
+ * collects the submitted processes onto the input queue (freeing them again,
+ * so that memory does not grow with the number of processes). The benchmark is
+ * repeated with 1, 2, 4, ... producer threads, and for each the submission rate
+ * and the speedup over a single producer are reported. The processes are
+ * simulated, so none are started.
+ *
+ * The speedup only measures scaling whilst every producer has a CPU of its own
+ * (along with the main thread). Beyond the number of online CPUs, the producers
+ * are time-sliced and the speedup measures contention instead, which is
+ * reported alongside the results.
+ *
+ * The collected processes are appended to the tail of the input queue, which
+ * the host dispatcher keeps track of, and are then removed and freed. Collecting
+ * therefore takes time proportional to the number of processes collected, and
+ * not to the length of the input queue, so the submission rate measures the
+ * producers and their contention rather than how many processes are queued.
+ *
+ * Usage: threads_bench [-n processes] [-p producers]
+ */
+#define _POSIX_C_SOURCE 200809L // for clock_gettime(), getopt() and pthread_barrier_t
+
+#include "../inc/dispatcher.h"
+#include "../inc/PCB.h"
+#include "../inc/input.h"
+#include "../inc/output.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_PROCESSES     50000   // default number of processes submitted by each producer
+#define BENCH_PRODUCERS     16      // default maximum number of producer threads
+#define BENCH_ARRIVAL       1000000 // arrival time of the submitted processes
+
+// A producer thread, and the processes that it submits
+typedef struct Producer {
+    pthread_t thread; // the thread
+    Dispatcher * dispatcher; // the host dispatcher that the processes are submitted to
+    pthread_barrier_t * start; // released when every producer is ready to submit
+    unsigned int * running; // number of producers that have not finished submitting
+    unsigned int n; // number of processes to submit
+    unsigned int failed; // number of processes that could not be submitted
+} Producer;
+
+static double run(unsigned int producers, unsigned int n, unsigned int * failed);
+static void * produce(void * argument);
+static void collect(Dispatcher * dispatcher);
+static double elapsed_s(struct timespec * start, struct timespec * stop);
+
+/*
+ * The main function for the concurrent submission benchmark.
+ *
+ * PARAMETERS
+ *     argc: The number of arguments.
+ *     argv: The arguments.
+ *
+ * RETURN VALUE
+ * An integer representing the exit status of the program. (0 = success)
+ */
+int main(int argc, char * argv[]) {
+    unsigned int n = BENCH_PROCESSES; // number of processes submitted by each producer
+    unsigned int max_producers = BENCH_PRODUCERS; // maximum number of producer threads
+    double base = 0.0; // submission rate of a single producer (processes per second)
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN); // number of online CPUs
+    int option; // command line option
+
+    while ((option = getopt(argc, argv, "n:p:")) != -1) {
+        switch (option) {
+            case 'n':
+                n = (unsigned int) strtoul(optarg, NULL, 10);
+                break;
+            case 'p':
+                max_producers = (unsigned int) strtoul(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(__ERROR_OUTPUT, "Usage: %s [-n processes] [-p producers]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if ((n == 0) || (max_producers == 0)) {
+        fprintf(__ERROR_OUTPUT, "The number of processes and producers must be positive.\n");
+        return 1;
+    }
+
+    if ((cpus > 0) && ((unsigned long) cpus <= max_producers)) {
+        fprintf(__ERROR_OUTPUT, "Only %ld CPUs are online. The speedup of %ld or more producers measures contention, not scaling.\n", cpus, cpus);
+    }
+
+    fprintf(__STANDARD_OUTPUT, "producers\tprocesses\tseconds\tprocesses_per_s\tspeedup\terrors\n");
+    for (unsigned int producers = 1; producers <= max_producers; producers *= 2) {
+        unsigned int failed = 0; // number of processes that could not be submitted
+        double seconds = run(producers, n, &failed); // time taken to submit every process
+        double rate; // submission rate (processes per second)
+
+        if (seconds < 0.0) {
+            return 1;
+        }
+
+        rate = (double) producers * n / seconds;
+        if (producers == 1) {
+            base = rate;
+        }
+        fprintf(__STANDARD_OUTPUT, "%d\t%d\t%.3f\t%.0f\t%.2f\t%d\n", producers, producers * n, seconds, rate, rate / base, failed);
+        fflush(__STANDARD_OUTPUT);
+
+        // Always finish with the maximum number of producers
+        if ((producers < max_producers) && (2 * producers > max_producers)) {
+            producers = max_producers / 2;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Submits processes from a number of producer threads to a new host
+ * dispatcher, whilst the calling thread collects them.
+ *
+ * PARAMETERS
+ *     producers: The number of producer threads.
+ *     n: The number of processes submitted by each producer.
+ *     failed: Set to the number of processes that could not be submitted.
+ *
+ * RETURN VALUE
+ * The time from when the producers started until every process was collected
+ * (in seconds), or a negative value if the benchmark could not be run.
+ */
+static double run(unsigned int producers, unsigned int n, unsigned int * failed) {
+    DispatcherConfig config; // the scheduling parameters
+    Dispatcher * dispatcher; // the host dispatcher
+    Producer * threads = (Producer *) calloc(producers, sizeof(Producer)); // the producer threads
+    pthread_barrier_t start; // released when every producer is ready to submit
+    unsigned int running = producers; // number of producers that have not finished submitting
+    struct timespec started; // time at which the producers were released
+    struct timespec stopped; // time at which every process had been collected
+
+    default_config(&config);
+    config.execution = Simulated_Execution;
+    config.fast = true;
+    if ((threads == NULL) || ((dispatcher = dispatcher_create(&config)) == NULL)) {
+        fprintf(__ERROR_OUTPUT, "Unable to allocate memory for the benchmark.\n");
+        free(threads);
+        return -1.0;
+    }
+    pthread_barrier_init(&start, NULL, producers + 1);
+
+    for (unsigned int i = 0; i < producers; i++) {
+        threads[i].dispatcher = dispatcher;
+        threads[i].start = &start;
+        threads[i].running = &running;
+        threads[i].n = n;
+        if (pthread_create(&threads[i].thread, NULL, produce, &threads[i]) != 0) {
+            fprintf(__ERROR_OUTPUT, "Unable to create producer thread %d.\n", i);
+            exit(1);
+        }
+    }
+
+    pthread_barrier_wait(&start);
+    clock_gettime(CLOCK_MONOTONIC, &started);
+
+    // Collect the submitted processes as the host dispatcher would at the start of each tick, until every producer has finished
+    while (__atomic_load_n(&running, __ATOMIC_ACQUIRE) > 0) {
+        collect(dispatcher);
+    }
+    collect(dispatcher);
+    clock_gettime(CLOCK_MONOTONIC, &stopped);
+
+    *failed = 0;
+    for (unsigned int i = 0; i < producers; i++) {
+        pthread_join(threads[i].thread, NULL);
+        *failed += threads[i].failed;
+    }
+
+    pthread_barrier_destroy(&start);
+    dispatcher_free(dispatcher);
+    free(threads);
+    return elapsed_s(&started, &stopped);
+}
+
+/*
+ * Submits the processes of a producer thread.
+ *
+ * PARAMETERS
+ *     argument: The producer.
+ *
+ * RETURN VALUE
+ * NULL.
+ */
+static void * produce(void * argument) {
+    Producer * producer = (Producer *) argument; // the producer
+    ProcessRecord record; // the process submitted
+
+    memset(&record, 0, sizeof(ProcessRecord));
+    record.arrival_time = BENCH_ARRIVAL;
+    record.priority = 1;
+    record.remaining_cpu_time = 1;
+    record.mbytes = 16;
+
+    pthread_barrier_wait(producer->start);
+    for (unsigned int i = 0; i < producer->n; i++) {
+        if (dispatcher_submit(producer->dispatcher, &record) == 0) {
+            producer->failed++;
+        }
+    }
+
+    __atomic_sub_fetch(producer->running, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+/*
+ * Collects the submitted processes onto the input queue, and then frees them.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ */
+static void collect(Dispatcher * dispatcher) {
+    collect_submitted(dispatcher);
+    while (dispatcher->input_queue != NULL) {
+        PCB * pcb = dispatcher->input_queue; // the collected process
+
+        remove_from_input_queue(dispatcher, pcb);
+        free_PCB(dispatcher, &pcb);
+    }
+}
+
+/*
+ * Calculates the time elapsed between two times.
+ *
+ * PARAMETERS
+ *     start: The earlier time.
+ *     stop: The later time.
+ *
+ * RETURN VALUE
+ * The time elapsed (in seconds).
+ */
+static double elapsed_s(struct timespec * start, struct timespec * stop) {
+    return (double) (stop->tv_sec - start->tv_sec) + (double) (stop->tv_nsec - start->tv_nsec) / 1e9;
+}
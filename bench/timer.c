@@ -0,0 +1,196 @@
+/*
+ * timer.c
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains a benchmark of the timer wheel. Increasing numbers of
+ * timers are added with random expiry times, half of them are cancelled and
+ * re-added, and then the wheel is advanced until every timer has expired. The
+ * cost of each operation is reported for each number of timers, and should not
+ * grow with the number of pending timers.
+ *
+ * Usage: timer_bench [-n timers] [-h horizon] [-s seed]
+ */
+#define _POSIX_C_SOURCE 200809L // for clock_gettime() and getopt()
+
+#include "../inc/timer.h"
+#include "../inc/output.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_TIMERS    4000000 // default maximum number of timers
+#define BENCH_HORIZON   1000000 // default range of expiry times (in ticks)
+#define BENCH_SEED      1       // default random seed
+
+static unsigned long _random_state; // state of the random number generator
+
+static boolean run(unsigned int n, unsigned int horizon);
+static unsigned int random_uniform(unsigned int lo, unsigned int hi);
+static double elapsed_ns(struct timespec * start);
+
+/*
+ * The main function for the timer wheel benchmark.
+ *
+ * PARAMETERS
+ *     argc: The number of arguments.
+ *     argv: The arguments.
+ *
+ * RETURN VALUE
+ * An integer representing the exit status of the program. (0 = success)
+ */
+int main(int argc, char * argv[]) {
+    unsigned int max_timers = BENCH_TIMERS; // maximum number of timers
+    unsigned int horizon = BENCH_HORIZON; // range of expiry times
+    int option; // command line option
+
+    _random_state = BENCH_SEED;
+    while ((option = getopt(argc, argv, "n:h:s:")) != -1) {
+        switch (option) {
+            case 'n':
+                max_timers = (unsigned int) strtoul(optarg, NULL, 10);
+                break;
+            case 'h':
+                horizon = (unsigned int) strtoul(optarg, NULL, 10);
+                break;
+            case 's':
+                _random_state = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(__ERROR_OUTPUT, "Usage: %s [-n timers] [-h horizon] [-s seed]\n", argv[0]);
+                return 1;
+        }
+    }
+    if ((max_timers == 0) || (horizon == 0)) {
+        fprintf(__ERROR_OUTPUT, "The number of timers and the horizon must be positive.\n");
+        return 1;
+    }
+
+    fprintf(__STANDARD_OUTPUT, "Timer wheel benchmark: expiry times within %u ticks.\n\n", horizon);
+    fprintf(__STANDARD_OUTPUT, "%10s  %12s  %12s  %12s  %12s\n", "timers", "add (ns)", "cancel (ns)", "expire (ns)", "max pending");
+    for (unsigned int n = 1000; ; n *= 10) {
+        if (n > max_timers) {
+            n = max_timers;
+        }
+        if (!run(n, horizon)) {
+            return 1;
+        }
+        if (n == max_timers) {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Runs the benchmark with a number of timers, and prints the results.
+ *
+ * PARAMETERS
+ *     n: The number of timers.
+ *     horizon: The range of expiry times (in ticks).
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether every timer expired once, at its expiry
+ * time.
+ */
+static boolean run(unsigned int n, unsigned int horizon) {
+    TimerWheel * wheel = (TimerWheel *) malloc(sizeof(TimerWheel)); // the timer wheel
+    Timer * timers = (Timer *) malloc(n * sizeof(Timer)); // the timers
+    unsigned int expired = 0; // number of timers that have expired
+    unsigned int max_pending; // number of timers pending before any expired
+    double add_ns, cancel_ns, expire_ns; // cost of each operation
+    struct timespec start; // time at which the operation started
+    boolean success = true; // whether every timer expired correctly
+
+    if ((wheel == NULL) || (timers == NULL)) {
+        fprintf(__ERROR_OUTPUT, "Unable to allocate %u timers.\n", n);
+        free(wheel);
+        free(timers);
+        return false;
+    }
+    timer_init(wheel, 0);
+    for (unsigned int i = 0; i < n; i++) {
+        timer_clear(&timers[i]);
+    }
+
+    // Add every timer
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned int i = 0; i < n; i++) {
+        timer_add(wheel, &timers[i], random_uniform(1, horizon), Timer_Arrival, &timers[i]);
+    }
+    add_ns = elapsed_ns(&start) / n;
+    max_pending = wheel->pending;
+
+    // Cancel half of the timers, in a random order, and add them again
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned int i = 0; i < n / 2; i++) {
+        timer_cancel(&timers[random_uniform(0, n - 1)]);
+    }
+    cancel_ns = elapsed_ns(&start) / (n / 2 + 1);
+    for (unsigned int i = 0; i < n; i++) {
+        if (!timer_pending(&timers[i])) {
+            timer_add(wheel, &timers[i], random_uniform(1, horizon), Timer_Arrival, &timers[i]);
+        }
+    }
+
+    // Advance the wheel from one expiry to the next, retrieving the expired timers
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned int next; timer_next(wheel, &next); ) {
+        Timer * timer; // the next expired timer
+
+        timer_advance(wheel, next);
+        while ((timer = timer_expired(wheel, Timer_Arrival)) != NULL) {
+            if (timer->expiry != wheel->now) {
+                success = false;
+            }
+            expired++;
+        }
+    }
+    expire_ns = elapsed_ns(&start) / n;
+
+    if (!success || (expired != n)) {
+        fprintf(__ERROR_OUTPUT, "%u of %u timers expired, %s.\n", expired, n, success ? "on time" : "some at the wrong time");
+        success = false;
+    }
+
+    fprintf(__STANDARD_OUTPUT, "%10u  %12.1f  %12.1f  %12.1f  %12u\n", n, add_ns, cancel_ns, expire_ns, max_pending);
+
+    free(timers);
+    free(wheel);
+    return success;
+}
+
+/*
+ * Generates a uniformly distributed random number in a range.
+ *
+ * PARAMETERS
+ *     lo: The lowest number in the range.
+ *     hi: The highest number in the range.
+ *
+ * RETURN VALUE
+ * The random number.
+ */
+static unsigned int random_uniform(unsigned int lo, unsigned int hi) {
+    // 64-bit linear congruential generator (Knuth's MMIX constants)
+    _random_state = _random_state * 6364136223846793005UL + 1442695040888963407UL;
+    return lo + (unsigned int) ((_random_state >> 33) % (hi - lo + 1));
+}
+
+/*
+ * Gets the time elapsed since a start time.
+ *
+ * PARAMETERS
+ *     start: The start time.
+ *
+ * RETURN VALUE
+ * The elapsed time (in nanoseconds).
+ */
+static double elapsed_ns(struct timespec * start) {
+    struct timespec now; // the current time
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1e9 + (now.tv_nsec - start->tv_nsec);
+}
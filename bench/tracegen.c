@@ -0,0 +1,267 @@
+/*
+ * tracegen.c
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains a generator of synthetic dispatch lists for the host
+ * dispatcher. Processes arrive according to an arrival process:
+ *
+ *     poisson: Arrivals are independent, at a constant mean rate.
+ *     bursty: Bursts of processes arrive together, with a geometrically
+ *         distributed number of processes in each burst. The bursts arrive
+ *         independently, so the mean rate is the same as for 'poisson'.
+ *     diurnal: Arrivals are independent, but the rate varies sinusoidally over
+ *         a period between (1 - DIURNAL_AMPLITUDE) and (1 + DIURNAL_AMPLITUDE)
+ *         times the mean rate.
+ *
+ * The CPU time and memory of each process are exponentially distributed. A
+ * fraction of the processes are real time processes, with a deadline of two to
+ * four times their CPU time, and a fraction of the user processes require
+ * resources. The same options and seed always generate the same dispatch list.
+ *
+ * Usage: tracegen [-n processes] [-a poisson|bursty|diurnal] [-r rate]
+ *                 [-b burst] [-p period] [-c cpu] [-C max cpu] [-m mbytes]
+ *                 [-t real time fraction] [-R resource fraction] [-s seed]
+ */
+#define _POSIX_C_SOURCE 200809L // for getopt()
+
+#include "../inc/output.h"
+#include "../inc/boolean.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TRACE_PROCESSES         1000    // default number of processes
+#define TRACE_RATE              0.2     // default mean number of arrivals per tick
+#define TRACE_BURST             8.0     // default mean number of processes in a burst
+#define TRACE_PERIOD            500     // default period of the diurnal arrival rate (in ticks)
+#define TRACE_CPU_TIME          4.0     // default mean CPU time of a process (in ticks)
+#define TRACE_MAX_CPU_TIME      20      // default maximum CPU time of a process (in ticks)
+#define TRACE_MBYTES            64.0    // default mean memory of a user process (in megabytes)
+#define TRACE_REAL_TIME         0.1     // default fraction of real time processes
+#define TRACE_RESOURCES         0.2     // default fraction of user processes that require resources
+#define TRACE_SEED              1       // default random seed
+#define DIURNAL_AMPLITUDE       0.8     // relative amplitude of the diurnal arrival rate
+#define PI                      3.14159265358979323846 // ratio of the circumference of a circle to its diameter
+
+#define MAX_MBYTES              960     // maximum memory of a user process (in megabytes)
+#define MAX_REAL_TIME_MBYTES    64      // maximum memory of a real time process (in megabytes)
+#define MAX_PRINTERS            2       // maximum number of printers required by a process
+#define MAX_SCANNERS            1       // maximum number of scanners required by a process
+#define MAX_MODEMS              1       // maximum number of modems required by a process
+#define MAX_CDS                 2       // maximum number of CDs required by a process
+#define LOWEST_USER_PRIORITY    3       // lowest priority of a user process
+
+// An enumerator to identify the arrival process
+typedef enum {
+    Poisson_Arrivals, // independent arrivals at a constant rate
+    Bursty_Arrivals, // independent bursts of arrivals
+    Diurnal_Arrivals // independent arrivals at a sinusoidally varying rate
+} Arrivals;
+
+static unsigned long _random_state; // state of the random number generator
+
+static double random_unit(void);
+static unsigned int random_uniform(unsigned int lo, unsigned int hi);
+static double random_exponential(double mean);
+static void print_process(unsigned int arrival_time, double cpu, unsigned int max_cpu, double mbytes, double real_time, double resources);
+
+/*
+ * The main function for the dispatch list generator.
+ *
+ * PARAMETERS
+ *     argc: The number of arguments.
+ *     argv: The arguments.
+ *
+ * RETURN VALUE
+ * An integer representing the exit status of the program. (0 = success)
+ */
+int main(int argc, char * argv[]) {
+    unsigned int n = TRACE_PROCESSES; // number of processes
+    Arrivals arrivals = Poisson_Arrivals; // the arrival process
+    double rate = TRACE_RATE; // mean number of arrivals per tick
+    double burst = TRACE_BURST; // mean number of processes in a burst
+    double period = TRACE_PERIOD; // period of the diurnal arrival rate
+    double cpu = TRACE_CPU_TIME; // mean CPU time
+    unsigned int max_cpu = TRACE_MAX_CPU_TIME; // maximum CPU time
+    double mbytes = TRACE_MBYTES; // mean memory of a user process
+    double real_time = TRACE_REAL_TIME; // fraction of real time processes
+    double resources = TRACE_RESOURCES; // fraction of user processes that require resources
+    double time = 0.0; // time of the last arrival (or burst)
+    int option; // command line option
+
+    _random_state = TRACE_SEED;
+    while ((option = getopt(argc, argv, "n:a:r:b:p:c:C:m:t:R:s:")) != -1) {
+        switch (option) {
+            case 'n':
+                n = (unsigned int) strtoul(optarg, NULL, 10);
+                break;
+            case 'a':
+                if (strcmp(optarg, "poisson") == 0) {
+                    arrivals = Poisson_Arrivals;
+                } else if (strcmp(optarg, "bursty") == 0) {
+                    arrivals = Bursty_Arrivals;
+                } else if (strcmp(optarg, "diurnal") == 0) {
+                    arrivals = Diurnal_Arrivals;
+                } else {
+                    fprintf(__ERROR_OUTPUT, "Invalid arrival process '%s'.\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'r':
+                rate = strtod(optarg, NULL);
+                break;
+            case 'b':
+                burst = strtod(optarg, NULL);
+                break;
+            case 'p':
+                period = strtod(optarg, NULL);
+                break;
+            case 'c':
+                cpu = strtod(optarg, NULL);
+                break;
+            case 'C':
+                max_cpu = (unsigned int) strtoul(optarg, NULL, 10);
+                break;
+            case 'm':
+                mbytes = strtod(optarg, NULL);
+                break;
+            case 't':
+                real_time = strtod(optarg, NULL);
+                break;
+            case 'R':
+                resources = strtod(optarg, NULL);
+                break;
+            case 's':
+                _random_state = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(__ERROR_OUTPUT, "Usage: %s [-n processes] [-a poisson|bursty|diurnal] [-r rate] [-b burst] [-p period] [-c cpu] [-C max cpu] [-m mbytes] [-t real time fraction] [-R resource fraction] [-s seed]\n", argv[0]);
+                return 1;
+        }
+    }
+    if ((rate <= 0.0) || (burst < 1.0) || (period <= 0.0) || (cpu < 1.0) || (max_cpu == 0) || (mbytes < 1.0)) {
+        fprintf(__ERROR_OUTPUT, "The rate and period must be positive, and the burst size, CPU time and memory at least one.\n");
+        return 1;
+    }
+
+    for (unsigned int i = 0; i < n; ) {
+        switch (arrivals) {
+            case Poisson_Arrivals:
+                time += random_exponential(1.0 / rate);
+                print_process((unsigned int) time, cpu, max_cpu, mbytes, real_time, resources);
+                i++;
+                break;
+
+            case Bursty_Arrivals:
+                // The number of processes in a burst is geometric with the mean burst size
+                time += random_exponential(burst / rate);
+                do {
+                    print_process((unsigned int) time, cpu, max_cpu, mbytes, real_time, resources);
+                    i++;
+                } while ((i < n) && (random_unit() >= 1.0 / burst));
+                break;
+
+            case Diurnal_Arrivals:
+                // Arrivals at the peak rate are thinned to the rate at their arrival time
+                time += random_exponential(1.0 / (rate * (1.0 + DIURNAL_AMPLITUDE)));
+                if (random_unit() * (1.0 + DIURNAL_AMPLITUDE) < 1.0 + DIURNAL_AMPLITUDE * sin(2.0 * PI * time / period)) {
+                    print_process((unsigned int) time, cpu, max_cpu, mbytes, real_time, resources);
+                    i++;
+                }
+                break;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Prints a random process in the format of a dispatch list.
+ *
+ * PARAMETERS
+ *     arrival_time: The arrival time of the process.
+ *     cpu: The mean CPU time of a process.
+ *     max_cpu: The maximum CPU time of a process.
+ *     mbytes: The mean memory of a user process.
+ *     real_time: The fraction of real time processes.
+ *     resources: The fraction of user processes that require resources.
+ */
+static void print_process(unsigned int arrival_time, double cpu, unsigned int max_cpu, double mbytes, double real_time, double resources) {
+    // Both are at least one, so the excess over one is exponentially distributed (and rounded to the nearest integer)
+    unsigned int cpu_time = 1 + (unsigned int) (random_exponential(cpu - 1.0) + 0.5); // CPU time of the process
+    unsigned int memory = 1 + (unsigned int) (random_exponential(mbytes - 1.0) + 0.5); // memory of the process
+
+    if (cpu_time > max_cpu) {
+        cpu_time = max_cpu;
+    }
+
+    // Real time processes use the reserved memory, and require no resources
+    if (random_unit() < real_time) {
+        if (memory > MAX_REAL_TIME_MBYTES) {
+            memory = MAX_REAL_TIME_MBYTES;
+        }
+        fprintf(__STANDARD_OUTPUT, "%u, 0, %u, %u, 0, 0, 0, 0, deadline=%u\n", arrival_time, cpu_time, memory, cpu_time * random_uniform(2, 4));
+        return;
+    }
+
+    if (memory > MAX_MBYTES) {
+        memory = MAX_MBYTES;
+    }
+    if (random_unit() < resources) {
+        unsigned int printers = random_uniform(0, MAX_PRINTERS); // number of printers required
+        unsigned int scanners = random_uniform(0, MAX_SCANNERS); // number of scanners required
+        unsigned int modems = random_uniform(0, MAX_MODEMS); // number of modems required
+        unsigned int cds = random_uniform(0, MAX_CDS); // number of CDs required
+
+        // At least one resource is required
+        if (printers + scanners + modems + cds == 0) {
+            printers = 1;
+        }
+        fprintf(__STANDARD_OUTPUT, "%u, %u, %u, %u, %u, %u, %u, %u\n", arrival_time, random_uniform(1, LOWEST_USER_PRIORITY), cpu_time, memory, printers, scanners, modems, cds);
+    } else {
+        fprintf(__STANDARD_OUTPUT, "%u, %u, %u, %u, 0, 0, 0, 0\n", arrival_time, random_uniform(1, LOWEST_USER_PRIORITY), cpu_time, memory);
+    }
+}
+
+/*
+ * Generates a uniformly distributed random number in [0, 1).
+ *
+ * RETURN VALUE
+ * The random number.
+ */
+static double random_unit(void) {
+    // 64-bit linear congruential generator (Knuth's MMIX constants)
+    _random_state = _random_state * 6364136223846793005UL + 1442695040888963407UL;
+    return (double) (_random_state >> 11) / 9007199254740992.0;
+}
+
+/*
+ * Generates a uniformly distributed random number in a range.
+ *
+ * PARAMETERS
+ *     lo: The lowest number in the range.
+ *     hi: The highest number in the range.
+ *
+ * RETURN VALUE
+ * The random number.
+ */
+static unsigned int random_uniform(unsigned int lo, unsigned int hi) {
+    return lo + (unsigned int) (random_unit() * (hi - lo + 1));
+}
+
+/*
+ * Generates an exponentially distributed random number.
+ *
+ * PARAMETERS
+ *     mean: The mean of the distribution.
+ *
+ * RETURN VALUE
+ * The random number.
+ */
+static double random_exponential(double mean) {
+    return -mean * log(1.0 - random_unit());
+}
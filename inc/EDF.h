@@ -0,0 +1,36 @@
+/*
+ * EDF.h
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains the functions relating to the earliest deadline first
+ * (EDF) real time queue.
+ */
+#ifndef EDF_H_
+#define EDF_H_
+
+#include "PCB.h"
+#include "boolean.h"
+
+#define EDF_INITIAL_CAPACITY    16  // initial number of slots in the heap
+#define EDF_UTILISATION_BOUND   1.0 // maximum total utilisation of admitted real time processes
+
+typedef struct EDF_queue {
+    PCB ** heap; // binary min-heap of PCBs, ordered by absolute deadline
+    unsigned int size; // number of PCBs in the heap
+    unsigned int capacity; // number of slots allocated for the heap
+} EDF_queue;
+
+void edf_init(EDF_queue * queue);
+void edf_free(EDF_queue * queue);
+
+PCB * edf_enqueue(EDF_queue * queue, PCB * pcb);
+PCB * edf_dequeue(EDF_queue * queue);
+PCB * edf_remove(EDF_queue * queue, PCB * pcb);
+PCB * edf_peek(EDF_queue * queue);
+
+boolean edf_before(PCB * a, PCB * b);
+boolean edf_admit(EDF_queue * queue, PCB * active, PCB * pcb, unsigned int clock);
+
+#endif // #ifndef EDF_H_
@@ -11,26 +11,74 @@
 
 #include "boolean.h"
 
+// An enumerator to identify the placement policy used to choose a free MAB
+typedef enum {
+    First_Fit, // the free MAB with the lowest offset
+    Next_Fit, // the first free MAB at or after the end of the previous allocation
+    Best_Fit, // the smallest free MAB
+    Worst_Fit // the largest free MAB
+} PlacementPolicy;
+
 typedef struct MAB {
     unsigned int id; // unique identifier
+    unsigned int node; // the memory (NUMA) node containing this MAB
 
-    unsigned int offset; // the start address (in megabytes) of this MAB
+    unsigned int offset; // the start address (in megabytes) of this MAB, within its memory node
     unsigned int size; // the size (in megabytes) of this MAB
     boolean allocated; // has this MAB been allocated to a process? - note that the MAB does not know which process it has been allocated to
 
     struct MAB * next; // next MAB in the list
     struct MAB * prev; // previous MAB in the list
+
+    struct MAB * next_free; // next free MAB of the same size in the free-block index
+    struct MAB * prev_free; // previous free MAB of the same size in the free-block index
 } MAB;
 
-MAB * create_null_MAB(void);
+// A block of memory - the list of MABs that it is divided into, and the indexes of its free MABs
+typedef struct MemoryPool {
+    MAB * head; // the head of the MAB list, in order of offset
+    unsigned int id; // counter used to track assigned IDs
+    unsigned int node; // the memory (NUMA) node of the pool
+    unsigned int base; // the start address (in megabytes) of the pool, within the memory of all nodes
+
+    PlacementPolicy policy; // the placement policy
+    unsigned int cursor; // offset at which the next fit search starts
+
+    // The free-block index - free MABs are binned by their exact size, and a bitmap records which bins are non-empty
+    MAB ** bins; // bins[i] is the head of the list of free MABs of size i
+    unsigned long * bitmap; // bit i is set if bins[i] is non-empty
+    unsigned int index_size; // largest MAB size that can be indexed
+    unsigned int free_total; // total size of the free MABs
+
+    // The free-block index by offset - a max-tree whose leaves are the sizes of the free MABs starting at each offset
+    unsigned int * tree; // tree[leaves + i] is the size of the free MAB at offset i (0 if none), and each node is the maximum of its children
+    MAB ** at; // at[i] is the free MAB at offset i (NULL if none)
+    unsigned int leaves; // number of leaves in the tree (a power of two)
+} MemoryPool;
+
+MAB * create_null_MAB(MemoryPool * pool);
+MAB * mem_init(MemoryPool * pool, unsigned int size);
+void mem_destroy(MemoryPool * pool);
+void mem_set_node(MemoryPool * pool, unsigned int node, unsigned int base);
+void mem_set_policy(MemoryPool * pool, PlacementPolicy policy);
+PlacementPolicy mem_get_policy(MemoryPool * pool);
+const char * mem_policy_name(PlacementPolicy policy);
 
-MAB * mem_check(unsigned int size);
-MAB * mem_alloc(unsigned int size);
-MAB * mem_free(MAB * mab);
-MAB * mem_merge(MAB * mab);
-MAB * mem_split(MAB * mab, unsigned int size);
+MAB * mem_check(MemoryPool * pool, unsigned int size);
+MAB * mem_alloc(MemoryPool * pool, unsigned int size);
+MAB * mem_free(MemoryPool * pool, MAB * mab);
+MAB * mem_merge(MemoryPool * pool, MAB * mab);
+MAB * mem_split(MemoryPool * pool, MAB * mab, unsigned int size);
+unsigned int mem_largest_free(MemoryPool * pool);
+MAB * mem_reserve(MemoryPool * pool, unsigned int size, unsigned int reserve);
+MAB * mem_commit(MemoryPool * pool, MAB * mab, unsigned int size);
+MAB * mem_claim(MemoryPool * pool, unsigned int offset, unsigned int size);
+unsigned int mem_total_free(MemoryPool * pool);
+double mem_fragmentation(MemoryPool * pool);
+unsigned int mem_compact(MemoryPool * pool, MAB * pinned);
 
 void print_MAB_list(MAB * head);
+void print_node_list(MemoryPool * pools, unsigned int nodes);
 
 #ifdef DEBUG
 void print_MAB(MAB * mab);
@@ -9,14 +9,48 @@
 #ifndef PCB_H_
 #define PCB_H_
 
-#define MAX_ARGS                        3 // maximum number of arguments to args array
+#define MAX_ARGS                        5 // maximum number of arguments to args array
 #define LOWEST_PRIORITY                 3 // lowest priority (largest integer) that a process can be set to. priority will not be decremented below this value
 
 #define REAL_TIME_PROCESS_PRIORITY      0 // priority of a real time process
 #define REAL_TIME_PROCESS_MAX_MBYTES    64 // memory required for real time processes
+#define MEMORY_LIMIT_OVERHEAD           16 // memory (in megabytes) allowed to a process in addition to its MAB, for program text, shared libraries and stacks
+#define TICK_USEC                       1000000 // length of a tick (in microseconds)
+#define MEASURED_TIME_LIMIT             4 // with measured CPU accounting, a process is terminated once it has been active for this multiple of its CPU time
+#define IDLE_TICK_USEC                  (TICK_USEC / 10) // with measured CPU accounting, the quantum of the active process ends early if it uses less CPU time than this in a tick (in microseconds)
+#define SUSPEND_TIMEOUT_USEC            (TICK_USEC / 2) // real time that a process has to stop after being sent SIGTSTP, before it is stopped with SIGSTOP (in microseconds)
+#define MAX_DEPENDENCIES                4 // maximum number of processes that a process can depend on
+#define MAX_GANG                        64 // maximum number of member processes in a gang
 
 #include <sys/types.h>
 #include "MAB.h"
+#include "timer.h"
+
+// An enumerator to identify how the memory allocated to a process is enforced
+typedef enum {
+    No_Enforcement, // memory allocation is bookkeeping only
+    Rlimit_Enforcement, // the address space of the process is limited with RLIMIT_AS
+    Cgroup_Enforcement // the process is placed in its own memory cgroup (falling back to RLIMIT_AS)
+} MemoryEnforcement;
+
+// An enumerator to identify how processes are suspended and restarted
+typedef enum {
+    Signal_Suspension, // the process is sent SIGTSTP and SIGCONT
+    Freezer_Suspension // the process (and its descendants) are placed in their own freezer cgroup (falling back to signals)
+} SuspendMethod;
+
+// An enumerator to identify how CPU time is charged to processes
+typedef enum {
+    Tick_Accounting, // the active process is charged a full tick for every tick
+    Measured_Accounting // the active process is charged the CPU time that it actually consumed
+} CPUAccounting;
+
+// An enumerator to identify how processes are executed
+typedef enum {
+    Process_Execution, // each process is a real process, forked from the host dispatcher
+    Simulated_Execution // processes are not started - the host dispatcher only schedules them
+} Execution;
+#define NUM_EXECUTIONS (Simulated_Execution + 1) // number of execution modes
 
 typedef struct PCB {
     unsigned int id; // unique identifier
@@ -27,35 +61,85 @@ typedef struct PCB {
     unsigned int arrival_time; // time at which this process should begin execution
     unsigned int remaining_cpu_time; // remaining CPU time
     unsigned int priority; // priority of the process
+    unsigned int deadline; // absolute time by which a real time process must complete (0 if no deadline)
 
     unsigned int num_printers; // number of printer resources required by the process
     unsigned int num_scanners; // number of scanner resources required by the process
     unsigned int num_modems; // number of modem resources required by the process
     unsigned int num_cds; // number of CD resources required by the process
+    int banker_position; // position of the process in the safe sequence when resources are acquired incrementally (BANKER_NOT_ADMITTED if it has no maximum claim) - the resources required are then its maximum claim
 
     unsigned int mbytes; // size of memory required for this process
     MAB * memory; // the MAB assigned to this process
 
+    boolean freezer; // whether the process is in its own freezer cgroup
+    boolean cpuacct; // whether the process is in its own CPU accounting cgroup
+
+    unsigned long long cpu_usage; // CPU time measured for the process (in microseconds)
+    unsigned int cpu_ticks_charged; // ticks of measured CPU time charged against remaining_cpu_time
+    unsigned int active_ticks; // number of ticks for which the process has been active
+    unsigned long long idle_check_usage; // CPU time measured for the process when it was last checked for being idle (in microseconds)
+    unsigned int idle_check_time; // time at which the process was last checked for being idle
+
+    int last_cpu; // CPU that the process last ran on when it was suspended (AFFINITY_NO_CPU if not known)
+    int last_node; // NUMA node of that CPU (AFFINITY_NO_CPU if not known)
+    unsigned int suspend_time; // time at which the process was last suspended
+    unsigned long long suspend_usec; // real (monotonic) time at which the process was last sent SIGTSTP (in microseconds)
+
+    unsigned int dependencies[MAX_DEPENDENCIES]; // IDs of the processes that must complete before this process leaves the input queue
+    unsigned int num_dependencies; // number of IDs in dependencies
+    unsigned int unmet_dependencies; // number of those processes that have not yet completed
+    boolean dependency_failed; // whether one of those processes was removed without completing
+    unsigned int * dependents; // IDs of the processes that depend on this process
+    unsigned int num_dependents; // number of IDs in dependents
+    unsigned int dependents_capacity; // number of IDs that dependents can hold
+
+    unsigned int instances; // number of instances of a job array that have not been admitted (1 for a single process, 0 once a job array has been removed whilst instances split from it remain) - the PCB is the last instance
+    unsigned int array; // ID of the job array that the process was split from (0 if it was not split from a job array)
+    unsigned int outstanding; // number of instances split from this job array that have not yet been removed
+    boolean instance_failed; // whether this job array, or an instance split from it, was removed without completing
+    unsigned int gang; // number of member processes that are started, suspended and restarted together (1 for a single process) - pid is that of the first member, which leads their process group
+
+    Timer arrival_timer; // expires when the process arrives
+    Timer deadline_timer; // expires when a real time process has passed its deadline
+    Timer suspend_timer; // expires when a suspended process should have stopped
+
     struct PCB * prev; // prev PCB in the queue
     struct PCB * next; // next PCB in the queue
 } PCB;
 
+// The host dispatcher that a process belongs to (see dispatcher.h)
+struct Dispatcher;
+
 // Declaration to prevent compilation warnings
 int kill(pid_t pid, int sig);
 
+// Modes
+const char * memory_enforcement_name(MemoryEnforcement enforcement);
+const char * suspend_method_name(SuspendMethod method);
+const char * cpu_accounting_name(CPUAccounting accounting);
+const char * execution_name(Execution execution);
+
 // Queue operations
-PCB * create_null_PCB(void);
+PCB * create_null_PCB(struct Dispatcher * dispatcher, unsigned int ids);
 PCB * enqueue_PCB(PCB ** head, PCB ** pcb);
 PCB * dequeue_PCB(PCB ** head);
+PCB * split_PCB(struct Dispatcher * dispatcher, PCB * array);
+void rejoin_PCB(struct Dispatcher * dispatcher, PCB * array, PCB ** instance);
 
 // PCB operations
-PCB * start_PCB(PCB **pcb);
-PCB * decrement_remaining_cpu_time(PCB ** pcb);
-PCB * lower_priority(PCB ** pcb);
-PCB * suspend_PCB(PCB ** pcb);
-PCB * restart_PCB(PCB ** pcb);
-PCB * terminate_PCB(PCB ** pcb);
-void free_PCB(PCB ** pcb);
+PCB * start_PCB(struct Dispatcher * dispatcher, PCB ** pcb);
+PCB * decrement_remaining_cpu_time(struct Dispatcher * dispatcher, PCB ** pcb);
+unsigned int cpu_time_to_charge(struct Dispatcher * dispatcher, PCB * pcb, unsigned int quantum);
+boolean cpu_idle(struct Dispatcher * dispatcher, PCB * pcb, unsigned int quantum_start);
+PCB * charge_cpu_time(struct Dispatcher * dispatcher, PCB ** pcb, unsigned int ticks);
+PCB * lower_priority(PCB ** pcb, unsigned int lowest);
+PCB * suspend_PCB(struct Dispatcher * dispatcher, PCB ** pcb);
+PCB * confirm_suspension(struct Dispatcher * dispatcher, PCB ** pcb);
+PCB * restart_PCB(struct Dispatcher * dispatcher, PCB ** pcb);
+PCB * terminate_PCB(struct Dispatcher * dispatcher, PCB ** pcb);
+PCB * adopt_PCB(struct Dispatcher * dispatcher, PCB ** pcb, boolean suspended);
+void free_PCB(struct Dispatcher * dispatcher, PCB ** pcb);
 
 #ifdef DEBUG
 void print_PCB_queue(PCB * head);
@@ -11,6 +11,7 @@
 #define RAS_H_
 
 #include "PCB.h"
+#include "boolean.h"
 
 // An enumerator to identify the type of resource
 typedef enum {
@@ -21,6 +22,8 @@ typedef enum {
     CD_Resource
 } ResourceType;
 
+#define NUM_RESOURCE_TYPES  (CD_Resource + 1) // number of resource types (including Null_Resource)
+
 typedef struct RAS {
     unsigned int id; //unique identifier
 
@@ -31,12 +34,26 @@ typedef struct RAS {
     struct RAS * prev; // previous RAS in the list
 } RAS;
 
-RAS * create_resources(unsigned int num_printers, unsigned int num_scanners, unsigned int num_modems, unsigned int num_cds);
-RAS * create_null_RAS(void);
-
-RAS * resource_check(ResourceType type);
-RAS * resource_alloc(ResourceType type, PCB * pcb);
-RAS * resource_free(PCB * pcb);
+// The resources of a host - the list of RASs, and the number of each type that are not allocated
+typedef struct ResourcePool {
+    RAS * head; // the head of the RAS list
+    unsigned int id; // counter used to track assigned IDs
+    unsigned int available[NUM_RESOURCE_TYPES]; // number of unallocated resources of each type
+    unsigned int total[NUM_RESOURCE_TYPES]; // number of resources of each type
+} ResourcePool;
+
+RAS * create_resources(ResourcePool * pool, unsigned int num_printers, unsigned int num_scanners, unsigned int num_modems, unsigned int num_cds);
+void resource_destroy(ResourcePool * pool);
+RAS * create_null_RAS(ResourcePool * pool);
+
+RAS * resource_check(ResourcePool * pool, ResourceType type);
+RAS * resource_alloc(ResourcePool * pool, ResourceType type, PCB * pcb);
+RAS * resource_free(ResourcePool * pool, PCB * pcb);
+unsigned int resource_release(ResourcePool * pool, ResourceType type, PCB * pcb, unsigned int count);
+unsigned int resource_available(ResourcePool * pool, ResourceType type);
+unsigned int resource_total(ResourcePool * pool, ResourceType type);
+unsigned int resource_held(ResourcePool * pool, ResourceType type, PCB * pcb);
+boolean resource_reserve(ResourcePool * pool, ResourceType type, unsigned int count);
 
 void print_RAS_list(RAS * head);
 
@@ -0,0 +1,37 @@
+/*
+ * admission.h
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains the functions for admitting processes from the user job
+ * queue to the feedback queues.
+ */
+#ifndef ADMISSION_H_
+#define ADMISSION_H_
+
+#include "PCB.h"
+#include "boolean.h"
+
+#define EASY_BACKFILLING        true    // reserve capacity for the head of the user job queue so that it cannot be starved by smaller processes
+#define MEMORY_COMPACTION       true    // compact memory when fragmentation is all that prevents a process from being admitted
+#define COMPACTION_THRESHOLD    0.5     // minimum external fragmentation of free memory before memory is compacted
+
+// A vector of the memory and resources that are available to (or required by) processes
+typedef struct Capacity {
+    unsigned int mbytes; // size of the largest free MAB (or memory required)
+    unsigned int num_printers; // number of printer resources
+    unsigned int num_scanners; // number of scanner resources
+    unsigned int num_modems; // number of modem resources
+    unsigned int num_cds; // number of CD resources
+} Capacity;
+
+Capacity available_capacity(struct Dispatcher * dispatcher);
+Capacity required_capacity(PCB * pcb);
+boolean capacity_fits(Capacity * required, Capacity * available);
+boolean capacity_increased(Capacity * now, Capacity * before);
+
+void admission_notify_arrival(struct Dispatcher * dispatcher);
+void admit_user_processes(struct Dispatcher * dispatcher);
+
+#endif // #ifndef ADMISSION_H_
@@ -0,0 +1,32 @@
+/*
+ * affinity.h
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains the functions relating to the CPU affinity of processes -
+ * finding the CPU that a process last ran on and the NUMA node of that CPU,
+ * restricting a process to a CPU or to the CPUs of a NUMA node, and binding the
+ * memory of a process to a NUMA node.
+ */
+#ifndef AFFINITY_H_
+#define AFFINITY_H_
+
+#include "boolean.h"
+#include <sys/types.h>
+
+#define AFFINITY_CPU_PATH   "/sys/devices/system/cpu"   // sysfs directory of the CPUs (each CPU directory links to its NUMA node)
+#define AFFINITY_NODE_PATH  "/sys/devices/system/node"  // sysfs directory of the NUMA nodes
+#define AFFINITY_NO_CPU     -1                          // a CPU or NUMA node that is not known
+#define AFFINITY_MAX_NODES  1024                        // number of NUMA nodes that a memory binding can refer to
+
+boolean affinity_last_cpu(pid_t pid, int * cpu);
+int affinity_node_of(int cpu);
+unsigned int affinity_num_nodes(void);
+
+boolean affinity_pin_cpu(pid_t pid, int cpu);
+boolean affinity_pin_node(pid_t pid, int node);
+boolean affinity_release(pid_t pid);
+boolean affinity_bind_memory(int node);
+
+#endif // #ifndef AFFINITY_H_
@@ -0,0 +1,71 @@
+/*
+ * banker.h
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains the functions for incremental resource acquisition. Each
+ * admitted process declares a maximum claim of resources, and acquires and
+ * releases resources within that claim as it runs. A request is only granted
+ * if the banker's algorithm finds that the resulting state is safe, so that
+ * the processes can never deadlock.
+ */
+#ifndef BANKER_H_
+#define BANKER_H_
+
+#include "PCB.h"
+#include "RAS.h"
+#include "boolean.h"
+
+#define BANKER_LEAVES       16          // initial number of positions in the safe sequence
+#define BANKER_INFINITY     (1L << 40)  // slack of a position that does not hold a process
+#define BANKER_NOT_ADMITTED -1          // position of a process that has no maximum claim
+
+// An enumerator to identify the outcome of a resource request
+typedef enum {
+    Banker_Granted, // the resources were granted
+    Banker_Unavailable, // there are not enough free resources - the process must retry
+    Banker_Unsafe, // granting the resources could lead to deadlock - the process must retry
+    Banker_Exceeds_Claim, // the process would hold more than its maximum claim
+    Banker_Not_Admitted // the process has no maximum claim
+} BankerResult;
+
+// The maximum claim of an admitted process, and the resources allocated to it
+typedef struct BankerEntry {
+    PCB * pcb; // the process (NULL if it has been removed)
+    unsigned int claim[NUM_RESOURCE_TYPES]; // maximum number of resources of each type that the process may hold
+    unsigned int held[NUM_RESOURCE_TYPES]; // number of resources of each type allocated to the process
+    unsigned long unsafe_version; // version of the state at which the full safety check last refused the request below
+    unsigned int unsafe_request[NUM_RESOURCE_TYPES]; // the request that was refused
+} BankerEntry;
+
+// The admitted processes, held in the order of a safe sequence. The slack of a
+// position is the number of resources of a type that would be free when the
+// process at that position is reached (if every process before it finished)
+// less the need of that process - the state is safe whilst no slack is
+// negative. The slack of each type is kept in a min-tree with range additions,
+// so that a request is checked and applied in O(log n) for each type.
+typedef struct Banker {
+    BankerEntry * entries; // entries[i] is the process at position i of the safe sequence
+    unsigned int size; // number of positions used (including those of removed processes)
+    unsigned int live; // number of processes that have not been removed
+    unsigned int leaves; // number of leaves in each slack tree (a power of two, at least size)
+    long * slack[NUM_RESOURCE_TYPES]; // slack[t][node] is the minimum slack of type t in the subtree of the node (slack[t][leaves + i] for position i), including the additions at the node but not its ancestors
+    long * pending[NUM_RESOURCE_TYPES]; // pending[t][node] is the slack added to every position in the subtree of the node
+    unsigned long version; // incremented whenever resources are granted, released or a process is removed
+    unsigned int granted; // number of requests granted
+    unsigned int unavailable; // number of requests refused because there were not enough free resources
+    unsigned int unsafe; // number of requests refused because the resulting state would not be safe
+    unsigned int full_checks; // number of requests that needed the full safety check
+} Banker;
+
+void banker_init(Banker * banker);
+void banker_destroy(Banker * banker);
+
+boolean banker_admit(Banker * banker, ResourcePool * pool, PCB * pcb);
+BankerResult banker_request(Banker * banker, ResourcePool * pool, PCB * pcb, const unsigned int request[]);
+boolean banker_release(Banker * banker, PCB * pcb, const unsigned int release[]);
+void banker_remove(Banker * banker, PCB * pcb);
+boolean banker_is_safe(Banker * banker, ResourcePool * pool, PCB * pcb, const unsigned int request[], unsigned int * order);
+
+#endif // #ifndef BANKER_H_
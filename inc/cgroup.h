@@ -0,0 +1,44 @@
+/*
+ * cgroup.h
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains the functions for placing processes in control groups
+ * (cgroups). Each process is given its own cgroup beneath a cgroup created for
+ * the host dispatcher, for each controller that is available. Both the unified
+ * (v2) hierarchy and the legacy (v1) hierarchies are supported, with the
+ * unified hierarchy preferred.
+ */
+#ifndef CGROUP_H_
+#define CGROUP_H_
+
+#include "boolean.h"
+#include <sys/types.h>
+
+#define CGROUP_MOUNTS       "/proc/self/mounts" // mount table used to locate the cgroup hierarchies
+#define CGROUP_MEMBERSHIP   "/proc/self/cgroup" // cgroup membership of the host dispatcher
+#define CGROUP_PATH_LENGTH  512                 // maximum length of a cgroup path
+
+// An enumerator to identify a cgroup controller
+typedef enum {
+    Memory_Controller, // limits the memory used by a process
+    Freezer_Controller, // suspends and resumes all of the processes in a cgroup
+    CPU_Controller, // accounts for the CPU time used by the processes in a cgroup
+    NUM_CONTROLLERS
+} CgroupController;
+
+boolean cgroup_init(CgroupController controller);
+boolean cgroup_available(CgroupController controller);
+void cgroup_cleanup(void);
+
+boolean cgroup_create(CgroupController controller, unsigned int id);
+boolean cgroup_attach(CgroupController controller, unsigned int id, pid_t pid);
+void cgroup_remove(CgroupController controller, unsigned int id);
+
+boolean cgroup_set_memory_limit(unsigned int id, unsigned long long bytes);
+boolean cgroup_freeze(unsigned int id, boolean frozen);
+boolean cgroup_frozen(unsigned int id);
+boolean cgroup_cpu_usage(unsigned int id, unsigned long long * usec);
+
+#endif // #ifndef CGROUP_H_
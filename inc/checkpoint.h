@@ -0,0 +1,109 @@
+/*
+ * checkpoint.h
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains the functions for checkpointing the state of the host
+ * dispatcher, so that a host dispatcher that dies can be restarted without
+ * reprocessing the dispatch list. The state is saved as a snapshot of every
+ * process, plus a journal of the processes that changed in each tick since the
+ * snapshot was taken.
+ */
+#ifndef CHECKPOINT_H_
+#define CHECKPOINT_H_
+
+#include "PCB.h"
+#include "dispatcher.h"
+#include "boolean.h"
+#include <stdint.h>
+
+#define CHECKPOINT_MAGIC            0x706b6368u // identifies a snapshot or journal frame ("hckp")
+#define CHECKPOINT_VERSION          7           // version of the snapshot and journal format
+#define CHECKPOINT_MIN_JOURNAL      1048576     // size that the journal can always grow to before a snapshot is taken (in bytes)
+#define CHECKPOINT_SYNC             false       // whether the journal is synced to disk every tick (otherwise it only survives the host dispatcher, not the system)
+#define CHECKPOINT_JOURNAL          ".journal"  // suffix of the journal file
+#define CHECKPOINT_TEMPORARY        ".tmp"      // suffix of a snapshot that is being written
+#define NUM_CHECKPOINT_RESOURCES    4           // number of resource types saved for each process (printers, scanners, modems and CDs)
+#define NUM_CHECKPOINT_STATISTICS   8           // number of statistics saved (see checkpoint.c)
+
+// An enumerator to identify where a process is in the host dispatcher
+typedef enum {
+    Checkpoint_Removed, // the process has completed, been rejected or been cancelled
+    Checkpoint_Input, // the process is in the input queue
+    Checkpoint_User_Job, // the process is in the user job queue
+    Checkpoint_Real_Time, // the process is in the real time queue
+    Checkpoint_Feedback, // the process is in the feedback queue for its priority
+    Checkpoint_Active // the process is the active process
+} CheckpointLocation;
+
+// The saved state of a process
+typedef struct CheckpointPCB {
+    uint32_t id; // unique identifier
+    int32_t pid; // system process ID (0 if not started)
+    uint32_t arrival_time; // time at which the process should begin execution
+    uint32_t remaining_cpu_time; // remaining CPU time
+    uint32_t priority; // priority of the process
+    uint32_t deadline; // absolute deadline of a real time process (0 if no deadline)
+    uint32_t mbytes; // size of memory required for the process
+    int32_t memory_offset; // offset of the MAB allocated to the process, within the memory of all nodes (-1 if none)
+    uint32_t memory_size; // size of the MAB allocated to the process
+    uint8_t required[NUM_CHECKPOINT_RESOURCES]; // number of printers, scanners, modems and CDs required by the process
+    uint8_t held[NUM_CHECKPOINT_RESOURCES]; // number of printers, scanners, modems and CDs allocated to the process
+    uint8_t location; // where the process is (a CheckpointLocation)
+    uint8_t freezer; // whether the process is in its own freezer cgroup
+    uint8_t cpuacct; // whether the process is in its own CPU accounting cgroup
+    uint8_t instance_failed; // whether a job array, or an instance split from it, was removed without completing
+    uint64_t cpu_usage; // CPU time measured for the process (in microseconds)
+    uint32_t cpu_ticks_charged; // ticks of measured CPU time charged against the remaining CPU time
+    uint32_t active_ticks; // number of ticks for which the process has been active
+    uint32_t dependencies[MAX_DEPENDENCIES]; // IDs of the processes that must complete before the process is executed (0 if none)
+    uint32_t instances; // number of instances of a job array that have not been admitted
+    uint32_t gang; // number of member processes in a gang
+    uint32_t array; // ID of the job array that the process was split from (0 if none)
+} CheckpointPCB;
+
+// The header of a snapshot, or of the frame of journal records for a tick
+typedef struct CheckpointHeader {
+    uint32_t magic; // CHECKPOINT_MAGIC
+    uint32_t version; // CHECKPOINT_VERSION
+    uint32_t clock; // the clock at the end of the tick
+    uint32_t count; // number of process records that follow
+    uint32_t checksum; // checksum of the process records
+    uint32_t next_id; // the next PCB ID to be assigned
+    uint32_t memory_nodes; // number of memory nodes that the memory is divided between (the memory offsets of the records depend on it)
+    uint32_t statistics[NUM_CHECKPOINT_STATISTICS]; // deadline, admission, compaction and memory node statistics
+} CheckpointHeader;
+
+// The checkpoint of a host dispatcher
+typedef struct Checkpoint {
+    Dispatcher * dispatcher; // the host dispatcher whose state is checkpointed
+    char * path; // path of the snapshot
+    char * journal_path; // path of the journal
+    char * temporary_path; // path of a snapshot that is being written
+    int journal; // the journal file
+    CheckpointPCB * records; // the records journalled during the current tick
+    size_t count; // number of records journalled during the current tick
+    size_t capacity; // number of records that records can hold
+    boolean relocated; // whether memory has been compacted during the current tick
+    boolean snapshot_due; // whether a snapshot is taken at the end of the current tick
+    unsigned long long journal_bytes; // size of the journal
+    unsigned long long snapshot_bytes; // size of the snapshot
+    unsigned int snapshots; // number of snapshots taken
+    unsigned long long journalled; // number of records journalled
+    unsigned int commits; // number of ticks committed
+    unsigned long long usec; // time spent committing (in microseconds)
+} Checkpoint;
+
+boolean checkpoint_init(Dispatcher * dispatcher, const char * path);
+boolean checkpoint_recover(Checkpoint * checkpoint, boolean * recovered);
+void checkpoint_destroy(Dispatcher * dispatcher);
+
+void checkpoint_PCB(Checkpoint * checkpoint, PCB * pcb, CheckpointLocation location);
+void checkpoint_remove(Checkpoint * checkpoint, unsigned int id);
+void checkpoint_relocated(Checkpoint * checkpoint);
+void checkpoint_commit(Checkpoint * checkpoint);
+
+void checkpoint_print_statistics(Checkpoint * checkpoint);
+
+#endif // #ifndef CHECKPOINT_H_
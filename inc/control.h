@@ -0,0 +1,67 @@
+/*
+ * control.h
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains the functions for the control socket of the host
+ * dispatcher. Clients connect to a UNIX domain socket to submit processes,
+ * query their status and cancel them while the host dispatcher is running, and
+ * to request the submission ring.
+ */
+#ifndef CONTROL_H_
+#define CONTROL_H_
+
+#include "dispatcher.h"
+#include "ring.h"
+#include "boolean.h"
+
+#define CONTROL_MAX_CLIENTS 32          // maximum number of connected clients
+#define CONTROL_MAX_EVENTS  16          // maximum number of events handled for each call to epoll_wait()
+#define CONTROL_BUFFER      16384       // size of the buffer for requests from each client
+#define CONTROL_MAX_OUTPUT  1048576     // maximum size of the responses queued for a client before it is disconnected
+#define CONTROL_BACKLOG     16          // maximum number of pending connections
+
+// An enumerator to identify the state of the control socket
+typedef enum {
+    Control_Disabled, // there is no control socket
+    Control_Running, // processes can be submitted, and the host dispatcher runs until it is shut down
+    Control_Draining, // no more processes can be submitted, and the host dispatcher exits once all processes have completed
+    Control_Stopped // the host dispatcher exits at the end of the current tick
+} ControlState;
+
+// A client connected to the control socket
+typedef struct Client {
+    int fd; // the socket connected to the client (-1 if this slot is unused)
+    char input[CONTROL_BUFFER]; // requests received from the client that have not been handled
+    size_t input_length; // number of bytes in the input buffer
+    char * output; // responses that have not been sent to the client
+    size_t output_length; // number of bytes in the output buffer
+    size_t output_capacity; // number of bytes allocated for the output buffer
+    boolean writing; // whether the client is waiting for the socket to become writable
+    boolean closing; // whether the client has closed its end of the socket (or must be disconnected) once the responses have been sent
+    boolean descriptor; // whether the memfd of the submission ring is to be sent with the response at descriptor_offset
+    size_t descriptor_offset; // offset of the response in the output buffer that the memfd is sent with
+} Client;
+
+// The control socket of a host dispatcher
+typedef struct Control {
+    Dispatcher * dispatcher; // the host dispatcher that processes are submitted to
+    ControlState state; // the state of the control socket
+    int listener; // the listening socket
+    int epoll; // the epoll instance
+    char * path; // the path of the listening socket
+    Client clients[CONTROL_MAX_CLIENTS]; // the connected clients
+    RingConsumer * ring; // the submission ring (NULL if disabled)
+    int ring_fd; // the memfd containing the submission ring
+} Control;
+
+boolean control_init(Dispatcher * dispatcher, const char * path);
+boolean control_enable_ring(Control * control, unsigned int slots);
+void control_destroy(Dispatcher * dispatcher);
+ControlState control_state(Control * control);
+
+void control_collect(Control * control);
+void control_serve(Control * control, unsigned int milliseconds);
+
+#endif // #ifndef CONTROL_H_
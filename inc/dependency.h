@@ -0,0 +1,42 @@
+/*
+ * dependency.h
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains the functions for the dependencies between processes,
+ * which form a directed acyclic graph. A process that depends on other
+ * processes is held in the input queue until each of them has completed.
+ */
+#ifndef DEPENDENCY_H_
+#define DEPENDENCY_H_
+
+#include "PCB.h"
+#include "timer.h"
+#include "boolean.h"
+
+#define DEPENDENCY_MIN_TABLE    64 // minimum number of entries in the hash table of processes
+#define DEPENDENCY_HASH         2654435761u // odd multiplier that scatters consecutive IDs over the hash table
+
+// A hash table of the processes in a host dispatcher, by ID
+typedef struct DependencyTable {
+    PCB ** entries; // the entries of the hash table (NULL if empty)
+    size_t size; // number of entries in the hash table (a power of two)
+    size_t count; // number of processes in the hash table
+    PCB ** arrays; // the job arrays in the hash table (their reserved IDs are not in the hash table)
+    size_t num_arrays; // number of job arrays in arrays
+    size_t arrays_capacity; // number of job arrays that arrays can hold
+    TimerWheel * wheel; // the timer wheel holding the arrival timers of processes
+} DependencyTable;
+
+void dependency_init(DependencyTable * table, TimerWheel * wheel);
+void dependency_destroy(DependencyTable * table);
+
+void dependency_register(DependencyTable * table, PCB * pcb);
+void dependency_link(DependencyTable * table, PCB * pcb);
+void dependency_add(DependencyTable * table, PCB * pcb);
+boolean dependency_remove(DependencyTable * table, PCB * pcb);
+
+boolean dependency_blocked(PCB * pcb);
+
+#endif // #ifndef DEPENDENCY_H_
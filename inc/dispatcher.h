@@ -0,0 +1,210 @@
+/*
+ * dispatcher.h
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains the functions of the host dispatcher library. All of the
+ * state of a host dispatcher is held in a Dispatcher, so that any number of
+ * host dispatchers can be created and stepped independently within a program.
+ */
+#ifndef DISPATCHER_H_
+#define DISPATCHER_H_
+
+#include "PCB.h"
+#include "MAB.h"
+#include "RAS.h"
+#include "EDF.h"
+#include "timer.h"
+#include "dependency.h"
+#include "admission.h"
+#include "banker.h"
+#include "input.h"
+#include "boolean.h"
+#include <pthread.h>
+
+#define AVAILABLE_MEMORY    1024            // total available memory for all processes (in megabytes)
+#define RESERVED_MEMORY     64              // memory reserved for real time processes (in megabytes)
+#define AVAILABLE_PRINTERS  2               // number of printer resources that the host dispatcher can allocate
+#define AVAILABLE_SCANNERS  1               // number of scanner resources that the host dispatcher can allocate
+#define AVAILABLE_MODEMS    1               // number of modem resources that the host dispatcher can allocate
+#define AVAILABLE_CDS       2               // number of CD resources that the host dispatcher can allocate
+#define NUM_FEEDBACK_QUEUES LOWEST_PRIORITY // default number of feedback queues
+#define MAX_FEEDBACK_QUEUES 8               // maximum number of feedback queues
+#define QUANTUM             1               // default length of the quantum of the active process (in ticks)
+#define STATUS_INTERVAL     1               // default number of ticks between status dumps
+#define MIGRATION_COST      2               // default number of ticks for which a suspended process is resumed on the CPU that it last ran on (0 to never restrict processes)
+#define CPUS                1               // default number of CPUs that the active process can occupy (the widest gang that can be started)
+#define MEMORY_NODES        1               // default number of memory (NUMA) nodes that the available memory is divided between
+#define MAX_MEMORY_NODES    8               // maximum number of memory nodes
+
+// A reservation of the memory and resources required by a process
+typedef struct Reservation {
+    MAB * memory; // the free MAB that the memory for the process will be allocated from (NULL if no memory is required)
+    unsigned int node; // the memory node that the process prefers to be allocated memory on
+} Reservation;
+
+// An enumerator to identify a scheduling parameter that can be set (or swept) on the command line
+typedef enum {
+    Quantum_Parameter, // the length of the quantum
+    Feedback_Levels_Parameter, // the number of feedback queues
+    Reserved_Memory_Parameter, // the memory reserved for real time processes
+    Migration_Cost_Parameter // the time for which a suspended process is resumed on the CPU that it last ran on
+} ConfigParameter;
+
+#define NUM_CONFIG_PARAMETERS (Migration_Cost_Parameter + 1) // number of scheduling parameters
+
+// The location of a process within a host dispatcher
+typedef enum {
+    Not_Found, // the process is not in the host dispatcher
+    Active_Process, // the process is the active process
+    Real_Time_Queue, // the process is in the real time queue
+    Feedback_Queue, // the process is in a feedback queue
+    User_Job_Queue, // the process is in the user job queue
+    Input_Queue, // the process is in the input queue
+    Submitted // the process has been submitted, and will be added to the input queue at the start of the next tick
+} Location;
+
+// The scheduling parameters of a host dispatcher, and how its processes are executed
+typedef struct DispatcherConfig {
+    unsigned int quantum; // length of the quantum of the active process (in ticks)
+    unsigned int feedback_levels; // number of feedback queues (the lowest priority that a user process is lowered to)
+    unsigned int reserved_memory; // memory reserved for real time processes (in megabytes)
+    unsigned int migration_cost; // number of ticks for which a suspended process is resumed on the CPU that it last ran on, before its cache is considered cold (0 to never restrict processes)
+    unsigned int status_interval; // number of ticks between status dumps (0 to only print the status when the host dispatcher starts)
+    unsigned int cpus; // number of CPUs that the active process can occupy (the widest gang that can be started)
+    unsigned int memory_nodes; // number of memory (NUMA) nodes that the available memory is divided between
+    boolean fast; // whether the clock advances without waiting for real time to pass
+    boolean banker; // whether processes declare a maximum claim of resources, and acquire and release resources within it as they run (with the banker's algorithm avoiding deadlock)
+    PlacementPolicy placement; // the memory placement policy
+    Execution execution; // how processes are executed
+    MemoryEnforcement enforcement; // how the memory allocated to processes is enforced
+    SuspendMethod suspend_method; // how processes are suspended and restarted
+    CPUAccounting accounting; // how CPU time is charged to processes
+    Workload workload; // the workload performed by the process executed for each PCB
+} DispatcherConfig;
+
+// An instance of the host dispatcher - the queues, the clock, the timers, the memory and resources, and the statistics
+typedef struct Dispatcher {
+    DispatcherConfig config; // the scheduling parameters
+    PCB * input_queue; // the input (dispatcher) queue
+    PCB * input_tail; // the tail of the input queue (processes are only added to the input queue at its tail)
+    EDF_queue real_time_queue; // the real time queue - ordered by earliest deadline
+    PCB * user_job_queue; // the user job queue
+    PCB * feedback_queue[MAX_FEEDBACK_QUEUES]; // the feedback queues - note feedback_queue[i] stores processes with priority (i + 1)
+    PCB * active; // active process
+    PCB * submitted; // processes submitted since the input queue was last updated, most recent first (these are considered to be on the input queue)
+    unsigned int clock; // the clock
+    unsigned int next_id; // ID that will be assigned to the next PCB that is created
+    MemoryPool memory[MAX_MEMORY_NODES]; // the system memory of each memory (NUMA) node
+    ResourcePool resources; // the system resources
+    Banker banker; // the maximum claims of the admitted processes (only used if processes acquire resources incrementally)
+    DependencyTable dependencies; // the processes that other processes can depend on, by ID
+    Capacity admission_capacity; // capacity available at the end of the previous admission pass
+    unsigned int admission_node_free[MAX_MEMORY_NODES]; // size of the largest free MAB of each memory node at the end of the previous admission pass
+    boolean admission_wake; // whether the user job queue must be rescanned regardless of capacity
+    unsigned int deadlines_met; // number of real time processes that completed by their deadline
+    unsigned int deadlines_missed; // number of real time processes that completed after their deadline
+    unsigned int real_time_rejected; // number of real time processes rejected by the admission test
+    unsigned int memory_compactions; // number of times memory has been compacted
+    unsigned int memory_relocated; // total memory relocated by compaction (in megabytes)
+    unsigned int compaction_admissions; // number of processes that could only be admitted because memory was compacted
+    unsigned int compaction_cpu_time; // total CPU time of the processes admitted because memory was compacted
+    unsigned int memory_spills; // number of processes allocated memory on a node other than the node that they prefer
+    TimerWheel timers; // the timer wheel holding all future events
+    Timer quantum_timer; // expires when the quantum of the active process has expired
+    unsigned int quantum_start; // time at which the quantum of the active process started
+    Timer status_timer; // expires when the status should next be printed
+    unsigned int * turnaround_times; // turnaround time of each completed process (in ticks)
+    unsigned int num_turnaround_times; // number of completed processes
+    unsigned int turnaround_capacity; // number of turnaround times that turnaround_times can hold
+    unsigned long long dispatch_usec; // real time spent dispatching, excluding the waits for the next tick (in microseconds)
+    struct Checkpoint * checkpoint; // the checkpoint of the state (NULL if checkpointing is disabled)
+    struct Control * control; // the control socket (NULL if disabled)
+    pthread_mutex_t lock; // held by the thread stepping the host dispatcher whilst it is dispatching
+} Dispatcher;
+
+// The status of a process, as reported by dispatcher_query()
+typedef struct ProcessStatus {
+    unsigned int id; // unique identifier
+    pid_t pid; // system process ID (0 if not started)
+    unsigned int remaining_cpu_time; // remaining CPU time
+    unsigned int priority; // priority of the process
+    Location location; // where the process is
+    unsigned int level; // the feedback queue containing the process (only if it is in a feedback queue)
+} ProcessStatus;
+
+// A summary of the processes completed by a host dispatcher
+typedef struct Statistics {
+    unsigned int ticks; // the clock
+    unsigned int completed; // number of processes that completed
+    double turnaround_mean; // mean turnaround time (in ticks)
+    unsigned int turnaround_p50; // 50th percentile turnaround time (in ticks)
+    unsigned int turnaround_p90; // 90th percentile turnaround time (in ticks)
+    unsigned int turnaround_p99; // 99th percentile turnaround time (in ticks)
+    unsigned int turnaround_max; // maximum turnaround time (in ticks)
+    unsigned int deadlines_met; // number of real time processes that completed by their deadline
+    unsigned int deadlines_missed; // number of real time processes that completed after their deadline
+    unsigned int real_time_rejected; // number of real time processes rejected by the admission test
+    unsigned int memory_compactions; // number of times memory has been compacted
+    unsigned long long dispatch_usec; // real time spent dispatching (in microseconds)
+} Statistics;
+
+// Public interface
+Dispatcher * dispatcher_create(DispatcherConfig * config);
+void dispatcher_free(Dispatcher * dispatcher);
+unsigned int dispatcher_submit(Dispatcher * dispatcher, ProcessRecord * record);
+void dispatcher_step(Dispatcher * dispatcher);
+boolean dispatcher_query(Dispatcher * dispatcher, unsigned int id, ProcessStatus * status);
+boolean get_process_status(Dispatcher * dispatcher, unsigned int id, ProcessStatus * status);
+Location dispatcher_find(Dispatcher * dispatcher, unsigned int id, PCB ** pcb, unsigned int * level);
+boolean finished(Dispatcher * dispatcher);
+void get_statistics(Dispatcher * dispatcher, Statistics * statistics);
+
+// Configuration
+boolean dispatcher_init(Dispatcher * dispatcher, DispatcherConfig * config);
+void dispatcher_destroy(Dispatcher * dispatcher);
+void dispatcher_lock(Dispatcher * dispatcher);
+void dispatcher_unlock(Dispatcher * dispatcher);
+void default_config(DispatcherConfig * config);
+boolean check_config(DispatcherConfig * config);
+const char * config_parameter_name(ConfigParameter parameter);
+unsigned int get_config_parameter(DispatcherConfig * config, ConfigParameter parameter);
+void set_config_parameter(DispatcherConfig * config, ConfigParameter parameter, unsigned int value);
+boolean parse_config_option(char * option, ConfigParameter * parameter, char ** value);
+boolean set_config_option(DispatcherConfig * config, char * option);
+
+// Queue operations
+void submit_PCB(Dispatcher * dispatcher, PCB * pcb);
+void collect_submitted(Dispatcher * dispatcher);
+void append_to_input_queue(Dispatcher * dispatcher, PCB * head);
+void remove_from_input_queue(Dispatcher * dispatcher, PCB * pcb);
+void unload_pending_input_processes(Dispatcher * dispatcher);
+void unload_pending_user_processes(Dispatcher * dispatcher);
+void schedule_arrivals(Dispatcher * dispatcher, PCB * head);
+void schedule_deadline(Dispatcher * dispatcher, PCB * pcb);
+void check_timeouts(Dispatcher * dispatcher);
+
+// Memory and resources
+boolean check_memory_and_resources(Dispatcher * dispatcher, PCB * pcb);
+unsigned int max_process_memory(Dispatcher * dispatcher, PCB * pcb);
+boolean allocate_memory_and_resources(Dispatcher * dispatcher, PCB * pcb);
+boolean reserve_memory_and_resources(Dispatcher * dispatcher, PCB * pcb, Reservation * reservation);
+boolean commit_memory_and_resources(Dispatcher * dispatcher, PCB * pcb, Reservation * reservation);
+unsigned int compact_memory(Dispatcher * dispatcher);
+unsigned int largest_free_memory(Dispatcher * dispatcher);
+MAB * free_memory(Dispatcher * dispatcher, MAB * mab);
+MAB * claim_memory(Dispatcher * dispatcher, unsigned int offset, unsigned int size);
+BankerResult acquire_resources(Dispatcher * dispatcher, PCB * pcb, const unsigned int request[]);
+boolean release_resources(Dispatcher * dispatcher, PCB * pcb, const unsigned int release[]);
+
+// Scheduling and statistics
+PCB ** next_queued_PCB(Dispatcher * dispatcher, unsigned int min_priority);
+PCB * dequeue_next_PCB(Dispatcher * dispatcher, PCB ** next);
+void record_deadline(Dispatcher * dispatcher, PCB * pcb, unsigned int charged);
+void record_turnaround(Dispatcher * dispatcher, PCB * pcb, unsigned int charged);
+void print_statistics(Dispatcher * dispatcher);
+
+void print_status(Dispatcher * dispatcher);
+void format_suffix(PCB * pcb, char * buffer);
+#endif // #ifndef DISPATCHER_H_
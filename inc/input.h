@@ -13,10 +13,44 @@
 #define PROCESS         "./sigtrap" // the process to be executed for each PCB
 #define STRING_BUFFER   256         // size of buffer for string arguments for processes
 #define INPUT_BUFFER    1024        // buffer for storing a line of input
+#define MAX_INSTANCES   16777216    // maximum number of instances of a job array
 
 #include "PCB.h"
 #include <stdio.h>
 
-PCB * read_process_list(FILE * file);
+// An enumerator to identify the workload performed by the process executed for each PCB (the names of the workloads must match the profiles of sigtrap)
+typedef enum {
+    Sleep_Workload, // the process sleeps, and only reports each tick
+    CPU_Workload, // the process spins on the CPU
+    Memory_Workload, // the process repeatedly touches as much memory as the PCB requires
+    IO_Workload, // the process repeatedly writes a block to a file and flushes it to disk
+    Mixed_Workload // the process alternates between the CPU, memory and I/O workloads
+} Workload;
+
+#define NUM_WORKLOADS (Mixed_Workload + 1) // number of workloads
+
+// The fields of a process record, before they are validated
+typedef struct ProcessRecord {
+    unsigned int arrival_time; // arrival time of the process
+    unsigned int priority; // priority of the process
+    unsigned int remaining_cpu_time; // CPU time required by the process
+    unsigned int mbytes; // memory required by the process
+    unsigned int num_printers; // the number of printer resources required by the process
+    unsigned int num_scanners; // the number of scanner resources required by the process
+    unsigned int num_modems; // the number of modem resources required by the process
+    unsigned int num_cds; // the number of CD resources required by the process
+    unsigned int deadline; // deadline of a real time process, relative to its arrival time (0 if no deadline)
+    unsigned int dependencies[MAX_DEPENDENCIES]; // IDs of the processes that must complete before the process is executed
+    unsigned int num_dependencies; // number of IDs in dependencies
+    unsigned int instances; // number of identical processes in a job array (0 or 1 for a single process)
+    unsigned int gang; // number of member processes in a gang (0 or 1 for a single process)
+} ProcessRecord;
+
+PCB * read_process_list(struct Dispatcher * dispatcher, FILE * file);
+PCB * parse_process(struct Dispatcher * dispatcher, char * line);
+PCB * create_process(struct Dispatcher * dispatcher, ProcessRecord * record);
+PCB * create_submitted_process(struct Dispatcher * dispatcher, ProcessRecord * record);
+
+const char * workload_name(Workload workload);
 
 #endif // #ifndef INPUT_H_
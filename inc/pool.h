@@ -0,0 +1,36 @@
+/*
+ * pool.h
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains the functions relating to the pool of pre-spawned worker
+ * processes. A worker is a process that has already been forked and executed,
+ * and is parked waiting for the arguments of the job that it will run. Starting
+ * a job on a worker only costs a write to the worker's control socket.
+ */
+#ifndef POOL_H_
+#define POOL_H_
+
+#include "boolean.h"
+#include <sys/types.h>
+
+#define WORKER_FLAG     "-w"    // argument that tells a program to wait for its job arguments on standard input
+#define MAX_POOL_SIZE   64      // maximum number of idle workers
+
+// An idle worker process
+typedef struct Worker {
+    pid_t pid; // system process ID of the worker
+    int control; // the dispatcher's end of the socket that the worker reads its job arguments from
+} Worker;
+
+boolean pool_init(const char * program, unsigned int size);
+void pool_destroy(void);
+void pool_refill(void);
+unsigned int pool_idle(void);
+
+boolean pool_acquire(const char * program, Worker * worker);
+boolean pool_release(Worker * worker, char * const args[]);
+void pool_discard(Worker * worker);
+
+#endif // #ifndef POOL_H_
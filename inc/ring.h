@@ -0,0 +1,72 @@
+/*
+ * ring.h
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains the functions relating to the submission ring - a bounded
+ * queue of process records in shared memory, which any number of local producer
+ * processes can write to without locks or system calls, and which the host
+ * dispatcher drains in batches. Producers obtain the shared memory from the
+ * control socket of the host dispatcher.
+ */
+#ifndef RING_H_
+#define RING_H_
+
+#include "boolean.h"
+#include "input.h"
+#include <stdint.h>
+
+#define RING_MAGIC          0x676e6972u // identifies the shared memory as a submission ring ("ring")
+#define RING_DEFAULT_SLOTS  16384       // default number of records that the ring can hold
+#define RING_MAX_SLOTS      1048576     // maximum number of records that the ring can hold
+#define RING_BATCH          256         // maximum number of records drained from the ring at a time
+#define RING_DRAIN_INTERVAL 10          // time between drains of the ring whilst the host dispatcher waits for the next tick (in milliseconds)
+#define RING_WAIT_TIMEOUT   100         // maximum time that a producer waits for a full ring before checking again (in milliseconds)
+#define RING_CACHE_LINE     64          // size of a cache line (in bytes)
+
+// A slot in the ring
+typedef struct RingSlot {
+    uint64_t sequence; // the position that the slot can next be written at (or, once written, the position plus one)
+    ProcessRecord record; // the process record
+} RingSlot;
+
+// The shared memory of the ring. The positions are only ever incremented, and are kept on separate cache lines.
+typedef struct Ring {
+    uint32_t magic; // RING_MAGIC
+    uint32_t slots; // number of slots (a power of two)
+    char padding0[RING_CACHE_LINE - 2 * sizeof(uint32_t)];
+
+    uint64_t tail; // the next position to be claimed by a producer
+    char padding1[RING_CACHE_LINE - sizeof(uint64_t)];
+
+    uint64_t head; // the next position to be drained by the host dispatcher
+    uint32_t space; // futex incremented whenever records are drained, which producers waiting for a full ring wait on
+    uint32_t waiters; // number of producers waiting for a full ring
+    char padding2[RING_CACHE_LINE - sizeof(uint64_t) - 2 * sizeof(uint32_t)];
+
+    RingSlot slot[]; // the slots
+} Ring;
+
+// The host dispatcher's side of a ring. Producers can write to all of the shared memory, so the host dispatcher keeps its own copies of the fields that it indexes the ring with.
+typedef struct RingConsumer {
+    Ring * ring; // the shared memory of the ring
+    unsigned int slots; // number of slots (a power of two)
+    uint64_t mask; // mask that maps a position to its slot (slots - 1)
+    uint64_t head; // the next position to be drained
+} RingConsumer;
+
+// Host dispatcher
+RingConsumer * ring_create(unsigned int slots, int * fd);
+unsigned int ring_drain(RingConsumer * consumer, ProcessRecord * records, unsigned int max);
+void ring_close(RingConsumer * consumer);
+
+// Producers
+Ring * ring_connect(const char * path);
+Ring * ring_attach(int fd);
+boolean ring_submit(Ring * ring, ProcessRecord * record, boolean wait, uint64_t * position);
+boolean ring_drained(Ring * ring, uint64_t position);
+
+void ring_destroy(Ring * ring);
+
+#endif // #ifndef RING_H_
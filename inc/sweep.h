@@ -0,0 +1,30 @@
+/*
+ * sweep.h
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains the functions relating to parameter sweeps - replaying a
+ * dispatch list with simulated execution under every combination of a grid of
+ * scheduling parameters, and comparing the results.
+ */
+#ifndef SWEEP_H_
+#define SWEEP_H_
+
+#include "dispatcher.h"
+#include "boolean.h"
+
+#define MAX_SWEEP_VALUES    16 // maximum number of values that a scheduling parameter can be swept over
+
+// The values to sweep each scheduling parameter over
+typedef struct SweepGrid {
+    unsigned int values[NUM_CONFIG_PARAMETERS][MAX_SWEEP_VALUES]; // the values of each scheduling parameter
+    unsigned int num_values[NUM_CONFIG_PARAMETERS]; // number of values of each scheduling parameter (0 if it is not swept)
+} SweepGrid;
+
+void sweep_init(SweepGrid * grid);
+boolean sweep_add(SweepGrid * grid, char * option);
+boolean sweep_enabled(SweepGrid * grid);
+boolean sweep_run(SweepGrid * grid, DispatcherConfig * base, const char * path, unsigned int jobs);
+
+#endif // #ifndef SWEEP_H_
@@ -0,0 +1,72 @@
+/*
+ * timer.h
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains the functions for the timer wheel, which holds all of the
+ * future events of the host dispatcher (arrivals, quantum expirations, deadline
+ * checks, suspension timeouts and status dumps).
+ */
+#ifndef TIMER_H_
+#define TIMER_H_
+
+#include "boolean.h"
+#include <stdint.h>
+
+#define TIMER_SLOT_BITS     6                       // number of bits of the expiry time that select a slot at each level
+#define TIMER_SLOTS         (1 << TIMER_SLOT_BITS)  // number of slots at each level of the timer wheel
+#define TIMER_LEVELS        6                       // number of levels of the timer wheel (enough for any 32-bit expiry time)
+
+// An enumerator to identify the event that a timer is for
+typedef enum {
+    Timer_Arrival, // a process in the input queue has arrived
+    Timer_Quantum, // the quantum of the active process has expired
+    Timer_Deadline, // a real time process has passed its deadline
+    Timer_Suspend, // a suspended process should have stopped
+    Timer_Status // the status of the host dispatcher should be printed
+} TimerType;
+
+#define NUM_TIMER_TYPES (Timer_Status + 1) // number of timer types
+
+struct Timer;
+struct TimerWheel;
+
+// A list of timers, in the order that they were added
+typedef struct TimerList {
+    struct Timer * head; // the first timer in the list
+    struct Timer * tail; // the last timer in the list
+} TimerList;
+
+// A timer - timers are embedded in the structure that they are for, so adding and cancelling a timer does not allocate memory
+typedef struct Timer {
+    unsigned int expiry; // the time (in ticks) at which the timer expires
+    TimerType type; // the event that the timer is for
+    void * data; // the process that the timer is for (NULL if none)
+    struct TimerWheel * wheel; // the timer wheel that the timer has been added to (NULL if the timer is not pending)
+    TimerList * list; // the slot (or list of expired timers) that holds the timer
+    struct Timer * prev; // the previous timer in the list
+    struct Timer * next; // the next timer in the list
+} Timer;
+
+// A hashed hierarchical timer wheel - level n holds the timers that expire in the current window of TIMER_SLOTS^(n + 1) ticks, but not in the current window of TIMER_SLOTS^n ticks
+typedef struct TimerWheel {
+    unsigned int now; // the current time (in ticks)
+    unsigned int pending; // number of timers in the slots (that have not expired)
+    uint64_t occupied[TIMER_LEVELS]; // bitmap of the slots at each level that hold timers
+    TimerList slots[TIMER_LEVELS][TIMER_SLOTS]; // the slots at each level
+    TimerList expired[NUM_TIMER_TYPES]; // the timers of each type that have expired, in order of expiry
+} TimerWheel;
+
+void timer_init(TimerWheel * wheel, unsigned int now);
+void timer_clear(Timer * timer);
+
+void timer_add(TimerWheel * wheel, Timer * timer, unsigned int expiry, TimerType type, void * data);
+void timer_cancel(Timer * timer);
+boolean timer_pending(Timer * timer);
+
+void timer_advance(TimerWheel * wheel, unsigned int now);
+Timer * timer_expired(TimerWheel * wheel, TimerType type);
+boolean timer_next(TimerWheel * wheel, unsigned int * next);
+
+#endif // #ifndef TIMER_H_
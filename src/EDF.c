@@ -0,0 +1,280 @@
+/*
+ * EDF.c
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains the functions relating to the earliest deadline first
+ * (EDF) real time queue.
+ */
+#include "../inc/EDF.h"
+#include "../inc/PCB.h"
+#include "../inc/output.h"
+#include <stdlib.h>
+
+static void sift_up(EDF_queue * queue, unsigned int i);
+static void sift_down(EDF_queue * queue, unsigned int i);
+
+/*
+ * Initialises an empty EDF queue.
+ *
+ * PARAMETERS
+ *     queue: The queue to initialise.
+ */
+void edf_init(EDF_queue * queue) {
+    queue->heap = NULL;
+    queue->size = 0;
+    queue->capacity = 0;
+}
+
+/*
+ * Frees the heap associated with an EDF queue. Note that the PCBs in the queue
+ * are not freed.
+ *
+ * PARAMETERS
+ *     queue: The queue to free.
+ */
+void edf_free(EDF_queue * queue) {
+    free(queue->heap);
+    edf_init(queue);
+}
+
+/*
+ * Add a PCB to an EDF queue.
+ *
+ * PARAMETERS
+ *     queue: The queue to add the PCB to.
+ *     pcb: The PCB to add to the queue.
+ *
+ * RETURN VALUE
+ * A pointer to the PCB that was added, or NULL if the heap could not be grown.
+ */
+PCB * edf_enqueue(EDF_queue * queue, PCB * pcb) {
+    if (pcb == NULL) {
+        return NULL;
+    }
+
+    // Grow the heap if it is full
+    if (queue->size == queue->capacity) {
+        unsigned int capacity = (queue->capacity == 0) ? EDF_INITIAL_CAPACITY : (queue->capacity * 2);
+        PCB ** heap = (PCB **) realloc(queue->heap, capacity * sizeof(PCB *));
+
+        if (heap == NULL) {
+            fprintf(__ERROR_OUTPUT, "Unable to grow the real time queue for PCB %d.\n", pcb->id);
+            return NULL;
+        }
+
+        queue->heap = heap;
+        queue->capacity = capacity;
+    }
+
+    // PCBs in the heap are not linked to any other queue
+    pcb->prev = NULL;
+    pcb->next = NULL;
+
+    // Add the PCB to the bottom of the heap and restore the heap property
+    queue->heap[queue->size] = pcb;
+    sift_up(queue, (queue->size)++);
+
+    return pcb;
+}
+
+/*
+ * Remove and return the PCB with the earliest deadline from an EDF queue.
+ *
+ * PARAMETERS
+ *     queue: The queue to remove the PCB from.
+ *
+ * RETURN VALUE
+ * A pointer to the removed PCB, or NULL if the queue is empty.
+ */
+PCB * edf_dequeue(EDF_queue * queue) {
+    PCB * p = NULL; // the PCB to be removed
+
+    if (queue->size > 0) {
+        p = queue->heap[0];
+
+        // Move the last PCB to the root of the heap and restore the heap property
+        queue->heap[0] = queue->heap[--(queue->size)];
+        sift_down(queue, 0);
+    }
+
+    return p;
+}
+
+/*
+ * Remove a PCB from anywhere in an EDF queue.
+ *
+ * PARAMETERS
+ *     queue: The queue to remove the PCB from.
+ *     pcb: The PCB to remove.
+ *
+ * RETURN VALUE
+ * A pointer to the removed PCB, or NULL if the PCB is not in the queue.
+ */
+PCB * edf_remove(EDF_queue * queue, PCB * pcb) {
+    for (unsigned int i = 0; i < queue->size; i++) {
+        if (queue->heap[i] == pcb) {
+            // Move the last PCB into the vacated slot, which may need to move either up or down the heap
+            queue->heap[i] = queue->heap[--(queue->size)];
+            if (i < queue->size) {
+                sift_up(queue, i);
+                sift_down(queue, i);
+            }
+            return pcb;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Return the PCB with the earliest deadline from an EDF queue, without removing
+ * it from the queue.
+ *
+ * PARAMETERS
+ *     queue: The queue to inspect.
+ *
+ * RETURN VALUE
+ * A pointer to the PCB with the earliest deadline, or NULL if the queue is
+ * empty.
+ */
+PCB * edf_peek(EDF_queue * queue) {
+    return (queue->size > 0) ? queue->heap[0] : NULL;
+}
+
+/*
+ * Checks whether one PCB should be run before another under the EDF policy.
+ * PCBs without a deadline are considered to have an infinitely distant
+ * deadline. Ties are broken by arrival time and then by ID, so that processes
+ * without deadlines are served first come, first served.
+ *
+ * PARAMETERS
+ *     a: The first PCB.
+ *     b: The second PCB.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether PCB a should be run before PCB b.
+ */
+boolean edf_before(PCB * a, PCB * b) {
+    if (a->deadline != b->deadline) {
+        if (a->deadline == 0) {
+            return false;
+        } else if (b->deadline == 0) {
+            return true;
+        }
+        return (a->deadline < b->deadline);
+    }
+
+    if (a->arrival_time != b->arrival_time) {
+        return (a->arrival_time < b->arrival_time);
+    }
+
+    return (a->id < b->id);
+}
+
+/*
+ * Performs the utilisation-based admission test for a real time process. The
+ * process is admitted if the sum of (remaining CPU time / time to deadline)
+ * over the active process, the queued processes and the new process does not
+ * exceed EDF_UTILISATION_BOUND. Processes without a deadline do not contribute
+ * to the utilisation, and are always admitted.
+ *
+ * The test is pessimistic. Bounding the total density is sufficient for the
+ * admitted processes to meet their deadlines, but it is only necessary when
+ * every deadline is the same distance away. A process that is rejected here
+ * may still have been schedulable (for example, a short process with a near
+ * deadline alongside a long process with a distant deadline), so a rejection
+ * in the output does not mean that a deadline would have been missed.
+ *
+ * PARAMETERS
+ *     queue: The real time queue.
+ *     active: The active process (may be NULL or a non-real time process).
+ *     pcb: The process requesting admission.
+ *     clock: The current time.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the process can be admitted without
+ * causing any admitted process to miss its deadline.
+ */
+boolean edf_admit(EDF_queue * queue, PCB * active, PCB * pcb, unsigned int clock) {
+    double utilisation = 0.0; // total utilisation of admitted processes
+
+    if (pcb->deadline == 0) {
+        return true;
+    }
+
+    // A process whose deadline cannot be met even on an idle system is rejected
+    if (pcb->deadline < clock + pcb->remaining_cpu_time) {
+        return false;
+    }
+
+    // Utilisation of the new process
+    utilisation += (double) pcb->remaining_cpu_time / (double) (pcb->deadline - clock);
+
+    // Utilisation of the active process
+    if ((active != NULL) && (active->priority == REAL_TIME_PROCESS_PRIORITY) && (active->deadline > clock)) {
+        utilisation += (double) active->remaining_cpu_time / (double) (active->deadline - clock);
+    }
+
+    // Utilisation of the queued processes
+    for (unsigned int i = 0; i < queue->size; i++) {
+        PCB * p = queue->heap[i];
+        if (p->deadline > clock) {
+            utilisation += (double) p->remaining_cpu_time / (double) (p->deadline - clock);
+        }
+    }
+
+    return (utilisation <= EDF_UTILISATION_BOUND);
+}
+
+/*
+ * Moves a PCB up the heap until the heap property is restored.
+ *
+ * PARAMETERS
+ *     queue: The queue containing the heap.
+ *     i: The index of the PCB to move.
+ */
+static void sift_up(EDF_queue * queue, unsigned int i) {
+    PCB * p = queue->heap[i]; // the PCB being moved
+
+    while (i > 0) {
+        unsigned int parent = (i - 1) / 2;
+        if (!edf_before(p, queue->heap[parent])) {
+            break;
+        }
+        queue->heap[i] = queue->heap[parent];
+        i = parent;
+    }
+
+    queue->heap[i] = p;
+}
+
+/*
+ * Moves a PCB down the heap until the heap property is restored.
+ *
+ * PARAMETERS
+ *     queue: The queue containing the heap.
+ *     i: The index of the PCB to move.
+ */
+static void sift_down(EDF_queue * queue, unsigned int i) {
+    if (i >= queue->size) {
+        return;
+    }
+
+    PCB * p = queue->heap[i]; // the PCB being moved
+
+    while ((2 * i + 1) < queue->size) {
+        unsigned int child = 2 * i + 1;
+        if ((child + 1 < queue->size) && edf_before(queue->heap[child + 1], queue->heap[child])) {
+            child++;
+        }
+        if (!edf_before(queue->heap[child], p)) {
+            break;
+        }
+        queue->heap[i] = queue->heap[child];
+        i = child;
+    }
+
+    queue->heap[i] = p;
+}
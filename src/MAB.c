@@ -11,19 +11,36 @@
 #include "../inc/output.h"
 #include <stdlib.h>
 
-extern MAB * memory; // global variable to pointer to the head of the memory list
-static unsigned int _id = 1; // counter used to track assigned IDs
+#define BITS_PER_WORD   (8 * sizeof(unsigned long)) // number of bits in each word of the free-block bitmap
+
+static void index_insert(MemoryPool * pool, MAB * mab);
+static void index_remove(MemoryPool * pool, MAB * mab);
+static unsigned int index_highest(MemoryPool * pool, unsigned int below);
+static unsigned int index_lowest(MemoryPool * pool, unsigned int from);
+static boolean index_other(MemoryPool * pool, MAB * exclude, unsigned int size);
+static void tree_update(MemoryPool * pool, unsigned int offset, unsigned int size);
+static MAB * tree_first(MemoryPool * pool, unsigned int from, unsigned int size);
+static int tree_search(MemoryPool * pool, unsigned int node, unsigned int lo, unsigned int width, unsigned int from, unsigned int size);
 
 /*
  * Creates a new MAB, with all values initialised to logical default values.
  *
+ * PARAMETERS
+ *     pool: The memory pool.
+ *
  * RETURN VALUE
- * A pointer to the new MAB.
+ * A pointer to the new MAB, or NULL if there is no memory for it.
  */
-MAB * create_null_MAB(void) {
+MAB * create_null_MAB(MemoryPool * pool) {
     MAB * new_mab = (MAB *) malloc(sizeof(MAB));
 
-    new_mab->id = (_id++);
+    if (new_mab == NULL) {
+        fprintf(__ERROR_OUTPUT, "Unable to allocate memory for a MAB.\n");
+        return NULL;
+    }
+
+    new_mab->id = (pool->id++);
+    new_mab->node = pool->node;
 
     new_mab->offset = 0;
     new_mab->size = 0;
@@ -32,58 +49,214 @@ MAB * create_null_MAB(void) {
     new_mab->prev = NULL;
     new_mab->next = NULL;
 
+    new_mab->next_free = NULL;
+    new_mab->prev_free = NULL;
+
     return new_mab;
 }
 
 /*
- * Checks if there is a MAB of at least the right size available. If there is
- * such a MAB, it is returned.
+ * Initialises a memory pool for a block of memory. Its MAB list consists of a
+ * single free MAB, and its placement policy is first fit.
+ *
+ * PARAMETERS
+ *     pool: The memory pool to initialise.
+ *     size: The total size of the memory (in megabytes).
+ *
+ * RETURN VALUE
+ * A pointer to the head of the new MAB list, or NULL if there is no memory for
+ * the free-block index (the pool is then left empty).
+ */
+MAB * mem_init(MemoryPool * pool, unsigned int size) {
+    MAB * head; // the single free MAB
+
+    pool->head = NULL;
+    pool->id = 1;
+    pool->node = 0;
+    pool->base = 0;
+    pool->policy = First_Fit;
+
+    // Create the free-block index
+    pool->index_size = size;
+    pool->bins = (MAB **) calloc(size + 1, sizeof(MAB *));
+    pool->bitmap = (unsigned long *) calloc((size / BITS_PER_WORD) + 1, sizeof(unsigned long));
+    pool->free_total = 0;
+
+    for (pool->leaves = 1; pool->leaves < size; pool->leaves *= 2);
+    pool->tree = (unsigned int *) calloc(2 * pool->leaves, sizeof(unsigned int));
+    pool->at = (MAB **) calloc(pool->leaves, sizeof(MAB *));
+    pool->cursor = 0;
+
+    if ((pool->bins == NULL) || (pool->bitmap == NULL) || (pool->tree == NULL) || (pool->at == NULL) || ((head = create_null_MAB(pool)) == NULL)) {
+        fprintf(__ERROR_OUTPUT, "Unable to allocate the free-block index for %d MB of memory.\n", size);
+        mem_destroy(pool);
+        return NULL;
+    }
+    head->size = size;
+    index_insert(pool, head);
+
+    pool->head = head;
+    return head;
+}
+
+/*
+ * Frees every MAB in a memory pool, and its free-block index.
+ *
+ * PARAMETERS
+ *     pool: The memory pool.
+ */
+void mem_destroy(MemoryPool * pool) {
+    MAB * head = pool->head; // for iterating through the MAB list
+
+    while (head != NULL) {
+        MAB * next = head->next;
+        free(head);
+        head = next;
+    }
+
+    free(pool->bins);
+    free(pool->bitmap);
+    pool->bins = NULL;
+    pool->bitmap = NULL;
+    pool->index_size = 0;
+    pool->free_total = 0;
+
+    free(pool->tree);
+    free(pool->at);
+    pool->tree = NULL;
+    pool->at = NULL;
+    pool->leaves = 0;
+    pool->head = NULL;
+}
+
+/*
+ * Assigns a memory pool to a memory (NUMA) node. The offsets of its MABs remain
+ * relative to the start of the pool.
+ *
+ * PARAMETERS
+ *     pool: The memory pool.
+ *     node: The memory node.
+ *     base: The start address (in megabytes) of the pool, within the memory of
+ *         all nodes.
+ */
+void mem_set_node(MemoryPool * pool, unsigned int node, unsigned int base) {
+    pool->node = node;
+    pool->base = base;
+
+    for (MAB * m = pool->head; m != NULL; m = m->next) {
+        m->node = node;
+    }
+}
+
+/*
+ * Sets the placement policy used to choose a free MAB for an allocation.
+ *
+ * PARAMETERS
+ *     pool: The memory pool.
+ *     policy: The placement policy.
+ */
+void mem_set_policy(MemoryPool * pool, PlacementPolicy policy) {
+    pool->policy = policy;
+}
+
+/*
+ * Gets the placement policy used to choose a free MAB for an allocation.
  *
- * Uses the global variable 'memory' as the head of the MAB list.
+ * PARAMETERS
+ *     pool: The memory pool.
+ *
+ * RETURN VALUE
+ * The placement policy.
+ */
+PlacementPolicy mem_get_policy(MemoryPool * pool) {
+    return pool->policy;
+}
+
+/*
+ * Gets the name of a placement policy.
  *
  * PARAMETERS
+ *     policy: The placement policy.
+ *
+ * RETURN VALUE
+ * The name of the placement policy.
+ */
+const char * mem_policy_name(PlacementPolicy policy) {
+    switch (policy) {
+        case First_Fit:
+            return "first";
+        case Next_Fit:
+            return "next";
+        case Best_Fit:
+            return "best";
+        case Worst_Fit:
+            return "worst";
+    }
+
+    return "unknown";
+}
+
+/*
+ * Checks if there is a MAB of at least the right size available. If there is
+ * such a MAB, the MAB chosen by the placement policy is returned.
+ *
+ * PARAMETERS
+ *     pool: The memory pool.
  *     size: The size of the MAB being requested.
  *
  * RETURN VALUE
  * A pointer to the requested MAB. NULL if no such MAB could be found.
  */
-MAB * mem_check(unsigned int size) {
-    MAB * m = memory; // for iterating through the MAB list
-
-    // Look for available memory
-    while (m != NULL) {
-        // Check if this MAB is an appropriate choice
-        if (!m->allocated && m->size >= size) {
-            return m;
-        }
+MAB * mem_check(MemoryPool * pool, unsigned int size) {
+    MAB * m = NULL; // the chosen MAB
 
-        // Go to the next MAB in the list
-        m = m->next;
+    // No need to search if no free MAB is large enough
+    if ((size == 0) || (mem_largest_free(pool) < size)) {
+        return NULL;
     }
 
-    // Available memory not found
-    return NULL;
+    switch (pool->policy) {
+        case First_Fit:
+            m = tree_first(pool, 0, size);
+            break;
+
+        case Next_Fit:
+            // Search from the end of the previous allocation, wrapping around to the start of memory
+            if ((m = tree_first(pool, pool->cursor, size)) == NULL) {
+                m = tree_first(pool, 0, size);
+            }
+            break;
+
+        case Best_Fit:
+            m = pool->bins[index_lowest(pool, size)];
+            break;
+
+        case Worst_Fit:
+            m = pool->bins[mem_largest_free(pool)];
+            break;
+    }
+
+    return m;
 }
 
 /*
  * Allocates a MAB of the specified size and returns a pointer to this MAB. The
- * allocation algorithm employed is a first-fit policy.
- *
- * Uses the global variable 'memory' as the head of the MAB list.
+ * MAB is chosen by the placement policy (see mem_set_policy()).
  *
  * PARAMETERS
+ *     pool: The memory pool.
  *     size: The size of the MAB being requested.
  *
  * RETURN VALUE
  * A pointer to the requested MAB. NULL if no such MAB could be found.
  */
-MAB * mem_alloc(unsigned int size) {
+MAB * mem_alloc(MemoryPool * pool, unsigned int size) {
     MAB * m = NULL; // the requested MAB - null if none found
 
     if (size > 0) {
         // Try to allocate memory
-        if ((m = mem_check(size)) && mem_split(m, size)) {
-            m->allocated = true;
+        if ((m = mem_check(pool, size))) {
+            m = mem_commit(pool, m, size);
         }
     }
 
@@ -95,23 +268,25 @@ MAB * mem_alloc(unsigned int size) {
  * Frees a MAB.
  *
  * PARAMETERS
+ *     pool: The memory pool.
  *     mab: Pointer to the MAB to be freed.
  *
  * RETURN VALUE
  * NULL if the MAB was freed successfully.
  */
-MAB * mem_free(MAB * mab) {
+MAB * mem_free(MemoryPool * pool, MAB * mab) {
     if (mab != NULL) {
         MAB * prev = mab->prev; // remember the previous MAB before we free mab
 
         // Mark the MAB as not being allocated
         mab->allocated = false;
+        index_insert(pool, mab);
 
         // Try to merge the MAB that was freed with the next MAB in the list
-        mab = mem_merge(mab);
+        mab = mem_merge(pool, mab);
 
         // Try to merge the MAB that was freed with the previous MAB in the list
-        prev = mem_merge(prev);
+        prev = mem_merge(pool, prev);
     }
 
     // Success
@@ -122,13 +297,14 @@ MAB * mem_free(MAB * mab) {
  * Merge the specified MAB with the next MAB in the list, if appropriate.
  *
  * PARAMETERS
+ *     pool: The memory pool.
  *     mab: Pointer to the MAB to be merged.
  *
  * RETURN VALUE
  * A pointer to the merge MAB. If no merge occurred, returns a pointer to the
  * same element.
  */
-MAB * mem_merge(MAB * mab) {
+MAB * mem_merge(MemoryPool * pool, MAB * mab) {
     if (mab != NULL) {
         MAB * m = mab->next; // remember the next element
 
@@ -136,7 +312,10 @@ MAB * mem_merge(MAB * mab) {
             // Make sure a merge is a valid operation
             if ((!(mab->allocated)) && (!(m->allocated))) {
                 // Combine the sizes of the two MABs
+                index_remove(pool, mab);
+                index_remove(pool, m);
                 mab->size += m->size;
+                index_insert(pool, mab);
 
                 // Fix the list next/prev pointers
                 if (m->next != NULL) {
@@ -160,6 +339,7 @@ MAB * mem_merge(MAB * mab) {
  * size (mab->size - size).
  *
  * PARAMETERS
+ *     pool: The memory pool.
  *     mab: Pointer to the MAB to split.
  *     size: The requested size.
  *
@@ -167,15 +347,18 @@ MAB * mem_merge(MAB * mab) {
  * Returns a value to the first of the split MAB elements (the MAB with size
  * (size)). Returns NULL if the split cannot be performed.
  */
-MAB * mem_split(MAB * mab, unsigned int size) {
+MAB * mem_split(MemoryPool * pool, MAB * mab, unsigned int size) {
     // Check that splitting the MAB would be a valid operation
     if ((!(mab->allocated)) && (mab->size >= size)) {
         if (mab->size > size) {
             // Perform the split
-            MAB *new_mab = create_null_MAB(); // the new MAB that is created
+            MAB *new_mab = create_null_MAB(pool); // the new MAB that is created
+            index_remove(pool, mab);
             new_mab->offset = mab->offset + size;
             new_mab->size = mab->size - size;
             mab->size = size;
+            index_insert(pool, mab);
+            index_insert(pool, new_mab);
 
             // Set the list next/prev pointers
             new_mab->prev = mab;
@@ -193,6 +376,450 @@ MAB * mem_split(MAB * mab, unsigned int size) {
     return NULL;
 }
 
+/*
+ * Finds the size of the largest MAB that is not allocated, using the free-block
+ * index.
+ *
+ * PARAMETERS
+ *     pool: The memory pool.
+ *
+ * RETURN VALUE
+ * The size of the largest free MAB, or 0 if all memory is allocated.
+ */
+unsigned int mem_largest_free(MemoryPool * pool) {
+    return (pool->tree != NULL) ? pool->tree[1] : 0;
+}
+
+/*
+ * Determines, without modifying the MAB list, the MAB that mem_alloc() would
+ * allocate for a request of the specified size. The reservation fails if, after
+ * the allocation, no free MAB of at least the reserve size would remain.
+ *
+ * PARAMETERS
+ *     pool: The memory pool.
+ *     size: The size of the MAB being requested.
+ *     reserve: The size of the free MAB that must remain after the allocation
+ *         (0 if no memory needs to remain free).
+ *
+ * RETURN VALUE
+ * A pointer to the MAB that would be allocated. NULL if the request cannot be
+ * satisfied.
+ */
+MAB * mem_reserve(MemoryPool * pool, unsigned int size, unsigned int reserve) {
+    MAB * m = NULL; // the MAB that would be allocated
+
+    // Fail fast if there is not enough memory for both the request and the reserve
+    if ((size == 0) || (mem_largest_free(pool) < size) || (mem_largest_free(pool) < reserve)) {
+        return NULL;
+    }
+
+    if ((m = mem_check(pool, size)) == NULL) {
+        return NULL;
+    }
+
+    // Check that a large enough MAB would remain free
+    if ((reserve > 0) && ((m->size - size) < reserve) && !index_other(pool, m, reserve)) {
+        return NULL;
+    }
+
+    return m;
+}
+
+/*
+ * Allocates memory of the specified size from a free MAB, such as one returned
+ * by mem_check() or mem_reserve().
+ *
+ * PARAMETERS
+ *     pool: The memory pool.
+ *     mab: The free MAB to allocate from.
+ *     size: The size of the MAB being requested.
+ *
+ * RETURN VALUE
+ * A pointer to the allocated MAB. NULL if the allocation could not be
+ * performed.
+ */
+MAB * mem_commit(MemoryPool * pool, MAB * mab, unsigned int size) {
+    if ((mab != NULL) && mem_split(pool, mab, size)) {
+        index_remove(pool, mab);
+        mab->allocated = true;
+        pool->cursor = mab->offset + mab->size;
+        return mab;
+    }
+
+    return NULL;
+}
+
+/*
+ * Allocates the memory at a specific offset, such as memory that was allocated
+ * to a process before the host dispatcher was restarted.
+ *
+ * PARAMETERS
+ *     pool: The memory pool.
+ *     offset: The offset of the memory.
+ *     size: The size of the memory.
+ *
+ * RETURN VALUE
+ * A pointer to the allocated MAB. NULL if the memory is not free.
+ */
+MAB * mem_claim(MemoryPool * pool, unsigned int offset, unsigned int size) {
+    MAB * m = pool->head; // for iterating through the MAB list
+
+    // Find the MAB containing the offset
+    while ((m != NULL) && (m->offset + m->size <= offset)) {
+        m = m->next;
+    }
+
+    if ((size == 0) || (m == NULL) || m->allocated || (offset + size > m->offset + m->size)) {
+        return NULL;
+    }
+
+    // Split off the free memory before the offset
+    if (m->offset < offset) {
+        mem_split(pool, m, offset - m->offset);
+        m = m->next;
+    }
+
+    return mem_commit(pool, m, size);
+}
+
+/*
+ * Gets the total size of the MABs that are not allocated.
+ *
+ * PARAMETERS
+ *     pool: The memory pool.
+ *
+ * RETURN VALUE
+ * The total free memory (in megabytes).
+ */
+unsigned int mem_total_free(MemoryPool * pool) {
+    return pool->free_total;
+}
+
+/*
+ * Measures the external fragmentation of the free memory, defined as the
+ * fraction of the free memory that is not part of the largest free MAB.
+ *
+ * PARAMETERS
+ *     pool: The memory pool.
+ *
+ * RETURN VALUE
+ * The external fragmentation, between 0 (all free memory is contiguous) and 1.
+ */
+double mem_fragmentation(MemoryPool * pool) {
+    if (pool->free_total == 0) {
+        return 0.0;
+    }
+
+    return 1.0 - ((double) mem_largest_free(pool) / (double) pool->free_total);
+}
+
+/*
+ * Compacts memory by relocating allocated MABs towards lower offsets, so that
+ * the free memory is coalesced into as few MABs as possible. A pinned MAB (for
+ * example, the memory of the running process) is not relocated, so the free
+ * memory on either side of it is coalesced separately.
+ *
+ * The allocated MAB structures are relocated by updating their offsets, so any
+ * pointers to them (such as the memory of a PCB) remain valid.
+ *
+ * PARAMETERS
+ *     pool: The memory pool.
+ *     pinned: A MAB that must not be relocated (may be NULL).
+ *
+ * RETURN VALUE
+ * The total size (in megabytes) of the relocated MABs.
+ */
+unsigned int mem_compact(MemoryPool * pool, MAB * pinned) {
+    MAB * m = pool->head; // for iterating through the old MAB list
+    MAB * head = NULL; // head of the compacted MAB list
+    MAB * tail = NULL; // tail of the compacted MAB list
+    unsigned int offset = (pool->head != NULL) ? pool->head->offset : 0; // offset of the next MAB in the compacted list
+    unsigned int free_size = 0; // size of the free memory collected since the last pinned MAB
+    unsigned int relocated = 0; // total size of the relocated MABs
+
+    while (true) {
+        MAB * next = (m != NULL) ? m->next : NULL; // the next MAB in the old list
+        MAB * append = NULL; // the MAB to append to the compacted list
+
+        if ((m != NULL) && !m->allocated) {
+            // Collect the free memory - it will be appended before the next pinned MAB
+            free_size += m->size;
+            index_remove(pool, m);
+            free(m);
+            m = next;
+            continue;
+        }
+
+        // Append the collected free memory before a pinned MAB and at the end of the list
+        if (((m == NULL) || (m == pinned)) && (free_size > 0)) {
+            append = create_null_MAB(pool);
+            append->offset = offset;
+            append->size = free_size;
+            index_insert(pool, append);
+
+            append->prev = tail;
+            if (tail != NULL) {
+                tail->next = append;
+            } else {
+                head = append;
+            }
+            tail = append;
+
+            offset += free_size;
+            free_size = 0;
+        }
+
+        if (m == NULL) {
+            break;
+        }
+
+        // Relocate the allocated MAB
+        if ((m != pinned) && (m->offset != offset)) {
+            relocated += m->size;
+            m->offset = offset;
+        }
+        offset = m->offset + m->size;
+
+        m->prev = tail;
+        m->next = NULL;
+        if (tail != NULL) {
+            tail->next = m;
+        } else {
+            head = m;
+        }
+        tail = m;
+
+        m = next;
+    }
+
+    pool->head = head;
+    return relocated;
+}
+
+/*
+ * Adds a free MAB to the free-block index.
+ *
+ * PARAMETERS
+ *     pool: The memory pool.
+ *     mab: The MAB to add.
+ */
+static void index_insert(MemoryPool * pool, MAB * mab) {
+    if ((pool->bins == NULL) || (mab->size == 0) || (mab->size > pool->index_size)) {
+        return;
+    }
+
+    mab->prev_free = NULL;
+    mab->next_free = pool->bins[mab->size];
+    if (mab->next_free != NULL) {
+        mab->next_free->prev_free = mab;
+    }
+    pool->bins[mab->size] = mab;
+    pool->bitmap[mab->size / BITS_PER_WORD] |= (1UL << (mab->size % BITS_PER_WORD));
+    pool->free_total += mab->size;
+
+    pool->at[mab->offset] = mab;
+    tree_update(pool, mab->offset, mab->size);
+}
+
+/*
+ * Removes a free MAB from the free-block index.
+ *
+ * PARAMETERS
+ *     pool: The memory pool.
+ *     mab: The MAB to remove.
+ */
+static void index_remove(MemoryPool * pool, MAB * mab) {
+    if ((pool->bins == NULL) || (mab->size == 0) || (mab->size > pool->index_size)) {
+        return;
+    }
+
+    if (mab->prev_free != NULL) {
+        mab->prev_free->next_free = mab->next_free;
+    } else if (pool->bins[mab->size] == mab) {
+        pool->bins[mab->size] = mab->next_free;
+    }
+    if (mab->next_free != NULL) {
+        mab->next_free->prev_free = mab->prev_free;
+    }
+    mab->prev_free = NULL;
+    mab->next_free = NULL;
+    pool->free_total -= mab->size;
+
+    if (pool->bins[mab->size] == NULL) {
+        pool->bitmap[mab->size / BITS_PER_WORD] &= ~(1UL << (mab->size % BITS_PER_WORD));
+    }
+
+    pool->at[mab->offset] = NULL;
+    tree_update(pool, mab->offset, 0);
+}
+
+/*
+ * Finds the size of the largest free MAB that is smaller than a given size.
+ *
+ * PARAMETERS
+ *     pool: The memory pool.
+ *     below: The exclusive upper bound on the size.
+ *
+ * RETURN VALUE
+ * The size of the largest free MAB smaller than 'below', or 0 if there is no
+ * such MAB.
+ */
+static unsigned int index_highest(MemoryPool * pool, unsigned int below) {
+    if ((pool->bitmap == NULL) || (below <= 1)) {
+        return 0;
+    }
+    if (below > pool->index_size + 1) {
+        below = pool->index_size + 1;
+    }
+
+    unsigned int bit = below - 1; // highest size to consider
+    unsigned int word = bit / BITS_PER_WORD;
+    unsigned long bits = pool->bitmap[word]; // the bitmap word being searched
+
+    // Ignore sizes that are too large in the first word
+    if ((bit % BITS_PER_WORD) != (BITS_PER_WORD - 1)) {
+        bits &= (1UL << ((bit % BITS_PER_WORD) + 1)) - 1;
+    }
+
+    while (true) {
+        if (bits != 0) {
+            return (word * BITS_PER_WORD) + (BITS_PER_WORD - 1 - __builtin_clzl(bits));
+        }
+        if (word == 0) {
+            return 0;
+        }
+        bits = pool->bitmap[--word];
+    }
+}
+
+/*
+ * Finds the size of the smallest free MAB that is at least a given size.
+ *
+ * PARAMETERS
+ *     pool: The memory pool.
+ *     from: The inclusive lower bound on the size.
+ *
+ * RETURN VALUE
+ * The size of the smallest free MAB of at least 'from', or 0 if there is no
+ * such MAB.
+ */
+static unsigned int index_lowest(MemoryPool * pool, unsigned int from) {
+    if ((pool->bitmap == NULL) || (from > pool->index_size)) {
+        return 0;
+    }
+
+    unsigned int word = from / BITS_PER_WORD;
+    unsigned long bits = pool->bitmap[word] & (~0UL << (from % BITS_PER_WORD)); // the bitmap word being searched
+
+    while (true) {
+        if (bits != 0) {
+            return (word * BITS_PER_WORD) + __builtin_ctzl(bits);
+        }
+        if (++word > (pool->index_size / BITS_PER_WORD)) {
+            return 0;
+        }
+        bits = pool->bitmap[word];
+    }
+}
+
+/*
+ * Sets the size of the free MAB at an offset in the max-tree, and updates the
+ * maximum of each ancestor.
+ *
+ * PARAMETERS
+ *     pool: The memory pool.
+ *     offset: The offset of the MAB.
+ *     size: The size of the free MAB (0 if the MAB is no longer free).
+ */
+static void tree_update(MemoryPool * pool, unsigned int offset, unsigned int size) {
+    unsigned int node = pool->leaves + offset; // the leaf for the offset
+
+    pool->tree[node] = size;
+    while (node > 1) {
+        node /= 2;
+        pool->tree[node] = (pool->tree[2 * node] > pool->tree[2 * node + 1]) ? pool->tree[2 * node] : pool->tree[2 * node + 1];
+    }
+}
+
+/*
+ * Finds the free MAB with the lowest offset, at or after a given offset, that
+ * is at least the specified size.
+ *
+ * PARAMETERS
+ *     pool: The memory pool.
+ *     from: The lowest offset to consider.
+ *     size: The minimum size of the MAB.
+ *
+ * RETURN VALUE
+ * A pointer to the MAB, or NULL if there is no such MAB.
+ */
+static MAB * tree_first(MemoryPool * pool, unsigned int from, unsigned int size) {
+    int offset = tree_search(pool, 1, 0, pool->leaves, from, size); // offset of the MAB
+
+    return (offset >= 0) ? pool->at[offset] : NULL;
+}
+
+/*
+ * Searches a subtree of the max-tree for the leftmost free MAB, at or after a
+ * given offset, that is at least the specified size.
+ *
+ * PARAMETERS
+ *     pool: The memory pool.
+ *     node: The root of the subtree.
+ *     lo: The lowest offset covered by the subtree.
+ *     width: The number of offsets covered by the subtree.
+ *     from: The lowest offset to consider.
+ *     size: The minimum size of the MAB.
+ *
+ * RETURN VALUE
+ * The offset of the MAB, or -1 if there is no such MAB in the subtree.
+ */
+static int tree_search(MemoryPool * pool, unsigned int node, unsigned int lo, unsigned int width, unsigned int from, unsigned int size) {
+    int offset; // offset found in the left subtree
+
+    // Skip subtrees with no large enough MAB, or that end before 'from'
+    if ((pool->tree[node] < size) || (lo + width <= from)) {
+        return -1;
+    }
+
+    if (width == 1) {
+        return (int) lo;
+    }
+
+    if ((offset = tree_search(pool, 2 * node, lo, width / 2, from, size)) >= 0) {
+        return offset;
+    }
+    return tree_search(pool, 2 * node + 1, lo + width / 2, width / 2, from, size);
+}
+
+/*
+ * Checks whether there is a free MAB of at least the specified size, other than
+ * the specified MAB.
+ *
+ * PARAMETERS
+ *     pool: The memory pool.
+ *     exclude: The MAB to ignore.
+ *     size: The minimum size of the MAB.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether such a MAB exists.
+ */
+static boolean index_other(MemoryPool * pool, MAB * exclude, unsigned int size) {
+    unsigned int largest = index_highest(pool, pool->index_size + 1); // size of the largest free MAB
+
+    if (largest < size) {
+        return false;
+    }
+
+    // Another MAB is at least as large as the largest
+    if ((largest != exclude->size) || (pool->bins[largest] != exclude) || (exclude->next_free != NULL)) {
+        return true;
+    }
+
+    // The excluded MAB is the only largest MAB - check the next largest
+    return (index_highest(pool, largest) >= size);
+}
+
 /*
  * Prints the list of MABs with their attributes.
  *
@@ -227,6 +854,31 @@ void print_MAB_list(MAB * head) {
     fprintf(__DEBUG_OUTPUT, "==================================\n");
 }
 
+/*
+ * Prints the fill level of each memory (NUMA) node.
+ *
+ * PARAMETERS
+ *     pools: The memory pool of each node.
+ *     nodes: The number of nodes.
+ */
+void print_node_list(MemoryPool * pools, unsigned int nodes) {
+    // Output header
+    fprintf(__DEBUG_OUTPUT, "==================================\n");
+    fprintf(__DEBUG_OUTPUT, "NODE\tUSED\tFREE\tFILL\n");
+    fprintf(__DEBUG_OUTPUT, "----------------------------------\n");
+
+    // Output the fill level of each node
+    for (unsigned int i = 0; i < nodes; i++) {
+        unsigned int size = pools[i].index_size; // the size of the node
+        unsigned int free_size = mem_total_free(&pools[i]); // the free memory of the node
+
+        fprintf(__DEBUG_OUTPUT, "%d\t%d\t%d\t%d%%\n", pools[i].node, size - free_size, free_size, (size > 0) ? (100 * (size - free_size) / size) : 0);
+    }
+
+    // End
+    fprintf(__DEBUG_OUTPUT, "==================================\n");
+}
+
 #ifdef DEBUG
 /*
  * Prints a detailed description of a MAB.
@@ -6,42 +6,178 @@
  *
  * This file contains the functions relating to process control blocks (PCBs).
  */
+#define _POSIX_C_SOURCE 200809L // for sysconf() and clock_gettime()
+
 #include "../inc/PCB.h"
+#include "../inc/dispatcher.h"
 #include "../inc/output.h"
 #include "../inc/MAB.h"
 #include "../inc/RAS.h"
+#include "../inc/cgroup.h"
+#include "../inc/pool.h"
+#include "../inc/dependency.h"
+#include "../inc/affinity.h"
+#include "../inc/banker.h"
+#include "../inc/control.h"
 #include <stdlib.h>
+#include <errno.h>
 #include <unistd.h>
 #include <signal.h>
 #include <string.h>
+#include <time.h>
 #include <sys/wait.h>
+#include <sys/resource.h>
+
+static unsigned long long memory_limit(unsigned int mbytes, unsigned int members);
+static pid_t fork_member(Dispatcher * dispatcher, PCB * pcb, boolean cgroup, unsigned int rank);
+static int signal_PCB(PCB * pcb, int signal);
+static void place_PCB(Dispatcher * dispatcher, PCB * pcb);
+static boolean measure_cpu_usage(PCB * pcb, unsigned long long * usec);
+static boolean has_exited(PCB * pcb);
+static boolean attach_worker(PCB * pcb, pid_t pid, boolean cgroup);
+static unsigned long long monotonic_usec(void);
+
+/*
+ * Gets the name of a memory enforcement mode, as accepted on the command line.
+ *
+ * PARAMETERS
+ *     enforcement: The memory enforcement mode.
+ *
+ * RETURN VALUE
+ * The name of the memory enforcement mode.
+ */
+const char * memory_enforcement_name(MemoryEnforcement enforcement) {
+    switch (enforcement) {
+        case Rlimit_Enforcement:
+            return "rlimit";
+        case Cgroup_Enforcement:
+            return "cgroup";
+        default:
+            return "none";
+    }
+}
 
-static unsigned int _id = 1; // counter used to track assigned IDs
+/*
+ * Gets the name of a suspension method, as accepted on the command line.
+ *
+ * PARAMETERS
+ *     method: The suspension method.
+ *
+ * RETURN VALUE
+ * The name of the suspension method.
+ */
+const char * suspend_method_name(SuspendMethod method) {
+    switch (method) {
+        case Freezer_Suspension:
+            return "freezer";
+        default:
+            return "signal";
+    }
+}
+
+/*
+ * Gets the name of a CPU accounting mode, as accepted on the command line.
+ *
+ * PARAMETERS
+ *     accounting: The CPU accounting mode.
+ *
+ * RETURN VALUE
+ * The name of the CPU accounting mode.
+ */
+const char * cpu_accounting_name(CPUAccounting accounting) {
+    switch (accounting) {
+        case Measured_Accounting:
+            return "cpu";
+        default:
+            return "tick";
+    }
+}
+
+/*
+ * Gets the name of an execution mode, as accepted on the command line.
+ *
+ * PARAMETERS
+ *     execution: The execution mode.
+ *
+ * RETURN VALUE
+ * The name of the execution mode.
+ */
+const char * execution_name(Execution execution) {
+    switch (execution) {
+        case Simulated_Execution:
+            return "simulated";
+        default:
+            return "process";
+    }
+}
 
 /*
  * Creates a new PCB, with all values initialised to logical default values.
+ * The IDs are reserved atomically, so PCBs can be created by any thread.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     ids: The number of consecutive IDs to reserve for the PCB (the instances
+ *         of a job array). The PCB is given the first of them.
  *
  * RETURN VALUE
  * A pointer to the new PCB.
  */
-PCB * create_null_PCB(void) {
+PCB * create_null_PCB(Dispatcher * dispatcher, unsigned int ids) {
     PCB * new_pcb = (PCB *) malloc(sizeof(PCB));
 
-    new_pcb->id = (_id++);
+    new_pcb->id = __atomic_fetch_add(&dispatcher->next_id, ids, __ATOMIC_RELAXED);
     new_pcb->pid = 0;
 
+    for (unsigned int i = 0; i < MAX_ARGS; i++) {
+        new_pcb->args[i] = NULL;
+    }
+
     new_pcb->arrival_time = 0;
     new_pcb->remaining_cpu_time = 0;
     new_pcb->priority = 0;
+    new_pcb->deadline = 0;
 
     new_pcb->num_printers = 0;
     new_pcb->num_scanners = 0;
     new_pcb->num_modems = 0;
     new_pcb->num_cds = 0;
+    new_pcb->banker_position = BANKER_NOT_ADMITTED;
 
     new_pcb->mbytes = 0;
     new_pcb->memory = NULL;
 
+    new_pcb->freezer = false;
+    new_pcb->cpuacct = false;
+
+    new_pcb->cpu_usage = 0;
+    new_pcb->cpu_ticks_charged = 0;
+    new_pcb->active_ticks = 0;
+    new_pcb->idle_check_usage = 0;
+    new_pcb->idle_check_time = 0;
+
+    new_pcb->last_cpu = AFFINITY_NO_CPU;
+    new_pcb->last_node = AFFINITY_NO_CPU;
+    new_pcb->suspend_time = 0;
+    new_pcb->suspend_usec = 0;
+
+    new_pcb->num_dependencies = 0;
+    new_pcb->unmet_dependencies = 0;
+    new_pcb->dependency_failed = false;
+    new_pcb->dependents = NULL;
+    new_pcb->num_dependents = 0;
+    new_pcb->dependents_capacity = 0;
+
+    new_pcb->instances = 1;
+    new_pcb->array = 0;
+    new_pcb->outstanding = 0;
+    new_pcb->instance_failed = false;
+    new_pcb->gang = 1;
+
+    timer_clear(&new_pcb->arrival_timer);
+    timer_clear(&new_pcb->deadline_timer);
+    timer_clear(&new_pcb->suspend_timer);
+
     new_pcb->prev = NULL;
     new_pcb->next = NULL;
 
@@ -132,6 +268,91 @@ PCB * dequeue_PCB(PCB ** head) {
     return p;
 }
 
+/*
+ * Creates the next instance of a job array. A job array is held as a single
+ * PCB (the last instance), which counts the instances that have not been
+ * admitted - each other instance is only created, as a copy of it, when it is
+ * admitted. The instances have consecutive IDs, and are created in order.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     array: The job array. It must have more than one instance remaining.
+ *
+ * RETURN VALUE
+ * A pointer to the new instance, or NULL if the instance could not be created
+ * (the job array is left unchanged).
+ */
+PCB * split_PCB(Dispatcher * dispatcher, PCB * array) {
+    PCB * instance = (PCB *) malloc(sizeof(PCB)); // the new instance
+
+    if (instance == NULL) {
+        fprintf(__ERROR_OUTPUT, "Unable to allocate memory for the next instance of PCB %d.\n", array->id);
+        return NULL;
+    }
+
+    *instance = *array;
+    instance->id = array->id - (array->instances - 1);
+
+    // Copy the args array
+    for (unsigned int i = 0; i < MAX_ARGS; i++) {
+        if (array->args[i] != NULL) {
+            if ((instance->args[i] = (char *) malloc(strlen(array->args[i]) + 1)) == NULL) {
+                fprintf(__ERROR_OUTPUT, "Unable to allocate memory for the next instance of PCB %d.\n", array->id);
+
+                // Free the arguments copied so far
+                for (unsigned int j = 0; j < i; j++) {
+                    free(instance->args[j]);
+                }
+                free(instance);
+                return NULL;
+            }
+            strcpy(instance->args[i], array->args[i]);
+        }
+    }
+
+    // The dependencies of the job array were met before it was admitted, and processes can depend on the instance once it has been created
+    instance->num_dependencies = 0;
+    instance->unmet_dependencies = 0;
+    instance->dependency_failed = false;
+    instance->dependents = NULL;
+    instance->num_dependents = 0;
+    instance->dependents_capacity = 0;
+    instance->instances = 1;
+    instance->array = array->id;
+    instance->outstanding = 0;
+    instance->instance_failed = false;
+
+    timer_clear(&instance->arrival_timer);
+    timer_clear(&instance->deadline_timer);
+    timer_clear(&instance->suspend_timer);
+
+    instance->prev = NULL;
+    instance->next = NULL;
+
+    array->instances--;
+    dependency_register(&dispatcher->dependencies, instance);
+
+    return instance;
+}
+
+/*
+ * Returns an instance created by split_PCB() to its job array, such as when the
+ * instance could not be admitted after all. The instance is freed.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     array: The job array.
+ *     instance: Pointer to the instance.
+ */
+void rejoin_PCB(Dispatcher * dispatcher, PCB * array, PCB ** instance) {
+    // The instance was never admitted, so it is no longer outstanding (and its removal does not count as a failure)
+    array->instances++;
+    array->outstanding--;
+    (*instance)->array = 0;
+    free_PCB(dispatcher, instance);
+    *instance = NULL;
+}
+
 /*
  * Decrement the remaining CPU time from a process. If the process has no
  * remaining CPU time, then the process will be terminated.
@@ -140,21 +361,149 @@ PCB * dequeue_PCB(PCB ** head) {
  * the underlying pointer can be changed by this function.
  *
  * PARAMETERS
+ *     dispatcher: The host dispatcher.
  *     pcb: Pointer to the PCB to alter.
  *
  * RETURN VALUE
  * A pointer to the same process, unless this process was terminated in which
  * case NULL is returned.
  */
-PCB * decrement_remaining_cpu_time(PCB ** pcb) {
+PCB * decrement_remaining_cpu_time(Dispatcher * dispatcher, PCB ** pcb) {
+    return charge_cpu_time(dispatcher, pcb, 1);
+}
+
+/*
+ * Calculates the CPU time to charge to the active process at the end of its
+ * quantum.
+ *
+ * With tick accounting, every tick of the quantum is charged. With measured
+ * accounting, the CPU time consumed by the process (and any descendants in its CPU accounting
+ * cgroup) is measured, and the whole ticks of CPU time consumed since the
+ * process was last charged are charged (rounded to the nearest tick, with the
+ * remainder carried forward). A process that is blocked for most of a tick is
+ * therefore not charged for it. A process that has exited on its own is
+ * charged all of its remaining CPU time, as is a process that has been active
+ * for MEASURED_TIME_LIMIT times its CPU time (to bound the time that a mostly
+ * idle process can hold its memory and resources).
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     pcb: The active process.
+ *     quantum: The number of ticks for which the process has been active since
+ *         it was last charged.
+ *
+ * RETURN VALUE
+ * The number of ticks to charge to the process.
+ */
+unsigned int cpu_time_to_charge(Dispatcher * dispatcher, PCB * pcb, unsigned int quantum) {
+    unsigned long long usage; // CPU time consumed by the process (in microseconds)
+    unsigned int ticks; // ticks to charge to the process
+
+    pcb->active_ticks += quantum;
+
+    // If the CPU time cannot be measured, fall back to charging every tick
+    if ((dispatcher->config.accounting == Tick_Accounting) || (dispatcher->config.execution == Simulated_Execution) || !measure_cpu_usage(pcb, &usage)) {
+        ticks = quantum;
+    } else {
+        if (usage > pcb->cpu_usage) {
+            pcb->cpu_usage = usage;
+        }
+        ticks = (unsigned int) ((pcb->cpu_usage + TICK_USEC / 2) / TICK_USEC) - pcb->cpu_ticks_charged;
+
+        // Check whether the process has exited
+        if (has_exited(pcb)) {
+#ifdef DEBUG
+            fprintf(__DEBUG_OUTPUT, "PCB %d has exited after using %llu us of CPU time.\n", pcb->id, pcb->cpu_usage);
+#endif // #ifdef DEBUG
+            ticks = pcb->remaining_cpu_time;
+        } else if (pcb->active_ticks >= MEASURED_TIME_LIMIT * (pcb->cpu_ticks_charged + pcb->remaining_cpu_time)) {
+#ifdef DEBUG
+            fprintf(__DEBUG_OUTPUT, "PCB %d has been active for %d ticks but only used %llu us of CPU time.\n", pcb->id, pcb->active_ticks, pcb->cpu_usage);
+#endif // #ifdef DEBUG
+            ticks = pcb->remaining_cpu_time;
+        }
+    }
+
+    if (ticks > pcb->remaining_cpu_time) {
+        ticks = pcb->remaining_cpu_time;
+    }
+    pcb->cpu_ticks_charged += ticks;
+
+    return ticks;
+}
+
+/*
+ * Checks whether the active process has been idle (blocked or sleeping) since
+ * it was last checked, or since the start of its quantum, so that its quantum
+ * can end early rather than holding the CPU idle. A process is idle if it used
+ * less than IDLE_TICK_USEC of CPU time for each tick. Only measured accounting
+ * can tell - with tick accounting, a process is never idle.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     pcb: The active process.
+ *     quantum_start: The time at which the quantum of the process started.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the process has been idle.
+ */
+boolean cpu_idle(Dispatcher * dispatcher, PCB * pcb, unsigned int quantum_start) {
+    unsigned long long usage; // CPU time consumed by the process (in microseconds)
+    unsigned long long since; // CPU time consumed by the process at the previous check (in microseconds)
+    unsigned int ticks; // ticks since the previous check
+
+    if ((dispatcher->config.accounting == Tick_Accounting) || (dispatcher->config.execution == Simulated_Execution) || (dispatcher->clock <= quantum_start)) {
+        return false;
+    }
+
+    // A process that has exited is charged the rest of its CPU time when its quantum ends
+    if (has_exited(pcb)) {
+        return true;
+    }
+    if (!measure_cpu_usage(pcb, &usage)) {
+        return false;
+    }
+
+    // The process was last measured when it was charged, if it has not been checked during this quantum
+    if (pcb->idle_check_time > quantum_start) {
+        since = pcb->idle_check_usage;
+        ticks = dispatcher->clock - pcb->idle_check_time;
+    } else {
+        since = pcb->cpu_usage;
+        ticks = dispatcher->clock - quantum_start;
+    }
+    pcb->idle_check_usage = usage;
+    pcb->idle_check_time = dispatcher->clock;
+
+    return ((usage < since) || (usage - since < (unsigned long long) ticks * IDLE_TICK_USEC));
+}
+
+/*
+ * Charges CPU time to a process. If the process has no remaining CPU time, then
+ * the process will be terminated.
+ *
+ * The parameters for this function are pointers to pointers of a struct so that
+ * the underlying pointer can be changed by this function.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     pcb: Pointer to the PCB to alter.
+ *     ticks: The CPU time to charge (in ticks).
+ *
+ * RETURN VALUE
+ * A pointer to the same process, unless this process was terminated in which
+ * case NULL is returned.
+ */
+PCB * charge_cpu_time(Dispatcher * dispatcher, PCB ** pcb, unsigned int ticks) {
     if (*pcb != NULL) {
-        // Decrement the remaining CPU time for the process and check whether the process has any remaining CPU time
-        if ((--((*pcb)->remaining_cpu_time)) <= 0) {
+        // Charge the CPU time to the process and check whether the process has any remaining CPU time
+        (*pcb)->remaining_cpu_time = ((*pcb)->remaining_cpu_time > ticks) ? ((*pcb)->remaining_cpu_time - ticks) : 0;
+        if ((*pcb)->remaining_cpu_time == 0) {
             // Time's up - terminate process
-            *pcb = terminate_PCB(pcb);
+            *pcb = terminate_PCB(dispatcher, pcb);
 
             // Free memory associated with the PCB
-            free_PCB(pcb);
+            free_PCB(dispatcher, pcb);
 
             // The PCB has been freed, return NULL
             return NULL;
@@ -167,118 +516,302 @@ PCB * decrement_remaining_cpu_time(PCB ** pcb) {
 
 /*
  * Lower the priority of a process. If the priority of the process is already at
- * (or lower than) the value defined as LOWEST_PRIORITY, then the priority is
- * set to LOWEST_PRIORITY.
+ * (or lower than) the lowest priority, then the priority is set to the lowest
+ * priority.
  *
  * The parameters for this function are pointers to pointers of a struct so that
  * the underlying pointer can be changed by this function.
  *
  * PARAMETERS
  *     pcb: Pointer to the PCB to alter.
+ *     lowest: The lowest priority (largest integer) that the process can be set
+ *         to.
  *
  * RETURN VALUE
  * A pointer to the same process.
  */
-PCB * lower_priority(PCB ** pcb) {
+PCB * lower_priority(PCB ** pcb, unsigned int lowest) {
     // Lower the priority of the process (unless already at lowest priority)
-    if ((*pcb)->priority < LOWEST_PRIORITY) {
+    if ((*pcb)->priority < lowest) {
         ((*pcb)->priority)++;
     } else {
-        (*pcb)->priority = LOWEST_PRIORITY;
+        (*pcb)->priority = lowest;
     }
 
     return *pcb;
 }
 
 /*
- * Starts a process by forking the current process.
+ * Starts a process on a pre-spawned worker from the worker pool if one is
+ * available, or otherwise by forking the current process. If memory
+ * enforcement is enabled, the memory limit of the process is applied between
+ * fork() and exec(), so that the program never runs without it. Workers are
+ * placed in the cgroups of the process before they are sent the job, but are
+ * not used with RLIMIT_AS (which can only be set by the process itself).
+ *
+ * The members of a gang are always forked, into a process group led by the
+ * first member. They share the cgroups of the process, so that the memory limit
+ * applies to the gang as a whole and the gang is frozen as a whole. If any
+ * member cannot be forked, the members that were forked are killed and the
+ * process is left unstarted (with a PID of 0).
  *
  * The parameters for this function are pointers to pointers of a struct so that
  * the underlying pointer can be changed by this function.
  *
  * PARAMETERS
+ *     dispatcher: The host dispatcher.
  *     pcb: Pointer to the PCB to start.
  *
  * RETURN VALUE
  * A pointer to the same process, or NULL if starting the process failed.
  */
-PCB * start_PCB(PCB ** pcb) {
+PCB * start_PCB(Dispatcher * dispatcher, PCB ** pcb) {
+    boolean cgroup = false; // whether the process is placed in its own memory cgroup
+    Worker worker; // a pre-spawned worker to run the process
+
 #ifdef DEBUG
     fprintf(__DEBUG_OUTPUT, "Starting PCB %d. Remaining CPU time: %d\n", (*pcb)->id, (*pcb)->remaining_cpu_time);
 #endif // #ifdef DEBUG
-    // Fork the current process
-    switch((*pcb)->pid = fork()) {
-        case -1: // fork failed
-            fprintf(__ERROR_OUTPUT, "Forking of PCB %d failed.\n", (*pcb)->id);
-            return NULL;
-            break;
+    // A simulated process only needs a non-zero PID, to show that it has been started
+    if (dispatcher->config.execution == Simulated_Execution) {
+        (*pcb)->pid = (pid_t) (*pcb)->id;
+        return *pcb;
+    }
 
-        case 0: // child
+    // Create a memory cgroup for the process, falling back to RLIMIT_AS if that fails
+    if ((dispatcher->config.enforcement == Cgroup_Enforcement) && cgroup_create(Memory_Controller, (*pcb)->id)) {
+        if (!(cgroup = cgroup_set_memory_limit((*pcb)->id, memory_limit((*pcb)->mbytes, (*pcb)->gang)))) {
+            fprintf(__ERROR_OUTPUT, "Unable to limit the memory of PCB %d with a cgroup. Using RLIMIT_AS instead.\n", (*pcb)->id);
+            cgroup_remove(Memory_Controller, (*pcb)->id);
+        }
+    }
+
+    // Create a freezer cgroup for the process, falling back to signals if that fails
+    (*pcb)->freezer = ((dispatcher->config.suspend_method == Freezer_Suspension) && cgroup_create(Freezer_Controller, (*pcb)->id));
+
+    // Create a CPU accounting cgroup for the process, falling back to /proc if that fails
+    (*pcb)->cpuacct = ((dispatcher->config.accounting == Measured_Accounting) && cgroup_create(CPU_Controller, (*pcb)->id));
+
+    // Start the process on a pre-spawned worker (a worker cannot join the process group of a gang, bind its memory to a memory node or be told its ID)
+    if (((*pcb)->gang == 1) && ((dispatcher->config.enforcement == No_Enforcement) || cgroup) && (dispatcher->config.memory_nodes == 1) && !dispatcher->config.banker && pool_acquire((*pcb)->args[0], &worker)) {
+        if (attach_worker(*pcb, worker.pid, cgroup) && pool_release(&worker, (*pcb)->args)) {
+            (*pcb)->pid = worker.pid;
 #ifdef DEBUG
-            fprintf(__DEBUG_OUTPUT, "PCB %d forked (PID: %d).\n", (*pcb)->id, (int) getpid());
+            fprintf(__DEBUG_OUTPUT, "PCB %d started on worker (PID: %d).\n", (*pcb)->id, (int) worker.pid);
 #endif // #ifdef DEBUG
-            // Execute the command with the appropriate arguments
-            execvp((*pcb)->args[0], (*pcb)->args);
+            return *pcb;
+        }
 
-            // If execution reaches this line, an error has occured as execvp should never return
-            fprintf(__ERROR_OUTPUT, "Execution of PCB %d (PID: %d) failed.\n", (*pcb)->id, (int) getpid());
-            return NULL;
-            break;
+        fprintf(__ERROR_OUTPUT, "Unable to start PCB %d on worker (PID: %d). Forking instead.\n", (*pcb)->id, (int) worker.pid);
+        pool_discard(&worker);
+    }
 
-        default: // parent
-            return *pcb;
-            break;
+    // Fork the members of the process - the first member of a gang leads its process group, so that the gang can be signalled as a whole
+    for (unsigned int rank = 0; rank < (*pcb)->gang; rank++) {
+        pid_t pid = fork_member(dispatcher, *pcb, cgroup, rank); // the system process ID of the member
+
+        if (pid == -1) {
+            fprintf(__ERROR_OUTPUT, "Forking of PCB %d failed.\n", (*pcb)->id);
+            if (rank > 0) {
+                // Kill the members that have already been forked
+                kill(-(*pcb)->pid, SIGKILL);
+                while (waitpid(-(*pcb)->pid, NULL, 0) > 0);
+            }
+
+            // The process has not been started (a PID of -1 would signal every process, and the negated PID of a gang leader of 1 would signal init)
+            (*pcb)->pid = 0;
+            if (cgroup) {
+                cgroup_remove(Memory_Controller, (*pcb)->id);
+            }
+            if ((*pcb)->freezer) {
+                cgroup_remove(Freezer_Controller, (*pcb)->id);
+                (*pcb)->freezer = false;
+            }
+            if ((*pcb)->cpuacct) {
+                cgroup_remove(CPU_Controller, (*pcb)->id);
+                (*pcb)->cpuacct = false;
+            }
+            return NULL;
+        }
+        if (rank == 0) {
+            (*pcb)->pid = pid;
+        }
     }
+
+    return *pcb;
 }
 
 /*
- * Suspends a process using the SIGTSTP signal.
+ * Suspends a process. A process in its own freezer cgroup is frozen along with
+ * all of its descendants - this cannot be caught or ignored by the process, and
+ * takes effect asynchronously so there is no need to wait for the process.
+ * Otherwise (or if freezing fails), the process is sent the SIGTSTP signal. A
+ * process that has already exited (and been reaped, as an adopted process is)
+ * is left to be terminated when it is next charged.
+ *
+ * A process that has not stopped yet is given SUSPEND_TIMEOUT_USEC of real
+ * time to stop (see confirm_suspension()), rather than being waited for - a
+ * process that traps SIGTSTP would otherwise stall the host dispatcher. Every
+ * member of a gang is sent the signal, and the gang is always given time to
+ * stop.
+ *
+ * The CPU that the process last ran on (and its NUMA node) is recorded, so
+ * that restart_PCB() can resume the process there.
 
  * The parameters for this function are pointers to pointers of a struct so that
  * the underlying pointer can be changed by this function.
  *
  * PARAMETERS
+ *     dispatcher: The host dispatcher.
  *     pcb: Pointer to the PCB to suspend.
  *
  * RETURN VALUE
  * A pointer to the same process, or NULL if  suspending the process failed.
  */
-PCB * suspend_PCB(PCB ** pcb) {
+PCB * suspend_PCB(Dispatcher * dispatcher, PCB ** pcb) {
     int status;
 
 #ifdef DEBUG
     fprintf(__DEBUG_OUTPUT, "Suspending PCB %d (PID: %d). Remaining CPU time: %d\n", (*pcb)->id, (int) (*pcb)->pid, (*pcb)->remaining_cpu_time);
 #endif
+    if (dispatcher->config.execution == Simulated_Execution) {
+        return *pcb;
+    }
+
+    // Record where the process ran (the members of a gang run on several CPUs, so are not restricted)
+    (*pcb)->suspend_time = dispatcher->timers.now;
+    if ((dispatcher->config.migration_cost > 0) && ((*pcb)->gang == 1) && affinity_last_cpu((*pcb)->pid, &(*pcb)->last_cpu)) {
+        (*pcb)->last_node = affinity_node_of((*pcb)->last_cpu);
+    }
+
+    // Freeze the process
+    if ((*pcb)->freezer) {
+        if (cgroup_freeze((*pcb)->id, true)) {
+            return *pcb;
+        }
+        fprintf(__ERROR_OUTPUT, "Freezing of PCB %d (PID: %d) failed. Using SIGTSTP instead.\n", (*pcb)->id, (int) (*pcb)->pid);
+        (*pcb)->freezer = false;
+    }
+
     // Send the suspend signal
-    if (kill((*pcb)->pid, SIGTSTP)) {
+    (*pcb)->suspend_usec = monotonic_usec();
+    if (signal_PCB(*pcb, SIGTSTP)) {
+        if (errno == ESRCH) {
+            return *pcb;
+        }
         fprintf(__ERROR_OUTPUT, "Suspension of PCB %d (PID: %d) failed.\n", (*pcb)->id, (int) (*pcb)->pid);
         return NULL;
     }
 
-    // Wait for the process to respond to the signal
+    // Wait for the process to respond to the signal (the members of a gang cannot all be waited for without blocking)
+    if (((*pcb)->gang > 1) || (waitpid((*pcb)->pid, &status, WUNTRACED | WNOHANG) == 0)) {
+        timer_add(&dispatcher->timers, &(*pcb)->suspend_timer, dispatcher->timers.now + 1, Timer_Suspend, *pcb);
+    }
+
+    return *pcb;
+}
+
+/*
+ * Confirms that a process suspended by suspend_PCB() has stopped. This is
+ * checked at each tick after the process was suspended. A process that is
+ * still running SUSPEND_TIMEOUT_USEC after it was sent SIGTSTP is stopped with
+ * SIGSTOP, which cannot be trapped. The timeout is measured in real time rather
+ * than ticks, so that a process is given as long to stop in fast mode (where a
+ * tick may take microseconds) as otherwise. The members of a gang are always
+ * sent SIGSTOP once the timeout has passed, which has no effect on a member
+ * that has already stopped.
+ *
+ * The parameters for this function are pointers to pointers of a struct so that
+ * the underlying pointer can be changed by this function.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     pcb: Pointer to the PCB to check.
+ *
+ * RETURN VALUE
+ * A pointer to the same process, or NULL if stopping the process failed.
+ */
+PCB * confirm_suspension(Dispatcher * dispatcher, PCB ** pcb) {
+    int status;
+    boolean expired; // whether the process has had SUSPEND_TIMEOUT_USEC to stop
+
+    // A simulated process never runs
+    if (dispatcher->config.execution == Simulated_Execution) {
+        return *pcb;
+    }
+    expired = (monotonic_usec() - (*pcb)->suspend_usec >= SUSPEND_TIMEOUT_USEC);
+
+    // Stop any member of a gang that has not stopped yet, once the gang has had time to stop
+    if ((*pcb)->gang > 1) {
+        if (!expired) {
+            timer_add(&dispatcher->timers, &(*pcb)->suspend_timer, dispatcher->timers.now + 1, Timer_Suspend, *pcb);
+            return *pcb;
+        }
+        if (signal_PCB(*pcb, SIGSTOP) && (errno != ESRCH)) {
+            fprintf(__ERROR_OUTPUT, "Suspension of PCB %d (PID: %d) failed.\n", (*pcb)->id, (int) (*pcb)->pid);
+            return NULL;
+        }
+        return *pcb;
+    }
+
+    // An adopted process is not a child of the host dispatcher, so cannot be waited for
+    if (waitpid((*pcb)->pid, &status, WUNTRACED | WNOHANG) != 0) {
+        return *pcb;
+    }
+
+    // Check again at the next tick if the process still has time to stop
+    if (!expired) {
+        timer_add(&dispatcher->timers, &(*pcb)->suspend_timer, dispatcher->timers.now + 1, Timer_Suspend, *pcb);
+        return *pcb;
+    }
+
+    fprintf(__ERROR_OUTPUT, "PCB %d (PID: %d) did not stop within %d ms of being suspended. Stopping it with SIGSTOP.\n", (*pcb)->id, (int) (*pcb)->pid, SUSPEND_TIMEOUT_USEC / 1000);
+    if (signal_PCB(*pcb, SIGSTOP)) {
+        fprintf(__ERROR_OUTPUT, "Suspension of PCB %d (PID: %d) failed.\n", (*pcb)->id, (int) (*pcb)->pid);
+        return NULL;
+    }
     waitpid((*pcb)->pid, &status, WUNTRACED);
 
     return *pcb;
 }
 
 /*
- * Restarts a process that was suspended with SIGTSTP using the SIGCONT signal.
+ * Restarts a process that was suspended by suspend_PCB(), by thawing its
+ * freezer cgroup or by sending it the SIGCONT signal. The process is first
+ * placed back on the CPU that it last ran on if its cache may still be warm
+ * (see place_PCB()).
  *
  * The parameters for this function are pointers to pointers of a struct so that
  * the underlying pointer can be changed by this function.
  *
  * PARAMETERS
+ *     dispatcher: The host dispatcher.
  *     pcb: Pointer to the PCB to restart.
  *
  * RETURN VALUE
  * A pointer to the same process, or NULL if restarting the process failed.
  */
-PCB * restart_PCB(PCB ** pcb) {
+PCB * restart_PCB(Dispatcher * dispatcher, PCB ** pcb) {
 #ifdef DEBUG
     fprintf(__DEBUG_OUTPUT, "Restarting PCB %d (PID: %d). Remaining CPU time: %d\n", (*pcb)->id, (int) (*pcb)->pid, (*pcb)->remaining_cpu_time);
 #endif // #ifdef DEBUG
+    timer_cancel(&(*pcb)->suspend_timer);
+    if (dispatcher->config.execution == Simulated_Execution) {
+        return *pcb;
+    }
+    place_PCB(dispatcher, *pcb);
+
+    // Thaw the process
+    if ((*pcb)->freezer) {
+        if (cgroup_freeze((*pcb)->id, false)) {
+            return *pcb;
+        }
+        fprintf(__ERROR_OUTPUT, "Thawing of PCB %d (PID: %d) failed.\n", (*pcb)->id, (int) (*pcb)->pid);
+        return NULL;
+    }
+
     // Send the continue signal
-    if (kill((*pcb)->pid, SIGCONT)) {
+    if (signal_PCB(*pcb, SIGCONT)) {
         fprintf(__ERROR_OUTPUT, "Restarting of PCB %d (PID: %d) failed.\n", (*pcb)->id, (int) (*pcb)->pid);
         return NULL;
     }
@@ -287,47 +820,141 @@ PCB * restart_PCB(PCB ** pcb) {
 }
 
 /*
- * Terminates a process using the SIGINT signal.
+ * Terminates a process using the SIGINT signal. The memory and resources of a
+ * process that has already exited (and been reaped, as an adopted process is)
+ * are still released.
  *
  * The parameters for this function are pointers to pointers of a struct so that
  * the underlying pointer can be changed by this function.
  *
  * PARAMETERD
+ *     dispatcher: The host dispatcher.
  *     pcb: Pointer to the PCB to restart.
  *
  * RETURN VALUE
  * A pointer to the same process, or NULL if terminating the process failed.
  */
-PCB * terminate_PCB(PCB ** pcb) {
+PCB * terminate_PCB(Dispatcher * dispatcher, PCB ** pcb) {
     int status;
 
 #ifdef DEBUG
     fprintf(__DEBUG_OUTPUT, "Terminating PCB %d (PID: %d). Remaining CPU time: %d\n", (*pcb)->id, (int) (*pcb)->pid, (*pcb)->remaining_cpu_time);
 #endif // #ifdef DEBUG
-    // Send the kill signal
-    if (kill((*pcb)->pid, SIGINT)) {
-        fprintf(__ERROR_OUTPUT, "Termination of PCB %d (PID: %d) failed.\n", (*pcb)->id, (int) (*pcb)->pid);
-        return NULL;
+    // Send the kill signal (a simulated process has no system process to terminate)
+    if (dispatcher->config.execution == Process_Execution) {
+        if (signal_PCB(*pcb, SIGINT) == 0) {
+            // A suspended process cannot respond to the signal until it is thawed or continued
+            if ((*pcb)->freezer) {
+                cgroup_freeze((*pcb)->id, false);
+            } else {
+                signal_PCB(*pcb, SIGCONT);
+            }
+
+            // Wait for the process (or every member of a gang) to respond to the signal
+            if ((*pcb)->gang > 1) {
+                while (waitpid(-(*pcb)->pid, &status, 0) > 0);
+            } else {
+                waitpid((*pcb)->pid, &status, WUNTRACED);
+            }
+        } else if (errno != ESRCH) {
+            fprintf(__ERROR_OUTPUT, "Termination of PCB %d (PID: %d) failed.\n", (*pcb)->id, (int) (*pcb)->pid);
+            return NULL;
+        }
     }
 
-    // Wait for the process to respond to the signal
-    waitpid((*pcb)->pid, &status, WUNTRACED);
+    // Remove the memory cgroup of the process
+    if (dispatcher->config.enforcement == Cgroup_Enforcement) {
+        cgroup_remove(Memory_Controller, (*pcb)->id);
+    }
+
+    // Remove the freezer cgroup of the process
+    if ((*pcb)->freezer) {
+        cgroup_remove(Freezer_Controller, (*pcb)->id);
+        (*pcb)->freezer = false;
+    }
+
+    // Remove the CPU accounting cgroup of the process
+    if ((*pcb)->cpuacct) {
+        cgroup_remove(CPU_Controller, (*pcb)->id);
+        (*pcb)->cpuacct = false;
+    }
 
     // Free the memory associated with the process
 #ifdef DEBUG
     fprintf(__DEBUG_OUTPUT, "Freeing the memory associated with PCB %d.\n", (*pcb)->id);
 #endif // #ifdef DEBUG
-    (*pcb)->memory = mem_free((*pcb)->memory);
+    (*pcb)->memory = free_memory(dispatcher, (*pcb)->memory);
 
     // Free the resources associated with the process
 #ifdef DEBUG
     fprintf(__DEBUG_OUTPUT, "Freeing the resources associated with PCB %d.\n", (*pcb)->id);
 #endif // #ifdef DEBUG
-    resource_free(*pcb);
+    banker_remove(&dispatcher->banker, *pcb);
+    resource_free(&dispatcher->resources, *pcb);
 
     return *pcb;
 }
 
+/*
+ * Adopts a process that was started by a previous host dispatcher, which has
+ * since died. The process is checked to still be running its program (rather
+ * than the PID having been reused). The process is no longer a child of the
+ * host dispatcher, so it is terminated without being waited for.
+ *
+ * The cgroups of the previous host dispatcher cannot be used. The CPU time of
+ * the process is measured from /proc instead, and a process that was in a
+ * freezer cgroup is moved to a new freezer cgroup (which thaws it), falling
+ * back to signals if that fails (as it always does for a gang, whose other
+ * members cannot be found). A process that is not the active process is then
+ * suspended again.
+ *
+ * The parameters for this function are pointers to pointers of a struct so that
+ * the underlying pointer can be changed by this function.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     pcb: Pointer to the PCB to adopt.
+ *     suspended: Whether the process is suspended.
+ *
+ * RETURN VALUE
+ * A pointer to the same process, or NULL if the process is no longer running.
+ */
+PCB * adopt_PCB(Dispatcher * dispatcher, PCB ** pcb, boolean suspended) {
+    char path[64]; // path of the process command line
+    char program[256]; // the program that the process is running (the first argument of its command line)
+    size_t length = 0; // length of the program name
+    FILE * cmdline;
+
+    snprintf(path, sizeof(path), "/proc/%d/cmdline", (int) (*pcb)->pid);
+    if ((cmdline = fopen(path, "r")) != NULL) {
+        length = fread(program, 1, sizeof(program) - 1, cmdline);
+        fclose(cmdline);
+    }
+    program[length] = '\0';
+
+    if ((length == 0) || ((*pcb)->args[0] == NULL) || (strcmp(program, (*pcb)->args[0]) != 0)) {
+        fprintf(__ERROR_OUTPUT, "PCB %d (PID: %d) is no longer running.\n", (*pcb)->id, (int) (*pcb)->pid);
+        return NULL;
+    }
+
+    (*pcb)->cpuacct = false;
+    if ((*pcb)->freezer) {
+        (*pcb)->freezer = (((*pcb)->gang == 1) && (dispatcher->config.suspend_method == Freezer_Suspension) && cgroup_create(Freezer_Controller, (*pcb)->id) && cgroup_attach(Freezer_Controller, (*pcb)->id, (*pcb)->pid));
+        if (!(*pcb)->freezer) {
+            fprintf(__ERROR_OUTPUT, "Unable to move PCB %d (PID: %d) into a new freezer cgroup. Using signals instead.\n", (*pcb)->id, (int) (*pcb)->pid);
+        }
+    }
+
+    if (suspended && (((*pcb)->freezer && !cgroup_freeze((*pcb)->id, true)) || (!(*pcb)->freezer && signal_PCB(*pcb, SIGTSTP)))) {
+        fprintf(__ERROR_OUTPUT, "Suspension of adopted PCB %d (PID: %d) failed.\n", (*pcb)->id, (int) (*pcb)->pid);
+    }
+
+#ifdef DEBUG
+    fprintf(__DEBUG_OUTPUT, "Adopted PCB %d (PID: %d).\n", (*pcb)->id, (int) (*pcb)->pid);
+#endif // #ifdef DEBUG
+    return *pcb;
+}
+
 /*
  * Frees the memory associated with a PCB.
  *
@@ -335,17 +962,24 @@ PCB * terminate_PCB(PCB ** pcb) {
  * the underlying pointer can be changed by this function.
  *
  * PARAMETERS
+ *     dispatcher: The host dispatcher.
  *     pcb: Pointer to the PCB to free.
  */
-void free_PCB(PCB ** pcb) {
+void free_PCB(Dispatcher * dispatcher, PCB ** pcb) {
     if (*pcb) {
         // Free args array
         for (unsigned int i = 0; i < MAX_ARGS; i++) {
             if ((*pcb)->args[i]) {
                 free((*pcb)->args[i]);
+                (*pcb)->args[i] = NULL;
             }
         }
 
+        // Cancel the timers for this PCB
+        timer_cancel(&(*pcb)->arrival_timer);
+        timer_cancel(&(*pcb)->deadline_timer);
+        timer_cancel(&(*pcb)->suspend_timer);
+
         // Remove pointers to this PCB
         if ((*pcb)->prev != NULL) {
             (*pcb)->prev->next = (*pcb)->next;
@@ -354,11 +988,297 @@ void free_PCB(PCB ** pcb) {
             (*pcb)->next->prev = (*pcb)->prev;
         }
 
-        // Free PCB structure
-        free(*pcb);
+        // Release the processes that depend on this PCB, and free the PCB structure (unless it is a job array that is kept until the instances split from it have been removed)
+        if (dependency_remove(&dispatcher->dependencies, *pcb)) {
+            free(*pcb);
+        }
+    }
+}
+
+/*
+ * Calculates the memory limit enforced for a process, or for some of the
+ * members of a gang.
+ *
+ * PARAMETERS
+ *     mbytes: The memory allocated to the members (in megabytes).
+ *     members: The number of members.
+ *
+ * RETURN VALUE
+ * The memory limit (in bytes).
+ */
+static unsigned long long memory_limit(unsigned int mbytes, unsigned int members) {
+    return ((unsigned long long) mbytes + (unsigned long long) members * MEMORY_LIMIT_OVERHEAD) * 1024 * 1024;
+}
+
+/*
+ * Forks a member of a process, which places itself in the cgroups of the
+ * process and then executes the program of the process. The members of a gang
+ * join the process group of the first member, and are told their rank and the
+ * size of the gang in the HOSTD_GANG_RANK and HOSTD_GANG_SIZE environment
+ * variables. If memory enforcement is enabled but the process has no memory
+ * cgroup, each member is limited to its share of the memory of the process.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     pcb: The PCB of the process. Its PID must be that of the first member
+ *         when a later member is forked.
+ *     cgroup: Whether the process has its own memory cgroup.
+ *     rank: The rank of the member within its gang (0 for a single process).
+ *
+ * RETURN VALUE
+ * The system process ID of the member, or -1 if forking failed.
+ */
+static pid_t fork_member(Dispatcher * dispatcher, PCB * pcb, boolean cgroup, unsigned int rank) {
+    pid_t pid; // the system process ID of the member
+    char value[48]; // the value of an environment variable
+
+    switch (pid = fork()) {
+        case -1: // fork failed
+            return -1;
+            break;
+
+        case 0: // child
+#ifdef DEBUG
+            fprintf(__DEBUG_OUTPUT, "PCB %d forked (PID: %d).\n", pcb->id, (int) getpid());
+#endif // #ifdef DEBUG
+            // Join the process group of the gang
+            if (pcb->gang > 1) {
+                if (setpgid(0, (rank == 0) ? 0 : pcb->pid)) {
+                    fprintf(__ERROR_OUTPUT, "Unable to move PCB %d (PID: %d) into the process group of its gang.\n", pcb->id, (int) getpid());
+                    _exit(EXIT_FAILURE);
+                }
+                snprintf(value, sizeof(value), "%d", rank);
+                setenv("HOSTD_GANG_RANK", value, 1);
+                snprintf(value, sizeof(value), "%d", pcb->gang);
+                setenv("HOSTD_GANG_SIZE", value, 1);
+            }
+
+            // Tell the process its ID, its maximum claim and the control socket, over which it acquires and releases its resources
+            if (dispatcher->config.banker) {
+                snprintf(value, sizeof(value), "%d", pcb->id);
+                setenv("HOSTD_ID", value, 1);
+                snprintf(value, sizeof(value), "%d %d %d %d", pcb->num_printers, pcb->num_scanners, pcb->num_modems, pcb->num_cds);
+                setenv("HOSTD_CLAIM", value, 1);
+                if (dispatcher->control != NULL) {
+                    setenv("HOSTD_CONTROL", dispatcher->control->path, 1);
+                }
+            }
+
+            // Enforce the memory limit of the process
+            if (cgroup) {
+                if (!cgroup_attach(Memory_Controller, pcb->id, getpid())) {
+                    fprintf(__ERROR_OUTPUT, "Unable to move PCB %d (PID: %d) into its memory cgroup.\n", pcb->id, (int) getpid());
+                    _exit(EXIT_FAILURE);
+                }
+            } else if (dispatcher->config.enforcement != No_Enforcement) {
+                struct rlimit limit; // the address space limit
+                limit.rlim_cur = limit.rlim_max = (rlim_t) memory_limit(pcb->mbytes / pcb->gang, 1);
+                if (setrlimit(RLIMIT_AS, &limit)) {
+                    fprintf(__ERROR_OUTPUT, "Unable to limit the address space of PCB %d (PID: %d).\n", pcb->id, (int) getpid());
+                    _exit(EXIT_FAILURE);
+                }
+            }
+
+            // Bind the memory of the process to the memory node that it was allocated memory on, and run it on the CPUs of that node (if the host has such a NUMA node)
+            if ((dispatcher->config.memory_nodes > 1) && (pcb->memory != NULL)) {
+                if (!affinity_bind_memory((int) pcb->memory->node) || !affinity_pin_node(0, (int) pcb->memory->node)) {
+#ifdef DEBUG
+                    fprintf(__DEBUG_OUTPUT, "Unable to place PCB %d (PID: %d) on NUMA node %d.\n", pcb->id, (int) getpid(), pcb->memory->node);
+#endif // #ifdef DEBUG
+                }
+            }
+
+            // Move the process into its freezer cgroup, so that any descendants are frozen with it
+            if (pcb->freezer && !cgroup_attach(Freezer_Controller, pcb->id, getpid())) {
+                fprintf(__ERROR_OUTPUT, "Unable to move PCB %d (PID: %d) into its freezer cgroup.\n", pcb->id, (int) getpid());
+                _exit(EXIT_FAILURE);
+            }
+
+            // Move the process into its CPU accounting cgroup, so that the CPU time of any descendants is measured with it
+            if (pcb->cpuacct && !cgroup_attach(CPU_Controller, pcb->id, getpid())) {
+                fprintf(__ERROR_OUTPUT, "Unable to move PCB %d (PID: %d) into its CPU accounting cgroup.\n", pcb->id, (int) getpid());
+                _exit(EXIT_FAILURE);
+            }
+
+            // Execute the command with the appropriate arguments
+            execvp(pcb->args[0], pcb->args);
+
+            // If execution reaches this line, an error has occured as execvp should never return. The child must not return to the dispatcher.
+            fprintf(__ERROR_OUTPUT, "Execution of PCB %d (PID: %d) failed.\n", pcb->id, (int) getpid());
+            _exit(EXIT_FAILURE);
+            break;
+
+        default: // parent
+            // Also set the process group from the parent, so that the gang can be signalled as soon as the member has been forked
+            if (pcb->gang > 1) {
+                setpgid(pid, (rank == 0) ? pid : pcb->pid);
+            }
+            return pid;
+            break;
     }
 }
 
+/*
+ * Sends a signal to a process, or to every member of a gang.
+ *
+ * PARAMETERS
+ *     pcb: The PCB of the process.
+ *     signal: The signal.
+ *
+ * RETURN VALUE
+ * 0 on success, or -1 with errno set on failure (as for kill()). A process that
+ * has not been started fails with ESRCH, rather than the signal being sent to
+ * a process group (or to every process) by mistake.
+ */
+static int signal_PCB(PCB * pcb, int signal) {
+    if (pcb->pid <= 0) {
+        errno = ESRCH;
+        return -1;
+    }
+
+    return kill((pcb->gang > 1) ? -pcb->pid : pcb->pid, signal);
+}
+
+/*
+ * Sets the CPU affinity of a suspended process before it is restarted. A
+ * process that was suspended less than migration_cost ticks ago is restricted
+ * to the CPU that it last ran on, where its working set may still be cached.
+ * Otherwise its cache is considered cold, and it is only kept on the NUMA node
+ * that it last ran on (where its memory was allocated), or released if there
+ * is a single NUMA node. A process that cannot be restricted is left to run on
+ * any CPU.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     pcb: The PCB of the process.
+ */
+static void place_PCB(Dispatcher * dispatcher, PCB * pcb) {
+    boolean placed; // whether the process was restricted
+
+    if ((dispatcher->config.migration_cost == 0) || (pcb->gang > 1) || (pcb->last_cpu == AFFINITY_NO_CPU)) {
+        return;
+    }
+
+    // A process whose memory is bound to a memory node stays on the CPUs of that node
+    if ((dispatcher->config.memory_nodes > 1) && (pcb->memory != NULL)) {
+        pcb->last_node = (int) pcb->memory->node;
+    }
+
+    if (dispatcher->timers.now - pcb->suspend_time < dispatcher->config.migration_cost) {
+        placed = affinity_pin_cpu(pcb->pid, pcb->last_cpu);
+    } else {
+        placed = ((pcb->last_node != AFFINITY_NO_CPU) && (affinity_num_nodes() > 1) && affinity_pin_node(pcb->pid, pcb->last_node));
+    }
+    if (!placed) {
+        affinity_release(pcb->pid);
+    }
+#ifdef DEBUG
+    fprintf(__DEBUG_OUTPUT, "PCB %d (PID: %d) was suspended %d ticks ago on CPU %d (node %d). %s.\n", pcb->id, (int) pcb->pid, dispatcher->timers.now - pcb->suspend_time, pcb->last_cpu, pcb->last_node, placed ? "Restricted" : "Released");
+#endif // #ifdef DEBUG
+}
+
+/*
+ * Places a pre-spawned worker in the cgroups created for a process.
+ *
+ * PARAMETERS
+ *     pcb: The PCB of the process.
+ *     pid: The system process ID of the worker.
+ *     cgroup: Whether the process has its own memory cgroup.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the worker was placed in all of the
+ * cgroups.
+ */
+static boolean attach_worker(PCB * pcb, pid_t pid, boolean cgroup) {
+    return ((!cgroup || cgroup_attach(Memory_Controller, pcb->id, pid)) && (!pcb->freezer || cgroup_attach(Freezer_Controller, pcb->id, pid)) && (!pcb->cpuacct || cgroup_attach(CPU_Controller, pcb->id, pid)));
+}
+
+/*
+ * Measures the CPU time consumed by a process, from its CPU accounting cgroup
+ * if it has one, or otherwise from the user and system times (including those
+ * of any children that it has waited for) in /proc/<PID>/stat.
+ *
+ * PARAMETERS
+ *     pcb: The PCB of the process.
+ *     usec: Set to the CPU time consumed (in microseconds).
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the CPU time was measured.
+ */
+static boolean measure_cpu_usage(PCB * pcb, unsigned long long * usec) {
+    char path[64]; // path of the process statistics
+    char line[1024]; // the process statistics
+    char * fields; // the fields after the program name
+    unsigned long utime, stime; // user and system time (in clock ticks)
+    long cutime, cstime; // user and system time of waited-for children (in clock ticks)
+    long ticks_per_second = sysconf(_SC_CLK_TCK);
+    FILE * stat;
+
+    // The members of a gang share the cgroup, and consume CPU time on as many CPUs at once, so the CPU time is measured per member
+    if (pcb->cpuacct && cgroup_cpu_usage(pcb->id, usec)) {
+        *usec /= pcb->gang;
+        return true;
+    }
+
+    if ((pcb->pid <= 0) || (ticks_per_second <= 0)) {
+        return false;
+    }
+
+    snprintf(path, sizeof(path), "/proc/%d/stat", (int) pcb->pid);
+    if ((stat = fopen(path, "r")) == NULL) {
+        return false;
+    }
+    if (fgets(line, sizeof(line), stat) == NULL) {
+        fclose(stat);
+        return false;
+    }
+    fclose(stat);
+
+    // The program name may contain spaces, so skip to the closing parenthesis. utime is the 14th field.
+    if (((fields = strrchr(line, ')')) == NULL) || (sscanf(fields + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu %ld %ld", &utime, &stime, &cutime, &cstime) != 4)) {
+        return false;
+    }
+
+    *usec = ((unsigned long long) utime + stime + cutime + cstime) * TICK_USEC / (unsigned long long) ticks_per_second;
+    return true;
+}
+
+/*
+ * Checks whether a process has exited on its own, without reaping it (it is
+ * reaped when it is terminated). A process that no longer exists at all (it was
+ * reaped whilst it was being suspended, or it was adopted and is not a child
+ * of the host dispatcher) has also exited.
+ *
+ * PARAMETERS
+ *     pcb: The process.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the process has exited.
+ */
+static boolean has_exited(PCB * pcb) {
+    siginfo_t info; // the state of the process, if it has exited
+
+    info.si_pid = 0;
+    if ((waitid(P_PID, pcb->pid, &info, WEXITED | WNOHANG | WNOWAIT) == 0) && (info.si_pid == pcb->pid)) {
+        return true;
+    }
+
+    return ((signal_PCB(pcb, 0) != 0) && (errno == ESRCH));
+}
+
+/*
+ * Gets the current real time from a monotonic clock.
+ *
+ * RETURN VALUE
+ * The current time (in microseconds, from an arbitrary point).
+ */
+static unsigned long long monotonic_usec(void) {
+    struct timespec now; // the current time
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long long) now.tv_sec * 1000000ULL + (unsigned long long) now.tv_nsec / 1000ULL;
+}
+
 #ifdef DEBUG
 /*
  * Prints the queue of PCBs starting at the specified head.
@@ -397,11 +1317,18 @@ void print_PCB_queue(PCB * head) {
 void print_PCB(PCB * pcb) {
     fprintf(__DEBUG_OUTPUT, "PCB %d: {\n", pcb->id);
     fprintf(__DEBUG_OUTPUT, "\tpid:\t\t\t%d\n", pcb->pid);
+    fprintf(__DEBUG_OUTPUT, "\tgang:\t\t\t%d\n", pcb->gang);
+    fprintf(__DEBUG_OUTPUT, "\tlast_cpu:\t\t%d (node %d)\n", pcb->last_cpu, pcb->last_node);
+    if (pcb->freezer) {
+        fprintf(__DEBUG_OUTPUT, "\tfrozen:\t\t\t%s\n", cgroup_frozen(pcb->id) ? "yes" : "no");
+    }
     fprintf(__DEBUG_OUTPUT, "\n");
 
     fprintf(__DEBUG_OUTPUT, "\tarrival_time:\t\t%d\n", pcb->arrival_time);
     fprintf(__DEBUG_OUTPUT, "\tremaining_cpu_time:\t%d\n", pcb->remaining_cpu_time);
     fprintf(__DEBUG_OUTPUT, "\tpriority:\t\t%d\n", pcb->priority);
+    fprintf(__DEBUG_OUTPUT, "\tdeadline:\t\t%d\n", pcb->deadline);
+    fprintf(__DEBUG_OUTPUT, "\tcpu_usage:\t\t%llu\n", pcb->cpu_usage);
     fprintf(__DEBUG_OUTPUT, "\n");
 
     fprintf(__DEBUG_OUTPUT, "\tmbytes:\t\t\t%d\n", pcb->mbytes);
@@ -12,13 +12,12 @@
 #include "../inc/output.h"
 #include <stdlib.h>
 
-extern RAS * resources; // global variable for head of resource list
-static unsigned int _id = 1; // counter used to track assigned IDs
-
 /*
- * Creates an RAS list, containing the specified number of resources.
+ * Initialises a resource pool, with an RAS list containing the specified number
+ * of resources.
  *
  * PARAMETERS
+ *     pool: The resource pool to initialise.
  *     num_printers: The number of printer resources available.
  *     num_scanners: The number of scanner resources available.
  *     num_modems: The number of modem resources available.
@@ -27,13 +26,25 @@ static unsigned int _id = 1; // counter used to track assigned IDs
  * RETURN VALUE
  * A pointer to the head of the new RAS list.
  */
-RAS * create_resources(unsigned int num_printers, unsigned int num_scanners, unsigned int num_modems, unsigned int num_cds) {
+RAS * create_resources(ResourcePool * pool, unsigned int num_printers, unsigned int num_scanners, unsigned int num_modems, unsigned int num_cds) {
     RAS * head = NULL; // head of newly-created RAS list
     RAS * prev = NULL; // used to keep track of most recent RAS
 
+    pool->id = 1;
+
+    // Count the available resources of each type
+    pool->available[Null_Resource] = 0;
+    pool->available[Printer_Resource] = num_printers;
+    pool->available[Scanner_Resource] = num_scanners;
+    pool->available[Modem_Resource] = num_modems;
+    pool->available[CD_Resource] = num_cds;
+    for (unsigned int i = 0; i < NUM_RESOURCE_TYPES; i++) {
+        pool->total[i] = pool->available[i];
+    }
+
     // Create printer resources
     for (unsigned int i = 0; i < num_printers; i++) {
-        RAS * new_ras = create_null_RAS();
+        RAS * new_ras = create_null_RAS(pool);
         new_ras->resource = Printer_Resource;
 
         // Set next, prev and head pointers
@@ -49,7 +60,7 @@ RAS * create_resources(unsigned int num_printers, unsigned int num_scanners, uns
 
     // Create scanner resources
     for (unsigned int i = 0; i < num_scanners; i++) {
-        RAS * new_ras = create_null_RAS();
+        RAS * new_ras = create_null_RAS(pool);
         new_ras->resource = Scanner_Resource;
 
         // set next, prev and head pointers
@@ -65,7 +76,7 @@ RAS * create_resources(unsigned int num_printers, unsigned int num_scanners, uns
 
     // Create modem resources
     for (unsigned int i = 0; i < num_modems; i++) {
-        RAS * new_ras = create_null_RAS();
+        RAS * new_ras = create_null_RAS(pool);
         new_ras->resource = Modem_Resource;
 
         // Set next, prev and head pointers
@@ -81,7 +92,7 @@ RAS * create_resources(unsigned int num_printers, unsigned int num_scanners, uns
 
     // Create CD resources
     for (unsigned int i = 0; i < num_cds; i++) {
-        RAS *new_ras = create_null_RAS();
+        RAS *new_ras = create_null_RAS(pool);
         new_ras->resource = CD_Resource;
 
         // Set next, prev and head pointers
@@ -96,19 +107,37 @@ RAS * create_resources(unsigned int num_printers, unsigned int num_scanners, uns
     }
 
     // Return the head of the RAS list
+    pool->head = head;
     return head;
 }
 
+/*
+ * Frees every RAS in a resource pool.
+ *
+ * PARAMETERS
+ *     pool: The resource pool.
+ */
+void resource_destroy(ResourcePool * pool) {
+    while (pool->head != NULL) {
+        RAS * next = pool->head->next; // the next RAS in the list
+        free(pool->head);
+        pool->head = next;
+    }
+}
+
 /*
  * Creates a new RAS, with all values initialised to logical default values.
  *
+ * PARAMETERS
+ *     pool: The resource pool.
+ *
  * RETURN VALUE
  * A pointer to the new RAS.
  */
-RAS * create_null_RAS(void) {
+RAS * create_null_RAS(ResourcePool * pool) {
     RAS * new_ras = (RAS *) malloc(sizeof(RAS));
 
-    new_ras->id = (_id++);
+    new_ras->id = (pool->id++);
     new_ras->resource = Null_Resource;
 
     new_ras->allocated = NULL;
@@ -122,16 +151,20 @@ RAS * create_null_RAS(void) {
 * Checks if there is a resource of the specified type available. Note that this
 * does not allocate the resource.
 *
-* Uses the global variable 'resources' as the head of the RAS list.
-*
 * PARAMETERS
+*     pool: The resource pool.
 *     type: The type of resource requested.
 *
 * RETURN VALUE
 * A pointer to the requested RAS. NULL if no such RAS could be found.
 */
-RAS * resource_check(ResourceType type) {
-    RAS * r = resources; // for iterating through the RAS list
+RAS * resource_check(ResourcePool * pool, ResourceType type) {
+    RAS * r = pool->head; // for iterating through the RAS list
+
+    // No need to search if all resources of this type are allocated
+    if (pool->available[type] == 0) {
+        return NULL;
+    }
 
     // Look for the requested resource
     while (r != NULL) {
@@ -152,20 +185,20 @@ RAS * resource_check(ResourceType type) {
  * Allocates a RAS of the specified type and returns a pointer to the allocated
  * RAS.
  *
- * Uses the global variable 'resources' as the head of the RAS list.
- *
  * PARAMETERS
+ *     pool: The resource pool.
  *     type: The type of resource requested.
  *     pcb: The process requesting the resource.
  *
  * RETURN VALUE
  * A pointer to the requested RAS. NULL if no such RAS could be found.
  */
-RAS * resource_alloc(ResourceType type, PCB * pcb) {
+RAS * resource_alloc(ResourcePool * pool, ResourceType type, PCB * pcb) {
     RAS * r = NULL; // the requested RAS - null if none found
 
-    if ((r = resource_check(type))) {
+    if ((r = resource_check(pool, type))) {
         r->allocated = pcb;
+        pool->available[type]--;
     }
 
     // Return the resource
@@ -175,21 +208,21 @@ RAS * resource_alloc(ResourceType type, PCB * pcb) {
 /*
  * Frees all resources allocated to a process.
  *
- * Uses the global variable 'resources' as the head of the RAS list.
- *
  * PARAMETERS
+ *     pool: The resource pool.
  *     pcb: The process being freed.
  *
  * RETURN VALUE
  * NULL if the RAS list was freed successfully.
  */
-RAS * resource_free(PCB * pcb) {
-    RAS * r = resources; // to iterate through the RAS list
+RAS * resource_free(ResourcePool * pool, PCB * pcb) {
+    RAS * r = pool->head; // to iterate through the RAS list
 
     // Scan the RAS list for resources allocated to process pcb
     while (r != NULL) {
-        if (r->allocated == pcb) {
+        if ((pcb != NULL) && (r->allocated == pcb)) {
             r->allocated = NULL;
+            pool->available[r->resource]++;
         }
 
         // Go to the next resource
@@ -200,6 +233,103 @@ RAS * resource_free(PCB * pcb) {
     return NULL;
 }
 
+/*
+ * Frees a number of the resources of the specified type that are allocated to a
+ * process.
+ *
+ * PARAMETERS
+ *     pool: The resource pool.
+ *     type: The type of resource to free.
+ *     pcb: The process.
+ *     count: The number of resources to free.
+ *
+ * RETURN VALUE
+ * The number of resources freed (fewer than count if the process did not hold
+ * that many).
+ */
+unsigned int resource_release(ResourcePool * pool, ResourceType type, PCB * pcb, unsigned int count) {
+    unsigned int released = 0; // number of resources freed
+
+    for (RAS * r = pool->head; (r != NULL) && (released < count); r = r->next) {
+        if ((r->resource == type) && (r->allocated == pcb)) {
+            r->allocated = NULL;
+            pool->available[type]++;
+            released++;
+        }
+    }
+
+    return released;
+}
+
+/*
+ * Counts the number of resources of the specified type that are not allocated.
+ *
+ * PARAMETERS
+ *     pool: The resource pool.
+ *     type: The type of resource to count.
+ *
+ * RETURN VALUE
+ * The number of available resources of the specified type.
+ */
+unsigned int resource_available(ResourcePool * pool, ResourceType type) {
+    return pool->available[type];
+}
+
+/*
+ * Counts the number of resources of the specified type, whether or not they are
+ * allocated.
+ *
+ * PARAMETERS
+ *     pool: The resource pool.
+ *     type: The type of resource to count.
+ *
+ * RETURN VALUE
+ * The number of resources of the specified type.
+ */
+unsigned int resource_total(ResourcePool * pool, ResourceType type) {
+    return pool->total[type];
+}
+
+/*
+ * Counts the number of resources of the specified type that are allocated to a
+ * process.
+ *
+ * PARAMETERS
+ *     pool: The resource pool.
+ *     type: The type of resource to count.
+ *     pcb: The process.
+ *
+ * RETURN VALUE
+ * The number of resources of the specified type allocated to the process.
+ */
+unsigned int resource_held(ResourcePool * pool, ResourceType type, PCB * pcb) {
+    unsigned int held = 0; // number of resources allocated to the process
+
+    for (RAS * r = pool->head; r != NULL; r = r->next) {
+        if ((r->resource == type) && (r->allocated == pcb)) {
+            held++;
+        }
+    }
+
+    return held;
+}
+
+/*
+ * Checks, without allocating any resources, whether the specified number of
+ * resources of a type could be allocated.
+ *
+ * PARAMETERS
+ *     pool: The resource pool.
+ *     type: The type of resource requested.
+ *     count: The number of resources requested.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the resources are available.
+ */
+boolean resource_reserve(ResourcePool * pool, ResourceType type, unsigned int count) {
+    return (count <= pool->available[type]);
+}
+
 /*
  * Prints the list of RASs with their attributes.
  *
@@ -0,0 +1,497 @@
+/*
+ * admission.c
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains the functions for admitting processes from the user job
+ * queue to the feedback queues.
+ *
+ * Processes are admitted first come, first served. When the process at the
+ * head of the user job queue cannot be admitted, the capacity that it requires
+ * is reserved at the earliest time at which the resident processes are
+ * expected to release it (the 'shadow time'). Later processes may then be
+ * admitted ahead of the head process (backfilled) only if they are expected to
+ * complete before the shadow time, or if they only use capacity that the head
+ * process will not need at the shadow time.
+ *
+ * The user job queue is only rescanned when a new process arrives or when
+ * memory or resources are released, and a process is only allocated memory and
+ * resources if its requirements fit within the available capacity. The memory
+ * of a process cannot span memory nodes, so memory is released whenever the
+ * largest free MAB of any node grows.
+ *
+ * A job array stays in the user job queue until its last instance is admitted.
+ * Each other instance is only created when it is admitted, and the next
+ * instance is considered straight away.
+ */
+#include "../inc/admission.h"
+#include "../inc/dispatcher.h"
+#include "../inc/PCB.h"
+#include "../inc/MAB.h"
+#include "../inc/RAS.h"
+#include "../inc/checkpoint.h"
+#include "../inc/output.h"
+#include <stdlib.h>
+
+// The capacity that a resident process is expected to release
+typedef struct Release {
+    unsigned int remaining_cpu_time; // remaining CPU time of the resident process
+    Capacity capacity; // memory and resources held by the resident process
+    unsigned int node; // memory node holding the memory of the resident process
+} Release;
+
+static void remove_user_job(Dispatcher * dispatcher, PCB * pcb);
+static boolean capacity_released(Dispatcher * dispatcher, Capacity * capacity);
+static void record_capacity(Dispatcher * dispatcher, Capacity * capacity);
+static boolean compaction_would_admit(Dispatcher * dispatcher, PCB * pcb, Capacity * available);
+static void reserve_capacity(Dispatcher * dispatcher, PCB * pcb, Capacity * available, unsigned int * shadow_time, Capacity * extra);
+static int compare_releases(const void * a, const void * b);
+
+/*
+ * Gets the memory and resources that are currently available to user
+ * processes. If processes acquire their resources incrementally, a process is
+ * admitted with a maximum claim that only needs to be within the resources of
+ * the host, so every resource is considered to be available.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *
+ * RETURN VALUE
+ * The available capacity.
+ */
+Capacity available_capacity(Dispatcher * dispatcher) {
+    Capacity capacity; // the available capacity
+
+    capacity.mbytes = largest_free_memory(dispatcher);
+    if (dispatcher->config.banker) {
+        capacity.num_printers = resource_total(&dispatcher->resources, Printer_Resource);
+        capacity.num_scanners = resource_total(&dispatcher->resources, Scanner_Resource);
+        capacity.num_modems = resource_total(&dispatcher->resources, Modem_Resource);
+        capacity.num_cds = resource_total(&dispatcher->resources, CD_Resource);
+    } else {
+        capacity.num_printers = resource_available(&dispatcher->resources, Printer_Resource);
+        capacity.num_scanners = resource_available(&dispatcher->resources, Scanner_Resource);
+        capacity.num_modems = resource_available(&dispatcher->resources, Modem_Resource);
+        capacity.num_cds = resource_available(&dispatcher->resources, CD_Resource);
+    }
+
+    return capacity;
+}
+
+/*
+ * Gets the memory and resources that are required by a process.
+ *
+ * PARAMETERS
+ *     pcb: The process.
+ *
+ * RETURN VALUE
+ * The required capacity.
+ */
+Capacity required_capacity(PCB * pcb) {
+    Capacity capacity; // the required capacity
+
+    capacity.mbytes = pcb->mbytes;
+    capacity.num_printers = pcb->num_printers;
+    capacity.num_scanners = pcb->num_scanners;
+    capacity.num_modems = pcb->num_modems;
+    capacity.num_cds = pcb->num_cds;
+
+    return capacity;
+}
+
+/*
+ * Checks whether a capacity requirement fits within the available capacity.
+ *
+ * PARAMETERS
+ *     required: The required capacity.
+ *     available: The available capacity.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether every component of the required capacity
+ * is no greater than the corresponding component of the available capacity.
+ */
+boolean capacity_fits(Capacity * required, Capacity * available) {
+    return (required->mbytes <= available->mbytes) &&
+        (required->num_printers <= available->num_printers) &&
+        (required->num_scanners <= available->num_scanners) &&
+        (required->num_modems <= available->num_modems) &&
+        (required->num_cds <= available->num_cds);
+}
+
+/*
+ * Checks whether any component of a capacity has increased.
+ *
+ * PARAMETERS
+ *     now: The current capacity.
+ *     before: The previous capacity.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether any memory or resources were released.
+ */
+boolean capacity_increased(Capacity * now, Capacity * before) {
+    return (now->mbytes > before->mbytes) ||
+        (now->num_printers > before->num_printers) ||
+        (now->num_scanners > before->num_scanners) ||
+        (now->num_modems > before->num_modems) ||
+        (now->num_cds > before->num_cds);
+}
+
+/*
+ * Notifies the admission scheduler that a process has been added to the user
+ * job queue, so that the queue is rescanned on the next admission pass.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ */
+void admission_notify_arrival(Dispatcher * dispatcher) {
+    dispatcher->admission_wake = true;
+}
+
+/*
+ * Admits processes from the user job queue to the relevant feedback queue. The
+ * memory and resources required by a process are allocated to the process
+ * before it is admitted to the feedback queue.
+ *
+ * This function uses the clock, user job queue and the feedback queues of the
+ * host dispatcher.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ */
+void admit_user_processes(Dispatcher * dispatcher) {
+    Capacity capacity = available_capacity(dispatcher); // capacity currently available
+    boolean reserved = false; // whether capacity has been reserved for a blocked process
+    unsigned int shadow_time = 0; // time at which the reserved capacity is expected to be available
+    Capacity extra = {0, 0, 0, 0, 0}; // capacity not needed by the blocked process at the shadow time
+    PCB * user_job = dispatcher->user_job_queue; // for iterating through the user job queue
+    boolean compacted = false; // whether memory has been compacted during this pass
+    unsigned int largest_before = 0; // size of the largest free MAB before memory was compacted
+
+    // Nothing can be admitted unless a process has arrived or capacity has been released since the last pass
+    if (!dispatcher->admission_wake && !capacity_released(dispatcher, &capacity)) {
+#ifdef DEBUG
+        fprintf(__DEBUG_OUTPUT, "No memory or resources have been released. Skipping the user job queue.\n");
+#endif // #ifdef DEBUG
+        record_capacity(dispatcher, &capacity);
+        return;
+    }
+    dispatcher->admission_wake = false;
+
+    while (user_job != NULL) {
+        PCB * next = user_job->next; // the next user job
+        Capacity required = required_capacity(user_job); // capacity required by this user job
+        boolean eligible; // whether this user job can be admitted without delaying the reserved process
+        boolean uses_extra = false; // whether this user job is backfilled into the extra capacity
+        PCB * instance = user_job; // the process to admit (the next instance of a job array)
+
+        // Check that the system can provide the memory and resources that the process requires
+        if (!check_memory_and_resources(dispatcher, user_job)) {
+            fprintf(__ERROR_OUTPUT, "PCB %d requested more memory or resources than the system can provide. This process will not be executed.\n", user_job->id);
+
+            // Delete PCB
+            remove_user_job(dispatcher, user_job);
+            checkpoint_remove(dispatcher->checkpoint, user_job->id);
+            free_PCB(dispatcher, &user_job);
+
+            user_job = next;
+            continue;
+        }
+
+        eligible = capacity_fits(&required, &capacity);
+        if (eligible && reserved) {
+            // A backfilled process must complete before the shadow time, or only use capacity that the reserved process will not need
+            if (dispatcher->clock + user_job->remaining_cpu_time > shadow_time) {
+                uses_extra = true;
+                eligible = capacity_fits(&required, &extra);
+            }
+        }
+
+        if (eligible && (user_job->instances > 1) && ((instance = split_PCB(dispatcher, user_job)) == NULL)) {
+            // Leave the job array in the user job queue, and consider it again on the next pass
+            admission_notify_arrival(dispatcher);
+            user_job = next;
+            continue;
+        }
+
+        if (eligible && allocate_memory_and_resources(dispatcher, instance)) {
+#ifdef DEBUG
+            fprintf(__DEBUG_OUTPUT, "Allocated memory and resources for process PCB %d.\n", instance->id);
+            fprintf(__DEBUG_OUTPUT, "Unloading PCB %d to feedback queue RRQ%d.\n", instance->id, instance->priority);
+
+#endif // #ifdef DEBUG
+            // Remove the process from the user job queue (unless it is a job array with instances remaining, which is considered again) and add the process to the appropriate feedback queue
+            if (instance == user_job) {
+                remove_user_job(dispatcher, user_job);
+            } else {
+                checkpoint_PCB(dispatcher->checkpoint, user_job, Checkpoint_User_Job);
+                next = user_job;
+            }
+            enqueue_PCB(&dispatcher->feedback_queue[instance->priority - 1], &instance);
+            checkpoint_PCB(dispatcher->checkpoint, instance, Checkpoint_Feedback);
+
+            // Record processes that could only be admitted because memory was compacted
+            if (compacted && (required.mbytes > largest_before)) {
+                dispatcher->compaction_admissions++;
+                dispatcher->compaction_cpu_time += instance->remaining_cpu_time;
+            }
+
+            capacity = available_capacity(dispatcher);
+            if (uses_extra) {
+                extra.mbytes -= required.mbytes;
+                extra.num_printers -= required.num_printers;
+                extra.num_scanners -= required.num_scanners;
+                extra.num_modems -= required.num_modems;
+                extra.num_cds -= required.num_cds;
+            }
+        } else {
+#ifdef DEBUG
+            fprintf(__DEBUG_OUTPUT, "Unable to allocate memory and resources for PCB %d at this stage.\n", instance->id);
+
+#endif // #ifdef DEBUG
+            if (instance != user_job) {
+                rejoin_PCB(dispatcher, user_job, &instance);
+            }
+
+            // Compact memory (at most once per pass) and try again if fragmentation is all that prevents the first blocked process from being admitted
+            if (MEMORY_COMPACTION && !compacted && !reserved && compaction_would_admit(dispatcher, user_job, &capacity)) {
+                compacted = true;
+                largest_before = capacity.mbytes;
+                compact_memory(dispatcher);
+                capacity = available_capacity(dispatcher);
+                continue;
+            }
+
+            // Reserve capacity for the first process that cannot be admitted
+            if (EASY_BACKFILLING && !reserved) {
+                reserve_capacity(dispatcher, user_job, &capacity, &shadow_time, &extra);
+                reserved = true;
+#ifdef DEBUG
+                fprintf(__DEBUG_OUTPUT, "Reserving memory and resources for PCB %d at time %d.\n", user_job->id, shadow_time);
+#endif // #ifdef DEBUG
+            }
+        }
+
+        // Go to next user job
+        user_job = next;
+    }
+
+    record_capacity(dispatcher, &capacity);
+}
+
+/*
+ * Removes a process from the user job queue.
+ *
+ * This function uses the user job queue of the host dispatcher.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     pcb: The process to remove.
+ */
+static void remove_user_job(Dispatcher * dispatcher, PCB * pcb) {
+    if (pcb == dispatcher->user_job_queue) {
+        dequeue_PCB(&dispatcher->user_job_queue);
+    } else {
+        dequeue_PCB(&pcb);
+    }
+}
+
+/*
+ * Checks whether any memory or resources have been released since the end of
+ * the previous admission pass - that is, whether any component of the available
+ * capacity, or the largest free MAB of any memory node, has increased.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     capacity: The capacity currently available.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether any memory or resources were released.
+ */
+static boolean capacity_released(Dispatcher * dispatcher, Capacity * capacity) {
+    if (capacity_increased(capacity, &dispatcher->admission_capacity)) {
+        return true;
+    }
+
+    for (unsigned int i = 0; i < dispatcher->config.memory_nodes; i++) {
+        if (mem_largest_free(&dispatcher->memory[i]) > dispatcher->admission_node_free[i]) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Records the capacity available at the end of an admission pass, along with
+ * the largest free MAB of each memory node.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     capacity: The capacity currently available.
+ */
+static void record_capacity(Dispatcher * dispatcher, Capacity * capacity) {
+    dispatcher->admission_capacity = *capacity;
+    for (unsigned int i = 0; i < dispatcher->config.memory_nodes; i++) {
+        dispatcher->admission_node_free[i] = mem_largest_free(&dispatcher->memory[i]);
+    }
+}
+
+/*
+ * Checks whether compacting memory could allow a process to be admitted - that
+ * is, the resources required by the process are available and a memory node has
+ * enough free memory in total, but the free memory of that node is too
+ * fragmented.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     pcb: The process that cannot be admitted.
+ *     available: The capacity currently available.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether memory should be compacted.
+ */
+static boolean compaction_would_admit(Dispatcher * dispatcher, PCB * pcb, Capacity * available) {
+    Capacity required = required_capacity(pcb); // capacity required by the process
+
+    // Compaction cannot help if the process is waiting for resources
+    required.mbytes = 0;
+    if (!capacity_fits(&required, available)) {
+        return false;
+    }
+
+    for (unsigned int i = 0; i < dispatcher->config.memory_nodes; i++) {
+        unsigned int reserve = dispatcher->config.reserved_memory; // memory that must remain free on the node
+
+        // The memory reserved for real time processes may remain free on another node instead
+        for (unsigned int j = 0; j < dispatcher->config.memory_nodes; j++) {
+            if ((j != i) && (mem_total_free(&dispatcher->memory[j]) >= reserve)) {
+                reserve = 0;
+            }
+        }
+
+        // There must be enough free memory in total on the node for the process and the memory reserved for real time processes
+        if ((pcb->mbytes + reserve <= mem_total_free(&dispatcher->memory[i])) && (mem_fragmentation(&dispatcher->memory[i]) >= COMPACTION_THRESHOLD)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Computes the shadow time for a process that cannot be admitted - the time at
+ * which the resident processes are expected to have released enough capacity
+ * for the process to be admitted - and the capacity that will be left over at
+ * that time.
+ *
+ * The CPU is assumed to be shared by the resident processes shortest remaining
+ * time first, after any real time processes. Released memory is assumed to be
+ * coalesced with the largest free MAB of the memory node that it was allocated
+ * on - a MAB cannot span memory nodes, so memory released on one node does not
+ * help a process that needs more than is free on another.
+ *
+ * This function uses the clock, active process, real time queue and feedback
+ * queues of the host dispatcher.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     pcb: The process to reserve capacity for.
+ *     available: The capacity currently available.
+ *     shadow_time: Set to the expected time at which the process can be
+ *         admitted.
+ *     extra: Set to the capacity that will not be needed by the process at the
+ *         shadow time.
+ */
+static void reserve_capacity(Dispatcher * dispatcher, PCB * pcb, Capacity * available, unsigned int * shadow_time, Capacity * extra) {
+    Capacity required = required_capacity(pcb); // capacity required by the process
+    Capacity capacity = *available; // capacity expected to be available
+    Release * releases = NULL; // capacity released by the resident processes
+    unsigned int num_releases = 0; // number of resident processes
+    unsigned int time = dispatcher->clock; // expected time
+    unsigned int node_free[MAX_MEMORY_NODES]; // size of the largest free MAB expected on each memory node
+
+    for (unsigned int i = 0; i < dispatcher->config.memory_nodes; i++) {
+        node_free[i] = mem_largest_free(&dispatcher->memory[i]);
+    }
+
+    // Real time processes are always run first
+    if ((dispatcher->active != NULL) && (dispatcher->active->priority == REAL_TIME_PROCESS_PRIORITY)) {
+        time += dispatcher->active->remaining_cpu_time;
+    }
+    for (unsigned int i = 0; i < dispatcher->real_time_queue.size; i++) {
+        time += dispatcher->real_time_queue.heap[i]->remaining_cpu_time;
+    }
+
+    // Count the resident user processes
+    if ((dispatcher->active != NULL) && (dispatcher->active->priority != REAL_TIME_PROCESS_PRIORITY)) {
+        num_releases++;
+    }
+    for (unsigned int i = 0; i < dispatcher->config.feedback_levels; i++) {
+        for (PCB * p = dispatcher->feedback_queue[i]; p != NULL; p = p->next) {
+            num_releases++;
+        }
+    }
+
+    // Collect the capacity released by the resident user processes
+    if ((num_releases > 0) && ((releases = (Release *) malloc(num_releases * sizeof(Release))) != NULL)) {
+        num_releases = 0;
+        if ((dispatcher->active != NULL) && (dispatcher->active->priority != REAL_TIME_PROCESS_PRIORITY)) {
+            releases[num_releases].remaining_cpu_time = dispatcher->active->remaining_cpu_time;
+            releases[num_releases].node = (dispatcher->active->memory != NULL) ? dispatcher->active->memory->node : 0;
+            releases[num_releases++].capacity = required_capacity(dispatcher->active);
+        }
+        for (unsigned int i = 0; i < dispatcher->config.feedback_levels; i++) {
+            for (PCB * p = dispatcher->feedback_queue[i]; p != NULL; p = p->next) {
+                releases[num_releases].remaining_cpu_time = p->remaining_cpu_time;
+                releases[num_releases].node = (p->memory != NULL) ? p->memory->node : 0;
+                releases[num_releases++].capacity = required_capacity(p);
+            }
+        }
+
+        qsort(releases, num_releases, sizeof(Release), compare_releases);
+    } else {
+        num_releases = 0;
+    }
+
+    // Find the time at which the required capacity becomes available
+    for (unsigned int i = 0; (i < num_releases) && !capacity_fits(&required, &capacity); i++) {
+        time += releases[i].remaining_cpu_time;
+        node_free[releases[i].node] += releases[i].capacity.mbytes;
+        if (node_free[releases[i].node] > capacity.mbytes) {
+            capacity.mbytes = node_free[releases[i].node];
+        }
+        capacity.num_printers += releases[i].capacity.num_printers;
+        capacity.num_scanners += releases[i].capacity.num_scanners;
+        capacity.num_modems += releases[i].capacity.num_modems;
+        capacity.num_cds += releases[i].capacity.num_cds;
+    }
+    free(releases);
+
+    // The capacity that the process will not need at the shadow time
+    *shadow_time = time;
+    extra->mbytes = (capacity.mbytes > required.mbytes) ? (capacity.mbytes - required.mbytes) : 0;
+    extra->num_printers = (capacity.num_printers > required.num_printers) ? (capacity.num_printers - required.num_printers) : 0;
+    extra->num_scanners = (capacity.num_scanners > required.num_scanners) ? (capacity.num_scanners - required.num_scanners) : 0;
+    extra->num_modems = (capacity.num_modems > required.num_modems) ? (capacity.num_modems - required.num_modems) : 0;
+    extra->num_cds = (capacity.num_cds > required.num_cds) ? (capacity.num_cds - required.num_cds) : 0;
+}
+
+/*
+ * Compares two releases by the remaining CPU time of the resident process, for
+ * use with qsort().
+ *
+ * PARAMETERS
+ *     a: The first release.
+ *     b: The second release.
+ *
+ * RETURN VALUE
+ * A negative, zero or positive value if a is released before, at the same time
+ * as, or after b.
+ */
+static int compare_releases(const void * a, const void * b) {
+    unsigned int time_a = ((const Release *) a)->remaining_cpu_time;
+    unsigned int time_b = ((const Release *) b)->remaining_cpu_time;
+
+    return (time_a > time_b) - (time_a < time_b);
+}
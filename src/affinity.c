@@ -0,0 +1,280 @@
+/*
+ * affinity.c
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains the functions relating to the CPU affinity of processes.
+ * The CPU that a process last ran on is read from /proc, and the NUMA topology
+ * from sysfs. A process is only ever restricted to CPUs that the host
+ * dispatcher itself is allowed to run on, and is released by restoring the
+ * affinity of the host dispatcher. The memory policy is set with the
+ * set_mempolicy() system call directly, so that libnuma is not required.
+ */
+#define _GNU_SOURCE // for sched_setaffinity() and the CPU_* macros
+
+#include "../inc/affinity.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+static boolean allowed_cpus(cpu_set_t * cpus);
+static boolean read_cpu_list(const char * path, cpu_set_t * cpus);
+
+/*
+ * Finds the CPU that a process last ran on (the 39th field of
+ * /proc/<PID>/stat). For a process that is running, this is the CPU that it is
+ * running on.
+ *
+ * PARAMETERS
+ *     pid: The system process ID of the process.
+ *     cpu: Set to the CPU.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the CPU was found.
+ */
+boolean affinity_last_cpu(pid_t pid, int * cpu) {
+    char path[64]; // path of the process statistics
+    char line[1024]; // the process statistics
+    char * field; // the current field
+    char * state; // state of strtok_r()
+    unsigned int index = 3; // index of the current field (the fields after the program name start at the 3rd)
+    FILE * stat;
+
+    snprintf(path, sizeof(path), "/proc/%d/stat", (int) pid);
+    if ((stat = fopen(path, "r")) == NULL) {
+        return false;
+    }
+    if (fgets(line, sizeof(line), stat) == NULL) {
+        fclose(stat);
+        return false;
+    }
+    fclose(stat);
+
+    // The program name may contain spaces, so skip to the closing parenthesis
+    if ((field = strrchr(line, ')')) == NULL) {
+        return false;
+    }
+    for (field = strtok_r(field + 1, " \n", &state); field != NULL; field = strtok_r(NULL, " \n", &state), index++) {
+        if (index == 39) {
+            *cpu = atoi(field);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Finds the NUMA node of a CPU, from the node link in its sysfs directory.
+ *
+ * PARAMETERS
+ *     cpu: The CPU.
+ *
+ * RETURN VALUE
+ * The NUMA node, or AFFINITY_NO_CPU if it is not known.
+ */
+int affinity_node_of(int cpu) {
+    char path[64]; // path of the sysfs directory of the CPU
+    int node = AFFINITY_NO_CPU; // the NUMA node
+    struct dirent * entry; // an entry of the directory
+    DIR * directory;
+
+    snprintf(path, sizeof(path), "%s/cpu%d", AFFINITY_CPU_PATH, cpu);
+    if ((directory = opendir(path)) == NULL) {
+        return AFFINITY_NO_CPU;
+    }
+    while ((node == AFFINITY_NO_CPU) && ((entry = readdir(directory)) != NULL)) {
+        if (sscanf(entry->d_name, "node%d", &node) != 1) {
+            node = AFFINITY_NO_CPU;
+        }
+    }
+    closedir(directory);
+
+    return node;
+}
+
+/*
+ * Counts the NUMA nodes that have CPUs.
+ *
+ * RETURN VALUE
+ * The number of NUMA nodes (1 if the topology is not known).
+ */
+unsigned int affinity_num_nodes(void) {
+    char path[128]; // path of the CPU list of a NUMA node
+    unsigned int nodes = 0; // number of NUMA nodes
+    struct dirent * entry; // an entry of the directory
+    int node; // the NUMA node of the entry
+    cpu_set_t cpus; // the CPUs of the NUMA node
+    DIR * directory;
+
+    if ((directory = opendir(AFFINITY_NODE_PATH)) == NULL) {
+        return 1;
+    }
+    while ((entry = readdir(directory)) != NULL) {
+        if (sscanf(entry->d_name, "node%d", &node) == 1) {
+            snprintf(path, sizeof(path), "%s/node%d/cpulist", AFFINITY_NODE_PATH, node);
+            if (read_cpu_list(path, &cpus) && (CPU_COUNT(&cpus) > 0)) {
+                nodes++;
+            }
+        }
+    }
+    closedir(directory);
+
+    return (nodes > 0) ? nodes : 1;
+}
+
+/*
+ * Restricts a process to a single CPU.
+ *
+ * PARAMETERS
+ *     pid: The system process ID of the process.
+ *     cpu: The CPU.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the process was restricted to the CPU.
+ */
+boolean affinity_pin_cpu(pid_t pid, int cpu) {
+    cpu_set_t allowed; // the CPUs that the host dispatcher may run on
+    cpu_set_t cpus; // the CPUs that the process may run on
+
+    if ((cpu < 0) || (cpu >= CPU_SETSIZE) || !allowed_cpus(&allowed) || !CPU_ISSET(cpu, &allowed)) {
+        return false;
+    }
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+
+    return (sched_setaffinity(pid, sizeof(cpus), &cpus) == 0);
+}
+
+/*
+ * Restricts a process to the CPUs of a NUMA node.
+ *
+ * PARAMETERS
+ *     pid: The system process ID of the process.
+ *     node: The NUMA node.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the process was restricted to the NUMA
+ * node.
+ */
+boolean affinity_pin_node(pid_t pid, int node) {
+    char path[128]; // path of the CPU list of the NUMA node
+    cpu_set_t allowed; // the CPUs that the host dispatcher may run on
+    cpu_set_t cpus; // the CPUs that the process may run on
+
+    snprintf(path, sizeof(path), "%s/node%d/cpulist", AFFINITY_NODE_PATH, node);
+    if ((node < 0) || !allowed_cpus(&allowed) || !read_cpu_list(path, &cpus)) {
+        return false;
+    }
+    CPU_AND(&cpus, &cpus, &allowed);
+    if (CPU_COUNT(&cpus) == 0) {
+        return false;
+    }
+
+    return (sched_setaffinity(pid, sizeof(cpus), &cpus) == 0);
+}
+
+/*
+ * Releases a process from any restriction, by giving it the affinity of the
+ * host dispatcher.
+ *
+ * PARAMETERS
+ *     pid: The system process ID of the process.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the process was released.
+ */
+boolean affinity_release(pid_t pid) {
+    cpu_set_t allowed; // the CPUs that the host dispatcher may run on
+
+    return (allowed_cpus(&allowed) && (sched_setaffinity(pid, sizeof(allowed), &allowed) == 0));
+}
+
+/*
+ * Binds the memory of the calling process to a NUMA node, so that its pages are
+ * only allocated from that node. The binding is inherited across fork() and
+ * exec().
+ *
+ * PARAMETERS
+ *     node: The NUMA node.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the memory was bound to the NUMA node.
+ */
+boolean affinity_bind_memory(int node) {
+    unsigned long mask[AFFINITY_MAX_NODES / (8 * sizeof(unsigned long))]; // the nodes that memory may be allocated from
+
+    if ((node < 0) || (node >= AFFINITY_MAX_NODES)) {
+        return false;
+    }
+    memset(mask, 0, sizeof(mask));
+    mask[node / (8 * sizeof(unsigned long))] = 1UL << (node % (8 * sizeof(unsigned long)));
+
+    return (syscall(SYS_set_mempolicy, MPOL_BIND, mask, (unsigned long) AFFINITY_MAX_NODES + 1) == 0);
+}
+
+/*
+ * Gets the CPUs that the host dispatcher may run on.
+ *
+ * PARAMETERS
+ *     cpus: Set to the CPUs.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the CPUs were found.
+ */
+static boolean allowed_cpus(cpu_set_t * cpus) {
+    CPU_ZERO(cpus);
+    return (sched_getaffinity(0, sizeof(cpu_set_t), cpus) == 0);
+}
+
+/*
+ * Reads a CPU list in the format used by sysfs (e.g. "0-3,8,10-11").
+ *
+ * PARAMETERS
+ *     path: The path of the file containing the list.
+ *     cpus: Set to the CPUs in the list.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the list was read.
+ */
+static boolean read_cpu_list(const char * path, cpu_set_t * cpus) {
+    char list[1024]; // the CPU list
+    char * range; // the current range of the list
+    char * state; // state of strtok_r()
+    int first, last; // the first and last CPU of the range
+    FILE * file;
+
+    CPU_ZERO(cpus);
+    if ((file = fopen(path, "r")) == NULL) {
+        return false;
+    }
+    if (fgets(list, sizeof(list), file) == NULL) {
+        list[0] = '\0';
+    }
+    fclose(file);
+
+    for (range = strtok_r(list, ",\n", &state); range != NULL; range = strtok_r(NULL, ",\n", &state)) {
+        switch (sscanf(range, "%d-%d", &first, &last)) {
+            case 1:
+                last = first;
+                break;
+            case 2:
+                break;
+            default:
+                return false;
+        }
+        for (int cpu = first; (cpu <= last) && (cpu < CPU_SETSIZE); cpu++) {
+            if (cpu >= 0) {
+                CPU_SET(cpu, cpus);
+            }
+        }
+    }
+
+    return true;
+}
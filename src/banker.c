@@ -0,0 +1,576 @@
+/*
+ * banker.c
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains the functions for incremental resource acquisition, with
+ * the banker's algorithm avoiding deadlock.
+ *
+ * The admitted processes are held in the order of a safe sequence - an order
+ * in which every process could acquire the rest of its maximum claim and
+ * finish, if each of the processes before it had finished and released its
+ * resources. A new process is appended to the sequence, where every resource
+ * has been released, so it only needs its claim to be within the resources of
+ * the host.
+ *
+ * When a process at position p is granted r resources of a type, the resources
+ * available to every position up to p fall by r, whilst the positions after p
+ * are unaffected (p holds the r resources, which it returns when it finishes).
+ * The sequence therefore remains safe if the slack of every position before p
+ * is at least r, which is a prefix minimum of the slack tree, and granting the
+ * request is a prefix addition of -r. Releasing resources is a prefix addition
+ * of +r, and always leaves the sequence safe. Checking and applying a request
+ * therefore takes O(m log n) for n processes and m types of resource.
+ *
+ * The sequence is sufficient for safety but is not the only safe sequence, so a
+ * request that fails the prefix check is given the full O(n^2 m) safety check,
+ * which finds a new safe sequence if there is one. A request that the full
+ * check refused is not checked again until the state has changed.
+ */
+#include "../inc/banker.h"
+#include "../inc/PCB.h"
+#include "../inc/RAS.h"
+#include "../inc/output.h"
+#include <stdlib.h>
+#include <string.h>
+
+static void read_claim(PCB * pcb, unsigned int claim[]);
+static boolean resize(Banker * banker, unsigned int leaves);
+static void reorder(Banker * banker, const unsigned int * order, BankerEntry * entries);
+static void tree_build(Banker * banker, const long available[]);
+static void tree_add(Banker * banker, ResourceType type, unsigned int node, unsigned int lo, unsigned int width, unsigned int to, long delta);
+static long tree_min(Banker * banker, ResourceType type, unsigned int node, unsigned int lo, unsigned int width, unsigned int to);
+static void tree_set(Banker * banker, ResourceType type, unsigned int position, long value);
+
+/*
+ * Initialises the state of the banker's algorithm, with no admitted processes.
+ *
+ * PARAMETERS
+ *     banker: The state to initialise.
+ */
+void banker_init(Banker * banker) {
+    memset(banker, 0, sizeof(Banker));
+    banker->version = 1;
+}
+
+/*
+ * Frees the state of the banker's algorithm. The processes are not freed.
+ *
+ * PARAMETERS
+ *     banker: The state.
+ */
+void banker_destroy(Banker * banker) {
+    free(banker->entries);
+    for (ResourceType type = Printer_Resource; type < NUM_RESOURCE_TYPES; type++) {
+        free(banker->slack[type]);
+        free(banker->pending[type]);
+    }
+    banker_init(banker);
+}
+
+/*
+ * Admits a process, appending it to the safe sequence with its maximum claim
+ * (the resources that the process requires) and no resources allocated.
+ *
+ * PARAMETERS
+ *     banker: The state.
+ *     pool: The resource pool that the resources are allocated from.
+ *     pcb: The process.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the process was admitted. A process is
+ * not admitted if its claim exceeds the resources of the host.
+ */
+boolean banker_admit(Banker * banker, ResourcePool * pool, PCB * pcb) {
+    unsigned int claim[NUM_RESOURCE_TYPES]; // the maximum claim of the process
+    BankerEntry * entry; // the entry of the process
+
+    if (pcb->banker_position != BANKER_NOT_ADMITTED) {
+        return true;
+    }
+
+    read_claim(pcb, claim);
+    for (ResourceType type = Printer_Resource; type < NUM_RESOURCE_TYPES; type++) {
+        if (claim[type] > resource_total(pool, type)) {
+            return false;
+        }
+    }
+
+    // Drop the positions of removed processes when the sequence is full, and grow it if it is still more than half full
+    if (banker->size == banker->leaves) {
+        unsigned int leaves = (banker->leaves > 0) ? banker->leaves : BANKER_LEAVES; // the new number of leaves
+        long available[NUM_RESOURCE_TYPES]; // the free resources of each type
+
+        while (2 * (banker->live + 1) > leaves) {
+            leaves *= 2;
+        }
+        if ((leaves != banker->leaves) && !resize(banker, leaves)) {
+            return false;
+        }
+        reorder(banker, NULL, NULL);
+        for (ResourceType type = Null_Resource; type < NUM_RESOURCE_TYPES; type++) {
+            available[type] = (long) resource_available(pool, type);
+        }
+        tree_build(banker, available);
+    }
+
+    entry = &banker->entries[banker->size];
+    memset(entry, 0, sizeof(BankerEntry));
+    entry->pcb = pcb;
+    memcpy(entry->claim, claim, sizeof(claim));
+    pcb->banker_position = (int) banker->size;
+
+    // Every resource has been released by the time the end of the sequence is reached
+    for (ResourceType type = Printer_Resource; type < NUM_RESOURCE_TYPES; type++) {
+        tree_set(banker, type, banker->size, (long) resource_total(pool, type) - (long) claim[type]);
+    }
+    banker->size++;
+    banker->live++;
+
+    return true;
+}
+
+/*
+ * Requests resources for an admitted process. The request is granted if there
+ * are enough free resources, it is within the maximum claim of the process and
+ * the resulting state is safe. The resources themselves must then be allocated
+ * from the resource pool by the caller.
+ *
+ * PARAMETERS
+ *     banker: The state.
+ *     pool: The resource pool that the resources are allocated from.
+ *     pcb: The process.
+ *     request: The number of resources of each type requested (indexed by
+ *         ResourceType).
+ *
+ * RETURN VALUE
+ * The outcome of the request.
+ */
+BankerResult banker_request(Banker * banker, ResourcePool * pool, PCB * pcb, const unsigned int request[]) {
+    BankerEntry * entry; // the entry of the process
+    unsigned int position; // the position of the process in the safe sequence
+    boolean safe = true; // whether the safe sequence remains safe
+
+    if (pcb->banker_position == BANKER_NOT_ADMITTED) {
+        return Banker_Not_Admitted;
+    }
+    position = (unsigned int) pcb->banker_position;
+    entry = &banker->entries[position];
+
+    for (ResourceType type = Printer_Resource; type < NUM_RESOURCE_TYPES; type++) {
+        if (entry->held[type] + request[type] > entry->claim[type]) {
+            return Banker_Exceeds_Claim;
+        }
+    }
+    for (ResourceType type = Printer_Resource; type < NUM_RESOURCE_TYPES; type++) {
+        if (request[type] > resource_available(pool, type)) {
+            banker->unavailable++;
+            return Banker_Unavailable;
+        }
+    }
+
+    // Check the prefix of the safe sequence
+    for (ResourceType type = Printer_Resource; (type < NUM_RESOURCE_TYPES) && safe; type++) {
+        safe = ((request[type] == 0) || (tree_min(banker, type, 1, 0, banker->leaves, position) >= (long) request[type]));
+    }
+
+    if (safe) {
+        for (ResourceType type = Printer_Resource; type < NUM_RESOURCE_TYPES; type++) {
+            if (request[type] > 0) {
+                entry->held[type] += request[type];
+                tree_add(banker, type, 1, 0, banker->leaves, position, -(long) request[type]);
+            }
+        }
+    } else {
+        unsigned int * order; // the positions of the processes in the new safe sequence
+        BankerEntry * entries; // the new safe sequence
+        long available[NUM_RESOURCE_TYPES]; // the free resources of each type once the request is granted
+
+        // A request that the full check refused stays refused until the state changes
+        if ((entry->unsafe_version == banker->version) && (memcmp(entry->unsafe_request, request, sizeof(entry->unsafe_request)) == 0)) {
+            banker->unsafe++;
+            return Banker_Unsafe;
+        }
+
+        order = (unsigned int *) malloc(banker->live * sizeof(unsigned int));
+        entries = (BankerEntry *) malloc(banker->leaves * sizeof(BankerEntry));
+        if ((order == NULL) || (entries == NULL)) {
+            fprintf(__ERROR_OUTPUT, "Unable to allocate memory for the safety check of PCB %d.\n", pcb->id);
+            free(order);
+            free(entries);
+            banker->unsafe++;
+            return Banker_Unsafe;
+        }
+
+        banker->full_checks++;
+        if (!banker_is_safe(banker, pool, pcb, request, order)) {
+            entry->unsafe_version = banker->version;
+            memcpy(entry->unsafe_request, request, sizeof(entry->unsafe_request));
+            free(order);
+            free(entries);
+            banker->unsafe++;
+            return Banker_Unsafe;
+        }
+
+        // Grant the request, and adopt the safe sequence that the full check found
+        available[Null_Resource] = 0;
+        for (ResourceType type = Printer_Resource; type < NUM_RESOURCE_TYPES; type++) {
+            entry->held[type] += request[type];
+            available[type] = (long) resource_available(pool, type) - (long) request[type];
+        }
+        reorder(banker, order, entries);
+        tree_build(banker, available);
+        free(order);
+    }
+
+    banker->version++;
+    banker->granted++;
+    return Banker_Granted;
+}
+
+/*
+ * Releases resources held by an admitted process. The resources themselves
+ * must also be freed in the resource pool by the caller.
+ *
+ * PARAMETERS
+ *     banker: The state.
+ *     pcb: The process.
+ *     release: The number of resources of each type released (indexed by
+ *         ResourceType).
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the resources were released. Nothing is
+ * released if the process does not hold all of them.
+ */
+boolean banker_release(Banker * banker, PCB * pcb, const unsigned int release[]) {
+    BankerEntry * entry; // the entry of the process
+    unsigned int position; // the position of the process in the safe sequence
+
+    if (pcb->banker_position == BANKER_NOT_ADMITTED) {
+        return false;
+    }
+    position = (unsigned int) pcb->banker_position;
+    entry = &banker->entries[position];
+
+    for (ResourceType type = Printer_Resource; type < NUM_RESOURCE_TYPES; type++) {
+        if (release[type] > entry->held[type]) {
+            return false;
+        }
+    }
+
+    for (ResourceType type = Printer_Resource; type < NUM_RESOURCE_TYPES; type++) {
+        if (release[type] > 0) {
+            entry->held[type] -= release[type];
+            tree_add(banker, type, 1, 0, banker->leaves, position, (long) release[type]);
+        }
+    }
+
+    banker->version++;
+    return true;
+}
+
+/*
+ * Removes a process from the safe sequence, releasing every resource that it
+ * holds. The resources themselves must also be freed in the resource pool by
+ * the caller. Nothing is done if the process was not admitted.
+ *
+ * PARAMETERS
+ *     banker: The state.
+ *     pcb: The process.
+ */
+void banker_remove(Banker * banker, PCB * pcb) {
+    BankerEntry * entry; // the entry of the process
+    unsigned int position; // the position of the process in the safe sequence
+
+    if (pcb->banker_position == BANKER_NOT_ADMITTED) {
+        return;
+    }
+    position = (unsigned int) pcb->banker_position;
+    entry = &banker->entries[position];
+
+    for (ResourceType type = Printer_Resource; type < NUM_RESOURCE_TYPES; type++) {
+        if (entry->held[type] > 0) {
+            tree_add(banker, type, 1, 0, banker->leaves, position, (long) entry->held[type]);
+        }
+        tree_set(banker, type, position, BANKER_INFINITY);
+    }
+
+    entry->pcb = NULL;
+    pcb->banker_position = BANKER_NOT_ADMITTED;
+    banker->live--;
+    banker->version++;
+}
+
+/*
+ * Checks whether the state would be safe if a request was granted, with the
+ * full banker's algorithm - repeatedly finding a process whose remaining claim
+ * can be met, and releasing its resources. This takes O(n^2 m) for n processes
+ * and m types of resource.
+ *
+ * PARAMETERS
+ *     banker: The state.
+ *     pool: The resource pool that the resources are allocated from.
+ *     pcb: The process making the request. It must have been admitted.
+ *     request: The number of resources of each type requested (indexed by
+ *         ResourceType). There must be enough free resources.
+ *     order: Set to the positions of the processes in a safe sequence, if the
+ *         state would be safe (may be NULL). It must hold a position for every
+ *         admitted process.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the state would be safe.
+ */
+boolean banker_is_safe(Banker * banker, ResourcePool * pool, PCB * pcb, const unsigned int request[], unsigned int * order) {
+    long work[NUM_RESOURCE_TYPES]; // the resources that would be free once the processes found so far had finished
+    boolean * finished = (boolean *) calloc(banker->size + 1, sizeof(boolean)); // whether the process at each position has been found
+    unsigned int count = 0; // number of processes found
+    boolean progress = true; // whether a process was found in the last pass
+
+    if (finished == NULL) {
+        return false;
+    }
+
+    for (ResourceType type = Null_Resource; type < NUM_RESOURCE_TYPES; type++) {
+        work[type] = (long) resource_available(pool, type) - (long) request[type];
+    }
+
+    while (progress && (count < banker->live)) {
+        progress = false;
+        for (unsigned int i = 0; i < banker->size; i++) {
+            BankerEntry * entry = &banker->entries[i]; // the entry at this position
+            boolean fits = true; // whether the remaining claim of the process can be met
+
+            if ((entry->pcb == NULL) || finished[i]) {
+                continue;
+            }
+            for (ResourceType type = Printer_Resource; (type < NUM_RESOURCE_TYPES) && fits; type++) {
+                long held = (long) entry->held[type] + ((entry->pcb == pcb) ? (long) request[type] : 0); // resources held once the request is granted
+
+                fits = ((long) entry->claim[type] - held <= work[type]);
+            }
+            if (fits) {
+                for (ResourceType type = Printer_Resource; type < NUM_RESOURCE_TYPES; type++) {
+                    work[type] += (long) entry->held[type] + ((entry->pcb == pcb) ? (long) request[type] : 0);
+                }
+                finished[i] = true;
+                if (order != NULL) {
+                    order[count] = i;
+                }
+                count++;
+                progress = true;
+            }
+        }
+    }
+
+    free(finished);
+    return (count == banker->live);
+}
+
+/*
+ * Reads the maximum claim of a process - the resources that it requires.
+ *
+ * PARAMETERS
+ *     pcb: The process.
+ *     claim: Set to the number of resources of each type (indexed by
+ *         ResourceType).
+ */
+static void read_claim(PCB * pcb, unsigned int claim[]) {
+    claim[Null_Resource] = 0;
+    claim[Printer_Resource] = pcb->num_printers;
+    claim[Scanner_Resource] = pcb->num_scanners;
+    claim[Modem_Resource] = pcb->num_modems;
+    claim[CD_Resource] = pcb->num_cds;
+}
+
+/*
+ * Resizes the safe sequence and the slack trees. The trees must be rebuilt.
+ *
+ * PARAMETERS
+ *     banker: The state.
+ *     leaves: The new number of leaves (a power of two, at least the number of
+ *         positions used).
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the memory could be allocated.
+ */
+static boolean resize(Banker * banker, unsigned int leaves) {
+    BankerEntry * entries = (BankerEntry *) realloc(banker->entries, leaves * sizeof(BankerEntry)); // the resized sequence
+
+    if (entries == NULL) {
+        fprintf(__ERROR_OUTPUT, "Unable to allocate memory for the maximum claims of %d processes.\n", leaves);
+        return false;
+    }
+    banker->entries = entries;
+
+    for (ResourceType type = Printer_Resource; type < NUM_RESOURCE_TYPES; type++) {
+        long * slack = (long *) realloc(banker->slack[type], 2 * leaves * sizeof(long)); // the resized slack tree
+        long * pending; // the resized additions
+
+        if (slack == NULL) {
+            fprintf(__ERROR_OUTPUT, "Unable to allocate memory for the maximum claims of %d processes.\n", leaves);
+            return false;
+        }
+        banker->slack[type] = slack;
+        if ((pending = (long *) realloc(banker->pending[type], 2 * leaves * sizeof(long))) == NULL) {
+            fprintf(__ERROR_OUTPUT, "Unable to allocate memory for the maximum claims of %d processes.\n", leaves);
+            return false;
+        }
+        banker->pending[type] = pending;
+    }
+
+    banker->leaves = leaves;
+    return true;
+}
+
+/*
+ * Reorders the safe sequence, dropping the positions of removed processes. The
+ * slack trees must be rebuilt.
+ *
+ * PARAMETERS
+ *     banker: The state.
+ *     order: The positions of the processes in their new order (NULL to keep
+ *         their current order). It must hold the position of every process
+ *         that has not been removed.
+ *     entries: The array that the reordered sequence is moved to, which holds
+ *         a position for every leaf (only if order is not NULL). It replaces
+ *         the current array.
+ */
+static void reorder(Banker * banker, const unsigned int * order, BankerEntry * entries) {
+    unsigned int count = 0; // number of processes moved
+
+    if (order != NULL) {
+        for (unsigned int i = 0; i < banker->live; i++) {
+            entries[i] = banker->entries[order[i]];
+            entries[i].pcb->banker_position = (int) i;
+        }
+        free(banker->entries);
+        banker->entries = entries;
+        banker->size = banker->live;
+        return;
+    }
+
+    for (unsigned int i = 0; i < banker->size; i++) {
+        if (banker->entries[i].pcb != NULL) {
+            banker->entries[count] = banker->entries[i];
+            banker->entries[count].pcb->banker_position = (int) count;
+            count++;
+        }
+    }
+    banker->size = count;
+}
+
+/*
+ * Rebuilds the slack trees from the safe sequence.
+ *
+ * PARAMETERS
+ *     banker: The state.
+ *     available: The number of free resources of each type (indexed by
+ *         ResourceType).
+ */
+static void tree_build(Banker * banker, const long available[]) {
+    for (ResourceType type = Printer_Resource; type < NUM_RESOURCE_TYPES; type++) {
+        long * slack = banker->slack[type]; // the slack tree
+        long work = available[type]; // the resources that would be free when each position is reached
+
+        for (unsigned int i = 0; i < banker->leaves; i++) {
+            BankerEntry * entry = (i < banker->size) ? &banker->entries[i] : NULL; // the entry at this position
+
+            if ((entry != NULL) && (entry->pcb != NULL)) {
+                slack[banker->leaves + i] = work - ((long) entry->claim[type] - (long) entry->held[type]);
+                work += (long) entry->held[type];
+            } else {
+                slack[banker->leaves + i] = BANKER_INFINITY;
+            }
+        }
+        for (unsigned int node = banker->leaves - 1; node >= 1; node--) {
+            slack[node] = (slack[2 * node] < slack[2 * node + 1]) ? slack[2 * node] : slack[2 * node + 1];
+        }
+        memset(banker->pending[type], 0, 2 * banker->leaves * sizeof(long));
+    }
+}
+
+/*
+ * Adds to the slack of every position before a given position.
+ *
+ * PARAMETERS
+ *     banker: The state.
+ *     type: The type of resource.
+ *     node: The node of the subtree.
+ *     lo: The lowest position covered by the subtree.
+ *     width: The number of positions covered by the subtree.
+ *     to: The first position that is not added to.
+ *     delta: The slack to add.
+ */
+static void tree_add(Banker * banker, ResourceType type, unsigned int node, unsigned int lo, unsigned int width, unsigned int to, long delta) {
+    long * slack = banker->slack[type]; // the slack tree
+
+    if (to <= lo) {
+        return;
+    }
+    if (lo + width <= to) {
+        slack[node] += delta;
+        banker->pending[type][node] += delta;
+        return;
+    }
+
+    tree_add(banker, type, 2 * node, lo, width / 2, to, delta);
+    tree_add(banker, type, 2 * node + 1, lo + width / 2, width / 2, to, delta);
+    slack[node] = ((slack[2 * node] < slack[2 * node + 1]) ? slack[2 * node] : slack[2 * node + 1]) + banker->pending[type][node];
+}
+
+/*
+ * Finds the minimum slack of the positions before a given position.
+ *
+ * PARAMETERS
+ *     banker: The state.
+ *     type: The type of resource.
+ *     node: The node of the subtree.
+ *     lo: The lowest position covered by the subtree.
+ *     width: The number of positions covered by the subtree.
+ *     to: The first position that is not considered.
+ *
+ * RETURN VALUE
+ * The minimum slack, excluding the additions at the ancestors of the node
+ * (BANKER_INFINITY if there are no such positions).
+ */
+static long tree_min(Banker * banker, ResourceType type, unsigned int node, unsigned int lo, unsigned int width, unsigned int to) {
+    long left, right; // the minimum slack of each child
+
+    if (to <= lo) {
+        return BANKER_INFINITY;
+    }
+    if (lo + width <= to) {
+        return banker->slack[type][node];
+    }
+
+    left = tree_min(banker, type, 2 * node, lo, width / 2, to);
+    right = tree_min(banker, type, 2 * node + 1, lo + width / 2, width / 2, to);
+    return ((left < right) ? left : right) + banker->pending[type][node];
+}
+
+/*
+ * Sets the slack of a position.
+ *
+ * PARAMETERS
+ *     banker: The state.
+ *     type: The type of resource.
+ *     position: The position.
+ *     value: The slack.
+ */
+static void tree_set(Banker * banker, ResourceType type, unsigned int position, long value) {
+    long * slack = banker->slack[type]; // the slack tree
+    long * pending = banker->pending[type]; // the additions
+    long above = 0; // the slack added at the ancestors of the position
+    unsigned int leaf = banker->leaves + position; // the leaf of the position
+
+    for (unsigned int node = leaf / 2; node >= 1; node /= 2) {
+        above += pending[node];
+    }
+    slack[leaf] = value - above;
+    pending[leaf] = 0;
+
+    for (unsigned int node = leaf / 2; node >= 1; node /= 2) {
+        slack[node] = ((slack[2 * node] < slack[2 * node + 1]) ? slack[2 * node] : slack[2 * node + 1]) + pending[node];
+    }
+}
@@ -0,0 +1,576 @@
+/*
+ * cgroup.c
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains the functions for placing processes in control groups
+ * (cgroups). The cgroup for a process is named after its PCB ID, and lives
+ * beneath a cgroup named after the PID of the host dispatcher:
+ *
+ *     <hierarchy>/<dispatcher cgroup>/hostd.<PID>/job<ID>
+ */
+#define _POSIX_C_SOURCE 200809L // for getpid(), mkdir(), rmdir() and open()
+
+#include "../inc/cgroup.h"
+#include "../inc/output.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+static char _base[NUM_CONTROLLERS][CGROUP_PATH_LENGTH]; // cgroup created for the host dispatcher in each hierarchy (empty if the controller is unavailable)
+static boolean _unified[NUM_CONTROLLERS]; // whether each controller is in the unified (v2) hierarchy
+
+static const char * controller_name(CgroupController controller);
+static const char * core_file(CgroupController controller);
+static boolean find_hierarchy(CgroupController controller, char * mount, boolean * unified);
+static boolean find_membership(CgroupController controller, boolean unified, char * group);
+static boolean job_path(CgroupController controller, unsigned int id, const char * file, char * path);
+static boolean has_token(const char * list, const char * token, const char * separators);
+static boolean write_file(const char * path, const char * value);
+static boolean read_file(const char * path, char * value, size_t size);
+
+/*
+ * Initialises a cgroup controller, by creating a cgroup for the host dispatcher
+ * beneath the cgroup that the host dispatcher currently belongs to. In the
+ * unified hierarchy, the controller is also enabled for the children of the new
+ * cgroup.
+ *
+ * PARAMETERS
+ *     controller: The controller to initialise.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the controller is available.
+ */
+boolean cgroup_init(CgroupController controller) {
+    char mount[CGROUP_PATH_LENGTH]; // mount point of the hierarchy
+    char group[CGROUP_PATH_LENGTH]; // cgroup of the host dispatcher, relative to the mount point
+    char path[CGROUP_PATH_LENGTH]; // path of a cgroup file
+    char value[32]; // value to write to a cgroup file
+    boolean unified; // whether the controller is in the unified hierarchy
+
+    if (cgroup_available(controller)) {
+        return true;
+    }
+
+    if (!find_hierarchy(controller, mount, &unified) || !find_membership(controller, unified, group)) {
+        return false;
+    }
+
+    // The root cgroup is "/"
+    if (strcmp(group, "/") == 0) {
+        group[0] = '\0';
+    }
+
+    if (snprintf(_base[controller], CGROUP_PATH_LENGTH, "%s%s/hostd.%d", mount, group, (int) getpid()) >= CGROUP_PATH_LENGTH) {
+        _base[controller][0] = '\0';
+        return false;
+    }
+
+    if ((mkdir(_base[controller], 0755) != 0) && (errno != EEXIST)) {
+        fprintf(__ERROR_OUTPUT, "Unable to create cgroup '%s'.\n", _base[controller]);
+        _base[controller][0] = '\0';
+        return false;
+    }
+
+    // In the unified hierarchy, a core interface must be supported by the kernel
+    if (unified && (core_file(controller) != NULL)) {
+        if ((snprintf(path, CGROUP_PATH_LENGTH, "%s/%s", _base[controller], core_file(controller)) >= CGROUP_PATH_LENGTH) || (access(path, F_OK) != 0)) {
+            rmdir(_base[controller]);
+            _base[controller][0] = '\0';
+            return false;
+        }
+    }
+
+    // In the unified hierarchy, a controller must be enabled by each ancestor of the cgroups that use it
+    if (unified && (core_file(controller) == NULL)) {
+        snprintf(value, sizeof(value), "+%s", controller_name(controller));
+        if (snprintf(path, CGROUP_PATH_LENGTH, "%s%s/cgroup.subtree_control", mount, group) < CGROUP_PATH_LENGTH) {
+            write_file(path, value);
+        }
+
+        if ((snprintf(path, CGROUP_PATH_LENGTH, "%s/cgroup.subtree_control", _base[controller]) >= CGROUP_PATH_LENGTH) || !write_file(path, value)) {
+            fprintf(__ERROR_OUTPUT, "Unable to enable the %s controller in cgroup '%s'.\n", controller_name(controller), _base[controller]);
+            rmdir(_base[controller]);
+            _base[controller][0] = '\0';
+            return false;
+        }
+    }
+
+    _unified[controller] = unified;
+#ifdef DEBUG
+    fprintf(__DEBUG_OUTPUT, "Using cgroup '%s' for the %s controller.\n", _base[controller], controller_name(controller));
+#endif // #ifdef DEBUG
+    return true;
+}
+
+/*
+ * Checks whether a cgroup controller has been initialised.
+ *
+ * PARAMETERS
+ *     controller: The controller to check.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the controller is available.
+ */
+boolean cgroup_available(CgroupController controller) {
+    return (_base[controller][0] != '\0');
+}
+
+/*
+ * Removes the cgroups created for the host dispatcher. The cgroups of all
+ * processes must already have been removed.
+ */
+void cgroup_cleanup(void) {
+    for (CgroupController c = 0; c < NUM_CONTROLLERS; c++) {
+        if (cgroup_available(c)) {
+            rmdir(_base[c]);
+            _base[c][0] = '\0';
+        }
+    }
+}
+
+/*
+ * Creates the cgroup for a process.
+ *
+ * PARAMETERS
+ *     controller: The controller to create the cgroup in.
+ *     id: The ID of the PCB for the process.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the cgroup was created (or already
+ * existed).
+ */
+boolean cgroup_create(CgroupController controller, unsigned int id) {
+    char path[CGROUP_PATH_LENGTH]; // path of the cgroup
+
+    if (!job_path(controller, id, NULL, path)) {
+        return false;
+    }
+
+    if ((mkdir(path, 0755) != 0) && (errno != EEXIST)) {
+        fprintf(__ERROR_OUTPUT, "Unable to create cgroup '%s'.\n", path);
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Moves a process into its cgroup. This function is safe to call between
+ * fork() and exec().
+ *
+ * PARAMETERS
+ *     controller: The controller containing the cgroup.
+ *     id: The ID of the PCB for the process.
+ *     pid: The system process ID of the process.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the process was moved into the cgroup.
+ */
+boolean cgroup_attach(CgroupController controller, unsigned int id, pid_t pid) {
+    char path[CGROUP_PATH_LENGTH]; // path of the cgroup's process list
+    char value[32]; // the PID to add to the process list
+
+    if (!job_path(controller, id, "cgroup.procs", path)) {
+        return false;
+    }
+
+    snprintf(value, sizeof(value), "%d", (int) pid);
+    return write_file(path, value);
+}
+
+/*
+ * Removes the cgroup for a process. The process must have terminated.
+ *
+ * PARAMETERS
+ *     controller: The controller containing the cgroup.
+ *     id: The ID of the PCB for the process.
+ */
+void cgroup_remove(CgroupController controller, unsigned int id) {
+    char path[CGROUP_PATH_LENGTH]; // path of the cgroup
+
+    if (job_path(controller, id, NULL, path) && (rmdir(path) != 0) && (errno != ENOENT)) {
+        fprintf(__ERROR_OUTPUT, "Unable to remove cgroup '%s'.\n", path);
+    }
+}
+
+/*
+ * Limits the memory that can be used by the processes in a cgroup. Swap is
+ * limited as well (where the kernel supports it), so that a process that
+ * exceeds its limit is reclaimed or killed rather than pushed into swap.
+ *
+ * PARAMETERS
+ *     id: The ID of the PCB for the process.
+ *     bytes: The maximum memory usage (in bytes).
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the limit was set.
+ */
+boolean cgroup_set_memory_limit(unsigned int id, unsigned long long bytes) {
+    char path[CGROUP_PATH_LENGTH]; // path of the cgroup's memory limit
+    char value[32]; // the memory limit
+
+    snprintf(value, sizeof(value), "%llu", bytes);
+
+    if (_unified[Memory_Controller]) {
+        if (!job_path(Memory_Controller, id, "memory.max", path) || !write_file(path, value)) {
+            return false;
+        }
+        if (job_path(Memory_Controller, id, "memory.swap.max", path)) {
+            write_file(path, "0");
+        }
+    } else {
+        if (!job_path(Memory_Controller, id, "memory.limit_in_bytes", path) || !write_file(path, value)) {
+            return false;
+        }
+        // memory.memsw.limit_in_bytes limits memory and swap combined, and must not be less than memory.limit_in_bytes
+        if (job_path(Memory_Controller, id, "memory.memsw.limit_in_bytes", path)) {
+            write_file(path, value);
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Freezes or thaws all of the processes in a cgroup. The change takes effect
+ * asynchronously - cgroup_frozen() can be used to confirm that the processes
+ * have been frozen.
+ *
+ * PARAMETERS
+ *     id: The ID of the PCB for the process.
+ *     frozen: Whether to freeze (true) or thaw (false) the processes.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the request was accepted.
+ */
+boolean cgroup_freeze(unsigned int id, boolean frozen) {
+    char path[CGROUP_PATH_LENGTH]; // path of the cgroup's freezer state
+
+    if (_unified[Freezer_Controller]) {
+        return (job_path(Freezer_Controller, id, "cgroup.freeze", path) && write_file(path, frozen ? "1" : "0"));
+    } else {
+        return (job_path(Freezer_Controller, id, "freezer.state", path) && write_file(path, frozen ? "FROZEN" : "THAWED"));
+    }
+}
+
+/*
+ * Checks whether all of the processes in a cgroup have been frozen.
+ *
+ * PARAMETERS
+ *     id: The ID of the PCB for the process.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the processes are frozen.
+ */
+boolean cgroup_frozen(unsigned int id) {
+    char path[CGROUP_PATH_LENGTH]; // path of the cgroup's freezer state
+    char value[256]; // the freezer state
+
+    if (_unified[Freezer_Controller]) {
+        // cgroup.events contains a line "frozen 1" once the cgroup is frozen
+        return (job_path(Freezer_Controller, id, "cgroup.events", path) && read_file(path, value, sizeof(value)) && (strstr(value, "frozen 1") != NULL));
+    } else {
+        return (job_path(Freezer_Controller, id, "freezer.state", path) && read_file(path, value, sizeof(value)) && (strncmp(value, "FROZEN", 6) == 0));
+    }
+}
+
+/*
+ * Reads the CPU time consumed by all of the processes in a cgroup.
+ *
+ * PARAMETERS
+ *     id: The ID of the PCB for the process.
+ *     usec: Set to the CPU time consumed (in microseconds).
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the CPU time was read.
+ */
+boolean cgroup_cpu_usage(unsigned int id, unsigned long long * usec) {
+    char path[CGROUP_PATH_LENGTH]; // path of the cgroup's CPU statistics
+    char value[512]; // the CPU statistics
+    char * field; // the CPU time field
+
+    if (_unified[CPU_Controller]) {
+        // cpu.stat contains a line "usage_usec <microseconds>"
+        if (!job_path(CPU_Controller, id, "cpu.stat", path) || !read_file(path, value, sizeof(value)) || ((field = strstr(value, "usage_usec ")) == NULL)) {
+            return false;
+        }
+        *usec = strtoull(field + strlen("usage_usec "), NULL, 10);
+    } else {
+        // cpuacct.usage contains the CPU time in nanoseconds
+        if (!job_path(CPU_Controller, id, "cpuacct.usage", path) || !read_file(path, value, sizeof(value))) {
+            return false;
+        }
+        *usec = strtoull(value, NULL, 10) / 1000;
+    }
+
+    return true;
+}
+
+/*
+ * Gets the file that provides a controller in every cgroup of the unified
+ * hierarchy, for controllers that are part of the core of the unified
+ * hierarchy (and so do not need to be enabled).
+ *
+ * PARAMETERS
+ *     controller: The controller.
+ *
+ * RETURN VALUE
+ * The name of the file, or NULL if the controller is not a core interface.
+ */
+static const char * core_file(CgroupController controller) {
+    switch (controller) {
+        case Freezer_Controller:
+            return "cgroup.freeze";
+        case CPU_Controller:
+            return "cpu.stat";
+        default:
+            return NULL;
+    }
+}
+
+/*
+ * Gets the name of a cgroup controller, as used in the mount options of the
+ * legacy hierarchies and in cgroup.controllers of the unified hierarchy.
+ *
+ * PARAMETERS
+ *     controller: The controller.
+ *
+ * RETURN VALUE
+ * The name of the controller.
+ */
+static const char * controller_name(CgroupController controller) {
+    switch (controller) {
+        case Memory_Controller:
+            return "memory";
+        case Freezer_Controller:
+            return "freezer";
+        case CPU_Controller:
+            return "cpuacct";
+        default:
+            return "";
+    }
+}
+
+/*
+ * Finds the mount point of the hierarchy containing a controller.
+ *
+ * PARAMETERS
+ *     controller: The controller.
+ *     mount: Set to the mount point of the hierarchy. Must be at least
+ *            CGROUP_PATH_LENGTH characters long.
+ *     unified: Set to whether the hierarchy is the unified hierarchy.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether a hierarchy containing the controller was
+ * found.
+ */
+static boolean find_hierarchy(CgroupController controller, char * mount, boolean * unified) {
+    char line[3 * CGROUP_PATH_LENGTH]; // a line of the mount table
+    char dir[CGROUP_PATH_LENGTH]; // mount point
+    char type[32]; // file system type
+    char options[CGROUP_PATH_LENGTH]; // mount options
+    char controllers[CGROUP_PATH_LENGTH]; // controllers available in the unified hierarchy
+    boolean found = false; // whether a legacy hierarchy containing the controller was found
+    FILE * mounts = fopen(CGROUP_MOUNTS, "r");
+
+    if (mounts == NULL) {
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), mounts) != NULL) {
+        // Note that the field widths must be less than CGROUP_PATH_LENGTH
+        if (sscanf(line, "%*s %511s %31s %511s", dir, type, options) != 3) {
+            continue;
+        }
+
+        if (strcmp(type, "cgroup2") == 0) {
+            FILE * f; // the list of controllers available in the unified hierarchy
+
+            if ((snprintf(controllers, sizeof(controllers), "%s/cgroup.controllers", dir) >= (int) sizeof(controllers)) || ((f = fopen(controllers, "r")) == NULL)) {
+                continue;
+            }
+            if ((core_file(controller) != NULL) || ((fgets(controllers, sizeof(controllers), f) != NULL) && has_token(controllers, controller_name(controller), " \n"))) {
+                // The unified hierarchy is preferred
+                strcpy(mount, dir);
+                *unified = true;
+                fclose(f);
+                fclose(mounts);
+                return true;
+            }
+            fclose(f);
+        } else if (!found && (strcmp(type, "cgroup") == 0) && has_token(options, controller_name(controller), ",")) {
+            strcpy(mount, dir);
+            *unified = false;
+            found = true;
+        }
+    }
+
+    fclose(mounts);
+    return found;
+}
+
+/*
+ * Finds the cgroup that the host dispatcher belongs to in a hierarchy.
+ *
+ * PARAMETERS
+ *     controller: The controller.
+ *     unified: Whether the controller is in the unified hierarchy.
+ *     group: Set to the path of the cgroup, relative to the mount point of the
+ *            hierarchy. Must be at least CGROUP_PATH_LENGTH characters long.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the cgroup was found.
+ */
+static boolean find_membership(CgroupController controller, boolean unified, char * group) {
+    char line[2 * CGROUP_PATH_LENGTH]; // a line of the membership list - "<hierarchy ID>:<controllers>:<path>"
+    FILE * membership = fopen(CGROUP_MEMBERSHIP, "r");
+
+    if (membership == NULL) {
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), membership) != NULL) {
+        char * controllers = strchr(line, ':'); // the list of controllers in the hierarchy
+        char * path = (controllers != NULL) ? strchr(controllers + 1, ':') : NULL; // the path of the cgroup
+
+        if (path == NULL) {
+            continue;
+        }
+        *(path++) = '\0';
+        controllers++;
+
+        // The unified hierarchy has an empty list of controllers
+        if ((unified && (controllers[0] == '\0')) || (!unified && has_token(controllers, controller_name(controller), ","))) {
+            path[strcspn(path, "\n")] = '\0';
+            if (strlen(path) >= CGROUP_PATH_LENGTH) {
+                break;
+            }
+            strcpy(group, path);
+            fclose(membership);
+            return true;
+        }
+    }
+
+    fclose(membership);
+    return false;
+}
+
+/*
+ * Gets the path of the cgroup for a process, or of a file within it.
+ *
+ * PARAMETERS
+ *     controller: The controller containing the cgroup.
+ *     id: The ID of the PCB for the process.
+ *     file: The file within the cgroup (NULL for the cgroup itself).
+ *     path: Set to the path. Must be at least CGROUP_PATH_LENGTH characters
+ *           long.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the controller is available and the path
+ * fits.
+ */
+static boolean job_path(CgroupController controller, unsigned int id, const char * file, char * path) {
+    int length; // length of the path
+
+    if (!cgroup_available(controller)) {
+        return false;
+    }
+
+    if (file != NULL) {
+        length = snprintf(path, CGROUP_PATH_LENGTH, "%s/job%u/%s", _base[controller], id, file);
+    } else {
+        length = snprintf(path, CGROUP_PATH_LENGTH, "%s/job%u", _base[controller], id);
+    }
+
+    return (length < CGROUP_PATH_LENGTH);
+}
+
+/*
+ * Checks whether a list contains a token.
+ *
+ * PARAMETERS
+ *     list: The list.
+ *     token: The token to look for.
+ *     separators: The characters that separate the tokens in the list.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the token is in the list.
+ */
+static boolean has_token(const char * list, const char * token, const char * separators) {
+    size_t length = strlen(token); // length of the token
+
+    while (*list != '\0') {
+        size_t span = strcspn(list, separators); // length of the current token
+
+        if ((span == length) && (strncmp(list, token, length) == 0)) {
+            return true;
+        }
+
+        list += span;
+        if (*list != '\0') {
+            list++;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Writes a value to a cgroup file. This function only uses system calls, so it
+ * is safe to call between fork() and exec().
+ *
+ * PARAMETERS
+ *     path: The path of the file.
+ *     value: The value to write.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the value was written.
+ */
+static boolean write_file(const char * path, const char * value) {
+    int fd = open(path, O_WRONLY); // the file
+    ssize_t length = (ssize_t) strlen(value); // the length of the value
+    boolean success;
+
+    if (fd < 0) {
+        return false;
+    }
+
+    success = (write(fd, value, length) == length);
+    close(fd);
+    return success;
+}
+
+/*
+ * Reads a value from a cgroup file.
+ *
+ * PARAMETERS
+ *     path: The path of the file.
+ *     value: Set to the contents of the file (null terminated).
+ *     size: The size of the value buffer.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the value was read.
+ */
+static boolean read_file(const char * path, char * value, size_t size) {
+    int fd = open(path, O_RDONLY); // the file
+    ssize_t length; // the length of the value
+
+    if (fd < 0) {
+        return false;
+    }
+
+    length = read(fd, value, size - 1);
+    close(fd);
+
+    if (length < 0) {
+        return false;
+    }
+    value[length] = '\0';
+    return true;
+}
@@ -0,0 +1,1080 @@
+/*
+ * checkpoint.c
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains the functions for checkpointing the state of the host
+ * dispatcher.
+ *
+ * The checkpoint consists of a snapshot and a journal. The snapshot contains a
+ * record of every process, in queue order: the active process, the real time
+ * queue, the feedback queues, the user job queue and the input queue. The
+ * journal contains a frame for each tick since the snapshot was taken, with a
+ * record of each process that moved or changed during the tick, in the order
+ * that the changes were made. Every queue is only ever added to at its tail
+ * (the real time queue is ordered by deadline), so replaying the moves in
+ * order reproduces the order of each queue.
+ *
+ * The layout of memory and the allocation of resources are not saved
+ * separately - they are rebuilt from the MABs and resources held by each
+ * process. Memory compaction relocates the MABs of many processes at once, so
+ * every process that holds memory is journalled after memory is compacted.
+ *
+ * A frame is written to the journal at the end of each tick, with a single
+ * write. A new snapshot is taken (and the journal restarted) once the journal
+ * has grown larger than the snapshot, so the time to recover is proportional to
+ * the size of the state, and the cost of the snapshots is no more than the cost
+ * of the journal. Each snapshot is written to a temporary file and renamed, so
+ * there is always a complete snapshot. A frame that was only partly written
+ * when the host dispatcher died is detected by its checksum, and ignored.
+ *
+ * The statistics saved are: deadlines met, deadlines missed, real time
+ * processes rejected, memory compactions, memory relocated, processes admitted
+ * by compaction, the CPU time of those processes and processes that spilled to
+ * another memory node.
+ */
+#define _POSIX_C_SOURCE 200809L // for fsync() and fdatasync()
+
+#include "../inc/checkpoint.h"
+#include "../inc/dispatcher.h"
+#include "../inc/input.h"
+#include "../inc/admission.h"
+#include "../inc/dependency.h"
+#include "../inc/output.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+#define ACTIVE_LIST (Checkpoint_Feedback + MAX_FEEDBACK_QUEUES) // the list of the active process whilst recovering (after the feedback queues)
+#define NUM_LISTS   (ACTIVE_LIST + 1) // number of lists whilst recovering
+
+// A process that has been recovered
+typedef struct Recovered {
+    uint32_t id; // the ID of the process (0 if the entry is empty)
+    unsigned int list; // the list containing the process
+    PCB * pcb; // the process (NULL if it has been removed)
+    const CheckpointPCB * record; // the latest record of the process
+} Recovered;
+
+static CheckpointPCB * add_record(Checkpoint * checkpoint);
+static void save_PCB(Checkpoint * checkpoint, PCB * pcb, CheckpointLocation location, CheckpointPCB * record);
+static void fill_header(Checkpoint * checkpoint, CheckpointHeader * header, uint32_t count, uint32_t checksum);
+static uint32_t checksum(const CheckpointPCB * records, size_t count, uint32_t hash);
+static boolean write_snapshot(Checkpoint * checkpoint);
+static boolean write_frame(Checkpoint * checkpoint);
+static boolean open_journal(Checkpoint * checkpoint);
+static boolean write_all(int fd, const void * data, size_t size);
+static boolean read_all(const char * path, char ** data, size_t * size);
+static boolean recover_records(Checkpoint * checkpoint, Recovered * table, size_t size, PCB ** heads, PCB ** tails, const CheckpointPCB * records, uint32_t count);
+static Recovered * find_recovered(Recovered * table, size_t size, uint32_t id);
+static PCB * restore_PCB(Checkpoint * checkpoint, const CheckpointPCB * record);
+static void restore_fields(PCB * pcb, const CheckpointPCB * record);
+static unsigned int list_of(const CheckpointPCB * record);
+static void list_append(PCB ** heads, PCB ** tails, unsigned int list, PCB * pcb);
+static void list_remove(PCB ** heads, PCB ** tails, unsigned int list, PCB * pcb);
+static unsigned long long now_usec(void);
+
+/*
+ * Enables checkpointing of a host dispatcher. The state is saved to a snapshot
+ * at the path, and a journal at the path with CHECKPOINT_JOURNAL appended.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher whose state is checkpointed.
+ *     path: The path of the snapshot.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether checkpointing was enabled.
+ */
+boolean checkpoint_init(Dispatcher * dispatcher, const char * path) {
+    size_t length = strlen(path); // length of the path
+    Checkpoint * checkpoint; // the checkpoint
+
+    if ((checkpoint = (Checkpoint *) calloc(1, sizeof(Checkpoint))) == NULL) {
+        fprintf(__ERROR_OUTPUT, "Unable to allocate the checkpoint.\n");
+        return false;
+    }
+    checkpoint->dispatcher = dispatcher;
+    checkpoint->journal = -1;
+    dispatcher->checkpoint = checkpoint;
+
+    checkpoint->path = (char *) malloc(length + 1);
+    checkpoint->journal_path = (char *) malloc(length + strlen(CHECKPOINT_JOURNAL) + 1);
+    checkpoint->temporary_path = (char *) malloc(length + strlen(CHECKPOINT_TEMPORARY) + 1);
+    if ((checkpoint->path == NULL) || (checkpoint->journal_path == NULL) || (checkpoint->temporary_path == NULL)) {
+        fprintf(__ERROR_OUTPUT, "Unable to allocate the checkpoint paths.\n");
+        checkpoint_destroy(dispatcher);
+        return false;
+    }
+
+    strcpy(checkpoint->path, path);
+    sprintf(checkpoint->journal_path, "%s%s", path, CHECKPOINT_JOURNAL);
+    sprintf(checkpoint->temporary_path, "%s%s", path, CHECKPOINT_TEMPORARY);
+    checkpoint->snapshot_due = true;
+
+    return true;
+}
+
+/*
+ * Recovers the state of a previous host dispatcher from its checkpoint, if
+ * there is one. The processes are restored to their queues, with their memory
+ * and resources, and processes that had been started are adopted (see
+ * adopt_PCB()). Processes that are no longer running are removed.
+ *
+ * This function uses the clock, statistics, input queue, user job queue, real
+ * time queue, feedback queues and active process of the host dispatcher, and
+ * the system memory and resources, which must already be initialised (and
+ * empty).
+ *
+ * PARAMETERS
+ *     checkpoint: The checkpoint (NULL if checkpointing is disabled).
+ *     recovered: Set to whether the state was recovered (false if there was no
+ *         checkpoint).
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the checkpoint could be read (true if
+ * there was no checkpoint).
+ */
+boolean checkpoint_recover(Checkpoint * checkpoint, boolean * recovered) {
+    char * snapshot = NULL; // the contents of the snapshot
+    char * journal = NULL; // the contents of the journal
+    size_t snapshot_size = 0, journal_size = 0; // sizes of the snapshot and the journal
+    CheckpointHeader header; // the header of the snapshot (or of the current frame)
+    CheckpointHeader last; // the header of the last complete frame
+    Recovered * table = NULL; // hash table of recovered processes
+    size_t table_size = 1; // number of entries in the hash table (a power of two)
+    PCB * heads[NUM_LISTS] = {NULL}; // the head of each list
+    PCB * tails[NUM_LISTS] = {NULL}; // the tail of each list
+    unsigned int restored = 0, adopted = 0, lost = 0; // number of processes restored, adopted and no longer running
+    unsigned long long start = now_usec(); // time at which recovery started
+    boolean success = false; // whether the checkpoint could be read
+
+    *recovered = false;
+    if (checkpoint == NULL) {
+        return true;
+    }
+
+    if (!read_all(checkpoint->path, &snapshot, &snapshot_size)) {
+        return (errno == ENOENT);
+    }
+
+    // Check the snapshot
+    if (snapshot_size >= sizeof(header)) {
+        memcpy(&header, snapshot, sizeof(header));
+    }
+    if ((snapshot_size < sizeof(header)) || (header.magic != CHECKPOINT_MAGIC) || (header.version != CHECKPOINT_VERSION) || (snapshot_size != sizeof(header) + (size_t) header.count * sizeof(CheckpointPCB)) || (checksum((CheckpointPCB *) (snapshot + sizeof(header)), header.count, 0) != header.checksum)) {
+        fprintf(__ERROR_OUTPUT, "Checkpoint '%s' is corrupt.\n", checkpoint->path);
+        free(snapshot);
+        return false;
+    }
+
+    // The memory of each process is saved as an offset within the memory of all nodes, which only places it on the same node if the memory is divided in the same way
+    if (header.memory_nodes != checkpoint->dispatcher->config.memory_nodes) {
+        fprintf(__ERROR_OUTPUT, "Checkpoint '%s' was taken with %d memory nodes, not %d. It can only be recovered with -N %d.\n", checkpoint->path, header.memory_nodes, checkpoint->dispatcher->config.memory_nodes, header.memory_nodes);
+        free(snapshot);
+        return false;
+    }
+    last = header;
+
+    // A journal may not exist if the host dispatcher died whilst a snapshot was being taken
+    if (!read_all(checkpoint->journal_path, &journal, &journal_size)) {
+        journal = NULL;
+        journal_size = 0;
+    }
+
+    // The hash table has room for every record, so that it is at most half full
+    while (table_size < 2 * (header.count + journal_size / sizeof(CheckpointPCB) + 1)) {
+        table_size *= 2;
+    }
+    if ((table = (Recovered *) calloc(table_size, sizeof(Recovered))) == NULL) {
+        fprintf(__ERROR_OUTPUT, "Unable to allocate memory to recover checkpoint '%s'.\n", checkpoint->path);
+        goto cleanup;
+    }
+
+    if (!recover_records(checkpoint, table, table_size, heads, tails, (CheckpointPCB *) (snapshot + sizeof(header)), header.count)) {
+        goto cleanup;
+    }
+
+    // Replay the complete frames of the journal that are newer than the snapshot
+    for (size_t offset = 0; offset + sizeof(header) <= journal_size; ) {
+        CheckpointPCB * records = (CheckpointPCB *) (journal + offset + sizeof(header)); // the records of the frame
+
+        memcpy(&header, journal + offset, sizeof(header));
+        if ((header.magic != CHECKPOINT_MAGIC) || (header.version != CHECKPOINT_VERSION) || (offset + sizeof(header) + (size_t) header.count * sizeof(CheckpointPCB) > journal_size) || (checksum(records, header.count, 0) != header.checksum)) {
+            fprintf(__ERROR_OUTPUT, "Ignoring an incomplete frame at the end of journal '%s'.\n", checkpoint->journal_path);
+            break;
+        }
+        offset += sizeof(header) + (size_t) header.count * sizeof(CheckpointPCB);
+
+        if (header.clock <= last.clock) {
+            continue;
+        }
+        if (!recover_records(checkpoint, table, table_size, heads, tails, records, header.count)) {
+            goto cleanup;
+        }
+        last = header;
+    }
+
+    // Adopt the processes that have been started, and restore the memory and resources of each process
+    for (unsigned int list = 0; list < NUM_LISTS; list++) {
+        PCB * pcb = heads[list];
+
+        while (pcb != NULL) {
+            PCB * next = pcb->next; // the next process in the list
+            const CheckpointPCB * record = find_recovered(table, table_size, pcb->id)->record; // the latest record of the process
+
+            // The removal of a process that is no longer running is checkpointed at the end of the first tick
+            if ((pcb->pid != 0) && (adopt_PCB(checkpoint->dispatcher, &pcb, list != ACTIVE_LIST) == NULL)) {
+                list_remove(heads, tails, list, pcb);
+                checkpoint_remove(checkpoint, pcb->id);
+                free_PCB(checkpoint->dispatcher, &pcb);
+                pcb = next;
+                lost++;
+                continue;
+            }
+
+            if ((record->memory_offset >= 0) && ((pcb->memory = claim_memory(checkpoint->dispatcher, (unsigned int) record->memory_offset, record->memory_size)) == NULL)) {
+                fprintf(__ERROR_OUTPUT, "Unable to restore the memory of PCB %d from checkpoint '%s'.\n", pcb->id, checkpoint->path);
+                goto cleanup;
+            }
+            for (unsigned int i = 0; i < NUM_CHECKPOINT_RESOURCES; i++) {
+                for (unsigned int j = 0; j < record->held[i]; j++) {
+                    if (resource_alloc(&checkpoint->dispatcher->resources, (ResourceType) (Printer_Resource + i), pcb) == NULL) {
+                        fprintf(__ERROR_OUTPUT, "Unable to restore the resources of PCB %d from checkpoint '%s'.\n", pcb->id, checkpoint->path);
+                        goto cleanup;
+                    }
+                }
+            }
+
+            if (pcb->pid != 0) {
+                adopted++;
+            }
+            restored++;
+            pcb = next;
+        }
+    }
+
+    success = true;
+    *recovered = true;
+
+cleanup:
+    if (success) {
+        // Move the lists to the queues of the host dispatcher
+        checkpoint->dispatcher->input_queue = heads[Checkpoint_Input];
+        checkpoint->dispatcher->input_tail = tails[Checkpoint_Input];
+        checkpoint->dispatcher->user_job_queue = heads[Checkpoint_User_Job];
+        for (unsigned int i = 0; i < checkpoint->dispatcher->config.feedback_levels; i++) {
+            checkpoint->dispatcher->feedback_queue[i] = heads[Checkpoint_Feedback + i];
+        }
+        for (PCB * pcb = heads[Checkpoint_Real_Time]; pcb != NULL; ) {
+            PCB * next = pcb->next; // the next process in the list
+
+            pcb->prev = NULL;
+            pcb->next = NULL;
+            if (edf_enqueue(&checkpoint->dispatcher->real_time_queue, pcb) == NULL) {
+                // The process cannot be queued, so it must not be left running with memory and resources allocated
+                fprintf(__ERROR_OUTPUT, "Unable to restore real time PCB %d from checkpoint '%s'. This process will not be executed.\n", pcb->id, checkpoint->path);
+                if ((pcb->pid == 0) || (terminate_PCB(checkpoint->dispatcher, &pcb) == NULL)) {
+                    pcb->memory = free_memory(checkpoint->dispatcher, pcb->memory);
+                    resource_free(&checkpoint->dispatcher->resources, pcb);
+                }
+                checkpoint_remove(checkpoint, pcb->id);
+                free_PCB(checkpoint->dispatcher, &pcb);
+            }
+            pcb = next;
+        }
+        checkpoint->dispatcher->active = heads[ACTIVE_LIST];
+
+        // Rebuild the dependencies - job arrays are registered before the instances split from them, and only processes in the input queue can still be waiting for other processes to complete
+        for (unsigned int pass = 0; pass < 2; pass++) {
+            for (unsigned int list = 0; list < NUM_LISTS; list++) {
+                for (PCB * pcb = (list != Checkpoint_Real_Time) ? heads[list] : NULL; pcb != NULL; pcb = pcb->next) {
+                    if ((pcb->array != 0) == (pass == 1)) {
+                        dependency_register(&checkpoint->dispatcher->dependencies, pcb);
+                    }
+                }
+            }
+        }
+        for (unsigned int i = 0; i < checkpoint->dispatcher->real_time_queue.size; i++) {
+            dependency_register(&checkpoint->dispatcher->dependencies, checkpoint->dispatcher->real_time_queue.heap[i]);
+        }
+        for (PCB * pcb = checkpoint->dispatcher->input_queue; pcb != NULL; pcb = pcb->next) {
+            dependency_link(&checkpoint->dispatcher->dependencies, pcb);
+        }
+
+        checkpoint->dispatcher->clock = last.clock;
+        checkpoint->dispatcher->deadlines_met = last.statistics[0];
+        checkpoint->dispatcher->deadlines_missed = last.statistics[1];
+        checkpoint->dispatcher->real_time_rejected = last.statistics[2];
+        checkpoint->dispatcher->memory_compactions = last.statistics[3];
+        checkpoint->dispatcher->memory_relocated = last.statistics[4];
+        checkpoint->dispatcher->compaction_admissions = last.statistics[5];
+        checkpoint->dispatcher->compaction_cpu_time = last.statistics[6];
+        checkpoint->dispatcher->memory_spills = last.statistics[7];
+        checkpoint->dispatcher->next_id = last.next_id;
+
+        // The user job queue must be rescanned by the admission scheduler
+        admission_notify_arrival(checkpoint->dispatcher);
+
+        fprintf(__STANDARD_OUTPUT, "Recovered %d processes (%d running, %d no longer running) from checkpoint '%s' at time %d in %.3f ms.\n", restored, adopted, lost, checkpoint->path, checkpoint->dispatcher->clock, (now_usec() - start) / 1000.0);
+    } else {
+        fprintf(__ERROR_OUTPUT, "Unable to recover checkpoint '%s'.\n", checkpoint->path);
+        for (unsigned int list = 0; list < NUM_LISTS; list++) {
+            while (heads[list] != NULL) {
+                PCB * pcb = dequeue_PCB(&heads[list]);
+                free_PCB(checkpoint->dispatcher, &pcb);
+            }
+        }
+    }
+
+    free(table);
+    free(snapshot);
+    free(journal);
+    return success;
+}
+
+/*
+ * Disables checkpointing of a host dispatcher, and removes the checkpoint. This
+ * is called when the host dispatcher exits normally, so there is nothing to
+ * recover.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ */
+void checkpoint_destroy(Dispatcher * dispatcher) {
+    Checkpoint * checkpoint = dispatcher->checkpoint; // the checkpoint
+
+    if (checkpoint == NULL) {
+        return;
+    }
+
+    if (checkpoint->journal >= 0) {
+        close(checkpoint->journal);
+        checkpoint->journal = -1;
+    }
+
+    if (checkpoint->path != NULL) {
+        unlink(checkpoint->path);
+        unlink(checkpoint->journal_path);
+        unlink(checkpoint->temporary_path);
+    }
+
+    free(checkpoint->path);
+    free(checkpoint->journal_path);
+    free(checkpoint->temporary_path);
+    free(checkpoint->records);
+    free(checkpoint);
+    dispatcher->checkpoint = NULL;
+}
+
+/*
+ * Journals the state of a process that has moved or changed. This must be
+ * called after the process has been added to its new location (at the tail of
+ * a queue).
+ *
+ * PARAMETERS
+ *     checkpoint: The checkpoint (NULL if checkpointing is disabled).
+ *     pcb: The process.
+ *     location: Where the process is.
+ */
+void checkpoint_PCB(Checkpoint * checkpoint, PCB * pcb, CheckpointLocation location) {
+    CheckpointPCB * record; // the record of the process
+
+    if ((checkpoint != NULL) && (pcb != NULL) && ((record = add_record(checkpoint)) != NULL)) {
+        save_PCB(checkpoint, pcb, location, record);
+    }
+}
+
+/*
+ * Journals that a process has been removed from the host dispatcher (because it
+ * has completed, or been rejected or cancelled).
+ *
+ * PARAMETERS
+ *     checkpoint: The checkpoint (NULL if checkpointing is disabled).
+ *     id: The ID of the process.
+ */
+void checkpoint_remove(Checkpoint * checkpoint, unsigned int id) {
+    CheckpointPCB * record; // the record of the removal
+
+    if ((checkpoint != NULL) && ((record = add_record(checkpoint)) != NULL)) {
+        memset(record, 0, sizeof(CheckpointPCB));
+        record->id = id;
+        record->location = Checkpoint_Removed;
+    }
+}
+
+/*
+ * Notes that memory has been compacted, so that every process that holds
+ * memory is journalled at the end of the tick.
+ *
+ * PARAMETERS
+ *     checkpoint: The checkpoint (NULL if checkpointing is disabled).
+ */
+void checkpoint_relocated(Checkpoint * checkpoint) {
+    if (checkpoint != NULL) {
+        checkpoint->relocated = true;
+    }
+}
+
+/*
+ * Saves the changes made during a tick, by writing a frame to the journal or by
+ * taking a snapshot. The active process is always journalled, as it has been
+ * charged for the tick.
+ *
+ * This function uses the clock, statistics, input queue, user job queue, real
+ * time queue, feedback queues and active process of the host dispatcher.
+ *
+ * PARAMETERS
+ *     checkpoint: The checkpoint (NULL if checkpointing is disabled).
+ */
+void checkpoint_commit(Checkpoint * checkpoint) {
+    unsigned long long start; // time at which the commit started
+
+    if (checkpoint == NULL) {
+        return;
+    }
+    start = now_usec();
+
+    // Journal the processes whose memory may have been relocated
+    if (checkpoint->relocated) {
+        for (unsigned int i = 0; i < checkpoint->dispatcher->real_time_queue.size; i++) {
+            if (checkpoint->dispatcher->real_time_queue.heap[i]->memory != NULL) {
+                checkpoint_PCB(checkpoint, checkpoint->dispatcher->real_time_queue.heap[i], Checkpoint_Real_Time);
+            }
+        }
+        for (unsigned int i = 0; i < checkpoint->dispatcher->config.feedback_levels; i++) {
+            for (PCB * p = checkpoint->dispatcher->feedback_queue[i]; p != NULL; p = p->next) {
+                if (p->memory != NULL) {
+                    checkpoint_PCB(checkpoint, p, Checkpoint_Feedback);
+                }
+            }
+        }
+        checkpoint->relocated = false;
+    }
+    checkpoint_PCB(checkpoint, checkpoint->dispatcher->active, Checkpoint_Active);
+
+    // Take a snapshot once the journal is larger than the snapshot would be
+    if (checkpoint->journal_bytes > ((checkpoint->snapshot_bytes > CHECKPOINT_MIN_JOURNAL) ? checkpoint->snapshot_bytes : CHECKPOINT_MIN_JOURNAL)) {
+        checkpoint->snapshot_due = true;
+    }
+
+    if (checkpoint->snapshot_due) {
+        checkpoint->snapshot_due = !write_snapshot(checkpoint);
+    } else if (!write_frame(checkpoint)) {
+        // The journal is no longer consistent with the snapshot
+        checkpoint->snapshot_due = true;
+    }
+
+    checkpoint->journalled += checkpoint->count;
+    checkpoint->count = 0;
+    checkpoint->commits++;
+    checkpoint->usec += now_usec() - start;
+}
+
+/*
+ * Prints the number of snapshots and journal records written, and the average
+ * time spent checkpointing each tick.
+ *
+ * PARAMETERS
+ *     checkpoint: The checkpoint (NULL if checkpointing is disabled).
+ */
+void checkpoint_print_statistics(Checkpoint * checkpoint) {
+    if ((checkpoint == NULL) || (checkpoint->commits == 0)) {
+        return;
+    }
+
+    fprintf(__STANDARD_OUTPUT, "Checkpoint snapshots: %d. Journal records: %llu. Checkpoint time: %.3f ms per tick (%.3f%% of a tick).\n", checkpoint->snapshots, checkpoint->journalled, checkpoint->usec / 1000.0 / checkpoint->commits, 100.0 * checkpoint->usec / checkpoint->commits / TICK_USEC);
+}
+
+/*
+ * Adds a record to the records journalled during the current tick.
+ *
+ * PARAMETERS
+ *     checkpoint: The checkpoint.
+ *
+ * RETURN VALUE
+ * A pointer to the record, or NULL if there is no memory for the record.
+ */
+static CheckpointPCB * add_record(Checkpoint * checkpoint) {
+    if (checkpoint->count == checkpoint->capacity) {
+        size_t capacity = (checkpoint->capacity > 0) ? 2 * checkpoint->capacity : 64; // the new capacity
+        CheckpointPCB * records = (CheckpointPCB *) realloc(checkpoint->records, capacity * sizeof(CheckpointPCB)); // the enlarged records
+
+        if (records == NULL) {
+            // The change cannot be journalled, so the next commit must take a snapshot
+            checkpoint->snapshot_due = true;
+            return NULL;
+        }
+        checkpoint->records = records;
+        checkpoint->capacity = capacity;
+    }
+
+    return &checkpoint->records[checkpoint->count++];
+}
+
+/*
+ * Saves the state of a process to a record.
+ *
+ * PARAMETERS
+ *     checkpoint: The checkpoint.
+ *     pcb: The process.
+ *     location: Where the process is.
+ *     record: Set to the state of the process.
+ */
+static void save_PCB(Checkpoint * checkpoint, PCB * pcb, CheckpointLocation location, CheckpointPCB * record) {
+    memset(record, 0, sizeof(CheckpointPCB));
+    record->id = pcb->id;
+    record->location = (uint8_t) location;
+    record->pid = (int32_t) pcb->pid;
+    record->arrival_time = pcb->arrival_time;
+    record->remaining_cpu_time = pcb->remaining_cpu_time;
+    record->priority = pcb->priority;
+    record->deadline = pcb->deadline;
+    record->mbytes = pcb->mbytes;
+    record->memory_offset = (pcb->memory != NULL) ? (int32_t) (checkpoint->dispatcher->memory[pcb->memory->node].base + pcb->memory->offset) : -1;
+    record->memory_size = (pcb->memory != NULL) ? pcb->memory->size : 0;
+    record->required[0] = (uint8_t) pcb->num_printers;
+    record->required[1] = (uint8_t) pcb->num_scanners;
+    record->required[2] = (uint8_t) pcb->num_modems;
+    record->required[3] = (uint8_t) pcb->num_cds;
+    for (unsigned int i = 0; i < NUM_CHECKPOINT_RESOURCES; i++) {
+        record->held[i] = (uint8_t) resource_held(&checkpoint->dispatcher->resources, (ResourceType) (Printer_Resource + i), pcb);
+    }
+    record->freezer = (uint8_t) pcb->freezer;
+    record->cpuacct = (uint8_t) pcb->cpuacct;
+    record->cpu_usage = pcb->cpu_usage;
+    record->cpu_ticks_charged = pcb->cpu_ticks_charged;
+    record->active_ticks = pcb->active_ticks;
+    for (unsigned int i = 0; i < pcb->num_dependencies; i++) {
+        record->dependencies[i] = pcb->dependencies[i];
+    }
+    record->instances = pcb->instances;
+    record->array = pcb->array;
+    record->instance_failed = (uint8_t) pcb->instance_failed;
+    record->gang = pcb->gang;
+}
+
+/*
+ * Fills in the header of a snapshot or journal frame.
+ *
+ * This function uses the clock and statistics of the host dispatcher.
+ *
+ * PARAMETERS
+ *     checkpoint: The checkpoint.
+ *     header: The header.
+ *     count: The number of records.
+ *     sum: The checksum of the records.
+ */
+static void fill_header(Checkpoint * checkpoint, CheckpointHeader * header, uint32_t count, uint32_t sum) {
+    memset(header, 0, sizeof(CheckpointHeader));
+    header->magic = CHECKPOINT_MAGIC;
+    header->version = CHECKPOINT_VERSION;
+    header->clock = checkpoint->dispatcher->clock;
+    header->count = count;
+    header->checksum = sum;
+    header->next_id = __atomic_load_n(&checkpoint->dispatcher->next_id, __ATOMIC_RELAXED);
+    header->memory_nodes = checkpoint->dispatcher->config.memory_nodes;
+    header->statistics[0] = checkpoint->dispatcher->deadlines_met;
+    header->statistics[1] = checkpoint->dispatcher->deadlines_missed;
+    header->statistics[2] = checkpoint->dispatcher->real_time_rejected;
+    header->statistics[3] = checkpoint->dispatcher->memory_compactions;
+    header->statistics[4] = checkpoint->dispatcher->memory_relocated;
+    header->statistics[5] = checkpoint->dispatcher->compaction_admissions;
+    header->statistics[6] = checkpoint->dispatcher->compaction_cpu_time;
+    header->statistics[7] = checkpoint->dispatcher->memory_spills;
+}
+
+/*
+ * Calculates the checksum of records (FNV-1a, over 32-bit words).
+ *
+ * PARAMETERS
+ *     records: The records.
+ *     count: The number of records.
+ *     hash: The checksum of any preceding records (0 if none).
+ *
+ * RETURN VALUE
+ * The checksum of the preceding records and these records.
+ */
+static uint32_t checksum(const CheckpointPCB * records, size_t count, uint32_t hash) {
+    const uint32_t * word = (const uint32_t *) records; // the words of the records
+    size_t words = count * (sizeof(CheckpointPCB) / sizeof(uint32_t)); // number of words
+
+    if (hash == 0) {
+        hash = 2166136261u;
+    }
+    for (size_t i = 0; i < words; i++) {
+        hash = (hash ^ word[i]) * 16777619u;
+    }
+
+    return hash;
+}
+
+/*
+ * Takes a snapshot of every process, and restarts the journal.
+ *
+ * This function uses the input queue, user job queue, real time queue, feedback
+ * queues and active process of the host dispatcher.
+ *
+ * PARAMETERS
+ *     checkpoint: The checkpoint.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the snapshot was taken.
+ */
+static boolean write_snapshot(Checkpoint * checkpoint) {
+    CheckpointHeader header; // the header of the snapshot
+    CheckpointPCB buffer[256]; // records waiting to be written
+    unsigned int buffered = 0; // number of records waiting to be written
+    uint32_t count = 0; // number of records written
+    uint32_t sum = 0; // checksum of the records written
+    boolean success; // whether the snapshot was written
+    int fd; // the temporary snapshot
+
+    if ((fd = open(checkpoint->temporary_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)) < 0) {
+        fprintf(__ERROR_OUTPUT, "Unable to create checkpoint '%s'.\n", checkpoint->temporary_path);
+        return false;
+    }
+
+    // Leave room for the header, which is written once the records have been counted
+    success = (lseek(fd, sizeof(header), SEEK_SET) == (off_t) sizeof(header));
+
+    // Write the processes in queue order
+    for (unsigned int list = 0; success && (list < NUM_LISTS); list++) {
+        PCB * p = NULL; // the next process to save
+        unsigned int heap_index = 0; // the next index of the real time queue
+        CheckpointLocation location = (list >= Checkpoint_Feedback) ? Checkpoint_Feedback : (CheckpointLocation) list; // where the processes are
+
+        switch (list) {
+            case Checkpoint_Removed:
+                p = checkpoint->dispatcher->active;
+                location = Checkpoint_Active;
+                break;
+            case Checkpoint_Input:
+                p = checkpoint->dispatcher->input_queue;
+                break;
+            case Checkpoint_User_Job:
+                p = checkpoint->dispatcher->user_job_queue;
+                break;
+            case Checkpoint_Real_Time:
+                p = (checkpoint->dispatcher->real_time_queue.size > 0) ? checkpoint->dispatcher->real_time_queue.heap[heap_index++] : NULL;
+                break;
+            case ACTIVE_LIST:
+                continue;
+            default:
+                p = checkpoint->dispatcher->feedback_queue[list - Checkpoint_Feedback];
+                break;
+        }
+
+        while (success && (p != NULL)) {
+            save_PCB(checkpoint, p, location, &buffer[buffered++]);
+            if (buffered == sizeof(buffer) / sizeof(buffer[0])) {
+                sum = checksum(buffer, buffered, sum);
+                success = write_all(fd, buffer, buffered * sizeof(CheckpointPCB));
+                count += buffered;
+                buffered = 0;
+            }
+
+            // The active process is not in a queue, and the real time queue is a heap
+            if (list == Checkpoint_Removed) {
+                p = NULL;
+            } else if (list == Checkpoint_Real_Time) {
+                p = (heap_index < checkpoint->dispatcher->real_time_queue.size) ? checkpoint->dispatcher->real_time_queue.heap[heap_index++] : NULL;
+            } else {
+                p = p->next;
+            }
+        }
+    }
+
+    if (success && (buffered > 0)) {
+        sum = checksum(buffer, buffered, sum);
+        success = write_all(fd, buffer, buffered * sizeof(CheckpointPCB));
+        count += buffered;
+    }
+
+    fill_header(checkpoint, &header, count, (count > 0) ? sum : checksum(NULL, 0, 0));
+    success = success && (lseek(fd, 0, SEEK_SET) == 0) && write_all(fd, &header, sizeof(header)) && (fsync(fd) == 0);
+    success = (close(fd) == 0) && success;
+
+    // Replace the previous snapshot, and then restart the journal
+    if (!success || (rename(checkpoint->temporary_path, checkpoint->path) != 0)) {
+        fprintf(__ERROR_OUTPUT, "Unable to write checkpoint '%s'.\n", checkpoint->path);
+        unlink(checkpoint->temporary_path);
+        return false;
+    }
+
+    checkpoint->snapshot_bytes = sizeof(header) + (unsigned long long) count * sizeof(CheckpointPCB);
+    checkpoint->snapshots++;
+    return open_journal(checkpoint);
+}
+
+/*
+ * Writes the records journalled during the current tick to the journal, as a
+ * frame.
+ *
+ * PARAMETERS
+ *     checkpoint: The checkpoint.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the frame was written.
+ */
+static boolean write_frame(Checkpoint * checkpoint) {
+    CheckpointHeader header; // the header of the frame
+    size_t size = sizeof(header) + checkpoint->count * sizeof(CheckpointPCB); // size of the frame
+    char * frame; // the frame
+    boolean success; // whether the frame was written
+
+    if ((checkpoint->journal < 0) || ((frame = (char *) malloc(size)) == NULL)) {
+        return false;
+    }
+
+    // The header and records are written together, so that the frame is written with a single write
+    fill_header(checkpoint, &header, (uint32_t) checkpoint->count, checksum(checkpoint->records, checkpoint->count, 0));
+    memcpy(frame, &header, sizeof(header));
+    if (checkpoint->count > 0) {
+        memcpy(frame + sizeof(header), checkpoint->records, checkpoint->count * sizeof(CheckpointPCB));
+    }
+
+    success = write_all(checkpoint->journal, frame, size) && (!CHECKPOINT_SYNC || (fdatasync(checkpoint->journal) == 0));
+    free(frame);
+
+    if (!success) {
+        fprintf(__ERROR_OUTPUT, "Unable to write to journal '%s'.\n", checkpoint->journal_path);
+        return false;
+    }
+
+    checkpoint->journal_bytes += size;
+    return true;
+}
+
+/*
+ * Creates an empty journal, replacing the previous journal.
+ *
+ * PARAMETERS
+ *     checkpoint: The checkpoint.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the journal was created.
+ */
+static boolean open_journal(Checkpoint * checkpoint) {
+    if (checkpoint->journal >= 0) {
+        close(checkpoint->journal);
+    }
+
+    if ((checkpoint->journal = open(checkpoint->journal_path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644)) < 0) {
+        fprintf(__ERROR_OUTPUT, "Unable to create journal '%s'.\n", checkpoint->journal_path);
+        return false;
+    }
+
+    checkpoint->journal_bytes = 0;
+    return true;
+}
+
+/*
+ * Writes data to a file, retrying partial writes.
+ *
+ * PARAMETERS
+ *     fd: The file.
+ *     data: The data.
+ *     size: The size of the data.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether all of the data was written.
+ */
+static boolean write_all(int fd, const void * data, size_t size) {
+    const char * p = (const char *) data; // the data remaining to be written
+
+    while (size > 0) {
+        ssize_t n = write(fd, p, size); // number of bytes written
+
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        p += n;
+        size -= n;
+    }
+
+    return true;
+}
+
+/*
+ * Reads the whole of a file.
+ *
+ * PARAMETERS
+ *     path: The path of the file.
+ *     data: Set to the contents of the file, which must be freed.
+ *     size: Set to the size of the file.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the file was read (errno is ENOENT if the
+ * file does not exist).
+ */
+static boolean read_all(const char * path, char ** data, size_t * size) {
+    struct stat info; // information about the file
+    size_t length = 0; // number of bytes read
+    int fd; // the file
+
+    if ((fd = open(path, O_RDONLY | O_CLOEXEC)) < 0) {
+        if (errno != ENOENT) {
+            fprintf(__ERROR_OUTPUT, "Unable to open checkpoint '%s'.\n", path);
+        }
+        return false;
+    }
+
+    if ((fstat(fd, &info) != 0) || ((*data = (char *) malloc((size_t) info.st_size + 1)) == NULL)) {
+        fprintf(__ERROR_OUTPUT, "Unable to read checkpoint '%s'.\n", path);
+        close(fd);
+        errno = EIO;
+        return false;
+    }
+
+    while (length < (size_t) info.st_size) {
+        ssize_t n = read(fd, *data + length, (size_t) info.st_size - length); // number of bytes read
+
+        if ((n < 0) && (errno == EINTR)) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        length += n;
+    }
+    close(fd);
+
+    *size = length;
+    return true;
+}
+
+/*
+ * Applies records to the recovered processes. A process that is seen for the
+ * first time is restored to the tail of its list, and a process that has moved
+ * is moved to the tail of its new list.
+ *
+ * PARAMETERS
+ *     checkpoint: The checkpoint.
+ *     table: The hash table of recovered processes.
+ *     size: The number of entries in the hash table.
+ *     heads: The head of each list.
+ *     tails: The tail of each list.
+ *     records: The records.
+ *     count: The number of records.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the records were applied.
+ */
+static boolean recover_records(Checkpoint * checkpoint, Recovered * table, size_t size, PCB ** heads, PCB ** tails, const CheckpointPCB * records, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        const CheckpointPCB * record = &records[i]; // the record
+        Recovered * entry = find_recovered(table, size, record->id); // the recovered process
+
+        if ((record->id == 0) || (record->location > Checkpoint_Active) || ((record->location == Checkpoint_Feedback) && ((record->priority < 1) || (record->priority > checkpoint->dispatcher->config.feedback_levels)))) {
+            fprintf(__ERROR_OUTPUT, "Checkpoint '%s' contains an invalid record for PCB %d.\n", checkpoint->path, record->id);
+            return false;
+        }
+
+        if (record->location == Checkpoint_Removed) {
+            if (entry->pcb != NULL) {
+                list_remove(heads, tails, entry->list, entry->pcb);
+                free_PCB(checkpoint->dispatcher, &entry->pcb);
+                entry->pcb = NULL;
+            }
+            entry->id = record->id;
+            entry->record = record;
+            continue;
+        }
+
+        if (entry->pcb == NULL) {
+            if ((entry->pcb = restore_PCB(checkpoint, record)) == NULL) {
+                return false;
+            }
+            entry->id = record->id;
+            entry->list = list_of(record);
+            list_append(heads, tails, entry->list, entry->pcb);
+        } else {
+            restore_fields(entry->pcb, record);
+            if (list_of(record) != entry->list) {
+                list_remove(heads, tails, entry->list, entry->pcb);
+                entry->list = list_of(record);
+                list_append(heads, tails, entry->list, entry->pcb);
+            }
+        }
+        entry->record = record;
+    }
+
+    return true;
+}
+
+/*
+ * Finds the entry for a process in the hash table of recovered processes, or
+ * the empty entry where it belongs.
+ *
+ * PARAMETERS
+ *     table: The hash table.
+ *     size: The number of entries in the hash table (a power of two).
+ *     id: The ID of the process.
+ *
+ * RETURN VALUE
+ * A pointer to the entry.
+ */
+static Recovered * find_recovered(Recovered * table, size_t size, uint32_t id) {
+    size_t i = ((size_t) id * 2654435761u) & (size - 1); // the entry to check
+
+    while ((table[i].id != 0) && (table[i].id != id)) {
+        i = (i + 1) & (size - 1);
+    }
+
+    return &table[i];
+}
+
+/*
+ * Creates a process from a record.
+ *
+ * PARAMETERS
+ *     checkpoint: The checkpoint.
+ *     record: The record of the process.
+ *
+ * RETURN VALUE
+ * A pointer to the process.
+ */
+static PCB * restore_PCB(Checkpoint * checkpoint, const CheckpointPCB * record) {
+    ProcessRecord process; // the process record (as it would appear in the dispatch list)
+    PCB * pcb; // the process
+
+    process.arrival_time = record->arrival_time;
+    process.priority = record->priority;
+    process.remaining_cpu_time = record->remaining_cpu_time;
+    process.mbytes = record->mbytes;
+    process.num_printers = record->required[0];
+    process.num_scanners = record->required[1];
+    process.num_modems = record->required[2];
+    process.num_cds = record->required[3];
+    process.deadline = 0;
+    process.num_dependencies = 0;
+    process.instances = 1;
+    process.gang = record->gang;
+
+    if ((pcb = create_process(checkpoint->dispatcher, &process)) != NULL) {
+        restore_fields(pcb, record);
+    }
+
+    return pcb;
+}
+
+/*
+ * Restores the state of a process from a record. The memory and resources of
+ * the process are restored separately.
+ *
+ * PARAMETERS
+ *     pcb: The process.
+ *     record: The record of the process.
+ */
+static void restore_fields(PCB * pcb, const CheckpointPCB * record) {
+    pcb->id = record->id;
+    pcb->pid = (pid_t) record->pid;
+    pcb->arrival_time = record->arrival_time;
+    pcb->remaining_cpu_time = record->remaining_cpu_time;
+    pcb->priority = record->priority;
+    pcb->deadline = record->deadline;
+    pcb->mbytes = record->mbytes;
+    pcb->num_printers = record->required[0];
+    pcb->num_scanners = record->required[1];
+    pcb->num_modems = record->required[2];
+    pcb->num_cds = record->required[3];
+    pcb->freezer = (boolean) record->freezer;
+    pcb->cpuacct = (boolean) record->cpuacct;
+    pcb->cpu_usage = record->cpu_usage;
+    pcb->cpu_ticks_charged = record->cpu_ticks_charged;
+    pcb->active_ticks = record->active_ticks;
+    pcb->num_dependencies = 0;
+    for (unsigned int i = 0; (i < MAX_DEPENDENCIES) && (record->dependencies[i] != 0); i++) {
+        pcb->dependencies[pcb->num_dependencies++] = record->dependencies[i];
+    }
+    pcb->instances = (record->instances > 1) ? record->instances : 1;
+    pcb->array = record->array;
+    pcb->instance_failed = (boolean) record->instance_failed;
+    pcb->gang = (record->gang > 1) ? record->gang : 1;
+}
+
+/*
+ * Gets the list that a recovered process belongs in.
+ *
+ * PARAMETERS
+ *     record: The record of the process.
+ *
+ * RETURN VALUE
+ * The list.
+ */
+static unsigned int list_of(const CheckpointPCB * record) {
+    switch (record->location) {
+        case Checkpoint_Feedback:
+            return Checkpoint_Feedback + record->priority - 1;
+        case Checkpoint_Active:
+            return ACTIVE_LIST;
+        default:
+            return record->location;
+    }
+}
+
+/*
+ * Adds a recovered process to the tail of a list.
+ *
+ * PARAMETERS
+ *     heads: The head of each list.
+ *     tails: The tail of each list.
+ *     list: The list.
+ *     pcb: The process.
+ */
+static void list_append(PCB ** heads, PCB ** tails, unsigned int list, PCB * pcb) {
+    pcb->prev = tails[list];
+    pcb->next = NULL;
+    if (tails[list] != NULL) {
+        tails[list]->next = pcb;
+    } else {
+        heads[list] = pcb;
+    }
+    tails[list] = pcb;
+}
+
+/*
+ * Removes a recovered process from a list.
+ *
+ * PARAMETERS
+ *     heads: The head of each list.
+ *     tails: The tail of each list.
+ *     list: The list.
+ *     pcb: The process.
+ */
+static void list_remove(PCB ** heads, PCB ** tails, unsigned int list, PCB * pcb) {
+    if (pcb->prev != NULL) {
+        pcb->prev->next = pcb->next;
+    } else {
+        heads[list] = pcb->next;
+    }
+    if (pcb->next != NULL) {
+        pcb->next->prev = pcb->prev;
+    } else {
+        tails[list] = pcb->prev;
+    }
+    pcb->prev = NULL;
+    pcb->next = NULL;
+}
+
+/*
+ * Gets the current time.
+ *
+ * RETURN VALUE
+ * The current time (in microseconds).
+ */
+static unsigned long long now_usec(void) {
+    struct timeval now; // the current time
+
+    gettimeofday(&now, NULL);
+    return (unsigned long long) now.tv_sec * 1000000 + now.tv_usec;
+}
@@ -0,0 +1,972 @@
+/*
+ * control.c
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains the functions for the control socket of the host
+ * dispatcher.
+ *
+ * The control socket is a UNIX domain stream socket. Clients send requests as
+ * lines of text, and receive one line of response for each request, in order.
+ * Requests may be pipelined - a client can send many requests before reading
+ * any responses. The requests are:
+ *     SUBMIT <record>: Submits a process, in the same format as a line of the
+ *         dispatch list. Responds with "OK <id>".
+ *     STATUS: Responds with the clock and the number of processes in each
+ *         queue.
+ *     STATUS <id>: Responds with the status of a process.
+ *     CANCEL <id>: Removes a process from its queue, terminating it if it has
+ *         been started.
+ *     SHUTDOWN [NOW]: Stops accepting processes. The host dispatcher exits
+ *         once all processes have completed, or at the end of the current tick
+ *         if NOW is given.
+ *     RING: Responds with "OK <slots>", and passes the memfd containing the
+ *         submission ring (see ring.c) with the response, if it is enabled.
+ *     ACQUIRE <id> <printers> <scanners> <modems> <cds>: Acquires resources
+ *         for a process, within its maximum claim, if processes acquire their
+ *         resources incrementally. Responds with "OK" if the resources were
+ *         allocated, or "WAIT unavailable" or "WAIT unsafe" if the process
+ *         must retry later (see banker.c).
+ *     RELEASE <id> <printers> <scanners> <modems> <cds>: Releases resources
+ *         acquired by a process.
+ * Errors are reported with a response of "ERR <message>".
+ *
+ * The sockets are non-blocking and are serviced with epoll whilst the host
+ * dispatcher waits for the next tick, so that a slow client never delays a
+ * tick. Submitted processes are collected, and added to the tail of the input
+ * queue together at the end of the wait, so that the input queue is only walked
+ * once per tick rather than once per submission. The submission ring is
+ * drained every RING_DRAIN_INTERVAL milliseconds whilst waiting, and at the
+ * start of each tick.
+ */
+#define _POSIX_C_SOURCE 200809L // for fcntl() and sysconf()
+
+#include "../inc/control.h"
+#include "../inc/dispatcher.h"
+#include "../inc/input.h"
+#include "../inc/checkpoint.h"
+#include "../inc/dependency.h"
+#include "../inc/output.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/times.h>
+#include <sys/un.h>
+
+static void accept_clients(Control * control);
+static void read_requests(Control * control, Client * client);
+static boolean write_responses(Control * control, Client * client);
+static void disconnect(Control * control, Client * client);
+static void handle_request(Control * control, Client * client, char * request);
+static char * match(char * request, const char * command);
+static void submit(Control * control, Client * client, char * record);
+static void drain_ring(Control * control);
+static void status(Control * control, Client * client, char * argument);
+static void cancel(Control * control, Client * client, char * argument);
+static void acquire(Control * control, Client * client, char * argument);
+static void release(Control * control, Client * client, char * argument);
+static PCB * parse_resources(Control * control, Client * client, char * argument, unsigned int resources[]);
+static void remove_from_queue(PCB ** head, PCB * pcb);
+static void respond(Control * control, Client * client, const char * format, ...);
+static long remaining_milliseconds(clock_t deadline);
+
+/*
+ * Creates the control socket of a host dispatcher and starts listening for
+ * clients. Any existing socket at the path is replaced.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher that processes are submitted to.
+ *     path: The path of the control socket.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the control socket was created.
+ */
+boolean control_init(Dispatcher * dispatcher, const char * path) {
+    struct sockaddr_un address; // the address of the control socket
+    struct epoll_event event; // the event registered for the listening socket
+    struct stat info; // information about an existing file at the path
+    Control * control; // the control socket
+
+    control_destroy(dispatcher);
+    if ((control = (Control *) calloc(1, sizeof(Control))) == NULL) {
+        fprintf(__ERROR_OUTPUT, "Unable to allocate the control socket.\n");
+        return false;
+    }
+    control->dispatcher = dispatcher;
+    control->listener = -1;
+    control->epoll = -1;
+    control->ring_fd = -1;
+    for (unsigned int i = 0; i < CONTROL_MAX_CLIENTS; i++) {
+        control->clients[i].fd = -1;
+    }
+    dispatcher->control = control;
+
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        fprintf(__ERROR_OUTPUT, "Control socket path '%s' is too long.\n", path);
+        control_destroy(dispatcher);
+        return false;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+
+    // Replace a socket left behind by a previous host dispatcher (but nothing else)
+    if ((stat(path, &info) == 0) && S_ISSOCK(info.st_mode)) {
+        unlink(path);
+    }
+
+    if ((control->listener = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+        fprintf(__ERROR_OUTPUT, "Unable to create the control socket.\n");
+        control_destroy(dispatcher);
+        return false;
+    }
+
+    // Neither the listening socket nor the clients may be inherited by processes
+    fcntl(control->listener, F_SETFD, FD_CLOEXEC);
+    fcntl(control->listener, F_SETFL, O_NONBLOCK);
+
+    if ((bind(control->listener, (struct sockaddr *) &address, sizeof(address)) != 0) || (listen(control->listener, CONTROL_BACKLOG) != 0)) {
+        fprintf(__ERROR_OUTPUT, "Unable to listen on control socket '%s'.\n", path);
+        control_destroy(dispatcher);
+        return false;
+    }
+
+    if ((control->path = (char *) malloc(strlen(path) + 1)) != NULL) {
+        strcpy(control->path, path);
+    }
+
+    // The listening socket is registered with a null pointer, and each client with a pointer to its slot
+    event.events = EPOLLIN;
+    event.data.ptr = NULL;
+    if (((control->epoll = epoll_create1(EPOLL_CLOEXEC)) < 0) || (epoll_ctl(control->epoll, EPOLL_CTL_ADD, control->listener, &event) != 0)) {
+        fprintf(__ERROR_OUTPUT, "Unable to poll control socket '%s'.\n", path);
+        control_destroy(dispatcher);
+        return false;
+    }
+
+    control->state = Control_Running;
+    return true;
+}
+
+/*
+ * Disconnects all clients and removes the control socket of a host dispatcher.
+ * Any processes waiting in the submission ring are added to the input queue.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ */
+void control_destroy(Dispatcher * dispatcher) {
+    Control * control = dispatcher->control; // the control socket
+
+    if (control == NULL) {
+        return;
+    }
+
+    control_collect(control);
+    collect_submitted(dispatcher);
+
+    for (unsigned int i = 0; i < CONTROL_MAX_CLIENTS; i++) {
+        if (control->clients[i].fd >= 0) {
+            disconnect(control, &control->clients[i]);
+        }
+    }
+
+    if (control->ring != NULL) {
+        ring_close(control->ring);
+        close(control->ring_fd);
+        control->ring = NULL;
+        control->ring_fd = -1;
+    }
+
+    if (control->epoll >= 0) {
+        close(control->epoll);
+        control->epoll = -1;
+    }
+
+    if (control->listener >= 0) {
+        close(control->listener);
+    }
+
+    if (control->path != NULL) {
+        unlink(control->path);
+        free(control->path);
+    }
+
+    free(control);
+    dispatcher->control = NULL;
+}
+
+/*
+ * Enables the submission ring, which producers can request over the control
+ * socket.
+ *
+ * PARAMETERS
+ *     control: The control socket (NULL if disabled).
+ *     slots: The number of records that the ring can hold.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the submission ring was created.
+ */
+boolean control_enable_ring(Control * control, unsigned int slots) {
+    if ((control == NULL) || (control->ring != NULL)) {
+        return false;
+    }
+
+    return ((control->ring = ring_create(slots, &control->ring_fd)) != NULL);
+}
+
+/*
+ * Submits the processes waiting in the submission ring. This is called at the
+ * start of each tick, before the submitted processes are added to the tail of
+ * the input queue (see collect_submitted()).
+ *
+ * PARAMETERS
+ *     control: The control socket (NULL if disabled).
+ */
+void control_collect(Control * control) {
+    if (control != NULL) {
+        drain_ring(control);
+    }
+}
+
+/*
+ * Gets the state of the control socket.
+ *
+ * PARAMETERS
+ *     control: The control socket (NULL if disabled).
+ *
+ * RETURN VALUE
+ * The state of the control socket.
+ */
+ControlState control_state(Control * control) {
+    return (control != NULL) ? control->state : Control_Disabled;
+}
+
+/*
+ * Services the control socket for a period of time. This replaces the sleep
+ * between ticks of the host dispatcher. The host dispatcher is locked whilst
+ * requests are handled, but not whilst waiting for them.
+ *
+ * PARAMETERS
+ *     control: The control socket.
+ *     milliseconds: The time for which to service the control socket.
+ */
+void control_serve(Control * control, unsigned int milliseconds) {
+    struct epoll_event events[CONTROL_MAX_EVENTS]; // the events that are ready
+    struct tms unused; // process times (not used)
+    clock_t deadline = times(&unused) + ((clock_t) milliseconds * sysconf(_SC_CLK_TCK)) / 1000; // the time at which to return (in clock ticks)
+    long timeout; // the time remaining until the deadline (in milliseconds)
+
+    while ((timeout = remaining_milliseconds(deadline)) > 0) {
+        // Wake up periodically to drain the submission ring, so that producers are not blocked by a full ring until the next tick
+        if ((control->ring != NULL) && (timeout > RING_DRAIN_INTERVAL)) {
+            timeout = RING_DRAIN_INTERVAL;
+        }
+
+        int n = epoll_wait(control->epoll, events, CONTROL_MAX_EVENTS, (int) timeout); // the number of events that are ready
+
+        dispatcher_lock(control->dispatcher);
+        for (int i = 0; i < n; i++) {
+            Client * client = (Client *) events[i].data.ptr; // the client that the event is for
+
+            if (client == NULL) {
+                accept_clients(control);
+                continue;
+            }
+
+            if ((events[i].events & EPOLLOUT) && (!write_responses(control, client) || (client->closing && (client->output_length == 0)))) {
+                disconnect(control, client);
+                continue;
+            }
+
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                if (client->closing) {
+                    // The client has closed its end of the socket and can no longer receive the responses
+                    disconnect(control, client);
+                } else {
+                    read_requests(control, client);
+                }
+            }
+        }
+
+        drain_ring(control);
+        dispatcher_unlock(control->dispatcher);
+    }
+
+    dispatcher_lock(control->dispatcher);
+    collect_submitted(control->dispatcher);
+    dispatcher_unlock(control->dispatcher);
+}
+
+/*
+ * Accepts all pending connections on the listening socket.
+ *
+ * PARAMETERS
+ *     control: The control socket.
+ */
+static void accept_clients(Control * control) {
+    int fd; // the socket connected to the new client
+
+    while ((fd = accept(control->listener, NULL, NULL)) >= 0) {
+        Client * client = NULL; // an unused client slot
+        struct epoll_event event; // the event registered for the client
+
+        for (unsigned int i = 0; i < CONTROL_MAX_CLIENTS; i++) {
+            if (control->clients[i].fd < 0) {
+                client = &control->clients[i];
+                break;
+            }
+        }
+
+        if (client == NULL) {
+            fprintf(__ERROR_OUTPUT, "Too many control clients. Refusing connection.\n");
+            close(fd);
+            continue;
+        }
+
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+
+        event.events = EPOLLIN;
+        event.data.ptr = client;
+        if (epoll_ctl(control->epoll, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close(fd);
+            continue;
+        }
+
+        client->fd = fd;
+        client->input_length = 0;
+        client->output = NULL;
+        client->output_length = 0;
+        client->output_capacity = 0;
+        client->writing = false;
+        client->closing = false;
+        client->descriptor = false;
+#ifdef DEBUG
+        fprintf(__DEBUG_OUTPUT, "Control client %d connected.\n", (int) (client - control->clients));
+#endif // #ifdef DEBUG
+    }
+}
+
+/*
+ * Reads requests from a client, handles each complete request and sends the
+ * responses. A partial request is kept until the rest of it is received.
+ *
+ * PARAMETERS
+ *     control: The control socket.
+ *     client: The client.
+ */
+static void read_requests(Control * control, Client * client) {
+    ssize_t received = recv(client->fd, client->input + client->input_length, CONTROL_BUFFER - client->input_length, 0); // number of bytes received
+    char * request = client->input; // the next request
+    char * end; // the end of the next request
+
+    if (received < 0) {
+        if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+            disconnect(control, client);
+        }
+        return;
+    }
+
+    if (received == 0) {
+        // The client has closed its end of the socket - disconnect once the remaining responses have been sent
+        client->closing = true;
+        if (client->output_length == 0) {
+            disconnect(control, client);
+        }
+        return;
+    }
+
+    client->input_length += received;
+
+    while ((end = (char *) memchr(request, '\n', client->input_length - (request - client->input))) != NULL) {
+        *end = '\0';
+        handle_request(control, client, request);
+        request = end + 1;
+    }
+
+    // Keep any partial request
+    client->input_length -= request - client->input;
+    memmove(client->input, request, client->input_length);
+
+    if (client->input_length == CONTROL_BUFFER) {
+        respond(control, client, "ERR request too long");
+        client->input_length = 0;
+        client->closing = true;
+    }
+
+    if (!write_responses(control, client) || (client->closing && (client->output_length == 0))) {
+        disconnect(control, client);
+    }
+}
+
+/*
+ * Sends as many of the queued responses to a client as the socket will accept.
+ * If any responses remain, the client is polled until the socket is writable.
+ *
+ * PARAMETERS
+ *     control: The control socket.
+ *     client: The client.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the client is still connected.
+ */
+static boolean write_responses(Control * control, Client * client) {
+    size_t sent = 0; // number of bytes sent
+    struct epoll_event event; // the events polled for the client
+
+    while (sent < client->output_length) {
+        ssize_t n; // number of bytes sent by this call
+
+        if (client->descriptor && (sent == client->descriptor_offset)) {
+            // Send the memfd of the submission ring with the first byte of its response
+            char buffer[CMSG_SPACE(sizeof(int))]; // the ancillary data
+            struct iovec data = { client->output + sent, client->output_length - sent }; // the responses
+            struct msghdr message; // the message sent
+            struct cmsghdr * header; // the header of the ancillary data
+
+            memset(buffer, 0, sizeof(buffer));
+            memset(&message, 0, sizeof(message));
+            message.msg_iov = &data;
+            message.msg_iovlen = 1;
+            message.msg_control = buffer;
+            message.msg_controllen = sizeof(buffer);
+
+            header = CMSG_FIRSTHDR(&message);
+            header->cmsg_level = SOL_SOCKET;
+            header->cmsg_type = SCM_RIGHTS;
+            header->cmsg_len = CMSG_LEN(sizeof(int));
+            memcpy(CMSG_DATA(header), &control->ring_fd, sizeof(int));
+
+            if ((n = sendmsg(client->fd, &message, MSG_NOSIGNAL)) > 0) {
+                client->descriptor = false;
+            }
+        } else {
+            size_t end = (client->descriptor && (client->descriptor_offset > sent)) ? client->descriptor_offset : client->output_length; // the end of the responses that can be sent without the memfd
+            n = send(client->fd, client->output + sent, end - sent, MSG_NOSIGNAL);
+        }
+
+        if (n < 0) {
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+                break;
+            } else if (errno != EINTR) {
+                return false;
+            }
+        } else {
+            sent += n;
+        }
+    }
+
+    client->output_length -= sent;
+    memmove(client->output, client->output + sent, client->output_length);
+    if (client->descriptor) {
+        client->descriptor_offset -= sent;
+    }
+
+    // Only poll for the socket becoming writable whilst there are responses to send
+    if ((client->output_length > 0) != client->writing) {
+        client->writing = (client->output_length > 0);
+        event.events = client->writing ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+        event.data.ptr = client;
+        epoll_ctl(control->epoll, EPOLL_CTL_MOD, client->fd, &event);
+    }
+
+    return true;
+}
+
+/*
+ * Disconnects a client.
+ *
+ * PARAMETERS
+ *     control: The control socket.
+ *     client: The client.
+ */
+static void disconnect(Control * control, Client * client) {
+#ifdef DEBUG
+    fprintf(__DEBUG_OUTPUT, "Control client %d disconnected.\n", (int) (client - control->clients));
+#endif // #ifdef DEBUG
+    epoll_ctl(control->epoll, EPOLL_CTL_DEL, client->fd, NULL);
+    close(client->fd);
+    client->fd = -1;
+
+    free(client->output);
+    client->output = NULL;
+    client->output_length = 0;
+    client->output_capacity = 0;
+    client->descriptor = false;
+}
+
+/*
+ * Handles a request from a client.
+ *
+ * PARAMETERS
+ *     control: The control socket.
+ *     client: The client.
+ *     request: The request (without the line terminator).
+ */
+static void handle_request(Control * control, Client * client, char * request) {
+    char * argument; // the argument of the request
+
+    // Allow CRLF line terminators
+    request[strcspn(request, "\r")] = '\0';
+
+    // Ignore empty requests
+    if (request[strspn(request, " \t")] == '\0') {
+        return;
+    }
+
+    if ((argument = match(request, "SUBMIT")) != NULL) {
+        submit(control, client, argument);
+    } else if ((argument = match(request, "STATUS")) != NULL) {
+        status(control, client, argument);
+    } else if ((argument = match(request, "CANCEL")) != NULL) {
+        cancel(control, client, argument);
+    } else if ((argument = match(request, "SHUTDOWN")) != NULL) {
+        if (strcmp(argument, "NOW") == 0) {
+            control->state = Control_Stopped;
+        } else if (argument[0] == '\0') {
+            if (control->state == Control_Running) {
+                control->state = Control_Draining;
+            }
+        } else {
+            respond(control, client, "ERR invalid argument '%s'", argument);
+            return;
+        }
+        respond(control, client, "OK");
+    } else if ((argument = match(request, "ACQUIRE")) != NULL) {
+        acquire(control, client, argument);
+    } else if ((argument = match(request, "RELEASE")) != NULL) {
+        release(control, client, argument);
+    } else if ((argument = match(request, "RING")) != NULL) {
+        if (control->ring == NULL) {
+            respond(control, client, "ERR submission ring not enabled");
+        } else if (client->descriptor) {
+            respond(control, client, "ERR submission ring already requested");
+        } else {
+            client->descriptor = true;
+            client->descriptor_offset = client->output_length;
+            respond(control, client, "OK %d", control->ring->slots);
+        }
+    } else {
+        respond(control, client, "ERR unknown request '%s'", request);
+    }
+}
+
+/*
+ * Checks whether a request is for a command.
+ *
+ * PARAMETERS
+ *     request: The request.
+ *     command: The command.
+ *
+ * RETURN VALUE
+ * A pointer to the argument of the request (after any whitespace), or NULL if
+ * the request is not for the command.
+ */
+static char * match(char * request, const char * command) {
+    size_t length = strlen(command); // length of the command
+
+    request += strspn(request, " \t");
+    if ((strncmp(request, command, length) != 0) || ((request[length] != '\0') && (request[length] != ' ') && (request[length] != '\t'))) {
+        return NULL;
+    }
+
+    return request + length + strspn(request + length, " \t");
+}
+
+/*
+ * Submits a process.
+ *
+ * PARAMETERS
+ *     control: The control socket.
+ *     client: The client that submitted the process.
+ *     record: The process record.
+ */
+static void submit(Control * control, Client * client, char * record) {
+    PCB * pcb; // the submitted process
+
+    if (control->state != Control_Running) {
+        respond(control, client, "ERR not accepting processes");
+        return;
+    }
+
+    if ((pcb = parse_process(control->dispatcher, record)) == NULL) {
+        respond(control, client, "ERR invalid record");
+        return;
+    }
+
+    submit_PCB(control->dispatcher, pcb);
+    respond(control, client, "OK %d", pcb->id);
+}
+
+/*
+ * Drains the submission ring, in batches of RING_BATCH records. Records that
+ * are drained after the host dispatcher has stopped accepting processes are
+ * discarded.
+ *
+ * PARAMETERS
+ *     control: The control socket.
+ */
+static void drain_ring(Control * control) {
+    ProcessRecord records[RING_BATCH]; // the records drained
+    unsigned int n; // the number of records drained
+    unsigned int discarded = 0; // the number of records discarded
+
+    if (control->ring == NULL) {
+        return;
+    }
+
+    while ((n = ring_drain(control->ring, records, RING_BATCH)) > 0) {
+        if (control->state != Control_Running) {
+            discarded += n;
+            continue;
+        }
+
+        for (unsigned int i = 0; i < n; i++) {
+            dispatcher_submit(control->dispatcher, &records[i]);
+        }
+    }
+
+    if (discarded > 0) {
+        fprintf(__ERROR_OUTPUT, "Discarded %d processes submitted through the submission ring after shutdown.\n", discarded);
+    }
+}
+
+/*
+ * Responds with the status of the host dispatcher or of a process.
+ *
+ * This function uses the clock, input queue, user job queue, real time queue,
+ * feedback queues and active process of the host dispatcher.
+ *
+ * PARAMETERS
+ *     control: The control socket.
+ *     client: The client.
+ *     argument: The ID of the process, or an empty string for the status of
+ *         the host dispatcher.
+ */
+static void status(Control * control, Client * client, char * argument) {
+    ProcessStatus process; // the status of the process
+    unsigned int id; // the ID of the process
+    char trailing; // used to detect trailing garbage
+
+    if (argument[0] == '\0') {
+        unsigned int feedback = 0; // number of processes in the feedback queues
+        unsigned int pending = 0; // number of processes in the user job queue
+        unsigned int unloaded = 0; // number of processes in the input queue
+
+        for (unsigned int i = 0; i < control->dispatcher->config.feedback_levels; i++) {
+            for (PCB * p = control->dispatcher->feedback_queue[i]; p != NULL; p = p->next) {
+                feedback++;
+            }
+        }
+        for (PCB * p = control->dispatcher->user_job_queue; p != NULL; p = p->next) {
+            pending++;
+        }
+        for (PCB * p = control->dispatcher->input_queue; p != NULL; p = p->next) {
+            unloaded++;
+        }
+        for (PCB * p = __atomic_load_n(&control->dispatcher->submitted, __ATOMIC_ACQUIRE); p != NULL; p = p->next) {
+            unloaded++;
+        }
+
+        respond(control, client, "OK clock=%d active=%d real_time=%d feedback=%d pending=%d unloaded=%d", control->dispatcher->clock, (control->dispatcher->active != NULL) ? (int) control->dispatcher->active->id : 0, control->dispatcher->real_time_queue.size, feedback, pending, unloaded);
+        return;
+    }
+
+    if (sscanf(argument, "%u %c", &id, &trailing) != 1) {
+        respond(control, client, "ERR invalid process ID '%s'", argument);
+        return;
+    }
+
+    if (!get_process_status(control->dispatcher, id, &process)) {
+        respond(control, client, "ERR unknown process %d", id);
+        return;
+    }
+
+    switch (process.location) {
+        case Active_Process:
+            respond(control, client, "OK id=%d pid=%d remain=%d priority=%d status=ACTIVE", process.id, (int) process.pid, process.remaining_cpu_time, process.priority);
+            break;
+
+        case Real_Time_Queue:
+            respond(control, client, "OK id=%d pid=%d remain=%d priority=%d status=QUEUED-RT", process.id, (int) process.pid, process.remaining_cpu_time, process.priority);
+            break;
+
+        case Feedback_Queue:
+            respond(control, client, "OK id=%d pid=%d remain=%d priority=%d status=%s-RRQ%d", process.id, (int) process.pid, process.remaining_cpu_time, process.priority, (process.pid != 0) ? "SUSPENDED" : "QUEUED", process.level + 1);
+            break;
+
+        case User_Job_Queue:
+            respond(control, client, "OK id=%d pid=%d remain=%d priority=%d status=PENDING", process.id, (int) process.pid, process.remaining_cpu_time, process.priority);
+            break;
+
+        default:
+            respond(control, client, "OK id=%d pid=%d remain=%d priority=%d status=UNLOADED", process.id, (int) process.pid, process.remaining_cpu_time, process.priority);
+            break;
+    }
+}
+
+/*
+ * Cancels a process, removing it from its queue. A process that has been
+ * started is terminated, and the memory and resources allocated to the process
+ * are freed.
+ *
+ * This function uses the input queue, user job queue, real time queue, feedback
+ * queues and active process of the host dispatcher.
+ *
+ * PARAMETERS
+ *     control: The control socket.
+ *     client: The client.
+ *     argument: The ID of the process.
+ */
+static void cancel(Control * control, Client * client, char * argument) {
+    PCB * pcb = NULL; // the process
+    unsigned int level = 0; // the feedback queue of the process
+    unsigned int id; // the ID of the process
+    char trailing; // used to detect trailing garbage
+
+    if (sscanf(argument, "%u %c", &id, &trailing) != 1) {
+        respond(control, client, "ERR invalid process ID '%s'", argument);
+        return;
+    }
+
+    // A submitted process can only be removed once it is on the input queue (other threads may be submitting processes)
+    collect_submitted(control->dispatcher);
+
+    switch (dispatcher_find(control->dispatcher, id, &pcb, &level)) {
+        case Active_Process:
+            control->dispatcher->active = NULL;
+            break;
+
+        case Real_Time_Queue:
+            edf_remove(&control->dispatcher->real_time_queue, pcb);
+            break;
+
+        case Feedback_Queue:
+            remove_from_queue(&control->dispatcher->feedback_queue[level], pcb);
+            break;
+
+        case User_Job_Queue:
+            remove_from_queue(&control->dispatcher->user_job_queue, pcb);
+            break;
+
+        case Input_Queue:
+            remove_from_input_queue(control->dispatcher, pcb);
+            break;
+
+        default:
+            respond(control, client, "ERR unknown process %d", id);
+            return;
+    }
+
+#ifdef DEBUG
+    fprintf(__DEBUG_OUTPUT, "Cancelling PCB %d.\n", pcb->id);
+#endif // #ifdef DEBUG
+    // A process that has not been started (or that could not be terminated) may still have memory and resources allocated
+    if ((pcb->pid == 0) || (terminate_PCB(control->dispatcher, &pcb) == NULL)) {
+        pcb->memory = free_memory(control->dispatcher, pcb->memory);
+        banker_remove(&control->dispatcher->banker, pcb);
+        resource_free(&control->dispatcher->resources, pcb);
+    }
+    checkpoint_remove(control->dispatcher->checkpoint, id);
+    free_PCB(control->dispatcher, &pcb);
+
+    respond(control, client, "OK %d", id);
+}
+
+/*
+ * Acquires resources for a process that was admitted with a maximum claim.
+ *
+ * PARAMETERS
+ *     control: The control socket.
+ *     client: The client.
+ *     argument: The ID of the process, and the number of printers, scanners,
+ *         modems and CDs requested.
+ */
+static void acquire(Control * control, Client * client, char * argument) {
+    unsigned int request[NUM_RESOURCE_TYPES]; // the number of resources of each type requested
+    PCB * pcb; // the process
+
+    if ((pcb = parse_resources(control, client, argument, request)) == NULL) {
+        return;
+    }
+
+    switch (acquire_resources(control->dispatcher, pcb, request)) {
+        case Banker_Granted:
+            respond(control, client, "OK");
+            break;
+        case Banker_Unavailable:
+            respond(control, client, "WAIT unavailable");
+            break;
+        case Banker_Unsafe:
+            respond(control, client, "WAIT unsafe");
+            break;
+        case Banker_Exceeds_Claim:
+            respond(control, client, "ERR request exceeds the maximum claim of process %d", pcb->id);
+            break;
+        default:
+            respond(control, client, "ERR process %d has no maximum claim", pcb->id);
+            break;
+    }
+}
+
+/*
+ * Releases resources acquired by a process.
+ *
+ * PARAMETERS
+ *     control: The control socket.
+ *     client: The client.
+ *     argument: The ID of the process, and the number of printers, scanners,
+ *         modems and CDs released.
+ */
+static void release(Control * control, Client * client, char * argument) {
+    unsigned int resources[NUM_RESOURCE_TYPES]; // the number of resources of each type released
+    PCB * pcb; // the process
+
+    if ((pcb = parse_resources(control, client, argument, resources)) == NULL) {
+        return;
+    }
+
+    if (release_resources(control->dispatcher, pcb, resources)) {
+        respond(control, client, "OK");
+    } else {
+        respond(control, client, "ERR process %d does not hold the resources", pcb->id);
+    }
+}
+
+/*
+ * Parses the argument of an ACQUIRE or RELEASE request, responding with an
+ * error if it is invalid.
+ *
+ * PARAMETERS
+ *     control: The control socket.
+ *     client: The client.
+ *     argument: The ID of the process, and the number of printers, scanners,
+ *         modems and CDs.
+ *     resources: Set to the number of resources of each type (indexed by
+ *         ResourceType).
+ *
+ * RETURN VALUE
+ * The process, or NULL if the argument is invalid.
+ */
+static PCB * parse_resources(Control * control, Client * client, char * argument, unsigned int resources[]) {
+    PCB * pcb = NULL; // the process
+    unsigned int level = 0; // the feedback queue of the process
+    unsigned int id; // the ID of the process
+    char trailing; // used to detect trailing garbage
+
+    if (!control->dispatcher->config.banker) {
+        respond(control, client, "ERR resources are not acquired incrementally");
+        return NULL;
+    }
+
+    resources[Null_Resource] = 0;
+    if (sscanf(argument, "%u %u %u %u %u %c", &id, &resources[Printer_Resource], &resources[Scanner_Resource], &resources[Modem_Resource], &resources[CD_Resource], &trailing) != 5) {
+        respond(control, client, "ERR invalid request '%s'", argument);
+        return NULL;
+    }
+
+    if (dispatcher_find(control->dispatcher, id, &pcb, &level) == Not_Found) {
+        respond(control, client, "ERR unknown process %d", id);
+        return NULL;
+    }
+
+    return pcb;
+}
+
+/*
+ * Removes a process from a queue.
+ *
+ * PARAMETERS
+ *     head: Pointer to the head of the queue.
+ *     pcb: The process to remove.
+ */
+static void remove_from_queue(PCB ** head, PCB * pcb) {
+    if (pcb == *head) {
+        dequeue_PCB(head);
+    } else {
+        dequeue_PCB(&pcb);
+    }
+}
+
+/*
+ * Queues a response to a client. A client that does not read its responses is
+ * disconnected once CONTROL_MAX_OUTPUT bytes of responses are queued.
+ *
+ * PARAMETERS
+ *     control: The control socket.
+ *     client: The client.
+ *     format: The format of the response (without the line terminator).
+ *     ...: The values to format.
+ */
+static void respond(Control * control, Client * client, const char * format, ...) {
+    char response[INPUT_BUFFER]; // the formatted response
+    va_list values; // the values to format
+    int length; // length of the formatted response
+
+    // No more responses are sent to a client that is being disconnected
+    if (client->closing) {
+        return;
+    }
+
+    va_start(values, format);
+    length = vsnprintf(response, sizeof(response) - 1, format, values);
+    va_end(values);
+
+    if (length < 0) {
+        return;
+    } else if (length > (int) sizeof(response) - 2) {
+        length = sizeof(response) - 2;
+    }
+    response[length++] = '\n';
+
+    if (client->output_length + length > client->output_capacity) {
+        size_t capacity = (client->output_capacity == 0) ? CONTROL_BUFFER : (client->output_capacity * 2); // the new size of the output buffer
+        char * output; // the new output buffer
+
+        if (client->output_length + length > CONTROL_MAX_OUTPUT) {
+            fprintf(__ERROR_OUTPUT, "Control client %d is not reading its responses. Disconnecting.\n", (int) (client - control->clients));
+            client->output_length = 0;
+            client->closing = true;
+            return;
+        }
+
+        if ((output = (char *) realloc(client->output, capacity)) == NULL) {
+            client->output_length = 0;
+            client->closing = true;
+            return;
+        }
+        client->output = output;
+        client->output_capacity = capacity;
+    }
+
+    memcpy(client->output + client->output_length, response, length);
+    client->output_length += length;
+}
+
+/*
+ * Calculates the time remaining until a deadline. The elapsed real time
+ * returned by times() is used (rather than clock_gettime()), as <time.h>
+ * declares a clock() function that conflicts with the global clock.
+ *
+ * PARAMETERS
+ *     deadline: The deadline (in clock ticks, as returned by times()).
+ *
+ * RETURN VALUE
+ * The time remaining (in milliseconds), or 0 if the deadline has passed.
+ */
+static long remaining_milliseconds(clock_t deadline) {
+    struct tms unused; // process times (not used)
+    long remaining = (long) (deadline - times(&unused)); // the time remaining (in clock ticks)
+
+    return (remaining > 0) ? (remaining * 1000) / sysconf(_SC_CLK_TCK) : 0;
+}
@@ -0,0 +1,495 @@
+/*
+ * dependency.c
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains the functions for the dependencies between processes.
+ *
+ * A process can only depend on processes that were submitted before it (that
+ * have a lower ID), so the dependencies always form a directed acyclic graph.
+ * Each process counts the processes that it depends on that have not yet
+ * completed (its in-degree), and lists the processes that depend on it (its
+ * out-edges, by ID). Every process in the host dispatcher is held in a hash
+ * table by ID, so that the processes that a new process depends on can be
+ * found, and so that a process that depends on a process that has already
+ * completed (and so is no longer in the table) does not wait for it.
+ *
+ * A process that depends on other processes stays in the input queue after it
+ * arrives. When the last of them is removed, its arrival timer is set to expire
+ * immediately, so it is unloaded in the same tick. If a process is removed
+ * without completing (because it was rejected or cancelled), the processes
+ * that depend on it are released at once, whether or not they have arrived,
+ * and are discarded when they are unloaded.
+ *
+ * A job array is held as a single PCB, with the IDs of its other instances
+ * reserved, until each instance is split from it when it is admitted. A process
+ * that depends on any instance of a job array depends on the job array as a
+ * whole, whether or not that instance has been split off yet - the job arrays
+ * are listed so that a reserved ID can be found. A job array counts the
+ * instances split from it that have not yet been removed, and if it is removed
+ * before them it stays in the hash table until the last of them is removed.
+ * Only then are the processes that depend on it released, and they are
+ * discarded unless every instance completed.
+ */
+#include "../inc/dependency.h"
+#include "../inc/output.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static size_t hash(unsigned int id, size_t size);
+static PCB * find(DependencyTable * table, unsigned int id);
+static PCB * find_predecessor(DependencyTable * table, unsigned int id);
+static boolean grow(DependencyTable * table);
+static void unregister(DependencyTable * table, PCB * pcb);
+static boolean add_array(DependencyTable * table, PCB * array);
+static void remove_array(DependencyTable * table, PCB * array);
+static boolean add_dependent(PCB * pcb, unsigned int id);
+static void release_dependents(DependencyTable * table, PCB * pcb, boolean completed);
+
+/*
+ * Initialises an empty table of the dependencies between processes.
+ *
+ * PARAMETERS
+ *     table: The table of dependencies.
+ *     wheel: The timer wheel holding the arrival timers of processes.
+ */
+void dependency_init(DependencyTable * table, TimerWheel * wheel) {
+    table->entries = NULL;
+    table->size = 0;
+    table->count = 0;
+    table->arrays = NULL;
+    table->num_arrays = 0;
+    table->arrays_capacity = 0;
+    table->wheel = wheel;
+}
+
+/*
+ * Frees a table of the dependencies between processes. The processes
+ * themselves are not freed, other than job arrays that were removed before the
+ * instances split from them.
+ *
+ * PARAMETERS
+ *     table: The table of dependencies.
+ */
+void dependency_destroy(DependencyTable * table) {
+    for (size_t i = 0; i < table->size; i++) {
+        if ((table->entries[i] != NULL) && (table->entries[i]->instances == 0)) {
+            free(table->entries[i]->dependents);
+            free(table->entries[i]);
+        }
+    }
+
+    free(table->entries);
+    table->entries = NULL;
+    table->size = 0;
+    table->count = 0;
+    free(table->arrays);
+    table->arrays = NULL;
+    table->num_arrays = 0;
+    table->arrays_capacity = 0;
+    table->wheel = NULL;
+}
+
+/*
+ * Adds a process to the hash table of processes, so that processes submitted
+ * after it can depend on it.
+ *
+ * PARAMETERS
+ *     table: The table of dependencies.
+ *     pcb: The process.
+ */
+void dependency_register(DependencyTable * table, PCB * pcb) {
+    size_t i; // the entry for the process
+
+    if (find(table, pcb->id) == pcb) {
+        return;
+    }
+
+    // Count an instance split from a job array among the outstanding instances of the job array
+    if (pcb->array != 0) {
+        PCB * array = find(table, pcb->array); // the job array
+
+        if (array != NULL) {
+            array->outstanding++;
+        } else {
+            pcb->array = 0;
+        }
+    }
+
+    // The hash table is kept at most half full
+    if ((2 * (table->count + 1) > table->size) && !grow(table)) {
+        fprintf(__ERROR_OUTPUT, "Unable to allocate memory for the dependencies of PCB %d. Processes cannot depend on it.\n", pcb->id);
+        return;
+    }
+
+    for (i = hash(pcb->id, table->size); table->entries[i] != NULL; i = (i + 1) & (table->size - 1)) {
+        if (table->entries[i] == pcb) {
+            return;
+        }
+    }
+
+    table->entries[i] = pcb;
+    table->count++;
+
+    if ((pcb->instances > 1) && !add_array(table, pcb)) {
+        fprintf(__ERROR_OUTPUT, "Unable to allocate memory for the dependencies of PCB %d. Processes cannot depend on its other instances.\n", pcb->id);
+    }
+}
+
+/*
+ * Links a process to the processes that it depends on, that have not yet
+ * completed. A process that is no longer in the host dispatcher is assumed to
+ * have completed. A dependency on an instance of a job array is a dependency on
+ * the job array.
+ *
+ * PARAMETERS
+ *     table: The table of dependencies.
+ *     pcb: The process.
+ */
+void dependency_link(DependencyTable * table, PCB * pcb) {
+    for (unsigned int i = 0; i < pcb->num_dependencies; i++) {
+        PCB * predecessor = find_predecessor(table, pcb->dependencies[i]); // the process that must complete first
+
+        if ((predecessor != NULL) && (predecessor != pcb) && add_dependent(predecessor, pcb->id)) {
+            pcb->unmet_dependencies++;
+        }
+    }
+
+#ifdef DEBUG
+    if (pcb->unmet_dependencies > 0) {
+        fprintf(__DEBUG_OUTPUT, "PCB %d is waiting for %d processes to complete.\n", pcb->id, pcb->unmet_dependencies);
+    }
+#endif // #ifdef DEBUG
+}
+
+/*
+ * Adds a new process to the hash table of processes, and links it to the
+ * processes that it depends on.
+ *
+ * PARAMETERS
+ *     table: The table of dependencies.
+ *     pcb: The process.
+ */
+void dependency_add(DependencyTable * table, PCB * pcb) {
+    dependency_register(table, pcb);
+    dependency_link(table, pcb);
+}
+
+/*
+ * Removes a process from the hash table of processes, and releases the
+ * processes that depend on it. This is called when the process is freed. A
+ * process has completed if it has no remaining CPU time.
+ *
+ * A job array that is removed before the instances split from it is kept in
+ * the hash table, and is freed here once the last of them is removed.
+ *
+ * PARAMETERS
+ *     table: The table of dependencies.
+ *     pcb: The process.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the process can be freed (false if it is
+ * a job array that has been kept).
+ */
+boolean dependency_remove(DependencyTable * table, PCB * pcb) {
+    boolean completed = ((pcb->remaining_cpu_time == 0) && !pcb->instance_failed); // whether the process completed
+    PCB * array = (pcb->array != 0) ? find(table, pcb->array) : NULL; // the job array that the process was split from
+
+    remove_array(table, pcb);
+
+    // A job array waits for the instances split from it
+    if (pcb->outstanding > 0) {
+#ifdef DEBUG
+        fprintf(__DEBUG_OUTPUT, "PCB %d is waiting for %d instances to be removed.\n", pcb->id, pcb->outstanding);
+#endif // #ifdef DEBUG
+        pcb->instances = 0;
+        pcb->instance_failed = !completed;
+        return false;
+    }
+
+    unregister(table, pcb);
+    release_dependents(table, pcb, completed);
+
+    // The job array is released along with its last outstanding instance
+    if (array != NULL) {
+        array->outstanding--;
+        if (!completed) {
+            array->instance_failed = true;
+        }
+
+        if ((array->outstanding == 0) && (array->instances == 0)) {
+            unregister(table, array);
+            release_dependents(table, array, !array->instance_failed);
+            free(array);
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Checks whether a process is waiting for the processes that it depends on to
+ * complete. A process that depends on a process that did not complete is not
+ * waiting - it will never be executed.
+ *
+ * PARAMETERS
+ *     pcb: The process.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the process is waiting.
+ */
+boolean dependency_blocked(PCB * pcb) {
+    return ((pcb->unmet_dependencies > 0) && !pcb->dependency_failed);
+}
+
+/*
+ * Gets the entry of the hash table of processes that an ID hashes to.
+ *
+ * IDs are assigned in sequence, so taking their low bits directly would place
+ * the processes in one long run of entries, which every removal would have to
+ * scan. Multiplying by an odd number maps any run of consecutive IDs to
+ * distinct entries that are spread over the table.
+ *
+ * PARAMETERS
+ *     id: The ID of the process.
+ *     size: The number of entries in the hash table (a power of two).
+ *
+ * RETURN VALUE
+ * The index of the entry.
+ */
+static size_t hash(unsigned int id, size_t size) {
+    return (size_t) (id * DEPENDENCY_HASH) & (size - 1);
+}
+
+/*
+ * Finds a process in the hash table of processes.
+ *
+ * PARAMETERS
+ *     table: The table of dependencies.
+ *     id: The ID of the process.
+ *
+ * RETURN VALUE
+ * A pointer to the process, or NULL if it is not in the host dispatcher.
+ */
+static PCB * find(DependencyTable * table, unsigned int id) {
+    if (table->entries == NULL) {
+        return NULL;
+    }
+
+    for (size_t i = hash(id, table->size); table->entries[i] != NULL; i = (i + 1) & (table->size - 1)) {
+        if (table->entries[i]->id == id) {
+            return table->entries[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Finds the process that a process depends on, by ID. An instance of a job
+ * array resolves to the job array, whether or not it has been split off yet.
+ *
+ * PARAMETERS
+ *     table: The table of dependencies.
+ *     id: The ID of the process.
+ *
+ * RETURN VALUE
+ * A pointer to the process, or NULL if it is not in the host dispatcher.
+ */
+static PCB * find_predecessor(DependencyTable * table, unsigned int id) {
+    PCB * pcb = find(table, id); // the process with the ID
+
+    if (pcb == NULL) {
+        // The ID may be reserved for an instance that has not been split off yet
+        for (size_t i = 0; i < table->num_arrays; i++) {
+            if ((id < table->arrays[i]->id) && (id > table->arrays[i]->id - table->arrays[i]->instances)) {
+                return table->arrays[i];
+            }
+        }
+    } else if (pcb->array != 0) {
+        PCB * array = find(table, pcb->array); // the job array that the instance was split from
+
+        if (array != NULL) {
+            return array;
+        }
+    }
+
+    return pcb;
+}
+
+/*
+ * Doubles the size of the hash table of processes.
+ *
+ * PARAMETERS
+ *     table: The table of dependencies.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the hash table was grown.
+ */
+static boolean grow(DependencyTable * table) {
+    size_t size = (table->size == 0) ? DEPENDENCY_MIN_TABLE : (2 * table->size); // the new size of the hash table
+    PCB ** entries = (PCB **) calloc(size, sizeof(PCB *)); // the new hash table
+
+    if (entries == NULL) {
+        return false;
+    }
+
+    for (size_t i = 0; i < table->size; i++) {
+        if (table->entries[i] != NULL) {
+            size_t j; // the new entry for the process
+
+            for (j = hash(table->entries[i]->id, size); entries[j] != NULL; j = (j + 1) & (size - 1));
+            entries[j] = table->entries[i];
+        }
+    }
+
+    free(table->entries);
+    table->entries = entries;
+    table->size = size;
+    return true;
+}
+
+/*
+ * Removes a process from the hash table of processes. The processes after it
+ * in the same run of entries are moved back to fill the gap, so that no
+ * process becomes unreachable.
+ *
+ * PARAMETERS
+ *     table: The table of dependencies.
+ *     pcb: The process.
+ */
+static void unregister(DependencyTable * table, PCB * pcb) {
+    size_t i; // the entry for the process (and then the gap to be filled)
+
+    if (table->entries == NULL) {
+        return;
+    }
+
+    for (i = hash(pcb->id, table->size); table->entries[i] != pcb; i = (i + 1) & (table->size - 1)) {
+        if (table->entries[i] == NULL) {
+            return;
+        }
+    }
+
+    for (size_t j = (i + 1) & (table->size - 1); table->entries[j] != NULL; j = (j + 1) & (table->size - 1)) {
+        size_t home = hash(table->entries[j]->id, table->size); // the entry that the process at j hashes to
+
+        // The process at j can fill the gap unless it hashes to an entry after the gap (cyclically, up to j)
+        if ((i < j) ? ((home <= i) || (home > j)) : ((home <= i) && (home > j))) {
+            table->entries[i] = table->entries[j];
+            i = j;
+        }
+    }
+
+    table->entries[i] = NULL;
+    table->count--;
+}
+
+/*
+ * Adds a job array to the list of job arrays.
+ *
+ * PARAMETERS
+ *     table: The table of dependencies.
+ *     array: The job array.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the job array was added.
+ */
+static boolean add_array(DependencyTable * table, PCB * array) {
+    if (table->num_arrays == table->arrays_capacity) {
+        size_t capacity = (table->arrays_capacity == 0) ? 1 : (2 * table->arrays_capacity); // the new capacity
+        PCB ** arrays = (PCB **) realloc(table->arrays, capacity * sizeof(PCB *)); // the new list of job arrays
+
+        if (arrays == NULL) {
+            return false;
+        }
+        table->arrays = arrays;
+        table->arrays_capacity = capacity;
+    }
+
+    table->arrays[table->num_arrays++] = array;
+    return true;
+}
+
+/*
+ * Removes a job array from the list of job arrays, if it is in the list.
+ *
+ * PARAMETERS
+ *     table: The table of dependencies.
+ *     array: The job array.
+ */
+static void remove_array(DependencyTable * table, PCB * array) {
+    for (size_t i = 0; i < table->num_arrays; i++) {
+        if (table->arrays[i] == array) {
+            table->arrays[i] = table->arrays[--table->num_arrays];
+            return;
+        }
+    }
+}
+
+/*
+ * Records that a process depends on another process.
+ *
+ * PARAMETERS
+ *     pcb: The process that must complete first.
+ *     id: The ID of the process that depends on it.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the dependency was recorded.
+ */
+static boolean add_dependent(PCB * pcb, unsigned int id) {
+    if (pcb->num_dependents == pcb->dependents_capacity) {
+        unsigned int capacity = (pcb->dependents_capacity == 0) ? 1 : (2 * pcb->dependents_capacity); // the new capacity
+        unsigned int * dependents = (unsigned int *) realloc(pcb->dependents, capacity * sizeof(unsigned int)); // the new list of dependents
+
+        if (dependents == NULL) {
+            fprintf(__ERROR_OUTPUT, "Unable to allocate memory for the dependents of PCB %d. PCB %d will not wait for it.\n", pcb->id, id);
+            return false;
+        }
+        pcb->dependents = dependents;
+        pcb->dependents_capacity = capacity;
+    }
+
+    pcb->dependents[pcb->num_dependents++] = id;
+    return true;
+}
+
+/*
+ * Releases the processes that depend on a process that has been removed.
+ *
+ * PARAMETERS
+ *     table: The table of dependencies.
+ *     pcb: The process.
+ *     completed: Whether the process completed.
+ */
+static void release_dependents(DependencyTable * table, PCB * pcb, boolean completed) {
+    for (unsigned int i = 0; i < pcb->num_dependents; i++) {
+        PCB * dependent = find(table, pcb->dependents[i]); // a process that depends on this process
+
+        // The dependent may already have been removed (cancelled)
+        if (dependent == NULL) {
+            continue;
+        }
+
+        if (!completed) {
+            dependent->dependency_failed = true;
+        }
+        if (dependent->unmet_dependencies > 0) {
+            dependent->unmet_dependencies--;
+        }
+
+        // A dependent that has already arrived is unloaded straight away (a dependent that has not arrived yet is unloaded when it arrives), and a dependent that will never be executed is discarded straight away
+        if ((table->wheel != NULL) && (dependent->dependency_failed || ((dependent->unmet_dependencies == 0) && !timer_pending(&dependent->arrival_timer) && (dependent->arrival_time <= table->wheel->now)))) {
+#ifdef DEBUG
+            fprintf(__DEBUG_OUTPUT, "PCB %d has been released by PCB %d.\n", dependent->id, pcb->id);
+#endif // #ifdef DEBUG
+            timer_add(table->wheel, &dependent->arrival_timer, table->wheel->now, Timer_Arrival, dependent);
+        }
+    }
+
+    free(pcb->dependents);
+    pcb->dependents = NULL;
+    pcb->num_dependents = 0;
+    pcb->dependents_capacity = 0;
+}
@@ -0,0 +1,1898 @@
+/*
+ * dispatcher.c
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains the functions of the host dispatcher library.
+ *
+ * A host dispatcher is created with dispatcher_create() (or initialised in
+ * place with dispatcher_init()), processes are submitted to it with
+ * dispatcher_submit() (or read from a dispatch list with read_process_list()),
+ * and it is advanced one tick at a time with dispatcher_step() until
+ * finished() returns true. All of the state of a host dispatcher - its queues,
+ * clock, timers, memory, resources, dependencies, checkpoint and control
+ * socket - is held in its Dispatcher, so host dispatchers are independent of
+ * each other. Only the worker pool (see pool.c) and the cgroups (see cgroup.c)
+ * are shared by every host dispatcher in a process.
+ *
+ * A host dispatcher is owned by the thread that steps it. Its queues, memory,
+ * resources, timers and dependencies are only used by that thread, so they are
+ * not locked. Any other thread can submit processes with dispatcher_submit(),
+ * which pushes the process onto a lock-free stack that the owner takes in one
+ * exchange at the start of each tick (see collect_submitted()), so submitters
+ * never wait for the owner or for each other. Any other thread can query a
+ * process with dispatcher_query(), which takes the lock that the owner holds
+ * while it is dispatching (but not while it sleeps between ticks).
+ */
+#define _POSIX_C_SOURCE 200809L // for sleep()
+
+#include "../inc/dispatcher.h"
+#include "../inc/input.h"
+#include "../inc/PCB.h"
+#include "../inc/MAB.h"
+#include "../inc/RAS.h"
+#include "../inc/EDF.h"
+#include "../inc/admission.h"
+#include "../inc/pool.h"
+#include "../inc/control.h"
+#include "../inc/checkpoint.h"
+#include "../inc/dependency.h"
+#include "../inc/output.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+static unsigned long long now_usec(void);
+static unsigned int preferred_node(Dispatcher * dispatcher, PCB * pcb);
+static unsigned int largest_free_elsewhere(Dispatcher * dispatcher, unsigned int node);
+static int compare_times(const void * a, const void * b);
+
+/*
+ * Gets the default scheduling parameters of a host dispatcher.
+ *
+ * PARAMETERS
+ *     config: Set to the default scheduling parameters.
+ */
+void default_config(DispatcherConfig * config) {
+    config->quantum = QUANTUM;
+    config->feedback_levels = NUM_FEEDBACK_QUEUES;
+    config->reserved_memory = RESERVED_MEMORY;
+    config->migration_cost = MIGRATION_COST;
+    config->status_interval = STATUS_INTERVAL;
+    config->cpus = CPUS;
+    config->memory_nodes = MEMORY_NODES;
+    config->fast = false;
+    config->banker = false;
+    config->placement = First_Fit;
+    config->execution = Process_Execution;
+    config->enforcement = No_Enforcement;
+    config->suspend_method = Signal_Suspension;
+    config->accounting = Tick_Accounting;
+    config->workload = Sleep_Workload;
+}
+
+/*
+ * Checks that the scheduling parameters of a host dispatcher are valid,
+ * reporting the first parameter that is not.
+ *
+ * PARAMETERS
+ *     config: The scheduling parameters.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the scheduling parameters are valid.
+ */
+boolean check_config(DispatcherConfig * config) {
+    if (config->quantum == 0) {
+        fprintf(__ERROR_OUTPUT, "The quantum must be at least one tick.\n");
+        return false;
+    }
+
+    if ((config->feedback_levels == 0) || (config->feedback_levels > MAX_FEEDBACK_QUEUES)) {
+        fprintf(__ERROR_OUTPUT, "The number of feedback levels must be between 1 and %d.\n", MAX_FEEDBACK_QUEUES);
+        return false;
+    }
+
+    if ((config->memory_nodes == 0) || (config->memory_nodes > MAX_MEMORY_NODES)) {
+        fprintf(__ERROR_OUTPUT, "The number of memory nodes must be between 1 and %d.\n", MAX_MEMORY_NODES);
+        return false;
+    }
+
+    // The reserved memory must fit within a single memory node
+    if (config->reserved_memory >= AVAILABLE_MEMORY / config->memory_nodes) {
+        fprintf(__ERROR_OUTPUT, "The reserved memory must be less than %d MB.\n", AVAILABLE_MEMORY / config->memory_nodes);
+        return false;
+    }
+
+    if ((config->cpus == 0) || (config->cpus > MAX_GANG)) {
+        fprintf(__ERROR_OUTPUT, "The number of CPUs must be between 1 and %d.\n", MAX_GANG);
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Gets the name of a scheduling parameter, as accepted on the command line.
+ *
+ * PARAMETERS
+ *     parameter: The scheduling parameter.
+ *
+ * RETURN VALUE
+ * The name of the scheduling parameter.
+ */
+const char * config_parameter_name(ConfigParameter parameter) {
+    switch (parameter) {
+        case Feedback_Levels_Parameter:
+            return "levels";
+        case Reserved_Memory_Parameter:
+            return "reserved";
+        case Migration_Cost_Parameter:
+            return "migration";
+        default:
+            return "quantum";
+    }
+}
+
+/*
+ * Gets the value of a scheduling parameter.
+ *
+ * PARAMETERS
+ *     config: The scheduling parameters.
+ *     parameter: The scheduling parameter.
+ *
+ * RETURN VALUE
+ * The value of the scheduling parameter.
+ */
+unsigned int get_config_parameter(DispatcherConfig * config, ConfigParameter parameter) {
+    switch (parameter) {
+        case Feedback_Levels_Parameter:
+            return config->feedback_levels;
+        case Reserved_Memory_Parameter:
+            return config->reserved_memory;
+        case Migration_Cost_Parameter:
+            return config->migration_cost;
+        default:
+            return config->quantum;
+    }
+}
+
+/*
+ * Sets the value of a scheduling parameter. The value is not checked (see
+ * check_config()).
+ *
+ * PARAMETERS
+ *     config: The scheduling parameters.
+ *     parameter: The scheduling parameter.
+ *     value: The new value of the scheduling parameter.
+ */
+void set_config_parameter(DispatcherConfig * config, ConfigParameter parameter, unsigned int value) {
+    switch (parameter) {
+        case Feedback_Levels_Parameter:
+            config->feedback_levels = value;
+            break;
+        case Reserved_Memory_Parameter:
+            config->reserved_memory = value;
+            break;
+        case Migration_Cost_Parameter:
+            config->migration_cost = value;
+            break;
+        default:
+            config->quantum = value;
+            break;
+    }
+}
+
+/*
+ * Splits a 'name=value' command line option into a scheduling parameter and
+ * its value (or values).
+ *
+ * PARAMETERS
+ *     option: The option. This string is modified.
+ *     parameter: Set to the scheduling parameter.
+ *     value: Set to the text after the '='.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the option names a scheduling parameter.
+ */
+boolean parse_config_option(char * option, ConfigParameter * parameter, char ** value) {
+    char * separator = strchr(option, '='); // the end of the name
+
+    if (separator != NULL) {
+        *separator = '\0';
+        *value = separator + 1;
+        for (*parameter = 0; *parameter < NUM_CONFIG_PARAMETERS; (*parameter)++) {
+            if (strcmp(option, config_parameter_name(*parameter)) == 0) {
+                return true;
+            }
+        }
+    }
+
+    fprintf(__ERROR_OUTPUT, "Unknown scheduling parameter '%s'.\n", option);
+    return false;
+}
+
+/*
+ * Sets a scheduling parameter from a 'name=value' command line option.
+ *
+ * PARAMETERS
+ *     config: The scheduling parameters.
+ *     option: The option. This string is modified.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the option was valid.
+ */
+boolean set_config_option(DispatcherConfig * config, char * option) {
+    ConfigParameter parameter; // the scheduling parameter
+    char * value; // the value of the scheduling parameter
+    char * end; // the end of the value
+
+    if (!parse_config_option(option, &parameter, &value)) {
+        return false;
+    }
+
+    set_config_parameter(config, parameter, (unsigned int) strtoul(value, &end, 10));
+    if ((end == value) || (*end != '\0')) {
+        fprintf(__ERROR_OUTPUT, "Invalid value '%s' for scheduling parameter '%s'.\n", value, option);
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Creates a host dispatcher with no processes (see dispatcher_init()).
+ *
+ * PARAMETERS
+ *     config: The scheduling parameters, and how processes are executed. These
+ *         must be valid (see check_config()).
+ *
+ * RETURN VALUE
+ * A pointer to the host dispatcher, or NULL if there is no memory for it.
+ */
+Dispatcher * dispatcher_create(DispatcherConfig * config) {
+    Dispatcher * dispatcher = (Dispatcher *) malloc(sizeof(Dispatcher)); // the host dispatcher
+
+    if (dispatcher == NULL) {
+        fprintf(__ERROR_OUTPUT, "Unable to allocate memory for the host dispatcher.\n");
+        return NULL;
+    }
+
+    if (!dispatcher_init(dispatcher, config)) {
+        free(dispatcher);
+        return NULL;
+    }
+    return dispatcher;
+}
+
+/*
+ * Frees a host dispatcher created by dispatcher_create(), along with all of its
+ * processes (see dispatcher_destroy()).
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ */
+void dispatcher_free(Dispatcher * dispatcher) {
+    if (dispatcher != NULL) {
+        dispatcher_destroy(dispatcher);
+        free(dispatcher);
+    }
+}
+
+/*
+ * Initialises a host dispatcher with no processes, along with its memory and
+ * resources. Checkpointing and the control socket are disabled (see
+ * checkpoint_init() and control_init()).
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher to initialise.
+ *     config: The scheduling parameters, and how processes are executed.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the host dispatcher was initialised. If
+ * it was not, nothing remains allocated.
+ */
+boolean dispatcher_init(Dispatcher * dispatcher, DispatcherConfig * config) {
+    dispatcher->config = *config;
+    dispatcher->input_queue = NULL;
+    dispatcher->input_tail = NULL;
+    edf_init(&dispatcher->real_time_queue);
+    dispatcher->user_job_queue = NULL;
+    for (unsigned int i = 0; i < MAX_FEEDBACK_QUEUES; i++) {
+        dispatcher->feedback_queue[i] = NULL;
+    }
+    dispatcher->active = NULL;
+    dispatcher->submitted = NULL;
+    dispatcher->clock = 0;
+    dispatcher->next_id = 1;
+    dispatcher->admission_wake = true;
+    memset(&dispatcher->admission_capacity, 0, sizeof(Capacity));
+    memset(dispatcher->admission_node_free, 0, sizeof(dispatcher->admission_node_free));
+    dispatcher->deadlines_met = 0;
+    dispatcher->deadlines_missed = 0;
+    dispatcher->real_time_rejected = 0;
+    dispatcher->memory_compactions = 0;
+    dispatcher->memory_relocated = 0;
+    dispatcher->compaction_admissions = 0;
+    dispatcher->compaction_cpu_time = 0;
+    dispatcher->memory_spills = 0;
+    timer_init(&dispatcher->timers, dispatcher->clock);
+    timer_clear(&dispatcher->quantum_timer);
+    dispatcher->quantum_start = 0;
+    timer_clear(&dispatcher->status_timer);
+    dispatcher->turnaround_times = NULL;
+    dispatcher->num_turnaround_times = 0;
+    dispatcher->turnaround_capacity = 0;
+    dispatcher->dispatch_usec = 0;
+    dispatcher->checkpoint = NULL;
+    dispatcher->control = NULL;
+    pthread_mutex_init(&dispatcher->lock, NULL);
+    dependency_init(&dispatcher->dependencies, &dispatcher->timers);
+
+    // Initialise resources
+    create_resources(&dispatcher->resources, AVAILABLE_PRINTERS, AVAILABLE_SCANNERS, AVAILABLE_MODEMS, AVAILABLE_CDS);
+    banker_init(&dispatcher->banker);
+
+    // Initialise memory resources - the available memory is divided evenly between the memory nodes (any remainder is given to the last node)
+    memset(dispatcher->memory, 0, sizeof(dispatcher->memory));
+    for (unsigned int i = 0; i < config->memory_nodes; i++) {
+        unsigned int size = AVAILABLE_MEMORY / config->memory_nodes; // the size of the node
+
+        if (i == config->memory_nodes - 1) {
+            size += AVAILABLE_MEMORY % config->memory_nodes;
+        }
+        if (mem_init(&dispatcher->memory[i], size) == NULL) {
+            fprintf(__ERROR_OUTPUT, "Unable to initialise memory node %d.\n", i);
+            dispatcher_destroy(dispatcher);
+            return false;
+        }
+        mem_set_node(&dispatcher->memory[i], i, i * (AVAILABLE_MEMORY / config->memory_nodes));
+        mem_set_policy(&dispatcher->memory[i], config->placement);
+    }
+
+    return true;
+}
+
+/*
+ * Frees the processes of a host dispatcher, along with its memory and
+ * resources. Only processes that have been started (PID is non-zero) are
+ * terminated. The control socket and the checkpoint are removed.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ */
+void dispatcher_destroy(Dispatcher * dispatcher) {
+    control_destroy(dispatcher);
+    checkpoint_destroy(dispatcher);
+
+    if (dispatcher->active != NULL) {
+        terminate_PCB(dispatcher, &dispatcher->active);
+        free_PCB(dispatcher, &dispatcher->active);
+        dispatcher->active = NULL;
+    }
+
+    collect_submitted(dispatcher);
+    while (dispatcher->input_queue != NULL) {
+        PCB * tmp = dequeue_PCB(&dispatcher->input_queue);
+        free_PCB(dispatcher, &tmp);
+    }
+    dispatcher->input_tail = NULL;
+
+    while (dispatcher->user_job_queue != NULL) {
+        PCB * tmp = dequeue_PCB(&dispatcher->user_job_queue);
+        free_PCB(dispatcher, &tmp);
+    }
+
+    while (edf_peek(&dispatcher->real_time_queue) != NULL) {
+        PCB * tmp = edf_dequeue(&dispatcher->real_time_queue);
+        if (tmp->pid != 0) {
+            terminate_PCB(dispatcher, &tmp);
+        }
+        free_PCB(dispatcher, &tmp);
+    }
+    edf_free(&dispatcher->real_time_queue);
+
+    for (unsigned int i = 0; i < dispatcher->config.feedback_levels; i++) {
+        while (dispatcher->feedback_queue[i] != NULL) {
+            PCB * tmp = dequeue_PCB(&dispatcher->feedback_queue[i]);
+            if (tmp->pid != 0) {
+                terminate_PCB(dispatcher, &tmp);
+            }
+            free_PCB(dispatcher, &tmp);
+        }
+    }
+
+    dependency_destroy(&dispatcher->dependencies);
+    free(dispatcher->turnaround_times);
+    dispatcher->turnaround_times = NULL;
+    for (unsigned int i = 0; i < dispatcher->config.memory_nodes; i++) {
+        mem_destroy(&dispatcher->memory[i]);
+    }
+    banker_destroy(&dispatcher->banker);
+    resource_destroy(&dispatcher->resources);
+    pthread_mutex_destroy(&dispatcher->lock);
+}
+
+/*
+ * Submits a process to a host dispatcher. The process is added to the input
+ * queue at the start of the next tick (see submit_PCB()). This function can be
+ * called from any thread.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     record: The process record.
+ *
+ * RETURN VALUE
+ * The ID of the process, or 0 if the process could not be created (or can
+ * never be admitted).
+ */
+unsigned int dispatcher_submit(Dispatcher * dispatcher, ProcessRecord * record) {
+    PCB * pcb = create_submitted_process(dispatcher, record); // the submitted process
+    unsigned int id; // the ID of the process
+
+    if (pcb == NULL) {
+        return 0;
+    }
+
+    // Once submitted, the process belongs to the thread stepping the host dispatcher, which may free it at any time
+    id = pcb->id;
+    submit_PCB(dispatcher, pcb);
+    return id;
+}
+
+/*
+ * Adds a process to the processes that are added to the input queue at the
+ * start of the next tick. The process is pushed onto the head of a lock-free
+ * stack, so this function can be called from any thread.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     pcb: The submitted process.
+ */
+void submit_PCB(Dispatcher * dispatcher, PCB * pcb) {
+    PCB * head = __atomic_load_n(&dispatcher->submitted, __ATOMIC_RELAXED); // the most recently submitted process
+
+    pcb->prev = NULL;
+    do {
+        pcb->next = head;
+    } while (!__atomic_compare_exchange_n(&dispatcher->submitted, &head, pcb, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+/*
+ * Adds the processes that have been submitted to the tail of the input queue,
+ * in the order in which they were submitted.
+ *
+ * A process cannot arrive in the past, so a process with an arrival time
+ * earlier than the clock arrives now instead, and its deadline (if any) is
+ * moved by the same amount.
+ *
+ * This function uses the input queue of the host dispatcher.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ */
+void collect_submitted(Dispatcher * dispatcher) {
+    PCB * head = NULL; // the first of the submitted processes
+    PCB * pcb; // the submitted processes, most recent first
+
+    if ((pcb = __atomic_exchange_n(&dispatcher->submitted, NULL, __ATOMIC_ACQUIRE)) == NULL) {
+        return;
+    }
+
+    // Reverse the stack of submitted processes into a queue
+    while (pcb != NULL) {
+        PCB * next = pcb->next; // the process submitted before this process
+
+        pcb->next = head;
+        if (head != NULL) {
+            head->prev = pcb;
+        }
+        head = pcb;
+        pcb = next;
+    }
+
+    for (pcb = head; pcb != NULL; pcb = pcb->next) {
+        if (pcb->arrival_time < dispatcher->clock) {
+            if (pcb->deadline != 0) {
+                pcb->deadline += dispatcher->clock - pcb->arrival_time;
+            }
+            pcb->arrival_time = dispatcher->clock;
+        }
+        dependency_add(&dispatcher->dependencies, pcb);
+    }
+    for (pcb = head; pcb != NULL; pcb = pcb->next) {
+        checkpoint_PCB(dispatcher->checkpoint, pcb, Checkpoint_Input);
+    }
+    schedule_arrivals(dispatcher, head);
+    append_to_input_queue(dispatcher, head);
+}
+
+/*
+ * Adds a list of processes to the tail of the input queue. Only the list is
+ * walked (to find its tail), so appending to a long input queue is no slower
+ * than appending to an empty one.
+ *
+ * This function uses the input queue of the host dispatcher.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     head: The head of the list of processes (may be NULL).
+ */
+void append_to_input_queue(Dispatcher * dispatcher, PCB * head) {
+    PCB * tail = head; // the tail of the list
+
+    if (head == NULL) {
+        return;
+    }
+    while (tail->next != NULL) {
+        tail = tail->next;
+    }
+
+    if (dispatcher->input_tail == NULL) {
+        dispatcher->input_queue = head;
+    } else {
+        dispatcher->input_tail->next = head;
+        head->prev = dispatcher->input_tail;
+    }
+    dispatcher->input_tail = tail;
+}
+
+/*
+ * Removes a process from the input queue, keeping track of the tail of the
+ * input queue.
+ *
+ * This function uses the input queue of the host dispatcher.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     pcb: The process to remove (which must be in the input queue).
+ */
+void remove_from_input_queue(Dispatcher * dispatcher, PCB * pcb) {
+    if (pcb->prev == NULL) {
+        dispatcher->input_queue = pcb->next;
+    } else {
+        pcb->prev->next = pcb->next;
+    }
+    if (pcb->next == NULL) {
+        dispatcher->input_tail = pcb->prev;
+    } else {
+        pcb->next->prev = pcb->prev;
+    }
+    pcb->prev = NULL;
+    pcb->next = NULL;
+}
+
+/*
+ * Gets the status of a process in a host dispatcher. This function can be
+ * called from any thread, other than the thread stepping the host dispatcher
+ * whilst it holds the lock (see get_process_status()).
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     id: The ID of the process.
+ *     status: Set to the status of the process, if found.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the process was found.
+ */
+boolean dispatcher_query(Dispatcher * dispatcher, unsigned int id, ProcessStatus * status) {
+    boolean found; // whether the process was found
+
+    dispatcher_lock(dispatcher);
+    found = get_process_status(dispatcher, id, status);
+    dispatcher_unlock(dispatcher);
+    return found;
+}
+
+/*
+ * Gets the status of a process in a host dispatcher, from the thread stepping
+ * the host dispatcher.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     id: The ID of the process.
+ *     status: Set to the status of the process, if found.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the process was found.
+ */
+boolean get_process_status(Dispatcher * dispatcher, unsigned int id, ProcessStatus * status) {
+    PCB * pcb = NULL; // the process
+    unsigned int level = 0; // the feedback queue of the process
+    Location location = dispatcher_find(dispatcher, id, &pcb, &level); // where the process is
+
+    if (location == Not_Found) {
+        return false;
+    }
+
+    status->id = pcb->id;
+    status->pid = pcb->pid;
+    status->remaining_cpu_time = pcb->remaining_cpu_time;
+    status->priority = pcb->priority;
+    status->location = location;
+    status->level = level;
+    return true;
+}
+
+/*
+ * Finds a process in a host dispatcher.
+ *
+ * This function uses the input queue, user job queue, real time queue, feedback
+ * queues and active process of the host dispatcher, and the processes that have
+ * been submitted to it.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     id: The ID of the process.
+ *     pcb: Set to the process, if found.
+ *     level: Set to the index of the feedback queue containing the process, if
+ *         the process is in a feedback queue.
+ *
+ * RETURN VALUE
+ * The location of the process.
+ */
+Location dispatcher_find(Dispatcher * dispatcher, unsigned int id, PCB ** pcb, unsigned int * level) {
+    if ((dispatcher->active != NULL) && (dispatcher->active->id == id)) {
+        *pcb = dispatcher->active;
+        return Active_Process;
+    }
+
+    for (unsigned int i = 0; i < dispatcher->real_time_queue.size; i++) {
+        if (dispatcher->real_time_queue.heap[i]->id == id) {
+            *pcb = dispatcher->real_time_queue.heap[i];
+            return Real_Time_Queue;
+        }
+    }
+
+    for (unsigned int i = 0; i < dispatcher->config.feedback_levels; i++) {
+        for (PCB * p = dispatcher->feedback_queue[i]; p != NULL; p = p->next) {
+            if (p->id == id) {
+                *pcb = p;
+                *level = i;
+                return Feedback_Queue;
+            }
+        }
+    }
+
+    for (PCB * p = dispatcher->user_job_queue; p != NULL; p = p->next) {
+        if (p->id == id) {
+            *pcb = p;
+            return User_Job_Queue;
+        }
+    }
+
+    for (PCB * p = dispatcher->input_queue; p != NULL; p = p->next) {
+        if (p->id == id) {
+            *pcb = p;
+            return Input_Queue;
+        }
+    }
+
+    for (PCB * p = __atomic_load_n(&dispatcher->submitted, __ATOMIC_ACQUIRE); p != NULL; p = p->next) {
+        if (p->id == id) {
+            *pcb = p;
+            return Submitted;
+        }
+    }
+
+    return Not_Found;
+}
+
+/*
+ * The main functional component of the host dispatcher. This function "ticks"
+ * time and initiates the relevant process, memory and resource operation at
+ * each clock tick.
+ *
+ * This function uses the clock, input queue, user job queue, real time queue,
+ * feedback queues, active process, memory and resources of the host
+ * dispatcher.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ */
+void dispatcher_step(Dispatcher * dispatcher) {
+    PCB ** next = NULL; // the next process to execute - from either the real time queue or a feedback queue
+    unsigned int charged = 0; // CPU time charged to the active process for the previous tick
+    boolean completed = false; // whether the active process completed during the previous tick
+    boolean quantum_expired; // whether the quantum of the active process has expired
+    unsigned int next_event; // the time of the next event
+    unsigned int ticks = 1; // number of ticks until the next event
+    unsigned long long start = now_usec(); // time at which the tick started
+
+    // Other threads cannot query the host dispatcher whilst it is dispatching
+    dispatcher_lock(dispatcher);
+
+    // A blank line will separate ticks in the output
+    fprintf(__STANDARD_OUTPUT, "\n");
+
+    // Unload pending processes from the associated queues (after collecting processes submitted over the control socket and the submission ring)
+    control_collect(dispatcher->control);
+    collect_submitted(dispatcher);
+    timer_advance(&dispatcher->timers, dispatcher->clock);
+    unload_pending_input_processes(dispatcher);
+    check_timeouts(dispatcher);
+    unload_pending_user_processes(dispatcher);
+
+    // The quantum of an active process that is blocked or sleeping ends early if another process is ready to run
+    quantum_expired = (timer_expired(&dispatcher->timers, Timer_Quantum) != NULL);
+    if (!quantum_expired && (dispatcher->active != NULL) && timer_pending(&dispatcher->quantum_timer) && (next_queued_PCB(dispatcher, dispatcher->active->priority) != NULL) && cpu_idle(dispatcher, dispatcher->active, dispatcher->quantum_start)) {
+#ifdef DEBUG
+        fprintf(__DEBUG_OUTPUT, "PCB %d is idle. Ending its quantum early.\n", dispatcher->active->id);
+#endif // #ifdef DEBUG
+        timer_cancel(&dispatcher->quantum_timer);
+        quantum_expired = true;
+    }
+
+    // If the quantum of the active process has expired, charge it for the CPU time it used (terminating the process if time has expired)
+    if (quantum_expired && (dispatcher->active != NULL)) {
+        unsigned int id = dispatcher->active->id; // the ID of the active process
+
+        charged = cpu_time_to_charge(dispatcher, dispatcher->active, dispatcher->clock - dispatcher->quantum_start);
+        record_deadline(dispatcher, dispatcher->active, charged);
+        record_turnaround(dispatcher, dispatcher->active, charged);
+        dispatcher->active = charge_cpu_time(dispatcher, &dispatcher->active, charged);
+        if (dispatcher->active == NULL) {
+            checkpoint_remove(dispatcher->checkpoint, id);
+            completed = true;
+        }
+
+        // Make sure there is still an active process - ie. that the active process hasn't terminated
+        if (dispatcher->active != NULL) {
+            // A real time process is only preempted by a real time process with an earlier deadline (and only if the memory for that process can be allocated)
+            if (dispatcher->active->priority == REAL_TIME_PROCESS_PRIORITY) {
+                PCB * head = edf_peek(&dispatcher->real_time_queue); // the queued real time process with the earliest deadline
+                if ((head != NULL) && edf_before(head, dispatcher->active) && ((head->pid != 0) || allocate_memory_and_resources(dispatcher, head))) {
+#ifdef DEBUG
+                    fprintf(__DEBUG_OUTPUT, "PCB %d has an earlier deadline than real time PCB %d. Preempting PCB %d.\n", head->id, dispatcher->active->id, dispatcher->active->id);
+#endif // #ifdef DEBUG
+                    // Return the active process to the real time queue and suspend it (if the queue cannot grow, the process keeps running rather than being lost)
+                    if (edf_enqueue(&dispatcher->real_time_queue, dispatcher->active) != NULL) {
+                        PCB * p = suspend_PCB(dispatcher, &dispatcher->active);
+                        dispatcher->active = NULL;
+                        checkpoint_PCB(dispatcher->checkpoint, p, Checkpoint_Real_Time);
+
+                        // The real time queue may have been reallocated
+                        next = next_queued_PCB(dispatcher, REAL_TIME_PROCESS_PRIORITY);
+                    }
+                }
+#ifdef DEBUG
+                else {
+                    fprintf(__DEBUG_OUTPUT, "PCB %d is a real time process with the earliest deadline. No need to suspend process.\n", dispatcher->active->id);
+                }
+#endif // #ifdef DEBUG
+            } else {
+                // Check if there are any ready queued processes (with an equal or higher priority) on the feedback queues
+                if ((next = next_queued_PCB(dispatcher, dispatcher->active->priority)) != NULL) {
+                    // Suspend the active process
+                    PCB * p = suspend_PCB(dispatcher, &dispatcher->active);
+                    dispatcher->active = NULL;
+
+                    // A process that was not charged for the previous tick (because it was blocked) keeps its priority
+                    if (charged > 0) {
+                        p = lower_priority(&p, dispatcher->config.feedback_levels);
+                    }
+
+#ifdef DEBUG
+                    fprintf(__DEBUG_OUTPUT, "Enqueuing PCB %d onto feedback queue RQ%d.\n", p->id, p->priority);
+#endif // #ifdef DEBUG
+                    enqueue_PCB(&dispatcher->feedback_queue[p->priority - 1], &p);
+                    checkpoint_PCB(dispatcher->checkpoint, p, Checkpoint_Feedback);
+                }
+#ifdef DEBUG
+                else {
+                    fprintf(__DEBUG_OUTPUT, "No ready PCBs with priority greater than or equal to %d in feedback queues. No need to suspend active PCB %d.\n", dispatcher->active->priority, dispatcher->active->id);
+                }
+#endif // #ifdef DEBUG
+            }
+        }
+    }
+
+    // Processes that were waiting for the completed process are unloaded straight away, so that they can be started in this tick
+    if (completed) {
+        unload_pending_input_processes(dispatcher);
+        unload_pending_user_processes(dispatcher);
+    }
+
+    // If there is no next PCB specified, get the next queued PCB of any priority
+    if (next == NULL) {
+        next = next_queued_PCB(dispatcher, dispatcher->config.feedback_levels);
+    }
+
+    // If there is no active process but there is a ready queued process, then start/resume the next process
+    if ((dispatcher->active == NULL)) {
+        if (next != NULL) {
+            // The quantum of a process that was removed whilst active (killed over the control socket) does not carry over
+            timer_cancel(&dispatcher->quantum_timer);
+
+            // Remove next PCB from its queue and set is as the active PCB
+            dispatcher->active = dequeue_next_PCB(dispatcher, next);
+
+            // Process has been started if its PID is non-zero
+            if (dispatcher->active->pid != 0) {
+                // Resume the active process
+                restart_PCB(dispatcher, &dispatcher->active);
+            } else {
+                // If this is a real time process, allocate memory and resources (in real time, obviously)
+                if ((dispatcher->active->priority == REAL_TIME_PROCESS_PRIORITY) && (dispatcher->active->memory == NULL)) {
+                    if (!allocate_memory_and_resources(dispatcher, dispatcher->active)) {
+                        fprintf(__ERROR_OUTPUT, "Failed to allocate memory and resources for real time process PCB %d. This process will not be executed.\n", dispatcher->active->id);
+                        checkpoint_remove(dispatcher->checkpoint, dispatcher->active->id);
+                        free_PCB(dispatcher, &dispatcher->active);
+                        dispatcher->active = NULL;
+                    }
+#ifdef DEBUG
+                    else {
+                        fprintf(__DEBUG_OUTPUT, "Allocated memory and resources for real time process PCB %d.\n", dispatcher->active->id);
+                    }
+#endif // #ifdef DEBUG
+                }
+
+                // Start the active process - a process that cannot be started (or a gang that cannot be started as a whole) is removed, releasing its memory and resources
+                if ((dispatcher->active != NULL) && (start_PCB(dispatcher, &dispatcher->active) == NULL)) {
+                    fprintf(__ERROR_OUTPUT, "Failed to start PCB %d. This process will not be executed.\n", dispatcher->active->id);
+                    dispatcher->active->memory = free_memory(dispatcher, dispatcher->active->memory);
+                    banker_remove(&dispatcher->banker, dispatcher->active);
+                    resource_free(&dispatcher->resources, dispatcher->active);
+                    checkpoint_remove(dispatcher->checkpoint, dispatcher->active->id);
+                    free_PCB(dispatcher, &dispatcher->active);
+                    dispatcher->active = NULL;
+                }
+            }
+        }
+#ifdef DEBUG
+        else {
+            fprintf(__DEBUG_OUTPUT, "There is no process ready to execute at this stage.\n");
+        }
+#endif // #ifdef DEBUG
+    }
+
+    // The active process runs until its quantum expires, or until it would complete
+    if ((dispatcher->active != NULL) && !timer_pending(&dispatcher->quantum_timer)) {
+        unsigned int quantum = dispatcher->config.quantum; // length of the quantum
+
+        if ((dispatcher->active->remaining_cpu_time > 0) && (dispatcher->active->remaining_cpu_time < quantum)) {
+            quantum = dispatcher->active->remaining_cpu_time;
+        }
+        dispatcher->quantum_start = dispatcher->clock;
+        timer_add(&dispatcher->timers, &dispatcher->quantum_timer, dispatcher->clock + quantum, Timer_Quantum, NULL);
+    }
+
+    // Replace any workers that were used to start processes
+    pool_refill();
+
+    // Find the next event - a process can be submitted over the control socket at any time, so the control socket is served one tick at a time (as is an active process whose CPU time is measured, to notice when it is idle)
+    if ((control_state(dispatcher->control) == Control_Disabled) && ((dispatcher->config.accounting == Tick_Accounting) || (dispatcher->active == NULL)) && !finished(dispatcher) && timer_next(&dispatcher->timers, &next_event) && (next_event > dispatcher->clock + 1)) {
+        ticks = next_event - dispatcher->clock;
+    }
+
+    // Advance the clock and sleep until the next event to emulate real 'ticks' - serving the control socket in the meantime, if it is enabled
+#ifdef DEBUG
+    fprintf(__DEBUG_OUTPUT, "Ticking %d.\n", ticks);
+#endif // #ifdef DEBUG
+    dispatcher->clock += ticks;
+    checkpoint_commit(dispatcher->checkpoint);
+    dispatcher->dispatch_usec += now_usec() - start;
+    dispatcher_unlock(dispatcher);
+    if (control_state(dispatcher->control) != Control_Disabled) {
+        control_serve(dispatcher->control, dispatcher->config.fast ? 0 : 1000);
+    } else if (!dispatcher->config.fast) {
+        sleep(ticks);
+    }
+    dispatcher_lock(dispatcher);
+    start = now_usec();
+
+    // Output current dispatcher status, if it is due
+    timer_advance(&dispatcher->timers, dispatcher->clock);
+    if (timer_expired(&dispatcher->timers, Timer_Status) != NULL) {
+        print_status(dispatcher);
+        timer_add(&dispatcher->timers, &dispatcher->status_timer, dispatcher->clock + dispatcher->config.status_interval, Timer_Status, NULL);
+    }
+    dispatcher->dispatch_usec += now_usec() - start;
+    dispatcher_unlock(dispatcher);
+}
+
+/*
+ * Locks a host dispatcher against other threads. The thread stepping the host
+ * dispatcher holds the lock whilst it is dispatching, and whilst it serves the
+ * requests on the control socket.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ */
+void dispatcher_lock(Dispatcher * dispatcher) {
+    pthread_mutex_lock(&dispatcher->lock);
+}
+
+/*
+ * Unlocks a host dispatcher locked with dispatcher_lock().
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ */
+void dispatcher_unlock(Dispatcher * dispatcher) {
+    pthread_mutex_unlock(&dispatcher->lock);
+}
+
+/*
+ * Unload any pending processes from the input queue to the user job queue or
+ * real time queue. A process is pending once its arrival timer has expired. A
+ * process that depends on other processes stays in the input queue until they
+ * have completed (its arrival timer expires again then), and a process that
+ * depends on a process that did not complete is discarded.
+ *
+ * This function uses the clock, timer wheel, input queue and user job queue of
+ * the host dispatcher.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ */
+void unload_pending_input_processes(Dispatcher * dispatcher) {
+    PCB * user_job_tail = NULL; // the tail of the user job queue (found when the first process is unloaded to it)
+    Timer * timer; // the arrival timer of the next process to unload
+#ifdef DEBUG
+
+    fprintf(__DEBUG_OUTPUT, "Unloading any pending processes from the input queue.\n");
+#endif // #ifdef DEBUG
+
+    // Unload processes from the input queue in the order that they arrived (processes that arrived at the same time are unloaded in input queue order)
+    while ((timer = timer_expired(&dispatcher->timers, Timer_Arrival)) != NULL) {
+        PCB * p = (PCB *) timer->data; // the process that has arrived
+
+        // A process waiting for other processes to complete stays in the input queue
+        if (dependency_blocked(p)) {
+#ifdef DEBUG
+            fprintf(__DEBUG_OUTPUT, "PCB %d is waiting for %d processes to complete.\n", p->id, p->unmet_dependencies);
+#endif // #ifdef DEBUG
+            continue;
+        }
+
+        // Remove the process from the input queue
+        remove_from_input_queue(dispatcher, p);
+
+        // Check if PCB depends on a process that did not complete
+        if (p->dependency_failed) {
+            fprintf(__ERROR_OUTPUT, "PCB %d depends on a process that did not complete. This process will not be executed.\n", p->id);
+            checkpoint_remove(dispatcher->checkpoint, p->id);
+            free_PCB(dispatcher, &p);
+        } else if (p->priority == REAL_TIME_PROCESS_PRIORITY) {
+            // Check that the deadline of the process can be met without causing other real time processes to miss their deadlines
+            if (edf_admit(&dispatcher->real_time_queue, dispatcher->active, p, dispatcher->clock)) {
+#ifdef DEBUG
+                fprintf(__DEBUG_OUTPUT, "Unloading PCB %d to real time queue.\n", p->id);
+
+#endif // #ifdef DEBUG
+                // Add the process to the real time queue
+                if (edf_enqueue(&dispatcher->real_time_queue, p) == NULL) {
+                    checkpoint_remove(dispatcher->checkpoint, p->id);
+                    free_PCB(dispatcher, &p);
+                } else {
+                    schedule_deadline(dispatcher, p);
+                    checkpoint_PCB(dispatcher->checkpoint, p, Checkpoint_Real_Time);
+                }
+            } else {
+                fprintf(__ERROR_OUTPUT, "Real time PCB %d cannot meet its deadline (%d). This process will not be executed.\n", p->id, p->deadline);
+                dispatcher->real_time_rejected++;
+                checkpoint_remove(dispatcher->checkpoint, p->id);
+                free_PCB(dispatcher, &p);
+            }
+        } else {
+#ifdef DEBUG
+            fprintf(__DEBUG_OUTPUT, "Unloading PCB %d to user job queue.\n", p->id);
+
+#endif // #ifdef DEBUG
+            // A process cannot have a lower priority than the lowest feedback queue
+            if (p->priority > dispatcher->config.feedback_levels) {
+                p->priority = dispatcher->config.feedback_levels;
+            }
+
+            // Find the tail of the user job queue once, rather than for each process that is unloaded
+            if (user_job_tail == NULL) {
+                user_job_tail = dispatcher->user_job_queue;
+                while ((user_job_tail != NULL) && (user_job_tail->next != NULL)) {
+                    user_job_tail = user_job_tail->next;
+                }
+            }
+
+            // Add the process to the tail of the user job queue
+            if (user_job_tail == NULL) {
+                dispatcher->user_job_queue = p;
+            } else {
+                user_job_tail->next = p;
+                p->prev = user_job_tail;
+            }
+            user_job_tail = p;
+            checkpoint_PCB(dispatcher->checkpoint, p, Checkpoint_User_Job);
+            admission_notify_arrival(dispatcher);
+        }
+    }
+}
+
+/*
+ * Schedules the arrival of each process in a list of processes that have been
+ * added to the input queue.
+ *
+ * This function uses the timer wheel of the host dispatcher.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     head: The first process in the list.
+ */
+void schedule_arrivals(Dispatcher * dispatcher, PCB * head) {
+    for (PCB * p = head; p != NULL; p = p->next) {
+        timer_add(&dispatcher->timers, &p->arrival_timer, p->arrival_time, Timer_Arrival, p);
+    }
+}
+
+/*
+ * Schedules a check that a real time process has not passed its deadline.
+ *
+ * This function uses the timer wheel of the host dispatcher.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     pcb: The process.
+ */
+void schedule_deadline(Dispatcher * dispatcher, PCB * pcb) {
+    if (pcb->deadline != 0) {
+        // A process that completes at its deadline has met it
+        timer_add(&dispatcher->timers, &pcb->deadline_timer, pcb->deadline + 1, Timer_Deadline, pcb);
+    }
+}
+
+/*
+ * Handles the expired deadline and suspension timers. A real time process that
+ * has passed its deadline is reported, and a suspended process that has not
+ * stopped is stopped.
+ *
+ * This function uses the timer wheel and active process of the host dispatcher.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ */
+void check_timeouts(Dispatcher * dispatcher) {
+    Timer * timer; // the next expired timer
+
+    while ((timer = timer_expired(&dispatcher->timers, Timer_Deadline)) != NULL) {
+        PCB * p = (PCB *) timer->data; // the process that has passed its deadline
+
+        fprintf(__ERROR_OUTPUT, "Real time PCB %d has passed its deadline (%d). Remaining CPU time: %d.\n", p->id, p->deadline, p->remaining_cpu_time);
+    }
+
+    while ((timer = timer_expired(&dispatcher->timers, Timer_Suspend)) != NULL) {
+        PCB * p = (PCB *) timer->data; // the process that should have stopped
+
+        if (p != dispatcher->active) {
+            confirm_suspension(dispatcher, &p);
+        }
+    }
+}
+
+/*
+ * Unload any pending processes from the user job queue to the relevant feedback
+ * queue. The memory and resources required by a process are allocated to the
+ * process before it is unloaded to the feedback queue.
+ *
+ * Processes are admitted by the admission scheduler (see admission.c), which
+ * only rescans the user job queue when a process has arrived or memory or
+ * resources have been released.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ */
+void unload_pending_user_processes(Dispatcher * dispatcher) {
+#ifdef DEBUG
+    fprintf(__DEBUG_OUTPUT, "Unloading any pending processes from the user job queue.\n");
+
+#endif // #ifdef DEBUG
+    admit_user_processes(dispatcher);
+}
+
+/*
+ * Check that the memory and resources required by a process do not exceed the
+ * memory/resources that the system can provide.
+ *
+ * This function will return false if the process requests more memory or
+ * resources than the system can provide. The memory of a process must fit on a
+ * single memory node (see max_process_memory()).
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     PCB: Pointer to the process for which to allocate memory and resources.
+ *
+ * RETURN VALUE
+ * A boolean value indicating that the system is able to provide (however, not
+ * necessarily at this instant) the memory and resources that the process
+ * requires.
+ */
+boolean check_memory_and_resources(Dispatcher * dispatcher, PCB * pcb) {
+    // Check memory
+    if (pcb->mbytes > max_process_memory(dispatcher, pcb)) {
+        return false;
+    }
+
+    // Check printers
+    if (pcb->num_printers > AVAILABLE_PRINTERS) {
+        return false;
+    }
+
+    // Check scanners
+    if (pcb->num_scanners > AVAILABLE_SCANNERS) {
+        return false;
+    }
+
+    // Check modems
+    if (pcb->num_modems > AVAILABLE_MODEMS) {
+        return false;
+    }
+
+    // Check CDs
+    if (pcb->num_cds > AVAILABLE_CDS) {
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Gets the most memory that can ever be allocated to a process. A MAB cannot
+ * span memory nodes, so this is the size of the largest memory node. With a
+ * single memory node, the memory reserved for real time processes must also
+ * remain free on it (unless the process is a real time process). Otherwise the
+ * reserve can remain free on another node, which is always smaller than a node
+ * (see check_config()).
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     pcb: The process.
+ *
+ * RETURN VALUE
+ * The most memory that can be allocated to the process (in megabytes).
+ */
+unsigned int max_process_memory(Dispatcher * dispatcher, PCB * pcb) {
+    unsigned int largest = AVAILABLE_MEMORY / dispatcher->config.memory_nodes + AVAILABLE_MEMORY % dispatcher->config.memory_nodes; // size of the largest memory node (the last node is given any remainder)
+
+    if ((pcb->priority == REAL_TIME_PROCESS_PRIORITY) || (dispatcher->config.memory_nodes > 1)) {
+        return largest;
+    }
+
+    return largest - dispatcher->config.reserved_memory;
+}
+
+/*
+ * Allocates the memory and resources required by a process. The memory and
+ * resources are first reserved, and are only allocated if the entire request
+ * can be satisfied - so a failed allocation has no side effects.
+ *
+ * This function will return false if the process requests more memory or
+ * resources than the system can provide.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     PCB: Pointer to the process for which to allocate memory and resources.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the memory and resources were successfully
+ * allocated.
+ */
+boolean allocate_memory_and_resources(Dispatcher * dispatcher, PCB * pcb) {
+    Reservation reservation; // the memory and resources reserved for the process
+
+    // Free any memory and resources already allocated to process
+    pcb->memory = free_memory(dispatcher, pcb->memory);
+    banker_remove(&dispatcher->banker, pcb);
+    resource_free(&dispatcher->resources, pcb);
+
+    if (!reserve_memory_and_resources(dispatcher, pcb, &reservation)) {
+        return false;
+    }
+
+    return commit_memory_and_resources(dispatcher, pcb, &reservation);
+}
+
+/*
+ * Checks, without allocating anything, whether the memory and resources
+ * required by a process can be allocated at this instant. Resource availability
+ * is checked first, as it is the cheapest check. If processes acquire their
+ * resources incrementally, the resources required are a maximum claim, which
+ * only needs to be within the resources of the host.
+ *
+ * Memory is reserved on the memory node that the process prefers (see
+ * preferred_node()) if it fits there, and otherwise spills to the following
+ * nodes in turn. The memory reserved for real time processes only needs to
+ * remain free on one node.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     pcb: Pointer to the process for which to reserve memory and resources.
+ *     reservation: Set to the reservation, if successful.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the memory and resources can be allocated.
+ */
+boolean reserve_memory_and_resources(Dispatcher * dispatcher, PCB * pcb, Reservation * reservation) {
+    reservation->memory = NULL;
+    reservation->node = 0;
+
+    // Check resources
+    if (dispatcher->config.banker) {
+        if ((pcb->num_printers > resource_total(&dispatcher->resources, Printer_Resource)) ||
+            (pcb->num_scanners > resource_total(&dispatcher->resources, Scanner_Resource)) ||
+            (pcb->num_modems > resource_total(&dispatcher->resources, Modem_Resource)) ||
+            (pcb->num_cds > resource_total(&dispatcher->resources, CD_Resource))) {
+            return false;
+        }
+    } else if (!resource_reserve(&dispatcher->resources, Printer_Resource, pcb->num_printers) ||
+        !resource_reserve(&dispatcher->resources, Scanner_Resource, pcb->num_scanners) ||
+        !resource_reserve(&dispatcher->resources, Modem_Resource, pcb->num_modems) ||
+        !resource_reserve(&dispatcher->resources, CD_Resource, pcb->num_cds)) {
+        return false;
+    }
+
+    // Check memory (only if requested memory is nonzero) - there must still be enough memory for a real time process (unless pcb IS a real time process)
+    if (pcb->mbytes > 0) {
+        unsigned int reserve = (pcb->priority != REAL_TIME_PROCESS_PRIORITY) ? dispatcher->config.reserved_memory : 0; // memory that must remain free
+
+        reservation->node = preferred_node(dispatcher, pcb);
+        for (unsigned int i = 0; (i < dispatcher->config.memory_nodes) && (reservation->memory == NULL); i++) {
+            unsigned int node = (reservation->node + i) % dispatcher->config.memory_nodes; // the node to try
+
+            // The memory reserved for real time processes may remain free on another node instead
+            reservation->memory = mem_reserve(&dispatcher->memory[node], pcb->mbytes, (largest_free_elsewhere(dispatcher, node) >= reserve) ? 0 : reserve);
+        }
+        if (reservation->memory == NULL) {
+            return false;
+        }
+    } else if ((pcb->priority != REAL_TIME_PROCESS_PRIORITY) && (largest_free_memory(dispatcher) < dispatcher->config.reserved_memory)) {
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Allocates the memory and resources that were reserved for a process by
+ * reserve_memory_and_resources(). The reservation is only valid until memory
+ * or resources are next allocated or freed. If processes acquire their
+ * resources incrementally, the process is instead admitted to the banker with
+ * its maximum claim, and is allocated no resources.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     pcb: Pointer to the process for which to allocate memory and resources.
+ *     reservation: The reservation.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the memory and resources were successfully
+ * allocated.
+ */
+boolean commit_memory_and_resources(Dispatcher * dispatcher, PCB * pcb, Reservation * reservation) {
+    // Allocate memory
+    if (reservation->memory != NULL) {
+        if ((pcb->memory = mem_commit(&dispatcher->memory[reservation->memory->node], reservation->memory, pcb->mbytes)) == NULL) {
+            return false;
+        }
+        if (pcb->memory->node != reservation->node) {
+            fprintf(__STANDARD_OUTPUT, "PCB %d spilled to memory node %d. Memory node %d is full.\n", pcb->id, pcb->memory->node, reservation->node);
+            dispatcher->memory_spills++;
+        }
+    }
+
+    // Admit the process with its maximum claim
+    if (dispatcher->config.banker) {
+        if (!banker_admit(&dispatcher->banker, &dispatcher->resources, pcb)) {
+            pcb->memory = free_memory(dispatcher, pcb->memory);
+            return false;
+        }
+        return true;
+    }
+
+    // Allocate resources
+    for (unsigned int i = 0; i < pcb->num_printers; i++) {
+        resource_alloc(&dispatcher->resources, Printer_Resource, pcb);
+    }
+    for (unsigned int i = 0; i < pcb->num_scanners; i++) {
+        resource_alloc(&dispatcher->resources, Scanner_Resource, pcb);
+    }
+    for (unsigned int i = 0; i < pcb->num_modems; i++) {
+        resource_alloc(&dispatcher->resources, Modem_Resource, pcb);
+    }
+    for (unsigned int i = 0; i < pcb->num_cds; i++) {
+        resource_alloc(&dispatcher->resources, CD_Resource, pcb);
+    }
+
+    // Memory and resource allocation was successful
+    return true;
+}
+
+/*
+ * Compacts the memory of each memory node to coalesce the free memory. The
+ * memory of the active process is not relocated, as the process is running -
+ * only the memory of suspended (or not yet started) processes is relocated.
+ *
+ * This function uses the active process and compaction statistics of the host
+ * dispatcher.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *
+ * RETURN VALUE
+ * The total size (in megabytes) of the relocated memory.
+ */
+unsigned int compact_memory(Dispatcher * dispatcher) {
+    unsigned int relocated = 0; // memory relocated
+
+    for (unsigned int i = 0; i < dispatcher->config.memory_nodes; i++) {
+        relocated += mem_compact(&dispatcher->memory[i], (dispatcher->active != NULL) ? dispatcher->active->memory : NULL);
+    }
+
+    dispatcher->memory_compactions++;
+    dispatcher->memory_relocated += relocated;
+    checkpoint_relocated(dispatcher->checkpoint);
+    fprintf(__STANDARD_OUTPUT, "Compacted memory. Relocated %d MB.\n", relocated);
+
+    return relocated;
+}
+
+/*
+ * Finds the size of the largest MAB that is not allocated, on any memory node.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *
+ * RETURN VALUE
+ * The size of the largest free MAB (in megabytes).
+ */
+unsigned int largest_free_memory(Dispatcher * dispatcher) {
+    unsigned int largest = 0; // size of the largest free MAB
+
+    for (unsigned int i = 0; i < dispatcher->config.memory_nodes; i++) {
+        unsigned int size = mem_largest_free(&dispatcher->memory[i]); // size of the largest free MAB on the node
+
+        if (size > largest) {
+            largest = size;
+        }
+    }
+
+    return largest;
+}
+
+/*
+ * Frees a MAB, on whichever memory node it was allocated.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     mab: The MAB to free (may be NULL).
+ *
+ * RETURN VALUE
+ * NULL.
+ */
+MAB * free_memory(Dispatcher * dispatcher, MAB * mab) {
+    if (mab == NULL) {
+        return NULL;
+    }
+
+    return mem_free(&dispatcher->memory[mab->node], mab);
+}
+
+/*
+ * Allocates the memory at a specific offset within the memory of all nodes,
+ * such as memory that was allocated before the host dispatcher was restarted.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     offset: The offset of the memory.
+ *     size: The size of the memory (in megabytes).
+ *
+ * RETURN VALUE
+ * A pointer to the allocated MAB, or NULL if the memory is not free or does not
+ * lie within a single memory node.
+ */
+MAB * claim_memory(Dispatcher * dispatcher, unsigned int offset, unsigned int size) {
+    for (unsigned int i = 0; i < dispatcher->config.memory_nodes; i++) {
+        MemoryPool * pool = &dispatcher->memory[i]; // the memory of the node
+
+        if ((offset >= pool->base) && (offset < pool->base + pool->index_size)) {
+            return mem_claim(pool, offset - pool->base, size);
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Acquires resources for a process that was admitted with a maximum claim. The
+ * resources are only allocated if the banker grants the request.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     pcb: The process.
+ *     request: The number of resources of each type requested (indexed by
+ *         ResourceType).
+ *
+ * RETURN VALUE
+ * The outcome of the request.
+ */
+BankerResult acquire_resources(Dispatcher * dispatcher, PCB * pcb, const unsigned int request[]) {
+    BankerResult result = banker_request(&dispatcher->banker, &dispatcher->resources, pcb, request); // the outcome of the request
+
+    if (result == Banker_Granted) {
+        for (ResourceType type = Printer_Resource; type < NUM_RESOURCE_TYPES; type++) {
+            for (unsigned int i = 0; i < request[type]; i++) {
+                resource_alloc(&dispatcher->resources, type, pcb);
+            }
+        }
+    }
+
+#ifdef DEBUG
+    fprintf(__DEBUG_OUTPUT, "PCB %d requested %d printers, %d scanners, %d modems and %d CDs (result %d).\n", pcb->id, request[Printer_Resource], request[Scanner_Resource], request[Modem_Resource], request[CD_Resource], (int) result);
+#endif // #ifdef DEBUG
+
+    return result;
+}
+
+/*
+ * Releases resources acquired by a process with acquire_resources().
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     pcb: The process.
+ *     release: The number of resources of each type released (indexed by
+ *         ResourceType).
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the resources were released. Nothing is
+ * released if the process does not hold all of them.
+ */
+boolean release_resources(Dispatcher * dispatcher, PCB * pcb, const unsigned int release[]) {
+    if (!banker_release(&dispatcher->banker, pcb, release)) {
+        return false;
+    }
+
+    for (ResourceType type = Printer_Resource; type < NUM_RESOURCE_TYPES; type++) {
+        resource_release(&dispatcher->resources, type, pcb, release[type]);
+    }
+
+    return true;
+}
+
+/*
+ * Gets the next queued PCB with the highest priority from the real time queue
+ * or the relevant feedback queue. It will only return a PCB if that PCB is
+ * ready to be started (clock has reached arrival time). This function does not
+ * dequeue the PCB from its queue.
+ *
+ * A minimum priority can be specified such that a PCB will not be returned
+ * unless its priority is equal to or greater than (numerically less than) the
+ * minimum priority.
+ *
+ * This function uses the clock, real time queue and feedback queues of the host
+ * dispatcher.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     min_priority: The PCB returned must have a priority greater than
+ *         (numerically less than) or equal to this priority.
+ *
+ * RETURN VALUE
+ * The next PCB with the highest priority (and a priority at least equal to
+ * min_priority) from the relevant feedback queue. Returns NULL if there are no
+ * queued processes.
+ */
+PCB ** next_queued_PCB(Dispatcher * dispatcher, unsigned int min_priority) {
+    // Check if there are any queued real time proceeses (these processes will always have priority of at least min_priority so no need to check priority)
+    if ((edf_peek(&dispatcher->real_time_queue) != NULL) && (edf_peek(&dispatcher->real_time_queue)->arrival_time <= dispatcher->clock)) {
+        return &(dispatcher->real_time_queue.heap[0]);
+    }
+
+    // Check each feedback queue, from highest priority to lowest priority
+    unsigned int upper_limit;
+    if (min_priority > dispatcher->config.feedback_levels) {
+        upper_limit = dispatcher->config.feedback_levels;
+    } else {
+        upper_limit = min_priority;
+    }
+    for (unsigned int i = 0; i < upper_limit; i++) {
+        // If the feedback queue is not empty (head is not null) and the head element is ready, return the head element (if the head element is ready)
+        if ((dispatcher->feedback_queue[i] != NULL) && (dispatcher->feedback_queue[i]->arrival_time <= dispatcher->clock)) {
+            return &dispatcher->feedback_queue[i];
+        }
+    }
+
+    // No queued PCBs are ready
+    return NULL;
+}
+
+/*
+ * Removes a PCB returned by next_queued_PCB() from its queue.
+ *
+ * This function uses the real time queue of the host dispatcher.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     next: Pointer to the head of the queue, as returned by next_queued_PCB().
+ *
+ * RETURN VALUE
+ * A pointer to the removed PCB.
+ */
+PCB * dequeue_next_PCB(Dispatcher * dispatcher, PCB ** next) {
+    // The head of the real time queue must be removed from the heap
+    if ((dispatcher->real_time_queue.size > 0) && (next == &(dispatcher->real_time_queue.heap[0]))) {
+        return edf_dequeue(&dispatcher->real_time_queue);
+    }
+
+    return dequeue_PCB(next);
+}
+
+/*
+ * Records the turnaround time of a process (from its arrival to its
+ * completion), if the process will complete after being charged CPU time.
+ *
+ * This function uses the clock and turnaround times of the host dispatcher.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     pcb: The process.
+ *     charged: The CPU time about to be charged to the process.
+ */
+void record_turnaround(Dispatcher * dispatcher, PCB * pcb, unsigned int charged) {
+    if (pcb->remaining_cpu_time > charged) {
+        return;
+    }
+
+    if (dispatcher->num_turnaround_times == dispatcher->turnaround_capacity) {
+        unsigned int capacity = (dispatcher->turnaround_capacity == 0) ? 1024 : (2 * dispatcher->turnaround_capacity); // the new capacity
+        unsigned int * times = (unsigned int *) realloc(dispatcher->turnaround_times, capacity * sizeof(unsigned int)); // the new turnaround times
+
+        if (times == NULL) {
+            return;
+        }
+        dispatcher->turnaround_times = times;
+        dispatcher->turnaround_capacity = capacity;
+    }
+
+    dispatcher->turnaround_times[dispatcher->num_turnaround_times++] = dispatcher->clock - pcb->arrival_time;
+}
+
+/*
+ * Summarises the processes completed by the host dispatcher - the turnaround
+ * time percentiles, the deadline and compaction statistics, and the real time
+ * spent dispatching.
+ *
+ * This function uses the clock, statistics, turnaround times and dispatch time
+ * of the host dispatcher.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     statistics: Set to the summary.
+ */
+void get_statistics(Dispatcher * dispatcher, Statistics * statistics) {
+    unsigned int n = dispatcher->num_turnaround_times; // number of completed processes
+    unsigned long long total = 0; // total turnaround time
+
+    statistics->ticks = dispatcher->clock;
+    statistics->completed = n;
+    statistics->turnaround_mean = 0.0;
+    statistics->turnaround_p50 = 0;
+    statistics->turnaround_p90 = 0;
+    statistics->turnaround_p99 = 0;
+    statistics->turnaround_max = 0;
+    statistics->deadlines_met = dispatcher->deadlines_met;
+    statistics->deadlines_missed = dispatcher->deadlines_missed;
+    statistics->real_time_rejected = dispatcher->real_time_rejected;
+    statistics->memory_compactions = dispatcher->memory_compactions;
+    statistics->dispatch_usec = dispatcher->dispatch_usec;
+
+    if (n > 0) {
+        qsort(dispatcher->turnaround_times, n, sizeof(unsigned int), compare_times);
+        for (unsigned int i = 0; i < n; i++) {
+            total += dispatcher->turnaround_times[i];
+        }
+
+        // The nearest-rank percentiles
+        statistics->turnaround_mean = (double) total / n;
+        statistics->turnaround_p50 = dispatcher->turnaround_times[(n * 50 + 99) / 100 - 1];
+        statistics->turnaround_p90 = dispatcher->turnaround_times[(n * 90 + 99) / 100 - 1];
+        statistics->turnaround_p99 = dispatcher->turnaround_times[(n * 99 + 99) / 100 - 1];
+        statistics->turnaround_max = dispatcher->turnaround_times[n - 1];
+    }
+}
+
+/*
+ * Prints the turnaround time percentiles of the completed processes, and the
+ * real time spent dispatching.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ */
+void print_statistics(Dispatcher * dispatcher) {
+    Statistics statistics; // the summary of the completed processes
+
+    get_statistics(dispatcher, &statistics);
+    if (statistics.completed > 0) {
+        fprintf(__STANDARD_OUTPUT, "Processes completed: %d. Turnaround time: mean %.2f, 50th percentile %d, 90th percentile %d, 99th percentile %d, maximum %d.\n", statistics.completed, statistics.turnaround_mean,
+            statistics.turnaround_p50, statistics.turnaround_p90, statistics.turnaround_p99, statistics.turnaround_max);
+    }
+
+    fprintf(__STANDARD_OUTPUT, "Dispatch time: %.3f ms over %d ticks (%.2f us per tick).\n", statistics.dispatch_usec / 1000.0, statistics.ticks, (statistics.ticks > 0) ? ((double) statistics.dispatch_usec / statistics.ticks) : 0.0);
+}
+
+/*
+ * Records whether a real time process with a deadline met its deadline, if the
+ * process will complete when it is charged for the current tick.
+ *
+ * This function uses the clock and deadline statistics of the host dispatcher.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     pcb: The active process.
+ *     charged: The CPU time that will be charged to the process (in ticks).
+ */
+void record_deadline(Dispatcher * dispatcher, PCB * pcb, unsigned int charged) {
+    if ((pcb->priority == REAL_TIME_PROCESS_PRIORITY) && (pcb->deadline != 0) && (pcb->remaining_cpu_time <= charged)) {
+        if (dispatcher->clock > pcb->deadline) {
+            fprintf(__STANDARD_OUTPUT, "Real time PCB %d missed its deadline (%d) by %d.\n", pcb->id, pcb->deadline, dispatcher->clock - pcb->deadline);
+            dispatcher->deadlines_missed++;
+        } else {
+            dispatcher->deadlines_met++;
+        }
+    }
+}
+
+/*
+ * Checks if the host dispatcher has completed by inspecting the active and
+ * queued processes.
+ *
+ * This function uses the active process, input queue, user job queue, real time
+ * queue and feedback queues of the host dispatcher.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the host dispatcher has completed.
+ */
+boolean finished(Dispatcher * dispatcher) {
+    // Check for active process
+    if (dispatcher->active != NULL) {
+        return false;
+    }
+
+    // Check if there are any queued real time processes
+    if (dispatcher->real_time_queue.size > 0) {
+        return false;
+    }
+
+    // Check each feedback queue, from highest priority to lowest priority
+    for (unsigned int i = 0; i < dispatcher->config.feedback_levels; i++) {
+        if (dispatcher->feedback_queue[i] != NULL) {
+            return false;
+        }
+    }
+
+    // Check if there are any queued user job processes
+    if (dispatcher->user_job_queue != NULL) {
+        return false;
+    }
+
+    // Check if there are any queued input processes
+    if (dispatcher->input_queue != NULL) {
+        return false;
+    }
+
+    // Check if any processes have been submitted since the input queue was last updated
+    if (__atomic_load_n(&dispatcher->submitted, __ATOMIC_ACQUIRE) != NULL) {
+        return false;
+    }
+
+    // No queued PCBs - host dispatcher has completed
+    return true;
+}
+
+/*
+ * Prints the current status of the host dispatcher and all processes.
+ *
+ * This function uses the clock, input queue, user job queue, real time queue,
+ * feedback queues, active process, memory and resources of the host
+ * dispatcher.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ */
+void print_status(Dispatcher * dispatcher) {
+    PCB * input = dispatcher->input_queue; // to iterate through the input queue
+    PCB * user_job = dispatcher->user_job_queue; // to iterate through the user job queue
+    char suffix[STRING_BUFFER]; // the size of a gang and the number of instances of a job array that have not been admitted (empty for a single process)
+
+    // Output header
+    fprintf(__STANDARD_OUTPUT, "====================================================================================================\n");
+    fprintf(__STANDARD_OUTPUT, "Time:\t\t\t%d\n", dispatcher->clock);
+    fprintf(__STANDARD_OUTPUT, "====================================================================================================\n");
+    fprintf(__STANDARD_OUTPUT, "ID\t| PID\tARRIVE\tREMAIN\tPRIOR\t| MB\tMAB ID\t| PRINT\tSCAN\tMODEM\tCD\t| STATUS\n");
+    fprintf(__STANDARD_OUTPUT, "----------------------------------------------------------------------------------------------------\n");
+
+    // Output process information
+    if (!finished(dispatcher)) {
+        if (dispatcher->active != NULL) {
+            format_suffix(dispatcher->active, suffix);
+            if (dispatcher->active->memory != NULL) {
+                fprintf(__STANDARD_OUTPUT, "%d\t| %d\t%d\t%d\t%d\t| %d\t%d\t| %d\t%d\t%d\t%d\t| ACTIVE%s\n", dispatcher->active->id, dispatcher->active->pid, dispatcher->active->arrival_time, dispatcher->active->remaining_cpu_time, dispatcher->active->priority, dispatcher->active->mbytes, dispatcher->active->memory->id, dispatcher->active->num_printers, dispatcher->active->num_scanners, dispatcher->active->num_modems, dispatcher->active->num_cds, suffix);
+            } else {
+                fprintf(__STANDARD_OUTPUT, "%d\t| %d\t%d\t%d\t%d\t| %d\t(null)\t| %d\t%d\t%d\t%d\t| ACTIVE%s\n", dispatcher->active->id, dispatcher->active->pid, dispatcher->active->arrival_time, dispatcher->active->remaining_cpu_time, dispatcher->active->priority, dispatcher->active->mbytes, dispatcher->active->num_printers, dispatcher->active->num_scanners, dispatcher->active->num_modems, dispatcher->active->num_cds, suffix);
+            }
+        }
+
+        for (unsigned int i = 0; i < dispatcher->real_time_queue.size; i++) {
+            PCB * real_time = dispatcher->real_time_queue.heap[i]; // current real time process
+
+            format_suffix(real_time, suffix);
+            if (real_time->memory != NULL) {
+                fprintf(__STANDARD_OUTPUT, "%d\t| %d\t%d\t%d\t%d\t| %d\t%d\t| %d\t%d\t%d\t%d\t| QUEUED-RT%s\n", real_time->id, real_time->pid, real_time->arrival_time, real_time->remaining_cpu_time, real_time->priority, real_time->mbytes, real_time->memory->id, real_time->num_printers, real_time->num_scanners, real_time->num_modems, real_time->num_cds, suffix);
+            } else {
+                fprintf(__STANDARD_OUTPUT, "%d\t| %d\t%d\t%d\t%d\t| %d\t(null)\t| %d\t%d\t%d\t%d\t| QUEUED-RT%s\n", real_time->id, real_time->pid, real_time->arrival_time, real_time->remaining_cpu_time, real_time->priority, real_time->mbytes, real_time->num_printers, real_time->num_scanners, real_time->num_modems, real_time->num_cds, suffix);
+            }
+        }
+
+        for (unsigned int i = 0; i < dispatcher->config.feedback_levels; i++) {
+            if (dispatcher->feedback_queue[i] != NULL) {
+                PCB * feedback = dispatcher->feedback_queue[i]; // to iterate through current feedback queue
+                while (feedback != NULL) {
+                    format_suffix(feedback, suffix);
+
+                    // Check if the process has been started (PID is non-zero)
+                    if (feedback->pid != 0) {
+                        if (feedback->memory != NULL) {
+                            fprintf(__STANDARD_OUTPUT, "%d\t| %d\t%d\t%d\t%d\t| %d\t%d\t| %d\t%d\t%d\t%d\t| SUSPENDED-RRQ%d%s\n", feedback->id, feedback->pid, feedback->arrival_time, feedback->remaining_cpu_time, feedback->priority, feedback->mbytes, feedback->memory->id, feedback->num_printers, feedback->num_scanners, feedback->num_modems, feedback->num_cds, i + 1, suffix);
+                        } else {
+                            fprintf(__STANDARD_OUTPUT, "%d\t| %d\t%d\t%d\t%d\t| %d\t(null)\t| %d\t%d\t%d\t%d\t| SUSPENDED-RRQ%d%s\n", feedback->id, feedback->pid, feedback->arrival_time, feedback->remaining_cpu_time, feedback->priority, feedback->mbytes, feedback->num_printers, feedback->num_scanners, feedback->num_modems, feedback->num_cds, i + 1, suffix);
+                        }
+                    } else {
+                        if (feedback->memory != NULL) {
+                            fprintf(__STANDARD_OUTPUT, "%d\t| %d\t%d\t%d\t%d\t| %d\t%d\t| %d\t%d\t%d\t%d\t| QUEUED-RRQ%d%s\n", feedback->id, feedback->pid, feedback->arrival_time, feedback->remaining_cpu_time, feedback->priority, feedback->mbytes, feedback->memory->id, feedback->num_printers, feedback->num_scanners, feedback->num_modems, feedback->num_cds, i + 1, suffix);
+                        } else {
+                            fprintf(__STANDARD_OUTPUT, "%d\t| %d\t%d\t%d\t%d\t| %d\t(null)\t| %d\t%d\t%d\t%d\t| QUEUED-RRQ%d%s\n", feedback->id, feedback->pid, feedback->arrival_time, feedback->remaining_cpu_time, feedback->priority, feedback->mbytes, feedback->num_printers, feedback->num_scanners, feedback->num_modems, feedback->num_cds, i + 1, suffix);
+                        }
+                    }
+                    feedback = feedback->next;
+                }
+            }
+        }
+
+        while (user_job != NULL) {
+            format_suffix(user_job, suffix);
+            if (user_job->memory != NULL) {
+                fprintf(__STANDARD_OUTPUT, "%d\t| %d\t%d\t%d\t%d\t| %d\t%d\t| %d\t%d\t%d\t%d\t| PENDING%s\n", user_job->id, user_job->pid, user_job->arrival_time, user_job->remaining_cpu_time, user_job->priority, user_job->mbytes, user_job->memory->id, user_job->num_printers, user_job->num_scanners, user_job->num_modems, user_job->num_cds, suffix);
+            } else {
+                fprintf(__STANDARD_OUTPUT, "%d\t| %d\t%d\t%d\t%d\t| %d\t(null)\t| %d\t%d\t%d\t%d\t| PENDING%s\n", user_job->id, user_job->pid, user_job->arrival_time, user_job->remaining_cpu_time, user_job->priority, user_job->mbytes, user_job->num_printers, user_job->num_scanners, user_job->num_modems, user_job->num_cds, suffix);
+            }
+            user_job = user_job->next;
+        }
+
+        while (input != NULL) {
+            // A process that has arrived but is waiting for other processes to complete
+            const char * status = ((input->arrival_time <= dispatcher->clock) && dependency_blocked(input)) ? "WAITING" : "UNLOADED"; // the status of the process
+
+            format_suffix(input, suffix);
+            if (input->memory != NULL) {
+                fprintf(__STANDARD_OUTPUT, "%d\t| %d\t%d\t%d\t%d\t| %d\t%d\t| %d\t%d\t%d\t%d\t| %s%s\n", input->id, input->pid, input->arrival_time, input->remaining_cpu_time, input->priority, input->mbytes, input->memory->id, input->num_printers, input->num_scanners, input->num_modems, input->num_cds, status, suffix);
+            } else {
+                fprintf(__STANDARD_OUTPUT, "%d\t| %d\t%d\t%d\t%d\t| %d\t(null)\t| %d\t%d\t%d\t%d\t| %s%s\n", input->id, input->pid, input->arrival_time, input->remaining_cpu_time, input->priority, input->mbytes, input->num_printers, input->num_scanners, input->num_modems, input->num_cds, status, suffix);
+            }
+            input = input->next;
+        }
+    } else {
+        fprintf(__STANDARD_OUTPUT, "(none)\n");
+    }
+
+    // End of output
+    fprintf(__STANDARD_OUTPUT, "====================================================================================================\n");
+
+    // Output memory and resources - the fill level of each memory node is only output if memory is divided between nodes
+    for (unsigned int i = 0; i < dispatcher->config.memory_nodes; i++) {
+        print_MAB_list(dispatcher->memory[i].head);
+    }
+    if (dispatcher->config.memory_nodes > 1) {
+        print_node_list(dispatcher->memory, dispatcher->config.memory_nodes);
+    }
+    print_RAS_list(dispatcher->resources.head);
+}
+
+/*
+ * Formats the suffix appended to the status of a process - the number of
+ * members of a gang, and the number of instances of a job array that have not
+ * been admitted.
+ *
+ * PARAMETERS
+ *     pcb: The process.
+ *     buffer: Set to the suffix (empty for a single process). It must hold at
+ *         least STRING_BUFFER characters.
+ */
+void format_suffix(PCB * pcb, char * buffer) {
+    int length = 0; // length of the suffix
+
+    buffer[0] = '\0';
+    if (pcb->gang > 1) {
+        length = snprintf(buffer, STRING_BUFFER, " GANG%d", pcb->gang);
+    }
+    if (pcb->instances > 1) {
+        snprintf(buffer + length, STRING_BUFFER - length, " x%d", pcb->instances);
+    }
+}
+
+/*
+ * Gets the current time.
+ *
+ * RETURN VALUE
+ * The current time (in microseconds).
+ */
+static unsigned long long now_usec(void) {
+    struct timeval now; // the current time
+
+    gettimeofday(&now, NULL);
+    return (unsigned long long) now.tv_sec * 1000000 + now.tv_usec;
+}
+
+/*
+ * Compares two turnaround times, for sorting.
+ *
+ * PARAMETERS
+ *     a: The first turnaround time.
+ *     b: The second turnaround time.
+ *
+ * RETURN VALUE
+ * A negative, zero or positive integer, if the first turnaround time is less
+ * than, equal to or greater than the second.
+ */
+static int compare_times(const void * a, const void * b) {
+    unsigned int x = *(const unsigned int *) a; // the first turnaround time
+    unsigned int y = *(const unsigned int *) b; // the second turnaround time
+
+    return (x > y) - (x < y);
+}
+
+/*
+ * Chooses the memory node that a process prefers to be allocated memory on. A
+ * process that has run before prefers the node that it last ran on, and other
+ * processes are spread across the nodes by their ID.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     pcb: The process.
+ *
+ * RETURN VALUE
+ * The preferred memory node.
+ */
+static unsigned int preferred_node(Dispatcher * dispatcher, PCB * pcb) {
+    if ((pcb->last_node >= 0) && ((unsigned int) pcb->last_node < dispatcher->config.memory_nodes)) {
+        return (unsigned int) pcb->last_node;
+    }
+
+    return pcb->id % dispatcher->config.memory_nodes;
+}
+
+/*
+ * Finds the size of the largest MAB that is not allocated, on any memory node
+ * other than the specified node.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     node: The memory node to exclude.
+ *
+ * RETURN VALUE
+ * The size of the largest free MAB (in megabytes), or 0 if there are no other
+ * nodes.
+ */
+static unsigned int largest_free_elsewhere(Dispatcher * dispatcher, unsigned int node) {
+    unsigned int largest = 0; // size of the largest free MAB
+
+    for (unsigned int i = 0; i < dispatcher->config.memory_nodes; i++) {
+        unsigned int size = (i != node) ? mem_largest_free(&dispatcher->memory[i]) : 0; // size of the largest free MAB on the node
+
+        if (size > largest) {
+            largest = size;
+        }
+    }
+
+    return largest;
+}
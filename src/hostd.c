@@ -1,31 +1,31 @@
 /*
- * hostd.h
+ * hostd.c
  *
  * Author: Joshua Spence
  * SID:    308216350
  *
- * This file contains the main functions for the host dispatcher.
+ * This file contains the command line interface of the host dispatcher. The
+ * host dispatcher itself is in the host dispatcher library (see dispatcher.c).
  */
+#define _POSIX_C_SOURCE 200809L // for getopt()
+
 #include "../inc/hostd.h"
 #include "../inc/input.h"
 #include "../inc/PCB.h"
 #include "../inc/MAB.h"
-#include "../inc/RAS.h"
+#include "../inc/cgroup.h"
+#include "../inc/pool.h"
+#include "../inc/control.h"
+#include "../inc/ring.h"
+#include "../inc/checkpoint.h"
+#include "../inc/sweep.h"
+#include "../inc/affinity.h"
 #include "../inc/output.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
-// Global variables
-PCB * input_queue; // the input (dispatcher) queue
-PCB * real_time_queue; // the real time queue
-PCB * user_job_queue; // the user job queue
-PCB * feedback_queue[NUM_FEEDBACK_QUEUES]; // the feedback queues - note feedback_queue[i] stores processes with priority (i + 1)
-MAB * memory; // system memory
-RAS * resources; // system resources
-PCB * active; // active process
-unsigned int clock; // the clock
-
 /*
  * The main function for the host dispatcher.
  *
@@ -37,572 +37,373 @@ unsigned int clock; // the clock
  * An integer representing the exit status of the program. (0 = success)
  */
 int main(int argc, char * argv[]) {
-    // Print help
-    print_help();
-    fprintf(__STANDARD_OUTPUT, "\n");
+    int option; // command line option
+    unsigned int workers = 0; // number of idle workers to keep in the worker pool
+    char * control = NULL; // path of the control socket (NULL if disabled)
+    unsigned int ring_slots = 0; // number of slots in the submission ring (0 if disabled)
+    char * checkpoint = NULL; // path of the checkpoint (NULL if disabled)
+    boolean recovered = false; // whether the state was recovered from the checkpoint
+    DispatcherConfig config; // the scheduling parameters, and how processes are executed
+    SweepGrid grid; // the scheduling parameters to sweep (empty unless sweeping)
+    unsigned int jobs = 0; // number of simulations to run at once when sweeping (0 for one per online CPU)
+    Dispatcher instance; // the host dispatcher
+    Dispatcher * dispatcher = &instance; // the host dispatcher
+
+    default_config(&config);
+    sweep_init(&grid);
+
+    // Parse command line options
+    while ((option = getopt(argc, argv, "a:bc:e:fg:i:j:k:l:m:n:N:o:p:r:s:w:")) != -1) {
+        switch (option) {
+            case 'a': // CPU accounting
+                if (strcmp(optarg, cpu_accounting_name(Tick_Accounting)) == 0) {
+                    config.accounting = Tick_Accounting;
+                } else if (strcmp(optarg, cpu_accounting_name(Measured_Accounting)) == 0) {
+                    config.accounting = Measured_Accounting;
+                } else {
+                    fprintf(__ERROR_OUTPUT, "Unknown CPU accounting mode '%s'.\n", optarg);
+                    print_usage(argv[0]);
+                    exit(1);
+                }
+                break;
 
-    // Initialise
-    input_queue = NULL;
-    real_time_queue = NULL;
-    user_job_queue = NULL;
-    for (unsigned int i = 0; i < NUM_FEEDBACK_QUEUES; i++) {
-        feedback_queue[i] = NULL;
-    }
-    active = NULL;
-    clock = 0;
+            case 'b': // banker's algorithm
+                config.banker = true;
+                break;
 
-    FILE * input; // file to read input from
+            case 'c': // control socket
+                control = optarg;
+                break;
 
-    // Initialise memory resources
-    memory = create_null_MAB();
-    memory->size = AVAILABLE_MEMORY;
+            case 'e': // execution
+                for (config.execution = 0; config.execution < NUM_EXECUTIONS; config.execution++) {
+                    if (strcmp(optarg, execution_name(config.execution)) == 0) {
+                        break;
+                    }
+                }
+                if (config.execution == NUM_EXECUTIONS) {
+                    fprintf(__ERROR_OUTPUT, "Unknown execution mode '%s'.\n", optarg);
+                    print_usage(argv[0]);
+                    exit(1);
+                }
+                break;
 
-    // Initialise resources
-    resources = create_resources(AVAILABLE_PRINTERS, AVAILABLE_SCANNERS, AVAILABLE_MODEMS, AVAILABLE_CDS);
+            case 'f': // fast
+                config.fast = true;
+                break;
 
-    // Open file
-    if (argc < 2) {
-        fprintf(__ERROR_OUTPUT, "No input file specified.\n");
-        exit(1);
-    } else {
-        if (!(input = fopen(argv[1], "r"))) {
-            fprintf(__ERROR_OUTPUT, "Unable to open input file '%s' for reading.\n", argv[1]);
-            exit(1);
-        }
-    }
+            case 'g': // parameter sweep
+                if (!sweep_add(&grid, optarg)) {
+                    print_usage(argv[0]);
+                    exit(1);
+                }
+                break;
 
-    // Fill input queue from dispatch list file
-    input_queue = read_process_list(input);
+            case 'i': // status interval
+                if ((config.status_interval = (unsigned int) strtoul(optarg, NULL, 10)) == 0) {
+                    fprintf(__ERROR_OUTPUT, "Invalid status interval '%s'.\n", optarg);
+                    print_usage(argv[0]);
+                    exit(1);
+                }
+                break;
 
-    // Close the input file
-    if (input != NULL) {
-        fclose(input);
-        input = NULL;
-    }
-#ifdef DEBUG
+            case 'j': // sweep jobs
+                jobs = (unsigned int) strtoul(optarg, NULL, 10);
+                break;
 
-    fprintf(__DEBUG_OUTPUT, "Finished parsing input file. Input queue: ");
-    print_PCB_queue(input_queue);
-    fprintf(__DEBUG_OUTPUT, ".\n");
-#endif // #ifdef DEBUG
+            case 'k': // checkpoint
+                checkpoint = optarg;
+                break;
 
-    // Print initial status
-    print_status();
+            case 'l': // workload
+                for (config.workload = 0; config.workload < NUM_WORKLOADS; config.workload++) {
+                    if (strcmp(optarg, workload_name(config.workload)) == 0) {
+                        break;
+                    }
+                }
+                if (config.workload == NUM_WORKLOADS) {
+                    fprintf(__ERROR_OUTPUT, "Unknown workload '%s'.\n", optarg);
+                    print_usage(argv[0]);
+                    exit(1);
+                }
+                break;
+
+            case 'm': // memory enforcement
+                if (strcmp(optarg, memory_enforcement_name(No_Enforcement)) == 0) {
+                    config.enforcement = No_Enforcement;
+                } else if (strcmp(optarg, memory_enforcement_name(Rlimit_Enforcement)) == 0) {
+                    config.enforcement = Rlimit_Enforcement;
+                } else if (strcmp(optarg, memory_enforcement_name(Cgroup_Enforcement)) == 0) {
+                    config.enforcement = Cgroup_Enforcement;
+                } else {
+                    fprintf(__ERROR_OUTPUT, "Unknown memory enforcement mode '%s'.\n", optarg);
+                    print_usage(argv[0]);
+                    exit(1);
+                }
+                break;
 
-    // Start and run dispatch timer - this is the main host dispatcher action and won't return until the host dispatcher has completed
-    tick();
+            case 'n': // CPUs
+                config.cpus = (unsigned int) strtoul(optarg, NULL, 10);
+                break;
 
-    // Output the total elapsed time when the host dispatcher has finished
-    fprintf(__STANDARD_OUTPUT, "\nFinished processing. Total elapsed time is %d.\n", clock);
+            case 'N': // memory nodes
+                if ((config.memory_nodes = (unsigned int) strtoul(optarg, NULL, 10)) == 0) {
+                    config.memory_nodes = affinity_num_nodes();
+                }
+                break;
 
-    // Clean up
-    if (active != NULL) {
-        terminate_PCB(&active);
-        free_PCB(&active);
-    }
+            case 'o': // scheduling parameter
+                if (!set_config_option(&config, optarg)) {
+                    print_usage(argv[0]);
+                    exit(1);
+                }
+                break;
+
+            case 'p': // memory placement policy
+                if (strcmp(optarg, mem_policy_name(First_Fit)) == 0) {
+                    config.placement = First_Fit;
+                } else if (strcmp(optarg, mem_policy_name(Next_Fit)) == 0) {
+                    config.placement = Next_Fit;
+                } else if (strcmp(optarg, mem_policy_name(Best_Fit)) == 0) {
+                    config.placement = Best_Fit;
+                } else if (strcmp(optarg, mem_policy_name(Worst_Fit)) == 0) {
+                    config.placement = Worst_Fit;
+                } else {
+                    fprintf(__ERROR_OUTPUT, "Unknown memory placement policy '%s'.\n", optarg);
+                    print_usage(argv[0]);
+                    exit(1);
+                }
+                break;
 
-    while (input_queue != NULL) {
-        PCB * tmp = dequeue_PCB(&input_queue);
-        terminate_PCB(&tmp);
-        free_PCB(&tmp);
-    }
+            case 'r': // submission ring
+                if ((ring_slots = (unsigned int) strtoul(optarg, NULL, 10)) == 0) {
+                    ring_slots = RING_DEFAULT_SLOTS;
+                }
+                break;
+
+            case 's': // suspension method
+                if (strcmp(optarg, suspend_method_name(Signal_Suspension)) == 0) {
+                    config.suspend_method = Signal_Suspension;
+                } else if (strcmp(optarg, suspend_method_name(Freezer_Suspension)) == 0) {
+                    config.suspend_method = Freezer_Suspension;
+                } else {
+                    fprintf(__ERROR_OUTPUT, "Unknown suspension method '%s'.\n", optarg);
+                    print_usage(argv[0]);
+                    exit(1);
+                }
+                break;
 
-    while (user_job_queue != NULL) {
-        PCB * tmp = dequeue_PCB(&input_queue);
-        terminate_PCB(&tmp);
-        free_PCB(&tmp);
-    }
+            case 'w': // worker pool size
+                workers = (unsigned int) strtoul(optarg, NULL, 10);
+                break;
 
-    while (real_time_queue != NULL) {
-        PCB * tmp = dequeue_PCB(&real_time_queue);
-        terminate_PCB(&tmp);
-        free_PCB(&tmp);
-    }
-
-    for (unsigned int i = 0; i < NUM_FEEDBACK_QUEUES; i++) {
-        while (feedback_queue[i] != NULL) {
-            PCB * tmp = dequeue_PCB(&feedback_queue[i]);
-            terminate_PCB(&tmp);
-            free_PCB(&tmp);
+            default:
+                print_usage(argv[0]);
+                exit(1);
         }
     }
 
-    MAB * m = memory;
-    MAB * m_next = NULL;
-    while (m != NULL) {
-        m_next = m->next;
-        free(memory);
-        m = m_next;
-        m_next = NULL;
+    // The submission ring is handed out over the control socket
+    if ((ring_slots > 0) && (control == NULL)) {
+        fprintf(__ERROR_OUTPUT, "The submission ring requires a control socket.\n");
+        print_usage(argv[0]);
+        exit(1);
     }
 
-    RAS * r = resources;
-    RAS * r_next = NULL;
-    while (r != NULL) {
-        r_next = r->next;
-        free(r);
-        r = r_next;
-        r_next = NULL;
+    // Resources are acquired over the control socket, and the checkpoint does not record maximum claims
+    if (config.banker && ((control == NULL) || (checkpoint != NULL))) {
+        fprintf(__ERROR_OUTPUT, "Incremental resource acquisition requires a control socket, and cannot be combined with a checkpoint.\n");
+        print_usage(argv[0]);
+        exit(1);
     }
-}
 
-/*
- * The main functional component of the host dispatcher. This function "ticks"
- * time and initiates the relevant process, memory and resource operation at
- * each clock tick.
- *
- * This function uses global variables for the clock, memory resources,
- * resources, input queue, user job queue, real time queue, feedback queues and
- * active process.
- */
-void tick(void) {
-    PCB ** next = NULL; // the next process to execute - from either the real time queue or a feedback queue
-
-    // A blank line will separate ticks in the output
-    fprintf(__STANDARD_OUTPUT, "\n");
-
-    // Unload pending processes from the associated queues
-    unload_pending_input_processes();
-    unload_pending_user_processes();
-
-    // If there is an active process, decrement its remaining CPU time (terminating the process if time has expired)
-    if (active != NULL) {
-        active = decrement_remaining_cpu_time(&active);
-
-        // Make sure there is still an active process - ie. that the active process hasn't terminated
-        if (active != NULL) {
-            // If the running process is a real time process then it does not need to be suspended
-            if (active->priority != REAL_TIME_PROCESS_PRIORITY) {
-                // Check if there are any ready queued processes (with an equal or higher priority) on the feedback queues
-                if ((next = next_queued_PCB(active->priority)) != NULL) {
-                    // Suspend the active process
-                    PCB * p = suspend_PCB(&active);
-                    active = NULL;
-                    p = lower_priority(&p);
-
-#ifdef DEBUG
-                    fprintf(__DEBUG_OUTPUT, "Enqueuing PCB %d onto feedback queue RQ%d.\n", p->id, p->priority);
-#endif // #ifdef DEBUG
-                    enqueue_PCB(&feedback_queue[p->priority - 1], &p);
-                }
-#ifdef DEBUG
-                else {
-                    fprintf(__DEBUG_OUTPUT, "No ready PCBs with priority greater than or equal to %d in feedback queues. No need to suspend active PCB %d.\n", active->priority, active->id);
-                }
-#endif // #ifdef DEBUG
-            }
-#ifdef DEBUG
-            else {
-                fprintf(__DEBUG_OUTPUT, "PCB %d is a real time process. No need to suspend process.\n", active->id);
-            }
-#endif // #ifdef DEBUG
-        }
+    // Check the scheduling parameters
+    if (!check_config(&config)) {
+        print_usage(argv[0]);
+        exit(1);
     }
 
-    // If there is no next PCB specified, get the next queued PCB of any priority
-    if (next == NULL) {
-        next = next_queued_PCB(LOWEST_PRIORITY);
+    // A simulated process only exists in the host dispatcher, so there is nothing to enforce, measure or wait for
+    if (config.execution == Simulated_Execution) {
+        if ((control != NULL) || (checkpoint != NULL) || (workers > 0)) {
+            fprintf(__ERROR_OUTPUT, "Simulated execution cannot be combined with a control socket, a checkpoint or a worker pool.\n");
+            print_usage(argv[0]);
+            exit(1);
+        }
+        config.enforcement = No_Enforcement;
+        config.suspend_method = Signal_Suspension;
+        config.accounting = Tick_Accounting;
+        config.fast = true;
     }
 
-    // If there is no active process but there is a ready queued process, then start/resume the next process
-    if ((active == NULL)) {
-        if (next != NULL) {
-            // Remove next PCB from its queue and set is as the active PCB
-            active = dequeue_PCB(next);
-
-            // Process has been started if its PID is non-zero
-            if (active->pid != 0) {
-                // Resume the active process
-                restart_PCB(&active);
-            } else {
-                // If this is a real time process, allocate memory and resources (in real time, obviously)
-                if (active->pid == REAL_TIME_PROCESS_PRIORITY) {
-                    if (!allocate_memory_and_resources(active)) {
-                        fprintf(__ERROR_OUTPUT, "Failed to allocate memory and resources for real time process PCB %d. This process will not be executed.\n", active->id);
-                        free_PCB(&active);
-                        active = NULL;
-                    }
-#ifdef DEBUG
-                    else {
-                        fprintf(__DEBUG_OUTPUT, "Allocated memory and resources for real time process PCB %d.\n", active->id);
-                    }
-#endif // #ifdef DEBUG
-                }
-
-                // Start the active process
-                start_PCB(&active);
-            }
+    // Sweep the scheduling parameters over the dispatch list, instead of dispatching it
+    if (sweep_enabled(&grid)) {
+        if ((control != NULL) || (checkpoint != NULL)) {
+            fprintf(__ERROR_OUTPUT, "A parameter sweep cannot be combined with a control socket or a checkpoint.\n");
+            print_usage(argv[0]);
+            exit(1);
         }
-#ifdef DEBUG
-        else {
-            fprintf(__DEBUG_OUTPUT, "There is no process ready to execute at this stage.\n");
+        if (optind >= argc) {
+            fprintf(__ERROR_OUTPUT, "No input file specified.\n");
+            print_usage(argv[0]);
+            exit(1);
         }
-#endif // #ifdef DEBUG
+        return sweep_run(&grid, &config, argv[optind], jobs) ? 0 : 1;
     }
 
-    // Increment the clock and sleep for one second to emulate a real 'tick'
-#ifdef DEBUG
-    fprintf(__DEBUG_OUTPUT, "Ticking.\n");
-#endif // #ifdef DEBUG
-    clock++;
-    sleep(1);
+    // Print help
+    print_help();
+    fprintf(__STANDARD_OUTPUT, "\n");
 
-    // Output current dispatcher status
-    print_status();
+    FILE * input = NULL; // file to read input from
 
-    // Keep ticking if there are still remaining queued/active processes
-    if (!finished()) {
-        tick();
+    // Initialise memory enforcement
+    if ((config.enforcement == Cgroup_Enforcement) && !cgroup_init(Memory_Controller)) {
+        fprintf(__ERROR_OUTPUT, "Memory cgroups are unavailable. Using RLIMIT_AS instead.\n");
+        config.enforcement = Rlimit_Enforcement;
     }
-}
 
-/*
- * Unload any pending processes from the input queue to the user job queue or
- * real time queue.
- *
- * This function uses global variables for the clock, input queue and user job
- * queue.
- */
-void unload_pending_input_processes(void) {
-    PCB * input = input_queue; // for iterating through input queue
-#ifdef DEBUG
-
-    fprintf(__DEBUG_OUTPUT, "Unloading any pending processes from the input queue.\n");
-#endif // #ifdef DEBUG
-
-    // Unload processes from the input queue to the user job queue whilst there are processes on the input queue and the process is ready (arrival time has been reached)
-    while (input != NULL) {
-        PCB * prev = NULL; // for restoring queue head pointer
-        PCB * next = NULL; // for restoring queue head pointer
-
-        // Check that PCB is ready
-        if (input->arrival_time <= clock) {
-            // Capture next and previous PCBs
-            prev = input->prev;
-            next = input->next;
-
-            // Remove the process from the input queue
-            PCB * p = dequeue_PCB(&input);
-
-            // Check if PCB is a real time process
-            if (p->priority == REAL_TIME_PROCESS_PRIORITY) {
-#ifdef DEBUG
-                fprintf(__DEBUG_OUTPUT, "Unloading PCB %d to real time queue.\n", p->id);
-
-#endif // #ifdef DEBUG
-                // Add the process to the real time queue
-                enqueue_PCB(&real_time_queue, &p);
-            } else {
-#ifdef DEBUG
-                fprintf(__DEBUG_OUTPUT, "Unloading PCB %d to user job queue.\n", p->id);
-
-#endif // #ifdef DEBUG
-                // Add the process to the user job queue
-                enqueue_PCB(&user_job_queue, &p);
-            }
-
-            // Restore input queue pointer
-            if (prev == NULL) {
-                input_queue = next;
-            }
-        } else {
-#ifdef DEBUG
-            fprintf(__DEBUG_OUTPUT, "PCB %d is not yet ready and will remain on the input queue.\n", input->id);
-
-#endif // #ifdef DEBUG
-            // Go to next input PCB
-            input = input->next;
-        }
+    // Initialise suspension
+    if ((config.suspend_method == Freezer_Suspension) && !cgroup_init(Freezer_Controller)) {
+        fprintf(__ERROR_OUTPUT, "Freezer cgroups are unavailable. Using signals instead.\n");
+        config.suspend_method = Signal_Suspension;
     }
-}
-
-/*
- * Unload any pending processes from the user job queue to the relevant feedback
- * queue. The memory and resources required by a process are allocated to the
- * process before it is unloaded to the feedback queue.
- *
- * This function uses global variables for the user job queue and the feedback
- * queues.
- */
-void unload_pending_user_processes(void) {
-    PCB * user_job = user_job_queue; // for iterating through the user job queue
-#ifdef DEBUG
-
-    fprintf(__DEBUG_OUTPUT, "Unloading any pending processes from the user job queue.\n");
-#endif // #ifdef DEBUG
-
-    // Unload processes from the user job queue to the feedback queue while there are processes on the user job queue and there is enough memory for the new process
-    while (user_job != NULL) {
-        PCB * prev = NULL; // for restoring queue head pointer
-        PCB * next = NULL; // for restoring queue head pointer
 
-        // Check that the system can provide the memory and resources that the process requires)
-        if (check_memory_and_resources(user_job)) {
-            // Check that memory and resources can be allocated for this PCB
-            if (allocate_memory_and_resources(user_job)) {
-#ifdef DEBUG
-                fprintf(__DEBUG_OUTPUT, "Allocated memory and resources for process PCB %d.\n", user_job->id);
-                fprintf(__DEBUG_OUTPUT, "Unloading PCB %d to feedback queue RRQ%d.\n", user_job->id, user_job->priority);
-
-#endif // #ifdef DEBUG
-                // Capture next and previous PCBs
-                prev = user_job->prev;
-                next = user_job->next;
-
-                // Remove the process from the user job queue and add the process to the appropriate feedback queue
-                PCB * p = dequeue_PCB(&user_job);
-                enqueue_PCB(&feedback_queue[p->priority - 1], &p);
+    // Initialise the worker pool
+    pool_init(PROCESS, workers);
 
-                // If this PCB was the head of the user job queue, then we must restore user job queue pointer
-                if (prev == NULL) {
-                    user_job_queue = next;
-                }
-            } else {
+    // Initialise CPU accounting - the CPU time of processes is read from /proc if CPU accounting cgroups are unavailable
+    if ((config.accounting == Measured_Accounting) && !cgroup_init(CPU_Controller)) {
 #ifdef DEBUG
-                fprintf(__DEBUG_OUTPUT, "Unable to allocate memory and resources for PCB %d at this stage.\n", user_job->id);
-
+        fprintf(__DEBUG_OUTPUT, "CPU accounting cgroups are unavailable. Measuring CPU time from /proc instead.\n");
 #endif // #ifdef DEBUG
-                // Go to next user job
-                user_job = user_job->next;
-            }
-        } else {
-            fprintf(__ERROR_OUTPUT, "PCB %d requested more memory or resources than the system can provide. This process will not be executed.\n", user_job->id);
-
-            // Delete PCB
-            PCB * p = dequeue_PCB(&user_job);
-            free_PCB(&p);
-
-            // If this PCB was the head of the user job queue, then we must restore user job queue pointer
-            if (prev == NULL) {
-                user_job_queue = next;
-            }
-        }
-    }
-}
-
-/*
- * Check that the memory and resources required by a process do not exceed the
- * memory/resources that the system can provide.
- *
- * This function will return false if the process requests more memory or
- * resources than the system can provide.
- *
- * PARAMETERS
- *     PCB: Pointer to the process for which to allocate memory and resources.
- *
- * RETURN VALUE
- * A boolean value indicating that the system is able to provide (however, not
- * necessarily at this instant) the memory and resources that the process
- * requires.
- */
-boolean check_memory_and_resources(PCB * pcb) {
-    // Check memory
-    if (pcb->mbytes > (AVAILABLE_MEMORY - RESERVED_MEMORY)) {
-        return false;
-    }
-
-    // Check printers
-    if (pcb->num_printers > AVAILABLE_PRINTERS) {
-        return false;
-    }
-
-    // Check scanners
-    if (pcb->num_scanners > AVAILABLE_SCANNERS) {
-        return false;
     }
 
-    // Check modems
-    if (pcb->num_modems > AVAILABLE_MODEMS) {
-        return false;
-    }
-
-    // Check CDs
-    if (pcb->num_cds > AVAILABLE_CDS) {
-        return false;
+    // Initialise the host dispatcher
+    if (!dispatcher_init(dispatcher, &config)) {
+        exit(1);
     }
 
-    return true;
-}
-
-/*
- * Allocates the memory and resources required by a process. If any of the
- * allocations fail, then the function will unallocate all memory/resources that
- * have been allocated.
- *
- * This function will return false if the process requests more memory or
- * resources than the system can provide.
- *
- * PARAMETERS
- *     PCB: Pointer to the process for which to allocate memory and resources.
- *
- * RETURN VALUE
- * A boolean value indicating whether the memory and resources were successfully
- * allocated.
- */
-boolean allocate_memory_and_resources(PCB * pcb) {
-    // Free any memory and resources already allocated to process
-    if (pcb->memory != NULL) {
-        pcb->memory = mem_free(pcb->memory);
+    // Recover the state of a previous host dispatcher from the checkpoint
+    if ((checkpoint != NULL) && (!checkpoint_init(dispatcher, checkpoint) || !checkpoint_recover(dispatcher->checkpoint, &recovered))) {
+        exit(1);
     }
-    resource_free(pcb);
 
-    // Attempt to allocate memory (only if requested memory is nonzero)
-    if (pcb->mbytes > 0) {
-        if ((pcb->memory = mem_alloc(pcb->mbytes)) == NULL) {
-            // Allocation failed - roll back
-            return false;
+    // Open file - the input file is optional if processes can be submitted over the control socket, and is ignored if the state was recovered
+    if (recovered) {
+        if (optind < argc) {
+            fprintf(__STANDARD_OUTPUT, "Ignoring input file '%s'. The state was recovered from the checkpoint.\n", argv[optind]);
         }
-    }
-
-    // Check that there is still enough memory for a real time process (unless pcb IS a real time process)
-    if (pcb->priority != REAL_TIME_PROCESS_PRIORITY) {
-        MAB * m = memory; // for iterating through memory list
-        unsigned int largest_MAB_size = 0; // size of the largest MAB
-        while (m != NULL) {
-            if (!m->allocated && (m->size >= largest_MAB_size)) {
-                largest_MAB_size = m->size;
-            }
-
-            // Go to the next MAB
-            m = m->next;
+    } else if (optind >= argc) {
+        if (control == NULL) {
+            fprintf(__ERROR_OUTPUT, "No input file specified.\n");
+            print_usage(argv[0]);
+            exit(1);
         }
-        if (largest_MAB_size < RESERVED_MEMORY) {
-            // Allocation failed - roll back
-            pcb->memory = mem_free(pcb->memory);
-            return false;
+    } else {
+        if (!(input = fopen(argv[optind], "r"))) {
+            fprintf(__ERROR_OUTPUT, "Unable to open input file '%s' for reading.\n", argv[optind]);
+            exit(1);
         }
     }
 
-    // Attempt to allocate printers
-    for (unsigned int i = 0; i < pcb->num_printers; i++) {
-        if (resource_alloc(Printer_Resource, pcb) == NULL) {
-            // Allocation failed - roll back
-            pcb->memory = mem_free(pcb->memory);
-            resource_free(pcb);
-            return false;
-        }
+    // Fill input queue from dispatch list file
+    if (input != NULL) {
+        append_to_input_queue(dispatcher, read_process_list(dispatcher, input));
     }
 
-    // Attempt to allocate scanners
-    for (unsigned int i = 0; i < pcb->num_scanners; i++) {
-        if (resource_alloc(Scanner_Resource, pcb) == NULL) {
-            // Allocation failed - roll back
-            pcb->memory = mem_free(pcb->memory);
-            resource_free(pcb);
-            return false;
-        }
+    // Schedule the arrival of each process in the input queue, and the deadline of each real time process and the quantum of the active process (if the state was recovered, along with the clock)
+    timer_advance(&dispatcher->timers, dispatcher->clock);
+    schedule_arrivals(dispatcher, dispatcher->input_queue);
+    for (unsigned int i = 0; i < dispatcher->real_time_queue.size; i++) {
+        schedule_deadline(dispatcher, dispatcher->real_time_queue.heap[i]);
+    }
+    if (dispatcher->active != NULL) {
+        // The quantum of the recovered active process expires straight away, and is charged as a single tick
+        schedule_deadline(dispatcher, dispatcher->active);
+        timer_add(&dispatcher->timers, &dispatcher->quantum_timer, dispatcher->clock, Timer_Quantum, NULL);
+        dispatcher->quantum_start = dispatcher->clock - 1;
     }
 
-    // Attempt to allocate modems
-    for (unsigned int i = 0; i < pcb->num_modems; i++) {
-        if (resource_alloc(Modem_Resource, pcb) == NULL) {
-            // Allocation failed - roll back
-            pcb->memory = mem_free(pcb->memory);
-            resource_free(pcb);
-            return false;
-        }
+    // Start accepting processes over the control socket
+    if ((control != NULL) && !control_init(dispatcher, control)) {
+        exit(1);
+    }
+    if ((ring_slots > 0) && !control_enable_ring(dispatcher->control, ring_slots)) {
+        control_destroy(dispatcher);
+        exit(1);
     }
 
-    // Attempt to allocate CDs
-    for (unsigned int i = 0; i < pcb->num_cds; i++) {
-        if (resource_alloc(CD_Resource, pcb) == NULL) {
-            // Allocation failed - roll back
-            pcb->memory = mem_free(pcb->memory);
-            resource_free(pcb);
-            return false;
-        }
+    // Close the input file
+    if (input != NULL) {
+        fclose(input);
+        input = NULL;
     }
+#ifdef DEBUG
 
-    // Memory and resource allocation was successful
-    return true;
-}
+    fprintf(__DEBUG_OUTPUT, "Finished parsing input file. Input queue: ");
+    print_PCB_queue(dispatcher->input_queue);
+    fprintf(__DEBUG_OUTPUT, ".\n");
+#endif // #ifdef DEBUG
 
-/*
- * Gets the next queued PCB with the highest priority from the real time queue
- * or the relevant feedback queue. It will only return a PCB if that PCB is
- * ready to be started (clock has reached arrival time). This function does not
- * dequeue the PCB from its queue.
- *
- * A minimum priority can be specified such that a PCB will not be returned
- * unless its priority is equal to or greater than (numerically less than) the
- * minimum priority.
- *
- * This function uses global variables for the clock, real time queue and
- * feedback queues.
- *
- * PARAMETERS
- *     min_priority: The PCB returned must have a priority greater than
- *         (numerically less than) or equal to this priority.
- *
- * RETURN VALUE
- * The next PCB with the highest priority (and a priority at least equal to
- * min_priority) from the relevant feedback queue. Returns NULL if there are no
- * queued processes.
- */
-PCB ** next_queued_PCB(unsigned int min_priority) {
-    // Check if there are any queued real time proceeses (these processes will always have priority of at least min_priority so no need to check priority)
-    if ((real_time_queue != NULL) && (real_time_queue->arrival_time <= clock)) {
-        return &real_time_queue;
+    // Print initial status
+    print_status(dispatcher);
+    if (dispatcher->config.status_interval > 0) {
+        timer_add(&dispatcher->timers, &dispatcher->status_timer, dispatcher->clock + dispatcher->config.status_interval, Timer_Status, NULL);
     }
 
-    // Check each feedback queue, from highest priority to lowest priority
-    unsigned int upper_limit;
-    if (min_priority > NUM_FEEDBACK_QUEUES) {
-        upper_limit = NUM_FEEDBACK_QUEUES;
-    } else {
-        upper_limit = min_priority;
-    }
-    for (unsigned int i = 0; i < upper_limit; i++) {
-        // If the feedback queue is not empty (head is not null) and the head element is ready, return the head element (if the head element is ready)
-        if ((feedback_queue[i] != NULL) && (feedback_queue[i]->arrival_time <= clock)) {
-            return &feedback_queue[i];
-        }
-    }
+    // Start and run dispatch timer - this is the main host dispatcher action. Whilst the control socket is running, the host dispatcher keeps ticking even if there are no processes.
+    do {
+        dispatcher_step(dispatcher);
+    } while ((control_state(dispatcher->control) == Control_Running) || ((control_state(dispatcher->control) != Control_Stopped) && !finished(dispatcher)));
 
-    // No queued PCBs are ready
-    return NULL;
+    // Output the total elapsed time when the host dispatcher has finished
+    fprintf(__STANDARD_OUTPUT, "\nFinished processing. Total elapsed time is %d.\n", dispatcher->clock);
+    fprintf(__STANDARD_OUTPUT, "Real time deadlines met: %d. Missed: %d. Rejected by admission test: %d.\n", dispatcher->deadlines_met, dispatcher->deadlines_missed, dispatcher->real_time_rejected);
+    fprintf(__STANDARD_OUTPUT, "Memory compactions: %d. Memory relocated: %d MB. Processes admitted by compaction: %d (CPU time: %d).\n", dispatcher->memory_compactions, dispatcher->memory_relocated, dispatcher->compaction_admissions, dispatcher->compaction_cpu_time);
+    if (dispatcher->config.memory_nodes > 1) {
+        fprintf(__STANDARD_OUTPUT, "Memory nodes: %d. Processes spilled to another node: %d.\n", dispatcher->config.memory_nodes, dispatcher->memory_spills);
+    }
+    if (dispatcher->config.banker) {
+        fprintf(__STANDARD_OUTPUT, "Resource requests granted: %d. Deferred (unavailable): %d. Deferred (unsafe): %d. Full safety checks: %d.\n", dispatcher->banker.granted, dispatcher->banker.unavailable, dispatcher->banker.unsafe, dispatcher->banker.full_checks);
+    }
+    print_statistics(dispatcher);
+    checkpoint_print_statistics(dispatcher->checkpoint);
+
+    // Clean up - processes remain if the host dispatcher was shut down over the control socket, and only processes that have been started (PID is non-zero) are terminated (the control socket and the checkpoint are removed with the host dispatcher)
+    dispatcher_destroy(dispatcher);
+    pool_destroy();
+    cgroup_cleanup();
 }
 
 /*
- * Checks if the host dispatcher has completed by inspecting the active and
- * queued processes.
- *
- * This function uses global variables for the active process, input queue, user
- * job queue, real time queue and feedback queues.
+ * Prints the command line usage of the host dispatcher.
  *
- * RETURN VALUE
- * A boolean value indicating whether the host dispatcher has completed.
+ * PARAMETERS
+ *     program: The name of the program.
  */
-boolean finished(void) {
-    // Check for active process
-    if (active != NULL) {
-        return false;
-    }
-
-    // Check if there are any queued real time processes
-    if (real_time_queue != NULL) {
-        return false;
-    }
-
-    // Check each feedback queue, from highest priority to lowest priority
-    for (unsigned int i = 0; i < NUM_FEEDBACK_QUEUES; i++) {
-        if (feedback_queue[i] != NULL) {
-            return false;
-        }
-    }
-
-    // Check if there are any queued user job processes
-    if (user_job_queue != NULL) {
-        return false;
-    }
-
-    // Check if there are any queued input processes
-    if (input_queue != NULL) {
-        return false;
-    }
-
-    // No queued PCBs - host dispatcher has completed
-    return true;
+void print_usage(char * program) {
+    fprintf(__ERROR_OUTPUT, "Usage: %s [OPTIONS] <dispatch list>\n", program);
+    fprintf(__ERROR_OUTPUT, "\n");
+    fprintf(__ERROR_OUTPUT, "OPTIONS\n");
+    fprintf(__ERROR_OUTPUT, "\t-a MODE\t\tCPU accounting: tick (default) or cpu (charge measured CPU time).\n");
+    fprintf(__ERROR_OUTPUT, "\t-b\t\tIncremental resource acquisition: the resources of a process are a maximum claim, and the process\n\t\t\tacquires and releases resources within it with ACQUIRE and RELEASE requests on the control socket\n\t\t\t(HOSTD_CONTROL, HOSTD_ID and HOSTD_CLAIM are set in its environment). The banker's algorithm defers any\n\t\t\trequest that could lead to deadlock. Requires -c. Each 'sigtrap' process acquires its\n\t\t\tclaim in two halves, and releases it when it finishes.\n");
+    fprintf(__ERROR_OUTPUT, "\t-c SOCKET\tAccept processes over a UNIX domain control socket. The dispatch list is then optional.\n");
+    fprintf(__ERROR_OUTPUT, "\t-e MODE\t\tExecution: process (default) or simulated (no processes are started - implies -f).\n");
+    fprintf(__ERROR_OUTPUT, "\t-f\t\tFast mode: advance the clock without waiting for real time to pass (for benchmarks).\n");
+    fprintf(__ERROR_OUTPUT, "\t-g PARAM=V,...\tSweep a scheduling parameter over a list of values. Every combination of the swept parameters is simulated\n\t\t\tin parallel, and the results are compared in a table.\n");
+    fprintf(__ERROR_OUTPUT, "\t-i TICKS\tPrint the status every TICKS ticks (default %d). The host dispatcher sleeps until the next event.\n", STATUS_INTERVAL);
+    fprintf(__ERROR_OUTPUT, "\t-j JOBS\t\tNumber of simulations to run at once in a sweep (default one per online CPU).\n");
+    fprintf(__ERROR_OUTPUT, "\t-k FILE\t\tCheckpoint the state to FILE, and recover it from FILE on restart. The dispatch list is then ignored.\n");
+    fprintf(__ERROR_OUTPUT, "\t-l WORKLOAD\tWorkload performed by each process: sleep (default), cpu, memory (touching the memory of the process), io or mixed.\n");
+    fprintf(__ERROR_OUTPUT, "\t-m MODE\t\tMemory enforcement: none (default), rlimit or cgroup.\n");
+    fprintf(__ERROR_OUTPUT, "\t-n CPUS\t\tNumber of CPUs that the active process can occupy (default %d, at most %d). A gang with up to CPUS\n\t\t\tmembers runs all of its members at once.\n", CPUS, MAX_GANG);
+    fprintf(__ERROR_OUTPUT, "\t-N NODES\tNumber of memory (NUMA) nodes that the memory is divided between (default %d, at most %d, 0 for\n\t\t\tthe number of NUMA nodes of the host). A process is allocated memory on the node that it last ran on\n\t\t\t(or a node chosen by its ID), spilling to the next node if it does not fit, and is bound to that node.\n", MEMORY_NODES, MAX_MEMORY_NODES);
+    fprintf(__ERROR_OUTPUT, "\t-o PARAM=VALUE\tSet a scheduling parameter: quantum (default %d ticks), levels (number of feedback queues, default %d,\n\t\t\tat most %d), reserved (memory reserved for real time processes, default %d MB)\n\t\t\tor migration (ticks for which a suspended process is resumed on the CPU that it last ran on, default %d,\n\t\t\t0 to never restrict processes).\n", QUANTUM, NUM_FEEDBACK_QUEUES, MAX_FEEDBACK_QUEUES, RESERVED_MEMORY, MIGRATION_COST);
+    fprintf(__ERROR_OUTPUT, "\t-p POLICY\tMemory placement policy: first (default), next, best or worst.\n");
+    fprintf(__ERROR_OUTPUT, "\t-r SLOTS\tAccept processes through a shared-memory submission ring with SLOTS slots (0 for %d). Requires -c.\n", RING_DEFAULT_SLOTS);
+    fprintf(__ERROR_OUTPUT, "\t-s METHOD\tSuspension method: signal (default) or freezer.\n");
+    fprintf(__ERROR_OUTPUT, "\t-w WORKERS\tNumber of idle pre-spawned workers to keep for starting processes (default 0).\n");
 }
 
 /*
@@ -635,95 +436,8 @@ void print_help(void) {
     fprintf(__STANDARD_OUTPUT, "\tSUSPENDED-RRQx\tProcess is queued in the feedback (round robin) queue with priority x and \n\t\t\thas been suspended.\n");
     fprintf(__STANDARD_OUTPUT, "\tPENDING\t\tProcess is in the user job queue and has not yet been allocated memory or \n\t\t\tresources.\n");
     fprintf(__STANDARD_OUTPUT, "\tUNLOADED\tProcess is in the input dispatcher queue and is not ready to be executed \n\t\t\tyet.\n");
+    fprintf(__STANDARD_OUTPUT, "\tWAITING\t\tProcess has arrived, but is in the input dispatcher queue until the \n\t\t\tprocesses that it depends on have completed.\n");
+    fprintf(__STANDARD_OUTPUT, "\t... xN\t\tProcess is a job array with N instances that have not been admitted. \n\t\t\tThe ID is that of the last instance.\n");
+    fprintf(__STANDARD_OUTPUT, "\t... GANGn\tProcess is a gang of n member processes, which are started, suspended and \n\t\t\trestarted together. The PID is that of the first member.\n");
     fprintf(__STANDARD_OUTPUT, "====================================================================================================\n");
 }
-
-/*
- * Prints the current status of the host dispatcher and all processes.
- *
- * This function uses global variables for the clock, memory resources,
- * resources, input queue, user job queue, real time queue, feedback queues and
- * active process.
- */
-void print_status(void) {
-    PCB * input = input_queue; // to iterate through the input queue
-    PCB * user_job = user_job_queue; // to iterate through the user job queue
-    PCB * real_time = real_time_queue; // to iterate through the real time queue
-
-    // Output header
-    fprintf(__STANDARD_OUTPUT, "====================================================================================================\n");
-    fprintf(__STANDARD_OUTPUT, "Time:\t\t\t%d\n", clock);
-    fprintf(__STANDARD_OUTPUT, "====================================================================================================\n");
-    fprintf(__STANDARD_OUTPUT, "ID\t| PID\tARRIVE\tREMAIN\tPRIOR\t| MB\tMAB ID\t| PRINT\tSCAN\tMODEM\tCD\t| STATUS\n");
-    fprintf(__STANDARD_OUTPUT, "----------------------------------------------------------------------------------------------------\n");
-
-    // Output process information
-    if (!finished()) {
-        if (active != NULL) {
-            if (active->memory != NULL) {
-                fprintf(__STANDARD_OUTPUT, "%d\t| %d\t%d\t%d\t%d\t| %d\t%d\t| %d\t%d\t%d\t%d\t| ACTIVE\n", active->id, active->pid, active->arrival_time, active->remaining_cpu_time, active->priority, active->mbytes, active->memory->id, active->num_printers, active->num_scanners, active->num_modems, active->num_cds);
-            } else {
-                fprintf(__STANDARD_OUTPUT, "%d\t| %d\t%d\t%d\t%d\t| %d\t(null)\t| %d\t%d\t%d\t%d\t| ACTIVE\n", active->id, active->pid, active->arrival_time, active->remaining_cpu_time, active->priority, active->mbytes, active->num_printers, active->num_scanners, active->num_modems, active->num_cds);
-            }
-        }
-
-        while (real_time != NULL) {
-            if (real_time->memory != NULL) {
-                fprintf(__STANDARD_OUTPUT, "%d\t| %d\t%d\t%d\t%d\t| %d\t%d\t| %d\t%d\t%d\t%d\t| QUEUED-RT\n", real_time->id, real_time->pid, real_time->arrival_time, real_time->remaining_cpu_time, real_time->priority, real_time->mbytes, real_time->memory->id, real_time->num_printers, real_time->num_scanners, real_time->num_modems, real_time->num_cds);
-            } else {
-                fprintf(__STANDARD_OUTPUT, "%d\t| %d\t%d\t%d\t%d\t| %d\t(null)\t| %d\t%d\t%d\t%d\t| QUEUED-RT\n", real_time->id, real_time->pid, real_time->arrival_time, real_time->remaining_cpu_time, real_time->priority, real_time->mbytes, real_time->num_printers, real_time->num_scanners, real_time->num_modems, real_time->num_cds);
-            }
-            real_time = real_time->next;
-        }
-
-        for (unsigned int i = 0; i < NUM_FEEDBACK_QUEUES; i++) {
-            if (feedback_queue[i] != NULL) {
-                PCB * feedback = feedback_queue[i]; // to iterate through current feedback queue
-                while (feedback != NULL) {
-                    // Check if the process has been started (PID is non-zero)
-                    if (feedback->pid != 0) {
-                        if (feedback->memory != NULL) {
-                            fprintf(__STANDARD_OUTPUT, "%d\t| %d\t%d\t%d\t%d\t| %d\t%d\t| %d\t%d\t%d\t%d\t| SUSPENDED-RRQ%d\n", feedback->id, feedback->pid, feedback->arrival_time, feedback->remaining_cpu_time, feedback->priority, feedback->mbytes, feedback->memory->id, feedback->num_printers, feedback->num_scanners, feedback->num_modems, feedback->num_cds, i + 1);
-                        } else {
-                            fprintf(__STANDARD_OUTPUT, "%d\t| %d\t%d\t%d\t%d\t| %d\t(null)\t| %d\t%d\t%d\t%d\t| SUSPENDED-RRQ%d\n", feedback->id, feedback->pid, feedback->arrival_time, feedback->remaining_cpu_time, feedback->priority, feedback->mbytes, feedback->num_printers, feedback->num_scanners, feedback->num_modems, feedback->num_cds, i + 1);
-                        }
-                    } else {
-                        if (feedback->memory != NULL) {
-                            fprintf(__STANDARD_OUTPUT, "%d\t| %d\t%d\t%d\t%d\t| %d\t%d\t| %d\t%d\t%d\t%d\t| QUEUED-RRQ%d\n", feedback->id, feedback->pid, feedback->arrival_time, feedback->remaining_cpu_time, feedback->priority, feedback->mbytes, feedback->memory->id, feedback->num_printers, feedback->num_scanners, feedback->num_modems, feedback->num_cds, i + 1);
-                        } else {
-                            fprintf(__STANDARD_OUTPUT, "%d\t| %d\t%d\t%d\t%d\t| %d\t(null)\t| %d\t%d\t%d\t%d\t| QUEUED-RRQ%d\n", feedback->id, feedback->pid, feedback->arrival_time, feedback->remaining_cpu_time, feedback->priority, feedback->mbytes, feedback->num_printers, feedback->num_scanners, feedback->num_modems, feedback->num_cds, i + 1);
-                        }
-                    }
-                    feedback = feedback->next;
-                }
-            }
-        }
-
-        while (user_job != NULL) {
-            if (user_job->memory != NULL) {
-                fprintf(__STANDARD_OUTPUT, "%d\t| %d\t%d\t%d\t%d\t| %d\t%d\t| %d\t%d\t%d\t%d\t| PENDING\n", user_job->id, user_job->pid, user_job->arrival_time, user_job->remaining_cpu_time, user_job->priority, user_job->mbytes, user_job->memory->id, user_job->num_printers, user_job->num_scanners, user_job->num_modems, user_job->num_cds);
-            } else {
-                fprintf(__STANDARD_OUTPUT, "%d\t| %d\t%d\t%d\t%d\t| %d\t(null)\t| %d\t%d\t%d\t%d\t| PENDING\n", user_job->id, user_job->pid, user_job->arrival_time, user_job->remaining_cpu_time, user_job->priority, user_job->mbytes, user_job->num_printers, user_job->num_scanners, user_job->num_modems, user_job->num_cds);
-            }
-            user_job = user_job->next;
-        }
-
-        while (input != NULL) {
-            if (input->memory != NULL) {
-                fprintf(__STANDARD_OUTPUT, "%d\t| %d\t%d\t%d\t%d\t| %d\t%d\t| %d\t%d\t%d\t%d\t| UNLOADED\n", input->id, input->pid, input->arrival_time, input->remaining_cpu_time, input->priority, input->mbytes, input->memory->id, input->num_printers, input->num_scanners, input->num_modems, input->num_cds);
-            } else {
-                fprintf(__STANDARD_OUTPUT, "%d\t| %d\t%d\t%d\t%d\t| %d\t(null)\t| %d\t%d\t%d\t%d\t| UNLOADED\n", input->id, input->pid, input->arrival_time, input->remaining_cpu_time, input->priority, input->mbytes, input->num_printers, input->num_scanners, input->num_modems, input->num_cds);
-            }
-            input = input->next;
-        }
-    } else {
-        fprintf(__STANDARD_OUTPUT, "(none)\n");
-    }
-
-    // End of output
-    fprintf(__STANDARD_OUTPUT, "====================================================================================================\n");
-
-    // Output memory and resources
-    print_MAB_list(memory);
-    print_RAS_list(resources);
-}
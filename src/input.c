@@ -8,94 +8,42 @@
  * of PCBs.
  */
 #include "../inc/input.h"
-#include "../inc/hostd.h"
+#include "../inc/dispatcher.h"
 #include "../inc/PCB.h"
+#include "../inc/dependency.h"
 #include "../inc/output.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+static boolean parse_field(ProcessRecord * record, char * field);
+
 /*
- * Parse an input CSV file, creating a queue of PCBs.
+ * Parse an input CSV file, creating a queue of PCBs. Each line of the file is
+ * parsed with parse_process().
  *
  * PARAMETERS
+ *     dispatcher: The host dispatcher.
  *     file: The input file to parse.
  *
  * RETURN VALUE
  * A pointer to the head of the input queue.
  */
-PCB * read_process_list(FILE * file) {
+PCB * read_process_list(Dispatcher * dispatcher, FILE * file) {
     PCB * head = NULL; // the head of the input queue
     PCB * tail = NULL; // the tail of the input queue
     PCB * new_pcb = NULL; // the new PCB to add to the tail of the input queue
-    int status; // return value from fscanf
 
     char buffer[INPUT_BUFFER]; // buffer for reading a line of input
 
-    unsigned int arrival_time; // arrival time of PCB
-    unsigned int priority; // priority of PCB
-    unsigned int remaining_cpu_time; // remaining CPU time of PCB
-    unsigned int mbytes; // memory required by process
-    unsigned int num_printers; // the number of printer resources required by the process
-    unsigned int num_scanners; // the number of scanner resources required by the process
-    unsigned int num_modems; // the number of modem resources required by the process
-    unsigned int num_cds; // the number of CD resources required by the process
-
     // Read input file until at end of file
     while (fgets(buffer, sizeof(buffer), file) != NULL) {
-        status = sscanf(buffer, "%u, %u, %u, %u, %u, %u, %u, %u", &arrival_time, &priority, &remaining_cpu_time, &mbytes, &num_printers, &num_scanners, &num_modems, &num_cds);
-
-        if (status == 8) {
-            // Create new PCB node
-            new_pcb = create_null_PCB();
-
-            // Parse input file
-#ifdef DEBUG
-            fprintf(__DEBUG_OUTPUT, "Parsing input file for PCB %d.\n", new_pcb->id);
-#endif // #ifdef DEBUG
-
-            // Store PCB parameters
-            new_pcb->arrival_time = arrival_time;
-            if (priority > LOWEST_PRIORITY) {
-                fprintf(__ERROR_OUTPUT, "PCB %d has an invalid priority value (%d). Setting priority to lowest priority (%d).\n", new_pcb->id, priority, LOWEST_PRIORITY);
-                new_pcb->priority = LOWEST_PRIORITY;
-            } else {
-                new_pcb->priority = priority;
-            }
-            new_pcb->remaining_cpu_time = remaining_cpu_time;
-            new_pcb->mbytes = mbytes;
-            new_pcb->num_printers = num_printers;
-            new_pcb->num_scanners = num_scanners;
-            new_pcb->num_modems = num_modems;
-            new_pcb->num_cds = num_cds;
-
-            // Store the program to run in args[0]
-            new_pcb->args[0] = (char *) malloc(STRING_BUFFER);
-            strcpy(new_pcb->args[0], PROCESS);
-
-            // Store the program arguments in args[1]
-            new_pcb->args[1] = (char *) malloc(STRING_BUFFER);
-            sprintf(new_pcb->args[1], "%d", new_pcb->remaining_cpu_time);
-
-            // Args array is null terminated
-            new_pcb->args[2] = '\0';
-
-            // If real time process then check resources and memory
-            if (new_pcb->priority == REAL_TIME_PROCESS_PRIORITY) {
-                if (new_pcb->mbytes > REAL_TIME_PROCESS_MAX_MBYTES) {
-                    new_pcb->mbytes = REAL_TIME_PROCESS_MAX_MBYTES;
-                }
-                new_pcb->num_printers = 0;
-                new_pcb->num_scanners = 0;
-                new_pcb->num_modems = 0;
-                new_pcb->num_cds = 0;
-            }
-
+        if ((new_pcb = parse_process(dispatcher, buffer)) != NULL) {
             // Link previous node to new node
 #ifdef DEBUG
-            print_PCB(new_pcb);
             fprintf(__DEBUG_OUTPUT, "\nAdding PCB %d to input queue.\n", new_pcb->id);
 #endif // #ifdef DEBUG
+            dependency_add(&dispatcher->dependencies, new_pcb);
 
             if (head == NULL) {
                 head = new_pcb;
@@ -113,3 +61,289 @@ PCB * read_process_list(FILE * file) {
 
     return head;
 }
+
+/*
+ * Parse a single process record, creating a PCB.
+ *
+ * A record contains eight mandatory fields (arrival time, priority, CPU time,
+ * memory, printers, scanners, modems and CDs), optionally followed by any
+ * number of 'key=value' fields. The supported optional fields are:
+ *     deadline: The deadline of a real time process, relative to its arrival
+ *         time.
+ *     after: The ID of a process that must complete before this process is
+ *         executed (the ID of any instance of a job array waits for every
+ *         instance). Up to MAX_DEPENDENCIES of these fields can be given.
+ *     count: The number of identical processes to create (a job array). The
+ *         processes are given consecutive IDs.
+ *     gang: The number of member processes to start, suspend and restart
+ *         together on separate CPUs (at most the number of CPUs). The memory
+ *         and resources of the process are shared by its members.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     line: The record to parse. This string is modified.
+ *
+ * RETURN VALUE
+ * A pointer to the new PCB, or NULL if the mandatory fields are invalid or the
+ * process can never be admitted (see create_submitted_process()).
+ */
+PCB * parse_process(Dispatcher * dispatcher, char * line) {
+    ProcessRecord record; // the fields of the record
+    int status; // return value from sscanf
+    int length = 0; // number of characters consumed by sscanf
+
+    status = sscanf(line, "%u, %u, %u, %u, %u, %u, %u, %u%n", &record.arrival_time, &record.priority, &record.remaining_cpu_time, &record.mbytes, &record.num_printers, &record.num_scanners, &record.num_modems, &record.num_cds, &length);
+
+    if (status != 8) {
+        return NULL;
+    }
+    record.deadline = 0;
+    record.num_dependencies = 0;
+    record.instances = 1;
+    record.gang = 1;
+
+    // Parse any optional fields
+    for (char * field = strtok(line + length, ",\r\n"); field != NULL; field = strtok(NULL, ",\r\n")) {
+        if (!parse_field(&record, field)) {
+            fprintf(__ERROR_OUTPUT, "Invalid field '%s'. Ignoring field.\n", field);
+        }
+    }
+
+    return create_submitted_process(dispatcher, &record);
+}
+
+/*
+ * Creates a PCB for a process record that has been submitted (see
+ * create_process()). A process that requires more memory or resources than the
+ * system can provide is rejected, rather than being left to wait in the user
+ * job queue for memory or resources that will never be available (where it
+ * would block the processes that could be backfilled around it).
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     record: The process record.
+ *
+ * RETURN VALUE
+ * A pointer to the new PCB, or NULL if the process was rejected.
+ */
+PCB * create_submitted_process(Dispatcher * dispatcher, ProcessRecord * record) {
+    PCB * pcb = create_process(dispatcher, record); // the submitted process
+
+    if ((pcb != NULL) && !check_memory_and_resources(dispatcher, pcb)) {
+        fprintf(__ERROR_OUTPUT, "PCB %d requested more memory or resources than the system can provide. This process will not be executed.\n", pcb->id);
+        free_PCB(dispatcher, &pcb);
+        return NULL;
+    }
+
+    return pcb;
+}
+
+/*
+ * Creates a PCB for a process record, validating the fields of the record. A
+ * record for a job array creates a single PCB, which is given the ID of the
+ * last instance of the array - the IDs of the other instances are reserved.
+ *
+ * PARAMETERS
+ *     dispatcher: The host dispatcher.
+ *     record: The process record.
+ *
+ * RETURN VALUE
+ * A pointer to the new PCB.
+ */
+PCB * create_process(Dispatcher * dispatcher, ProcessRecord * record) {
+    unsigned int ids = 1; // number of IDs to reserve
+
+    // Reserve the IDs of the other instances of a job array along with the ID of the PCB (real time processes are admitted individually, so cannot be job arrays)
+    if ((record->instances > 1) && (record->priority != REAL_TIME_PROCESS_PRIORITY)) {
+        ids = (record->instances > MAX_INSTANCES) ? MAX_INSTANCES : record->instances;
+    }
+
+    // Create new PCB node
+    PCB * new_pcb = create_null_PCB(dispatcher, ids);
+    unsigned int first_id = new_pcb->id; // the ID of the first instance of a job array
+
+    if (record->instances > 1) {
+        if (record->priority == REAL_TIME_PROCESS_PRIORITY) {
+            fprintf(__ERROR_OUTPUT, "PCB %d is a real time process. Ignoring count.\n", new_pcb->id);
+        } else {
+            if (record->instances > MAX_INSTANCES) {
+                fprintf(__ERROR_OUTPUT, "PCB %d has too many instances (%d). Creating %d instances.\n", new_pcb->id, record->instances, MAX_INSTANCES);
+                record->instances = MAX_INSTANCES;
+            }
+            new_pcb->instances = record->instances;
+            new_pcb->id = first_id + record->instances - 1;
+        }
+    }
+
+#ifdef DEBUG
+    fprintf(__DEBUG_OUTPUT, "Creating PCB %d.\n", new_pcb->id);
+#endif // #ifdef DEBUG
+
+    // Store PCB parameters
+    new_pcb->arrival_time = record->arrival_time;
+    if (record->priority > LOWEST_PRIORITY) {
+        fprintf(__ERROR_OUTPUT, "PCB %d has an invalid priority value (%d). Setting priority to lowest priority (%d).\n", new_pcb->id, record->priority, LOWEST_PRIORITY);
+        new_pcb->priority = LOWEST_PRIORITY;
+    } else {
+        new_pcb->priority = record->priority;
+    }
+    new_pcb->remaining_cpu_time = record->remaining_cpu_time;
+    new_pcb->mbytes = record->mbytes;
+    new_pcb->num_printers = record->num_printers;
+    new_pcb->num_scanners = record->num_scanners;
+    new_pcb->num_modems = record->num_modems;
+    new_pcb->num_cds = record->num_cds;
+
+    // The members of a gang run at the same time, so a gang cannot have more members than there are CPUs for them
+    if (record->gang > 1) {
+        if (record->gang > dispatcher->config.cpus) {
+            fprintf(__ERROR_OUTPUT, "PCB %d has more members (%d) than CPUs (%d). Creating %d members.\n", new_pcb->id, record->gang, dispatcher->config.cpus, dispatcher->config.cpus);
+            record->gang = dispatcher->config.cpus;
+        }
+        new_pcb->gang = record->gang;
+    }
+
+    // Deadlines are specified relative to the arrival time
+    if (record->deadline != 0) {
+        new_pcb->deadline = record->arrival_time + record->deadline;
+    }
+
+    // A process can only depend on processes submitted before it, so the dependencies cannot form a cycle
+    for (unsigned int i = 0; (i < record->num_dependencies) && (i < MAX_DEPENDENCIES); i++) {
+        if ((record->dependencies[i] == 0) || (record->dependencies[i] >= first_id)) {
+            fprintf(__ERROR_OUTPUT, "PCB %d cannot depend on PCB %d, which was not submitted before it. Ignoring dependency.\n", new_pcb->id, record->dependencies[i]);
+        } else {
+            new_pcb->dependencies[new_pcb->num_dependencies++] = record->dependencies[i];
+        }
+    }
+
+    // Store the program to run in args[0]
+    new_pcb->args[0] = (char *) malloc(STRING_BUFFER);
+    strcpy(new_pcb->args[0], PROCESS);
+
+    // Store the program arguments in args[1]
+    new_pcb->args[1] = (char *) malloc(STRING_BUFFER);
+    sprintf(new_pcb->args[1], "%d", new_pcb->remaining_cpu_time);
+
+    // Args array is null terminated
+    new_pcb->args[2] = '\0';
+
+    // If real time process then check resources and memory
+    if (new_pcb->priority == REAL_TIME_PROCESS_PRIORITY) {
+        if (new_pcb->mbytes > REAL_TIME_PROCESS_MAX_MBYTES) {
+            new_pcb->mbytes = REAL_TIME_PROCESS_MAX_MBYTES;
+        }
+        new_pcb->num_printers = 0;
+        new_pcb->num_scanners = 0;
+        new_pcb->num_modems = 0;
+        new_pcb->num_cds = 0;
+    } else if (new_pcb->deadline != 0) {
+        fprintf(__ERROR_OUTPUT, "PCB %d is not a real time process. Ignoring deadline.\n", new_pcb->id);
+        new_pcb->deadline = 0;
+    }
+
+    // Store the workload in args[2] and the memory that each member may touch in args[3] (the default workload has no arguments, so that any program can be executed)
+    if (dispatcher->config.workload != Sleep_Workload) {
+        new_pcb->args[2] = (char *) malloc(STRING_BUFFER);
+        strcpy(new_pcb->args[2], workload_name(dispatcher->config.workload));
+        new_pcb->args[3] = (char *) malloc(STRING_BUFFER);
+        sprintf(new_pcb->args[3], "%d", new_pcb->mbytes / new_pcb->gang);
+    }
+
+#ifdef DEBUG
+    print_PCB(new_pcb);
+#endif // #ifdef DEBUG
+
+    return new_pcb;
+}
+
+/*
+ * Parse an optional 'key=value' field from a process record and store its
+ * value. Whitespace surrounding the field is ignored.
+ *
+ * PARAMETERS
+ *     record: The process record to store the value in.
+ *     field: The field to parse.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the field was valid.
+ */
+static boolean parse_field(ProcessRecord * record, char * field) {
+    char key[INPUT_BUFFER]; // the name of the field
+    unsigned int value; // the value of the field
+    char trailing; // used to detect trailing garbage
+
+    // Ignore empty fields
+    if (sscanf(field, " %c", &trailing) != 1) {
+        return true;
+    }
+
+    if (sscanf(field, " %[a-z_] = %u %c", key, &value, &trailing) != 2) {
+        return false;
+    }
+
+    if (strcmp(key, "deadline") == 0) {
+        if (value == 0) {
+            return false;
+        }
+        record->deadline = value;
+        return true;
+    }
+
+    if (strcmp(key, "after") == 0) {
+        // A repeated dependency is ignored
+        for (unsigned int i = 0; i < record->num_dependencies; i++) {
+            if (record->dependencies[i] == value) {
+                return true;
+            }
+        }
+        if ((value == 0) || (record->num_dependencies == MAX_DEPENDENCIES)) {
+            return false;
+        }
+        record->dependencies[record->num_dependencies++] = value;
+        return true;
+    }
+
+    if (strcmp(key, "count") == 0) {
+        if (value == 0) {
+            return false;
+        }
+        record->instances = value;
+        return true;
+    }
+
+    if (strcmp(key, "gang") == 0) {
+        if ((value == 0) || (value > MAX_GANG)) {
+            return false;
+        }
+        record->gang = value;
+        return true;
+    }
+
+    return false;
+}
+
+/*
+ * Gets the name of a workload, as it is given on the command line of the host
+ * dispatcher and of sigtrap.
+ *
+ * PARAMETERS
+ *     workload: The workload.
+ *
+ * RETURN VALUE
+ * The name of the workload.
+ */
+const char * workload_name(Workload workload) {
+    switch (workload) {
+        case CPU_Workload:
+            return "cpu";
+        case Memory_Workload:
+            return "memory";
+        case IO_Workload:
+            return "io";
+        case Mixed_Workload:
+            return "mixed";
+        default:
+            return "sleep";
+    }
+}
@@ -0,0 +1,250 @@
+/*
+ * pool.c
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains the functions relating to the pool of pre-spawned worker
+ * processes.
+ *
+ * Each worker is started as "<program> -w", with its standard input connected
+ * to a UNIX domain socket. The worker blocks reading its standard input until
+ * the dispatcher writes the job arguments (each terminated by a null character)
+ * and shuts down its end of the socket. A socket is used rather than a pipe so
+ * that writing to a worker that has died fails with EPIPE instead of raising
+ * SIGPIPE in the dispatcher.
+ */
+#define _POSIX_C_SOURCE 200809L // for fcntl() and waitpid()
+
+#include "../inc/pool.h"
+#include "../inc/output.h"
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+static Worker _idle[MAX_POOL_SIZE]; // the idle workers, oldest first
+static unsigned int _num_idle = 0; // number of idle workers
+static unsigned int _size = 0; // number of idle workers to maintain (0 if the pool is disabled)
+static char * _program = NULL; // the program run by the workers
+
+static boolean spawn_worker(void);
+static boolean worker_exited(Worker * worker);
+
+/*
+ * Initialises the worker pool, and spawns the initial workers.
+ *
+ * PARAMETERS
+ *     program: The program run by the workers. It must support WORKER_FLAG.
+ *     size: The number of idle workers to maintain (0 to disable the pool).
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the pool is enabled.
+ */
+boolean pool_init(const char * program, unsigned int size) {
+    pool_destroy();
+
+    if (size == 0) {
+        return false;
+    }
+
+    if ((_program = (char *) malloc(strlen(program) + 1)) == NULL) {
+        return false;
+    }
+    strcpy(_program, program);
+    _size = (size > MAX_POOL_SIZE) ? MAX_POOL_SIZE : size;
+
+    pool_refill();
+    return true;
+}
+
+/*
+ * Destroys the worker pool. Idle workers exit when they read the end of their
+ * standard input, and are then reaped.
+ */
+void pool_destroy(void) {
+    while (_num_idle > 0) {
+        pool_discard(&_idle[--_num_idle]);
+    }
+
+    free(_program);
+    _program = NULL;
+    _size = 0;
+}
+
+/*
+ * Spawns workers until the pool contains the configured number of idle
+ * workers. This is called once per tick, after processes have been
+ * dispatched, so that the cost of forking and executing the workers is kept off
+ * the job start path.
+ */
+void pool_refill(void) {
+    while (_num_idle < _size) {
+        if (!spawn_worker()) {
+            break;
+        }
+    }
+}
+
+/*
+ * Gets the number of idle workers.
+ *
+ * RETURN VALUE
+ * The number of idle workers.
+ */
+unsigned int pool_idle(void) {
+    return _num_idle;
+}
+
+/*
+ * Takes the oldest idle worker from the pool. The worker does not start its job
+ * until pool_release() is called, which allows the dispatcher to place the
+ * worker in its cgroups first.
+ *
+ * PARAMETERS
+ *     program: The program that the job runs.
+ *     worker: Set to the worker.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether an idle worker running the program was
+ * available.
+ */
+boolean pool_acquire(const char * program, Worker * worker) {
+    if ((_program == NULL) || (strcmp(program, _program) != 0)) {
+        return false;
+    }
+
+    while (_num_idle > 0) {
+        *worker = _idle[0];
+        memmove(&_idle[0], &_idle[1], (--_num_idle) * sizeof(Worker));
+
+        // A worker that failed to execute has already exited
+        if (!worker_exited(worker)) {
+            return true;
+        }
+        close(worker->control);
+    }
+
+    return false;
+}
+
+/*
+ * Starts a job on a worker, by sending it the job arguments.
+ *
+ * PARAMETERS
+ *     worker: The worker, taken from the pool with pool_acquire().
+ *     args: The job arguments (null terminated, with the program in args[0]).
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the arguments were sent. If not, the
+ * worker should be discarded.
+ */
+boolean pool_release(Worker * worker, char * const args[]) {
+    char buffer[PIPE_BUF]; // the encoded arguments
+    size_t length = 0; // length of the encoded arguments
+
+    // Encode the arguments (excluding the program), each terminated by a null character
+    for (unsigned int i = 1; args[i] != NULL; i++) {
+        size_t size = strlen(args[i]) + 1;
+        if (length + size > sizeof(buffer)) {
+            return false;
+        }
+        memcpy(buffer + length, args[i], size);
+        length += size;
+    }
+
+    if ((length > 0) && (send(worker->control, buffer, length, MSG_NOSIGNAL) != (ssize_t) length)) {
+        return false;
+    }
+
+    // The worker starts the job when it reads the end of its standard input
+    close(worker->control);
+    worker->control = -1;
+    return true;
+}
+
+/*
+ * Discards a worker that was taken from the pool but not released.
+ *
+ * PARAMETERS
+ *     worker: The worker.
+ */
+void pool_discard(Worker * worker) {
+    int status;
+
+    if (worker->control >= 0) {
+        close(worker->control);
+        worker->control = -1;
+    }
+
+    // A parked worker exits when its standard input is closed. A worker that has started its job is killed.
+    kill(worker->pid, SIGKILL);
+    waitpid(worker->pid, &status, 0);
+}
+
+/*
+ * Spawns an idle worker.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the worker was spawned.
+ */
+static boolean spawn_worker(void) {
+    int control[2]; // the socket pair - control[0] is the dispatcher's end, control[1] is the worker's standard input
+    Worker * worker = &_idle[_num_idle]; // the new worker
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, control) != 0) {
+        fprintf(__ERROR_OUTPUT, "Unable to create a control socket for a worker.\n");
+        return false;
+    }
+
+    // Neither end may be inherited by other processes, or the worker would never read the end of its input
+    fcntl(control[0], F_SETFD, FD_CLOEXEC);
+    fcntl(control[1], F_SETFD, FD_CLOEXEC);
+
+    switch (worker->pid = fork()) {
+        case -1: // fork failed
+            fprintf(__ERROR_OUTPUT, "Forking of a worker failed.\n");
+            close(control[0]);
+            close(control[1]);
+            return false;
+
+        case 0: // child
+            // dup2() clears the close-on-exec flag of the new descriptor
+            if (dup2(control[1], STDIN_FILENO) < 0) {
+                _exit(EXIT_FAILURE);
+            }
+            execl(_program, _program, WORKER_FLAG, (char *) NULL);
+
+            // If execution reaches this line, an error has occured as execl should never return
+            fprintf(__ERROR_OUTPUT, "Execution of a worker (PID: %d) failed.\n", (int) getpid());
+            _exit(EXIT_FAILURE);
+
+        default: // parent
+            close(control[1]);
+            worker->control = control[0];
+            _num_idle++;
+#ifdef DEBUG
+            fprintf(__DEBUG_OUTPUT, "Spawned worker (PID: %d). Idle workers: %d.\n", (int) worker->pid, _num_idle);
+#endif // #ifdef DEBUG
+            return true;
+    }
+}
+
+/*
+ * Checks whether a worker has exited, reaping it if so.
+ *
+ * PARAMETERS
+ *     worker: The worker.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the worker has exited.
+ */
+static boolean worker_exited(Worker * worker) {
+    int status;
+
+    return (waitpid(worker->pid, &status, WNOHANG) == worker->pid);
+}
@@ -0,0 +1,379 @@
+/*
+ * ring.c
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains the functions relating to the submission ring.
+ *
+ * The ring is a bounded multiple producer, single consumer queue in a memfd
+ * that is shared by the host dispatcher and the producers. Each slot carries a
+ * sequence number, which is equal to the position that the slot can next be
+ * written at. A producer claims a position by incrementing the tail of the ring
+ * with a compare-and-swap, writes its record to the slot, and then publishes
+ * the record by setting the sequence number to the position plus one. The host
+ * dispatcher drains published records in order, setting the sequence number of
+ * each slot to the position that the slot will be written at on the next lap.
+ * Neither side takes a lock or makes a system call, unless the ring is full.
+ *
+ * A producer that finds the ring full can wait on the 'space' futex, which the
+ * host dispatcher increments (and wakes, if there are waiters) whenever it
+ * drains records. The host dispatcher does not wait on the ring - it polls it
+ * at each tick, and every RING_DRAIN_INTERVAL milliseconds in between.
+ *
+ * Every producer maps the ring read-write, so nothing that the host dispatcher
+ * reads from the shared memory is trusted. The number of slots and the head of
+ * the ring are kept in a RingConsumer in the private memory of the host
+ * dispatcher, and the copy of the head in the ring is only ever written by the
+ * host dispatcher (for producers to read).
+ */
+#define _GNU_SOURCE // for memfd_create() and syscall()
+
+#include "../inc/ring.h"
+#include "../inc/output.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+
+static size_t ring_size(unsigned int slots);
+static long futex(uint32_t * word, int operation, uint32_t value, const struct timespec * timeout);
+
+/*
+ * Creates a submission ring in a new memfd.
+ *
+ * PARAMETERS
+ *     slots: The number of records that the ring can hold. This is rounded up to
+ *         a power of two.
+ *     fd: Set to the memfd containing the ring, which is passed to producers.
+ *
+ * RETURN VALUE
+ * A pointer to the host dispatcher's side of the ring, or NULL if the ring could
+ * not be created.
+ */
+RingConsumer * ring_create(unsigned int slots, int * fd) {
+    unsigned int size = 2; // number of slots (rounded up to a power of two)
+    RingConsumer * consumer; // the host dispatcher's side of the ring
+    Ring * ring; // the ring
+
+    while ((size < slots) && (size < RING_MAX_SLOTS)) {
+        size *= 2;
+    }
+
+    if ((consumer = (RingConsumer *) malloc(sizeof(RingConsumer))) == NULL) {
+        fprintf(__ERROR_OUTPUT, "Unable to allocate memory for the submission ring.\n");
+        *fd = -1;
+        return NULL;
+    }
+
+    if ((*fd = memfd_create("hostd-ring", MFD_CLOEXEC)) < 0) {
+        fprintf(__ERROR_OUTPUT, "Unable to create the shared memory for the submission ring.\n");
+        free(consumer);
+        return NULL;
+    }
+
+    if ((ftruncate(*fd, ring_size(size)) != 0) || ((ring = (Ring *) mmap(NULL, ring_size(size), PROT_READ | PROT_WRITE, MAP_SHARED, *fd, 0)) == MAP_FAILED)) {
+        fprintf(__ERROR_OUTPUT, "Unable to map the shared memory for the submission ring.\n");
+        close(*fd);
+        *fd = -1;
+        free(consumer);
+        return NULL;
+    }
+
+    // The memfd is zero filled, so only the slot sequence numbers need to be initialised
+    ring->slots = size;
+    for (unsigned int i = 0; i < size; i++) {
+        ring->slot[i].sequence = i;
+    }
+    __atomic_store_n(&ring->magic, RING_MAGIC, __ATOMIC_RELEASE);
+
+    consumer->ring = ring;
+    consumer->slots = size;
+    consumer->mask = size - 1;
+    consumer->head = 0;
+
+    return consumer;
+}
+
+/*
+ * Drains published records from a ring. This must only be called by the host
+ * dispatcher.
+ *
+ * PARAMETERS
+ *     consumer: The host dispatcher's side of the ring.
+ *     records: Set to the records that were drained.
+ *     max: The maximum number of records to drain.
+ *
+ * RETURN VALUE
+ * The number of records drained.
+ */
+unsigned int ring_drain(RingConsumer * consumer, ProcessRecord * records, unsigned int max) {
+    Ring * ring = consumer->ring; // the shared memory of the ring
+    uint64_t head = consumer->head; // the next position to drain
+    unsigned int n = 0; // number of records drained
+
+    while (n < max) {
+        RingSlot * slot = &ring->slot[head & consumer->mask]; // the slot at the head of the ring
+
+        // Stop at the first record that has not been published
+        if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != head + 1) {
+            break;
+        }
+
+        records[n++] = slot->record;
+
+        // Release the slot for the next lap of the ring
+        __atomic_store_n(&slot->sequence, head + consumer->slots, __ATOMIC_RELEASE);
+        head++;
+    }
+
+    if (n > 0) {
+        consumer->head = head;
+        __atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+
+        // Wake any producers waiting for space
+        __atomic_add_fetch(&ring->space, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&ring->waiters, __ATOMIC_SEQ_CST) > 0) {
+            futex(&ring->space, FUTEX_WAKE, INT_MAX, NULL);
+        }
+    }
+
+    return n;
+}
+
+/*
+ * Unmaps a ring and frees the host dispatcher's side of it. The memfd
+ * containing the ring is not closed.
+ *
+ * PARAMETERS
+ *     consumer: The host dispatcher's side of the ring.
+ */
+void ring_close(RingConsumer * consumer) {
+    if (consumer != NULL) {
+        munmap(consumer->ring, ring_size(consumer->slots));
+        free(consumer);
+    }
+}
+
+/*
+ * Attaches to the submission ring of a host dispatcher, by requesting the
+ * memfd containing the ring over its control socket.
+ *
+ * PARAMETERS
+ *     path: The path of the control socket.
+ *
+ * RETURN VALUE
+ * A pointer to the ring, or NULL if the ring could not be attached.
+ */
+Ring * ring_connect(const char * path) {
+    struct sockaddr_un address; // the address of the control socket
+    char response[RING_CACHE_LINE]; // the response to the request
+    size_t length = 0; // length of the response
+    int fd = -1; // the memfd received from the host dispatcher
+    int control; // the socket connected to the host dispatcher
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+
+    if (((control = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) || (connect(control, (struct sockaddr *) &address, sizeof(address)) != 0) || (send(control, "RING\n", 5, MSG_NOSIGNAL) != 5)) {
+        fprintf(__ERROR_OUTPUT, "Unable to request the submission ring from control socket '%s'.\n", path);
+        if (control >= 0) {
+            close(control);
+        }
+        return NULL;
+    }
+
+    // Read the response, which carries the memfd
+    while (length < sizeof(response) - 1) {
+        char buffer[CMSG_SPACE(sizeof(int))]; // the ancillary data
+        struct iovec data = { &response[length], 1 }; // the next byte of the response
+        struct msghdr message; // the message received
+        struct cmsghdr * header; // the header of the ancillary data
+
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = &data;
+        message.msg_iovlen = 1;
+        message.msg_control = buffer;
+        message.msg_controllen = sizeof(buffer);
+
+        if (recvmsg(control, &message, MSG_CMSG_CLOEXEC) != 1) {
+            break;
+        }
+
+        for (header = CMSG_FIRSTHDR(&message); header != NULL; header = CMSG_NXTHDR(&message, header)) {
+            if ((header->cmsg_level == SOL_SOCKET) && (header->cmsg_type == SCM_RIGHTS)) {
+                memcpy(&fd, CMSG_DATA(header), sizeof(int));
+            }
+        }
+
+        if (response[length++] == '\n') {
+            break;
+        }
+    }
+    response[length] = '\0';
+    close(control);
+
+    if ((strncmp(response, "OK", 2) != 0) || (fd < 0)) {
+        fprintf(__ERROR_OUTPUT, "The host dispatcher did not provide a submission ring: %s", (length > 0) ? response : "no response\n");
+        if (fd >= 0) {
+            close(fd);
+        }
+        return NULL;
+    }
+
+    return ring_attach(fd);
+}
+
+/*
+ * Attaches to a submission ring. The memfd is closed once it has been mapped.
+ *
+ * PARAMETERS
+ *     fd: The memfd containing the ring.
+ *
+ * RETURN VALUE
+ * A pointer to the ring, or NULL if the memfd does not contain a ring.
+ */
+Ring * ring_attach(int fd) {
+    struct stat info; // information about the memfd
+    Ring * ring; // the ring
+
+    if ((fstat(fd, &info) != 0) || ((size_t) info.st_size < sizeof(Ring)) || ((ring = (Ring *) mmap(NULL, info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED)) {
+        fprintf(__ERROR_OUTPUT, "Unable to map the submission ring.\n");
+        close(fd);
+        return NULL;
+    }
+    close(fd);
+
+    if ((__atomic_load_n(&ring->magic, __ATOMIC_ACQUIRE) != RING_MAGIC) || (ring_size(ring->slots) != (size_t) info.st_size)) {
+        fprintf(__ERROR_OUTPUT, "The shared memory does not contain a submission ring.\n");
+        munmap(ring, info.st_size);
+        return NULL;
+    }
+
+    return ring;
+}
+
+/*
+ * Submits a process record to a ring.
+ *
+ * PARAMETERS
+ *     ring: The ring.
+ *     record: The process record.
+ *     wait: Whether to wait for space if the ring is full.
+ *     position: Set to the position of the record in the ring, if not NULL.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the record was submitted (false if the
+ * ring is full and wait is false).
+ */
+boolean ring_submit(Ring * ring, ProcessRecord * record, boolean wait, uint64_t * position) {
+    uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED); // the position to claim
+    RingSlot * slot; // the slot at the claimed position
+
+    for (;;) {
+        slot = &ring->slot[tail & (ring->slots - 1)];
+        uint64_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE); // the position that the slot can next be written at
+        int64_t difference = (int64_t) (sequence - tail);
+
+        if (difference == 0) {
+            // The slot is free - claim the position (on failure, tail is updated to the current tail)
+            if (__atomic_compare_exchange_n(&ring->tail, &tail, tail + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (difference < 0) {
+            // The slot has not been drained since the previous lap - the ring is full
+            if (!wait) {
+                return false;
+            }
+
+            struct timespec timeout = { 0, RING_WAIT_TIMEOUT * 1000000L }; // the maximum time to wait
+            uint32_t space = __atomic_load_n(&ring->space, __ATOMIC_SEQ_CST); // the futex value before checking the slot again
+
+            __atomic_add_fetch(&ring->waiters, 1, __ATOMIC_SEQ_CST);
+            if (__atomic_load_n(&slot->sequence, __ATOMIC_SEQ_CST) == sequence) {
+                futex(&ring->space, FUTEX_WAIT, space, &timeout);
+            }
+            __atomic_sub_fetch(&ring->waiters, 1, __ATOMIC_SEQ_CST);
+
+            tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+        } else {
+            // Another producer claimed the position
+            tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    // Write and publish the record
+    slot->record = *record;
+    __atomic_store_n(&slot->sequence, tail + 1, __ATOMIC_RELEASE);
+
+    if (position != NULL) {
+        *position = tail;
+    }
+
+    return true;
+}
+
+/*
+ * Checks whether the record at a position has been drained by the host
+ * dispatcher.
+ *
+ * PARAMETERS
+ *     ring: The ring.
+ *     position: The position of the record.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the record has been drained.
+ */
+boolean ring_drained(Ring * ring, uint64_t position) {
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) > position;
+}
+
+/*
+ * Unmaps a ring.
+ *
+ * PARAMETERS
+ *     ring: The ring.
+ */
+void ring_destroy(Ring * ring) {
+    if (ring != NULL) {
+        munmap(ring, ring_size(ring->slots));
+    }
+}
+
+/*
+ * Calculates the size of the shared memory of a ring.
+ *
+ * PARAMETERS
+ *     slots: The number of slots in the ring.
+ *
+ * RETURN VALUE
+ * The size of the ring (in bytes).
+ */
+static size_t ring_size(unsigned int slots) {
+    return sizeof(Ring) + (size_t) slots * sizeof(RingSlot);
+}
+
+/*
+ * Performs a futex operation on a futex in shared memory.
+ *
+ * PARAMETERS
+ *     word: The futex.
+ *     operation: The futex operation.
+ *     value: The value for the operation.
+ *     timeout: The timeout for FUTEX_WAIT (NULL to wait indefinitely).
+ *
+ * RETURN VALUE
+ * The result of the futex system call.
+ */
+static long futex(uint32_t * word, int operation, uint32_t value, const struct timespec * timeout) {
+    return syscall(SYS_futex, word, operation, value, timeout, NULL, 0);
+}
@@ -2,16 +2,42 @@
   sigtrap - report system signals applied to process
 
   usage:
-    sigtrap [n]
+    sigtrap [n [profile [mbytes]]]
 
     [n] is time for process to exist - default 20 seconds
 
+    [profile] is the work done in each second - default sleep:
+      sleep   - nothing (the program sleeps)
+      cpu     - spin on the CPU
+      memory  - touch [mbytes] of memory (default 16), a cache line
+                at a time
+      io      - write a block to a temporary file and fsync it
+      mixed   - alternate between the cpu, memory and io kernels
+
+    with any profile but sleep, the program reports the work that it
+    achieved per second of work and its CPU time when it exits.
+
   program ticks away reporting process id and tick count every
   second. the program traps and reports the following signals:
     SIGINT, SIGQUIT, SIGHUP, SIGTERM, SIGABRT, SIGCONT, SIGTSTP
 
   program can not trap SIGSTOP or SIGKILL
 
+  if invoked as 'sigtrap -w', the program is a pre-spawned worker: it
+  waits for its arguments (each terminated by a null character) on
+  stdin, and starts when stdin is closed. it exits quietly if stdin
+  is closed without any arguments.
+
+  if HOSTD_ID and HOSTD_CONTROL are set in the environment (hostd -b),
+  the program is a client of the banker's algorithm: it acquires half
+  of its maximum claim (HOSTD_CLAIM - printers, scanners, modems and
+  CDs) over the control socket before the first tick, the rest half
+  way through, and releases it all before the last tick (hostd frees
+  the resources of a process that it terminates). a request that
+  must WAIT is retried every second, and the program does not tick
+  until it is granted. only the first member of a gang
+  (HOSTD_GANG_RANK 0) acquires the resources of the gang.
+
   to help identify specific processes, the program uses the process
   id to select one of 32 colour combinations for the display to an
   ASCC terminal.
@@ -35,9 +61,14 @@
 #include <ctype.h>
 #include <sys/types.h>
 #include <sys/time.h>
+#include <sys/select.h>
+#include <time.h>
+#include <fcntl.h>
 #include <sys/times.h>
 #include <limits.h>
 #include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 #ifndef TRUE
 #define TRUE 1
@@ -48,12 +79,38 @@
 #endif
 
 static void SignalHandler(int);
+static void ContinueHandler(int); // note that a stopped process was continued
+static int  Work(const sigset_t*);  // run the kernels of the profile for a second
+static double RunKernel(int);    // run a kernel once
+static void ReportWork(void);    // report the work achieved at exit
+int         ReadWorkerArgs(char*, char*[], int); // wait for args as a pooled worker
+static int  ControlOpen(int*);   // connect to the control socket of hostd (-b)
+static int  ControlRequest(FILE*, const char*, const int*); // ACQUIRE or RELEASE resources
 void        PrintUsage(char*);   // for error exit & info
 char       *StripPath(char*);    // strip path from filename
 
 #define DEFAULT_TIME 20
 #define DEFAULT_OP   stdout
 #define DEFAULT_NAME "sigtrap"
+#define WORKER_FLAG  "-w"        // must match WORKER_FLAG in pool.h
+#define WORKER_ARGS  256         // maximum length of args received as a worker
+#define N_RESOURCE   4           // printers, scanners, modems and CDs
+#define CONTROL_LINE 128         // maximum length of a request or response
+
+#define SLEEP_PROFILE  0         // profiles - names must match workload_name()
+#define CPU_PROFILE    1         //  in input.c
+#define MEMORY_PROFILE 2
+#define IO_PROFILE     3
+#define MIXED_PROFILE  4
+#define N_PROFILE      5
+
+#define DEFAULT_MBYTES 16        // memory touched if no [mbytes] given
+#define CPU_CHUNK      (1 << 20) // iterations of the cpu kernel per run
+#define MEMORY_CHUNK   (1 << 22) // bytes swept by the memory kernel per run
+#define CACHE_LINE     64        // bytes per cache line (one byte touched)
+#define IO_BLOCK       4096      // bytes written by the io kernel per run
+#define IO_BLOCKS      256       // blocks in the file before it is rewritten
+#define IO_TEMPLATE    "/tmp/sigtrapXXXXXX"
 
 #define BLACK   "\033[30m"       // foreground colours
 #define RED     "\033[31m"
@@ -90,6 +147,23 @@ char * colours [] = { BLACK ON_WHITE, CYAN ON_RED, GREEN ON_MAGENTA,
 
 #define N_COLOUR 32
 
+char * profiles [] = { "sleep", "cpu", "memory", "io", "mixed" };
+int profile = SLEEP_PROFILE;          // work done each second
+
+volatile unsigned long cpu_state = 1; // state of the cpu kernel
+unsigned char * memory = NULL;        // memory touched by the memory kernel
+size_t memory_size = 0;               //  (bytes)
+size_t memory_offset = 0;             //  next byte to touch
+int io_fd = -1;                       // file written by the io kernel
+char io_block[IO_BLOCK];              //  block written to the file
+int io_blocks = 0;                    //  blocks written since rewinding
+
+double work[N_PROFILE];               // work done by each kernel (iterations
+                                      //  of cpu, bytes swept by memory and
+                                      //  fsyncs by io)
+double work_seconds = 0;              // time spent running kernels
+static volatile sig_atomic_t continued = FALSE; // set if stopped during a run
+
 char * colour;                        // choice of colour for this process
 
 static int signal_SIGINT = FALSE;     // flags set by signal handler
@@ -100,6 +174,9 @@ static int signal_SIGABRT = FALSE;
 static int signal_SIGCONT = FALSE;
 static int signal_SIGTSTP = FALSE;
 
+int control_fd = -1;                  // control socket of hostd (-b), or -1
+int control_id = 0;                   //  ID of this process in hostd
+
 /*******************************************************************/
 int main(int argc, char *argv[])
 {
@@ -110,15 +187,65 @@ int main(int argc, char *argv[])
     struct tms t;
     clock_t starttick, stoptick;
     sigset_t mask;
+    sigset_t trapped, unblocked;      // signals only taken while waiting for a tick
+    struct timespec second = { 1, 0 };
+    char *worker_argv[5];             // args received as a pooled worker
+    long mbytes = DEFAULT_MBYTES;     // memory touched by the memory kernel
+    int claim[N_RESOURCE];            // maximum claim of resources (-b)
+    int pending[N_RESOURCE];          //  resources being acquired
+    int held[N_RESOURCE] = { 0 };     //  resources acquired
+    int waiting = FALSE;              //  set until pending is granted
+    int topped_up = FALSE;            //  set once the rest is requested
 
     colour = colours[pid % N_COLOUR]; // select colour for this process
 
-    if (argc > 2 || (argc == 2 && !isdigit((int)argv[1][0])))
+    if (argc == 2 && strcmp(argv[1], WORKER_FLAG) == 0) {
+        argc = ReadWorkerArgs(argv[0], worker_argv, 5);  // park until dispatched
+        argv = worker_argv;
+    }
+
+    if (argc > 4 || (argc >= 2 && !isdigit((int)argv[1][0])))
         PrintUsage(argv[0]);
 
+    if (argc >= 3) {                  // get work profile
+        for (profile = 0; profile < N_PROFILE; profile++)
+            if (strcmp(argv[2], profiles[profile]) == 0) break;
+        if (profile == N_PROFILE) PrintUsage(argv[0]);
+    }
+
+    if (argc == 4) {                  // get memory to touch
+        if (!isdigit((int)argv[3][0])) PrintUsage(argv[0]);
+        if ((mbytes = atol(argv[3])) <= 0) mbytes = 1;
+    }
+
+    if (profile == MEMORY_PROFILE || profile == MIXED_PROFILE) {
+        memory_size = (size_t) mbytes << 20;
+        while (memory_size > 0 && !(memory = malloc(memory_size)))
+            memory_size /= 2;         // the address space may be limited to mbytes,
+    }                                 //  which also holds the program itself
+
+    if (profile == IO_PROFILE || profile == MIXED_PROFILE) {
+        char io_name[] = IO_TEMPLATE;
+        if ((io_fd = mkstemp(io_name)) >= 0) unlink(io_name);
+        memset(io_block, pid & 0xff, IO_BLOCK);
+    }
+
+    if (profile != SLEEP_PROFILE) {
+        signal (SIGCONT, ContinueHandler); // a run that spans a stop is not counted
+        atexit(ReportWork);
+    }
+
     fprintf(output,"%s%7d; START" BLACK NORMAL "\n", colour, (int) pid);
     fflush(output);
 
+    sigemptyset (&trapped);           // a signal that arrives just before the wait
+    sigaddset (&trapped, SIGINT);     //  for a tick must interrupt it, so signals are
+    sigaddset (&trapped, SIGQUIT);    //  blocked except while waiting
+    sigaddset (&trapped, SIGHUP);
+    sigaddset (&trapped, SIGTERM);
+    sigaddset (&trapped, SIGTSTP);
+    sigprocmask (SIG_BLOCK, &trapped, &unblocked);
+
     signal (SIGINT, SignalHandler);   // hook up signal handler
     signal (SIGQUIT, SignalHandler);
     signal (SIGHUP, SignalHandler);
@@ -134,6 +261,12 @@ int main(int argc, char *argv[])
 
     if (cycle <= 0) cycle = 1;
 
+    if (ControlOpen(claim)) {         // acquire half of the claim up front
+        for (i = 0; i < N_RESOURCE; i++)
+            pending[i] = (claim[i] + 1) / 2;
+        waiting = TRUE;
+    }
+
     for (i = 0; i < cycle;) {          // tick
         if (signal_SIGCONT) {
             signal_SIGCONT = FALSE;
@@ -141,11 +274,30 @@ int main(int argc, char *argv[])
             fflush(output);
         }
 
+        if (control_fd >= 0 && !waiting && !topped_up && i >= cycle / 2) {
+            for (rc = 0; rc < N_RESOURCE; rc++) // acquire the rest half way
+                pending[rc] = claim[rc] - held[rc];
+            waiting = topped_up = TRUE;
+        } else if (control_fd >= 0 && !waiting && topped_up && i >= cycle - 1) {
+            ControlRequest(output, "RELEASE", held); // release it all before
+            memset(held, 0, sizeof(held));           //  the last tick
+        }
+
+        if (waiting && (rc = ControlRequest(output, "ACQUIRE", pending)) != 0) {
+            if (rc > 0)                // granted (or refused - carry on without)
+                for (rc = 0; rc < N_RESOURCE; rc++)
+                    held[rc] += pending[rc];
+            waiting = FALSE;
+        }
+
         starttick = times (&t);        // use timer to ascertain whether 'tick' should be
-        rc = sleep(1);                 //  reported
+        if (profile == SLEEP_PROFILE || waiting) //  reported (no work while waiting)
+            rc = pselect(0, NULL, NULL, NULL, &second, &unblocked);
+        else
+            rc = Work(&unblocked);
         stoptick = times (&t);
 
-        if (rc == 0 || (stoptick-starttick) > clktck/2)
+        if (!waiting && (rc == 0 || (stoptick-starttick) > clktck/2))
             fprintf(output,"%s%7d; tick %d" BLACK NORMAL "\n", colour, (int) pid, ++i);
 
         if (signal_SIGINT) {
@@ -173,6 +325,7 @@ int main(int argc, char *argv[])
             signal(SIGTSTP, SIG_DFL);       // reset trap to default
             raise (SIGTSTP);                // now suspend ourselves
             signal(SIGTSTP, SignalHandler); // reset trap on return from suspension
+            sigprocmask (SIG_BLOCK, &mask, NULL);
             signal_SIGCONT = TRUE;          // set flag here rather than trap signal
         }
 
@@ -192,10 +345,147 @@ int main(int argc, char *argv[])
 
     }
 
+    if (control_fd >= 0)              // release anything still held
+        ControlRequest(output, "RELEASE", held);
+
     exit(0);
 }
 
 
+/******************************************************************
+
+  static int Work(const sigset_t * unblocked)
+
+  run the kernels of the profile until a second has passed, or until
+  a signal is trapped. signals are unblocked while the kernels run,
+  and the flags are checked after each run of a kernel. a run during
+  which the process was stopped (with SIGSTOP) is not counted
+
+  unblocked - signal mask with the trapped signals unblocked
+
+  returns 0 if a second passed, -1 if a signal was trapped
+
+ *******************************************************************/
+
+static int Work(const sigset_t * unblocked)
+{
+    static int next = CPU_PROFILE;    // next kernel of the mixed profile
+    struct timespec start, last, now;
+    sigset_t blocked;
+    double elapsed = 0, done;
+    int kernel, rc = 0;
+
+    sigprocmask(SIG_SETMASK, unblocked, &blocked);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    last = start;
+    continued = FALSE;
+
+    while (elapsed < 1.0) {
+        if (signal_SIGINT || signal_SIGQUIT || signal_SIGHUP ||
+            signal_SIGTERM || signal_SIGTSTP) {
+            rc = -1;
+            break;
+        }
+
+        kernel = profile;
+        if (profile == MIXED_PROFILE) {
+            kernel = next;
+            next = next == IO_PROFILE ? CPU_PROFILE : next + 1;
+        }
+        done = RunKernel(kernel);
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        elapsed = (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) / 1e9;
+        if (continued)
+            continued = FALSE;
+        else {
+            work[kernel] += done;
+            work_seconds += (now.tv_sec - last.tv_sec) + (now.tv_nsec - last.tv_nsec) / 1e9;
+        }
+        last = now;
+    }
+
+    sigprocmask(SIG_SETMASK, &blocked, NULL);
+    return rc;
+}
+
+/******************************************************************
+
+  static double RunKernel(int kernel)
+
+  run a kernel once, for around a millisecond (the io kernel takes as
+  long as the fsync)
+
+  kernel - CPU_PROFILE, MEMORY_PROFILE or IO_PROFILE
+
+  returns the work done
+
+ *******************************************************************/
+
+static double RunKernel(int kernel)
+{
+    unsigned long state = cpu_state;
+    size_t n;
+    double done = 0;
+
+    switch (kernel) {
+        case CPU_PROFILE:             // 64-bit linear congruential generator
+            for (n = 0; n < CPU_CHUNK; n++)
+                state = state * 6364136223846793005UL + 1442695040888963407UL;
+            cpu_state = state;
+            done = CPU_CHUNK;
+            break;
+
+        case MEMORY_PROFILE:          // sweep the memory, wrapping around
+            if (!memory) break;
+            for (n = 0; n < MEMORY_CHUNK; n += CACHE_LINE) {
+                memory[memory_offset]++;
+                if ((memory_offset += CACHE_LINE) >= memory_size)
+                    memory_offset = 0;
+            }
+            done = MEMORY_CHUNK;
+            break;
+
+        case IO_PROFILE:              // write a block and flush it to disk
+            if (io_fd < 0) break;
+            if (io_blocks++ == IO_BLOCKS) {
+                lseek(io_fd, 0, SEEK_SET);
+                io_blocks = 1;
+            }
+            if (write(io_fd, io_block, IO_BLOCK) == IO_BLOCK && fsync(io_fd) == 0)
+                done = 1;
+            break;
+    }
+
+    return done;
+}
+
+/******************************************************************
+
+  static void ReportWork(void)
+
+  report the work achieved per second spent running kernels, and the
+  CPU time of the process (called at exit). comparing the rates at
+  different quanta shows the cost of being preempted
+
+ *******************************************************************/
+
+static void ReportWork(void)
+{
+    struct tms t;
+    long clktck = sysconf(_SC_CLK_TCK);
+    double seconds = work_seconds > 0 ? work_seconds : 1;
+
+    times(&t);
+    fprintf(DEFAULT_OP, "%s%7d; WORK %s: cpu %.1f Mops/s, memory %.1f MB/s (%lu MB),"
+            " io %.1f fsync/s over %.2fs, %.2fs CPU" BLACK NORMAL "\n",
+            colour, (int) getpid(), profiles[profile], work[CPU_PROFILE] / seconds / 1e6,
+            work[MEMORY_PROFILE] / seconds / (1 << 20), (unsigned long) (memory_size >> 20),
+            work[IO_PROFILE] / seconds, work_seconds,
+            (double) (t.tms_utime + t.tms_stime) / clktck);
+    fflush(DEFAULT_OP);
+}
+
 /******************************************************************
 
   static void SignalHandler(int sig)
@@ -244,6 +534,21 @@ static void SignalHandler(int sig)        // trap signals from shell/system
     }
 }
 
+/******************************************************************
+
+  static void ContinueHandler(int sig)
+
+  note that the process was continued after being stopped, so that the
+  run of a kernel that spanned the stop is not counted
+
+ *******************************************************************/
+
+static void ContinueHandler(int sig)
+{
+    (void) sig;
+    continued = TRUE;
+}
+
 /*******************************************************************
 
   void PrintUsage(char * pgmName)
@@ -264,13 +569,16 @@ void PrintUsage(char * pgmName)
     printf("\n"
            "  program: %s - trap and report process control signals\n\n"
            "    usage:\n\n"
-           "      %s [seconds]\n\n"
-           "      where [seconds] is the lifetime of the program - default = 20s.\n\n"
-           "    the program sleeps for a second, reports process id and tick count\n"
-           "    before sleeping again. any process control signals: SIGINT, SIGQUIT\n"
-           "    SIGHUP, SIGTERM, SIGABRT, SIGCONT, SIGTSTP, are trapped and\n"
-           "    reported before being actioned.\n\n",
-           actualName, actualName );
+           "      %s [seconds [profile [mbytes]]]\n\n"
+           "      where [seconds] is the lifetime of the program - default = 20s.\n"
+           "      [profile] is sleep (default), cpu, memory, io or mixed, and\n"
+           "      [mbytes] is the memory touched by memory and mixed - default = %dMB.\n\n"
+           "    the program sleeps (or works) for a second, reports process id and\n"
+           "    tick count before sleeping again. any process control signals: SIGINT,\n"
+           "    SIGQUIT, SIGHUP, SIGTERM, SIGABRT, SIGCONT, SIGTSTP, are trapped and\n"
+           "    reported before being actioned. with a profile other than sleep, the\n"
+           "    work achieved per second is reported at exit.\n\n",
+           actualName, actualName, DEFAULT_MBYTES );
     exit(127);
 }
 
@@ -304,3 +612,138 @@ char * StripPath(char * pathname)
     }                                      // original must be file name only
     return NULL;
 }
+
+/*******************************************************************
+
+int ReadWorkerArgs(char * name, char * argv[], int max);
+
+wait on stdin for the args of a pooled worker
+
+name - program name, returned as argv[0]
+argv - array to receive the args (null terminated)
+max  - size of argv
+
+the args are read from stdin until it is closed, each terminated by
+a null character. returns the number of args including argv[0].
+exits quietly if stdin is closed without any args (pool shut down)
+
+*******************************************************************/
+
+int ReadWorkerArgs(char * name, char * argv[], int max)
+{
+    static char buffer[WORKER_ARGS];       // args stay valid after return
+    int length = 0, argc = 1, n, i;
+
+    while (length < WORKER_ARGS - 1 &&
+           (n = read(STDIN_FILENO, buffer + length, WORKER_ARGS - 1 - length)) > 0)
+        length += n;
+
+    if (length == 0)                       // no job - pool shut down
+        exit(0);
+
+    buffer[length] = '\0';
+    argv[0] = name;
+    for (i = 0; i < length && argc < max - 1; i += strlen(buffer + i) + 1)
+        argv[argc++] = buffer + i;
+    argv[argc] = NULL;
+
+    return argc;
+}
+
+/*******************************************************************
+
+int ControlOpen(int * claim);
+
+connect to the control socket of hostd, if the program was started
+by hostd -b (HOSTD_ID and HOSTD_CONTROL are set). the other members
+of a gang leave the resources of the gang to its first member
+
+claim - set to the maximum claim of the process (HOSTD_CLAIM)
+
+returns TRUE if connected, else FALSE (control_fd stays -1)
+
+*******************************************************************/
+
+static int ControlOpen(int * claim)
+{
+    char * id = getenv("HOSTD_ID");
+    char * path = getenv("HOSTD_CONTROL");
+    char * claims = getenv("HOSTD_CLAIM");
+    char * rank = getenv("HOSTD_GANG_RANK");
+    struct sockaddr_un address;
+    int fd, i;
+
+    if (!id || !path || (rank && atoi(rank) != 0))
+        return FALSE;
+
+    for (i = 0; i < N_RESOURCE; i++)
+        claim[i] = 0;
+    if (claims)
+        sscanf(claims, "%d %d %d %d", &claim[0], &claim[1], &claim[2], &claim[3]);
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+
+    if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0 ||
+        connect(fd, (struct sockaddr *) &address, sizeof(address)) != 0) {
+        fprintf(DEFAULT_OP, "%s%7d; CONTROL %s unavailable" BLACK NORMAL "\n",
+                colour, (int) getpid(), path);
+        fflush(DEFAULT_OP);
+        if (fd >= 0) close(fd);
+        return FALSE;
+    }
+
+    control_fd = fd;
+    control_id = atoi(id);
+    return TRUE;
+}
+
+/*******************************************************************
+
+int ControlRequest(FILE * output, const char * verb, const int * resources);
+
+send an ACQUIRE or RELEASE request for this process to hostd, and
+report the response. nothing is sent for no resources. the control
+socket is closed if hostd does not respond
+
+output    - where to report the response
+verb      - "ACQUIRE" or "RELEASE"
+resources - printers, scanners, modems and CDs
+
+returns 1 if the request was granted (OK), 0 if it must be retried
+(WAIT), or -1 if it was refused (ERR) or hostd did not respond
+
+*******************************************************************/
+
+static int ControlRequest(FILE * output, const char * verb, const int * resources)
+{
+    char line[CONTROL_LINE];
+    int length = 0, n;
+
+    if (!resources[0] && !resources[1] && !resources[2] && !resources[3])
+        return 1;
+
+    n = snprintf(line, sizeof(line), "%s %d %d %d %d %d\n", verb, control_id,
+                 resources[0], resources[1], resources[2], resources[3]);
+    if (send(control_fd, line, n, MSG_NOSIGNAL) == n)
+        while (length < CONTROL_LINE - 1 &&
+               read(control_fd, line + length, 1) == 1 && line[length] != '\n')
+            length++;
+    line[length] = '\0';
+
+    fprintf(output, "%s%7d; %s %d %d %d %d: %s" BLACK NORMAL "\n", colour, (int) getpid(),
+            verb, resources[0], resources[1], resources[2], resources[3],
+            length ? line : "no response");
+    fflush(output);
+
+    if (length == 0) {
+        close(control_fd);
+        control_fd = -1;
+        return -1;
+    }
+
+    if (strncmp(line, "OK", 2) == 0) return 1;
+    if (strncmp(line, "WAIT", 4) == 0) return 0;
+    return -1;
+}
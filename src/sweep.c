@@ -0,0 +1,371 @@
+/*
+ * sweep.c
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains the functions relating to parameter sweeps.
+ *
+ * Each combination of the swept scheduling parameters is simulated by its own
+ * forked worker, which replays the dispatch list with simulated execution (so
+ * no processes are started, and the clock does not wait for real time to pass)
+ * and writes the statistics of the run back to the parent over a pipe. The
+ * memory, resources and process IDs of the host dispatcher are still global, so
+ * the runs are isolated by giving each its own address space rather than its
+ * own thread. At most 'jobs' workers run at once, and the results are printed
+ * in the order of the grid once every run has finished.
+ */
+#define _POSIX_C_SOURCE 200809L // for sysconf() and waitpid()
+
+#include "../inc/sweep.h"
+#include "../inc/output.h"
+#include "../inc/input.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+static boolean grid_config(SweepGrid * grid, DispatcherConfig * base, unsigned int run, DispatcherConfig * config);
+static void simulate(DispatcherConfig * config, const char * path, int fd);
+static void print_results(const char * path, unsigned int num_runs, DispatcherConfig * configs, Statistics * results, boolean * succeeded);
+
+/*
+ * Initialises an empty grid of scheduling parameters.
+ *
+ * PARAMETERS
+ *     grid: The grid to initialise.
+ */
+void sweep_init(SweepGrid * grid) {
+    for (unsigned int i = 0; i < NUM_CONFIG_PARAMETERS; i++) {
+        grid->num_values[i] = 0;
+    }
+}
+
+/*
+ * Adds the values of a scheduling parameter to a grid, from a
+ * 'name=value,value,...' command line option. Sweeping a parameter that is
+ * already swept replaces its values.
+ *
+ * PARAMETERS
+ *     grid: The grid.
+ *     option: The option. This string is modified.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the option was valid.
+ */
+boolean sweep_add(SweepGrid * grid, char * option) {
+    ConfigParameter parameter; // the scheduling parameter
+    char * value; // the next value of the scheduling parameter
+    char * end; // the end of the value
+    unsigned int count = 0; // number of values
+
+    if (!parse_config_option(option, &parameter, &value)) {
+        return false;
+    }
+
+    // A simulated process never runs, so it does not matter which CPU it is resumed on
+    if (parameter == Migration_Cost_Parameter) {
+        fprintf(__ERROR_OUTPUT, "Scheduling parameter '%s' has no effect on simulated execution, so cannot be swept.\n", option);
+        return false;
+    }
+
+    for (;;) {
+        if (count == MAX_SWEEP_VALUES) {
+            fprintf(__ERROR_OUTPUT, "Scheduling parameter '%s' can be swept over at most %d values.\n", option, MAX_SWEEP_VALUES);
+            return false;
+        }
+
+        grid->values[parameter][count++] = (unsigned int) strtoul(value, &end, 10);
+        if ((end == value) || ((*end != ',') && (*end != '\0'))) {
+            fprintf(__ERROR_OUTPUT, "Invalid values '%s' for scheduling parameter '%s'.\n", value, option);
+            return false;
+        }
+        if (*end == '\0') {
+            break;
+        }
+        value = end + 1;
+    }
+
+    grid->num_values[parameter] = count;
+    return true;
+}
+
+/*
+ * Checks whether any scheduling parameters are swept.
+ *
+ * PARAMETERS
+ *     grid: The grid.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the grid holds any values.
+ */
+boolean sweep_enabled(SweepGrid * grid) {
+    for (unsigned int i = 0; i < NUM_CONFIG_PARAMETERS; i++) {
+        if (grid->num_values[i] > 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Simulates a dispatch list under every combination of the scheduling
+ * parameters in a grid, and prints a table comparing the results. Parameters
+ * that are not swept keep their base values.
+ *
+ * PARAMETERS
+ *     grid: The grid.
+ *     base: The scheduling parameters that are not swept.
+ *     path: The path of the dispatch list.
+ *     jobs: The maximum number of simulations to run at once (0 for one per
+ *         online CPU).
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether every simulation succeeded.
+ */
+boolean sweep_run(SweepGrid * grid, DispatcherConfig * base, const char * path, unsigned int jobs) {
+    unsigned int num_runs = 1; // number of combinations of the scheduling parameters
+    unsigned int next = 0; // the next run to start
+    unsigned int running = 0; // number of workers running
+    DispatcherConfig * configs = NULL; // the scheduling parameters of each run
+    Statistics * results = NULL; // the results of each run
+    boolean * succeeded = NULL; // whether each run succeeded
+    pid_t * pids = NULL; // the worker running in each slot (0 if the slot is free)
+    int * fds = NULL; // the read end of the pipe from the worker in each slot
+    unsigned int * runs = NULL; // the run simulated by the worker in each slot
+    boolean success = true; // whether every run succeeded
+    FILE * input; // the dispatch list
+
+    for (unsigned int i = 0; i < NUM_CONFIG_PARAMETERS; i++) {
+        if (grid->num_values[i] > 0) {
+            num_runs *= grid->num_values[i];
+        }
+    }
+
+    // Default to one worker per online CPU, and never more workers than runs
+    if (jobs == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN); // number of online CPUs
+        jobs = (cpus > 0) ? (unsigned int) cpus : 1;
+    }
+    if (jobs > num_runs) {
+        jobs = num_runs;
+    }
+
+    // The dispatch list is read by each worker, so check that it can be read before starting any
+    if ((input = fopen(path, "r")) == NULL) {
+        fprintf(__ERROR_OUTPUT, "Unable to open input file '%s' for reading.\n", path);
+        return false;
+    }
+    fclose(input);
+
+    configs = (DispatcherConfig *) malloc(num_runs * sizeof(DispatcherConfig));
+    results = (Statistics *) malloc(num_runs * sizeof(Statistics));
+    succeeded = (boolean *) malloc(num_runs * sizeof(boolean));
+    pids = (pid_t *) malloc(jobs * sizeof(pid_t));
+    fds = (int *) malloc(jobs * sizeof(int));
+    runs = (unsigned int *) malloc(jobs * sizeof(unsigned int));
+    if ((configs == NULL) || (results == NULL) || (succeeded == NULL) || (pids == NULL) || (fds == NULL) || (runs == NULL)) {
+        fprintf(__ERROR_OUTPUT, "Unable to allocate memory for a parameter sweep of %d runs.\n", num_runs);
+        success = false;
+        goto cleanup;
+    }
+
+    for (unsigned int run = 0; run < num_runs; run++) {
+        if (!grid_config(grid, base, run, &configs[run])) {
+            success = false;
+            goto cleanup;
+        }
+        succeeded[run] = false;
+    }
+    for (unsigned int slot = 0; slot < jobs; slot++) {
+        pids[slot] = 0;
+    }
+
+    // Buffered output would otherwise be written again by each worker
+    fflush(__STANDARD_OUTPUT);
+    fflush(__ERROR_OUTPUT);
+
+    while ((next < num_runs) || (running > 0)) {
+        pid_t pid; // the worker that finished
+        int status; // the exit status of the worker
+        unsigned int slot; // the slot of the worker
+
+        // Start a worker in each free slot
+        for (slot = 0; (slot < jobs) && (next < num_runs); slot++) {
+            int fd[2]; // the pipe from the worker
+
+            if (pids[slot] != 0) {
+                continue;
+            }
+
+            if (pipe(fd)) {
+                fprintf(__ERROR_OUTPUT, "Unable to create a pipe for run %d of the parameter sweep.\n", next + 1);
+                next++;
+                success = false;
+                continue;
+            }
+
+            switch (pids[slot] = fork()) {
+                case -1: // fork failed
+                    fprintf(__ERROR_OUTPUT, "Forking of run %d of the parameter sweep failed.\n", next + 1);
+                    pids[slot] = 0;
+                    close(fd[0]);
+                    close(fd[1]);
+                    next++;
+                    success = false;
+                    break;
+
+                case 0: // child
+                    close(fd[0]);
+                    simulate(&configs[next], path, fd[1]);
+                    break;
+
+                default: // parent
+                    close(fd[1]);
+                    fds[slot] = fd[0];
+                    runs[slot] = next++;
+                    running++;
+                    break;
+            }
+        }
+
+        if (running == 0) {
+            continue;
+        }
+
+        // Collect the results of the next worker to finish - they fit in the pipe, so the worker never waits for them to be read
+        if ((pid = waitpid(-1, &status, 0)) == -1) {
+            fprintf(__ERROR_OUTPUT, "Unable to wait for the runs of the parameter sweep.\n");
+            success = false;
+            break;
+        }
+        for (slot = 0; (slot < jobs) && (pids[slot] != pid); slot++);
+        if (slot == jobs) {
+            continue;
+        }
+
+        succeeded[runs[slot]] = (WIFEXITED(status) && (WEXITSTATUS(status) == EXIT_SUCCESS) && (read(fds[slot], &results[runs[slot]], sizeof(Statistics)) == (ssize_t) sizeof(Statistics)));
+        if (!succeeded[runs[slot]]) {
+            success = false;
+        }
+        close(fds[slot]);
+        pids[slot] = 0;
+        running--;
+    }
+
+    print_results(path, num_runs, configs, results, succeeded);
+
+cleanup:
+    free(configs);
+    free(results);
+    free(succeeded);
+    free(pids);
+    free(fds);
+    free(runs);
+    return success;
+}
+
+/*
+ * Gets the scheduling parameters of a run of a parameter sweep. The runs are
+ * numbered in the order of the grid - the first parameter changes slowest.
+ *
+ * PARAMETERS
+ *     grid: The grid.
+ *     base: The scheduling parameters that are not swept.
+ *     run: The run.
+ *     config: Set to the scheduling parameters of the run.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the scheduling parameters are valid.
+ */
+static boolean grid_config(SweepGrid * grid, DispatcherConfig * base, unsigned int run, DispatcherConfig * config) {
+    *config = *base;
+
+    for (unsigned int i = NUM_CONFIG_PARAMETERS; i-- > 0; ) {
+        if (grid->num_values[i] > 0) {
+            set_config_parameter(config, i, grid->values[i][run % grid->num_values[i]]);
+            run /= grid->num_values[i];
+        }
+    }
+
+    return check_config(config);
+}
+
+/*
+ * Simulates a dispatch list in a forked worker, and writes the statistics of
+ * the run to a pipe. The output of the host dispatcher is discarded. This
+ * function does not return.
+ *
+ * PARAMETERS
+ *     config: The scheduling parameters.
+ *     path: The path of the dispatch list.
+ *     fd: The write end of the pipe to the parent.
+ */
+static void simulate(DispatcherConfig * config, const char * path, int fd) {
+    Dispatcher dispatcher; // the host dispatcher
+    Statistics statistics; // the results of the run
+    FILE * input; // the dispatch list
+    int null; // the null device
+    boolean success; // whether the results were written
+
+    if ((null = open("/dev/null", O_WRONLY)) != -1) {
+        dup2(null, STDOUT_FILENO);
+        dup2(null, STDERR_FILENO);
+        close(null);
+    }
+
+    config->execution = Simulated_Execution;
+    config->enforcement = No_Enforcement;
+    config->suspend_method = Signal_Suspension;
+    config->accounting = Tick_Accounting;
+    config->status_interval = 0;
+    config->fast = true;
+    if (!dispatcher_init(&dispatcher, config) || ((input = fopen(path, "r")) == NULL)) {
+        _exit(EXIT_FAILURE);
+    }
+    append_to_input_queue(&dispatcher, read_process_list(&dispatcher, input));
+    fclose(input);
+
+    timer_advance(&dispatcher.timers, dispatcher.clock);
+    schedule_arrivals(&dispatcher, dispatcher.input_queue);
+    while (!finished(&dispatcher)) {
+        dispatcher_step(&dispatcher);
+    }
+
+    get_statistics(&dispatcher, &statistics);
+    success = (write(fd, &statistics, sizeof(Statistics)) == (ssize_t) sizeof(Statistics));
+    close(fd);
+    dispatcher_destroy(&dispatcher);
+
+    _exit(success ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/*
+ * Prints a table comparing the results of the runs of a parameter sweep.
+ *
+ * PARAMETERS
+ *     path: The path of the dispatch list.
+ *     num_runs: The number of runs.
+ *     configs: The scheduling parameters of each run.
+ *     results: The results of each run.
+ *     succeeded: Whether each run succeeded.
+ */
+static void print_results(const char * path, unsigned int num_runs, DispatcherConfig * configs, Statistics * results, boolean * succeeded) {
+    fprintf(__STANDARD_OUTPUT, "Parameter sweep of '%s' (%d runs).\n", path, num_runs);
+    fprintf(__STANDARD_OUTPUT, "quantum\tlevels\treserved| ticks\tdone\t| mean\tp50\tp90\tp99\tmax\t| met\tmissed\trejected| compact\t| dispatch us\n");
+    fprintf(__STANDARD_OUTPUT, "------------------------------------------------------------------------------------------------------------------------------------\n");
+
+    for (unsigned int run = 0; run < num_runs; run++) {
+        Statistics * s = &results[run]; // the results of the run
+
+        fprintf(__STANDARD_OUTPUT, "%d\t%d\t%d\t| ", configs[run].quantum, configs[run].feedback_levels, configs[run].reserved_memory);
+        if (!succeeded[run]) {
+            fprintf(__STANDARD_OUTPUT, "FAILED\n");
+            continue;
+        }
+        fprintf(__STANDARD_OUTPUT, "%d\t%d\t| %.2f\t%d\t%d\t%d\t%d\t| %d\t%d\t%d\t| %d\t\t| %llu\n", s->ticks, s->completed, s->turnaround_mean, s->turnaround_p50, s->turnaround_p90, s->turnaround_p99, s->turnaround_max, s->deadlines_met, s->deadlines_missed, s->real_time_rejected, s->memory_compactions, s->dispatch_usec);
+    }
+}
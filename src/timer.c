@@ -0,0 +1,347 @@
+/*
+ * timer.c
+ *
+ * Author: Joshua Spence
+ * SID:    308216350
+ *
+ * This file contains the functions for the timer wheel.
+ *
+ * The timer wheel is hierarchical: a timer is held at the lowest level whose
+ * window contains both the current time and the expiry time of the timer, in
+ * the slot selected by the expiry time. When the current time reaches the start
+ * of the window of a slot, the timers in that slot are cascaded down to a lower
+ * level, and when it reaches the slot of a timer at the lowest level the timer
+ * expires. Adding, cancelling and expiring a timer are all O(1), however many
+ * timers are pending, and each timer is cascaded at most TIMER_LEVELS - 1
+ * times. Advancing the time skips straight over the slots that hold no timers.
+ *
+ * Slots are cascaded in order, so timers with the same expiry time expire in
+ * the order that they were added.
+ */
+#include "../inc/timer.h"
+#include <stdlib.h>
+
+static void list_append(TimerList * list, Timer * timer);
+static void list_remove(Timer * timer);
+static void insert(TimerWheel * wheel, Timer * timer);
+static void cascade(TimerWheel * wheel, unsigned int level, unsigned int slot);
+static unsigned int next_slot(TimerWheel * wheel);
+
+/*
+ * Initialises an empty timer wheel.
+ *
+ * PARAMETERS
+ *     wheel: The timer wheel to initialise.
+ *     now: The current time (in ticks).
+ */
+void timer_init(TimerWheel * wheel, unsigned int now) {
+    wheel->now = now;
+    wheel->pending = 0;
+
+    for (unsigned int level = 0; level < TIMER_LEVELS; level++) {
+        wheel->occupied[level] = 0;
+        for (unsigned int slot = 0; slot < TIMER_SLOTS; slot++) {
+            wheel->slots[level][slot].head = NULL;
+            wheel->slots[level][slot].tail = NULL;
+        }
+    }
+
+    for (unsigned int type = 0; type < NUM_TIMER_TYPES; type++) {
+        wheel->expired[type].head = NULL;
+        wheel->expired[type].tail = NULL;
+    }
+}
+
+/*
+ * Initialises a timer that is not pending.
+ *
+ * PARAMETERS
+ *     timer: The timer to initialise.
+ */
+void timer_clear(Timer * timer) {
+    timer->expiry = 0;
+    timer->type = Timer_Arrival;
+    timer->data = NULL;
+    timer->wheel = NULL;
+    timer->list = NULL;
+    timer->prev = NULL;
+    timer->next = NULL;
+}
+
+/*
+ * Adds a timer to a timer wheel. A timer that is already pending is cancelled
+ * first. A timer that expires at (or before) the current time expires
+ * immediately.
+ *
+ * PARAMETERS
+ *     wheel: The timer wheel.
+ *     timer: The timer to add.
+ *     expiry: The time (in ticks) at which the timer expires.
+ *     type: The event that the timer is for.
+ *     data: The process that the timer is for (NULL if none).
+ */
+void timer_add(TimerWheel * wheel, Timer * timer, unsigned int expiry, TimerType type, void * data) {
+    timer_cancel(timer);
+
+    timer->expiry = expiry;
+    timer->type = type;
+    timer->data = data;
+    timer->wheel = wheel;
+    insert(wheel, timer);
+}
+
+/*
+ * Cancels a timer. Cancelling a timer that is not pending has no effect.
+ *
+ * PARAMETERS
+ *     timer: The timer to cancel.
+ */
+void timer_cancel(Timer * timer) {
+    TimerWheel * wheel = timer->wheel; // the timer wheel holding the timer
+
+    if (wheel == NULL) {
+        return;
+    }
+
+    // An expired timer has not been counted as pending since it expired
+    if ((timer->list < wheel->expired) || (timer->list >= wheel->expired + NUM_TIMER_TYPES)) {
+        size_t index = (size_t) (timer->list - &wheel->slots[0][0]); // index of the slot holding the timer
+
+        wheel->pending--;
+        list_remove(timer);
+        if (timer->list->head == NULL) {
+            wheel->occupied[index / TIMER_SLOTS] &= ~((uint64_t) 1 << (index % TIMER_SLOTS));
+        }
+    } else {
+        list_remove(timer);
+    }
+
+    timer->wheel = NULL;
+    timer->list = NULL;
+}
+
+/*
+ * Checks whether a timer is pending (or has expired but not yet been
+ * retrieved with timer_expired()).
+ *
+ * PARAMETERS
+ *     timer: The timer.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether the timer is pending.
+ */
+boolean timer_pending(Timer * timer) {
+    return (timer->wheel != NULL);
+}
+
+/*
+ * Advances the current time of a timer wheel. Timers that expire at or before
+ * the new time are moved to the list of expired timers of their type, in order
+ * of expiry. Time cannot go backwards.
+ *
+ * PARAMETERS
+ *     wheel: The timer wheel.
+ *     now: The new current time (in ticks).
+ */
+void timer_advance(TimerWheel * wheel, unsigned int now) {
+    while (wheel->now < now) {
+        unsigned int level = 1; // one more than the highest level to cascade
+        unsigned int next; // the next time at which a slot holding timers is reached
+        TimerList * slot; // the slot at the lowest level that has been reached
+
+        // There is nothing to cascade or expire before the next slot that holds timers
+        if ((wheel->pending == 0) || ((next = next_slot(wheel)) > now)) {
+            wheel->now = now;
+            break;
+        }
+        wheel->now = next;
+
+        // Cascade the slots whose windows start now, from the highest level down
+        while ((level < TIMER_LEVELS) && ((wheel->now & ((1u << (TIMER_SLOT_BITS * level)) - 1)) == 0)) {
+            level++;
+        }
+        while (--level > 0) {
+            cascade(wheel, level, (wheel->now >> (TIMER_SLOT_BITS * level)) & (TIMER_SLOTS - 1));
+        }
+
+        // Expire the timers in the slot for the current time
+        slot = &wheel->slots[0][wheel->now & (TIMER_SLOTS - 1)];
+        while (slot->head != NULL) {
+            Timer * timer = slot->head; // the timer to expire
+
+            list_remove(timer);
+            wheel->pending--;
+            list_append(&wheel->expired[timer->type], timer);
+        }
+        wheel->occupied[0] &= ~((uint64_t) 1 << (wheel->now & (TIMER_SLOTS - 1)));
+    }
+}
+
+/*
+ * Retrieves the next expired timer of a type. The timer is no longer pending
+ * once it has been retrieved.
+ *
+ * PARAMETERS
+ *     wheel: The timer wheel.
+ *     type: The type of timer.
+ *
+ * RETURN VALUE
+ * A pointer to the timer that expired first, or NULL if no timers of the type
+ * have expired.
+ */
+Timer * timer_expired(TimerWheel * wheel, TimerType type) {
+    Timer * timer = wheel->expired[type].head; // the timer that expired first
+
+    if (timer != NULL) {
+        timer_cancel(timer);
+    }
+
+    return timer;
+}
+
+/*
+ * Finds the next time at which a timer could expire. This is the expiry time
+ * of the next timer at the lowest level, or otherwise the time at which the
+ * next timer at a higher level is cascaded (which is no later than its expiry
+ * time). Either way, no timer expires before this time.
+ *
+ * PARAMETERS
+ *     wheel: The timer wheel.
+ *     next: Set to the next time (in ticks) at which a timer could expire, which
+ *         is the current time if timers have expired but not been retrieved.
+ *
+ * RETURN VALUE
+ * A boolean value indicating whether there are any timers.
+ */
+boolean timer_next(TimerWheel * wheel, unsigned int * next) {
+    for (unsigned int type = 0; type < NUM_TIMER_TYPES; type++) {
+        if (wheel->expired[type].head != NULL) {
+            *next = wheel->now;
+            return true;
+        }
+    }
+
+    if (wheel->pending == 0) {
+        return false;
+    }
+
+    *next = next_slot(wheel);
+    return true;
+}
+
+/*
+ * Finds the next time at which a slot holding timers is reached - either to
+ * expire the timers at the lowest level, or to cascade the timers at a higher
+ * level. There must be pending timers.
+ *
+ * PARAMETERS
+ *     wheel: The timer wheel.
+ *
+ * RETURN VALUE
+ * The next time (in ticks) at which a slot holding timers is reached.
+ */
+static unsigned int next_slot(TimerWheel * wheel) {
+    // Timers at each level are only held in the slots after the slot for the current time, and the slots at lower levels are reached first
+    for (unsigned int level = 0; level < TIMER_LEVELS; level++) {
+        unsigned int shift = TIMER_SLOT_BITS * level; // position of the bits that select a slot at this level
+        unsigned int current = (wheel->now >> shift) & (TIMER_SLOTS - 1); // the slot for the current time
+        uint64_t later = (current == TIMER_SLOTS - 1) ? 0 : (wheel->occupied[level] & ~(((uint64_t) 2 << current) - 1)); // the occupied slots after it
+
+        if (later != 0) {
+            unsigned int slot = __builtin_ctzll(later); // the next occupied slot
+            unsigned int window = (level + 1 < TIMER_LEVELS) ? ((wheel->now >> (shift + TIMER_SLOT_BITS)) << (shift + TIMER_SLOT_BITS)) : 0; // the start of the current window at this level
+
+            return window | (slot << shift);
+        }
+    }
+
+    return wheel->now;
+}
+
+/*
+ * Adds a timer to the tail of a list.
+ *
+ * PARAMETERS
+ *     list: The list.
+ *     timer: The timer.
+ */
+static void list_append(TimerList * list, Timer * timer) {
+    timer->list = list;
+    timer->prev = list->tail;
+    timer->next = NULL;
+    if (list->tail != NULL) {
+        list->tail->next = timer;
+    } else {
+        list->head = timer;
+    }
+    list->tail = timer;
+}
+
+/*
+ * Removes a timer from its list.
+ *
+ * PARAMETERS
+ *     timer: The timer.
+ */
+static void list_remove(Timer * timer) {
+    if (timer->prev != NULL) {
+        timer->prev->next = timer->next;
+    } else {
+        timer->list->head = timer->next;
+    }
+    if (timer->next != NULL) {
+        timer->next->prev = timer->prev;
+    } else {
+        timer->list->tail = timer->prev;
+    }
+    timer->prev = NULL;
+    timer->next = NULL;
+}
+
+/*
+ * Inserts a timer into the slot for its expiry time, at the lowest level whose
+ * window contains both the current time and the expiry time.
+ *
+ * PARAMETERS
+ *     wheel: The timer wheel.
+ *     timer: The timer.
+ */
+static void insert(TimerWheel * wheel, Timer * timer) {
+    unsigned int level = 0; // the level to hold the timer
+    unsigned int slot; // the slot to hold the timer
+
+    if (timer->expiry <= wheel->now) {
+        list_append(&wheel->expired[timer->type], timer);
+        return;
+    }
+
+    while ((level + 1 < TIMER_LEVELS) && ((timer->expiry >> (TIMER_SLOT_BITS * (level + 1))) != (wheel->now >> (TIMER_SLOT_BITS * (level + 1))))) {
+        level++;
+    }
+    slot = (timer->expiry >> (TIMER_SLOT_BITS * level)) & (TIMER_SLOTS - 1);
+
+    list_append(&wheel->slots[level][slot], timer);
+    wheel->occupied[level] |= (uint64_t) 1 << slot;
+    wheel->pending++;
+}
+
+/*
+ * Moves the timers in a slot to lower levels (or expires them), in order.
+ *
+ * PARAMETERS
+ *     wheel: The timer wheel.
+ *     level: The level of the slot.
+ *     slot: The slot.
+ */
+static void cascade(TimerWheel * wheel, unsigned int level, unsigned int slot) {
+    TimerList * list = &wheel->slots[level][slot]; // the slot to cascade
+
+    while (list->head != NULL) {
+        Timer * timer = list->head; // the timer to move
+
+        list_remove(timer);
+        wheel->pending--;
+        insert(wheel, timer);
+    }
+    wheel->occupied[level] &= ~((uint64_t) 1 << slot);
+}